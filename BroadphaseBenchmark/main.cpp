@@ -0,0 +1,251 @@
+// 同じ記録を全ての広域判定の実装で再生し、時間・メモリ・ペア数を比べる
+// 使い方: BroadphaseBenchmark [記録ファイル...] [--frames N] [--save 出力先]
+// 記録ファイルを渡さなければ組み込みのシーンを生成する
+// ゲーム側ではCollisionWorld::SetRecordingで記録し、BroadphaseRecording::Saveで書き出す
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../Renderer/Collision/Broadphase.hpp"
+#include "../Renderer/Collision/BroadphaseRecording.hpp"
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    struct BenchmarkScene {
+        std::string name;
+        BroadphaseRecording recording;
+    };
+
+    struct Result {
+        double updateMilliseconds;
+        double pairMilliseconds;
+        size_t peakMemory;
+        std::uint64_t pairCount;
+        // 実装間でペアの集合が一致するかの確認用
+        std::uint64_t pairHash;
+    };
+
+    struct Body {
+        Vector3 position;
+        Vector3 velocity;
+        Vector3 halfSize;
+    };
+
+    AABB MakeAABB(const Body& body) {
+        return AABB(body.position - body.halfSize, body.position + body.halfSize);
+    }
+
+    // 立方体の中で跳ね返りながら動く箱
+    void StepBodies(std::vector<Body>& bodies, float worldHalfSize, float deltaTime) {
+        for (auto& body : bodies) {
+            body.position += body.velocity * deltaTime;
+            for (size_t i = 0; i < 3; ++i) {
+                if (std::abs(body.position[i]) > worldHalfSize) {
+                    body.position[i] = std::clamp(body.position[i], -worldHalfSize, worldHalfSize);
+                    body.velocity[i] = -body.velocity[i];
+                }
+            }
+        }
+    }
+
+    // 広い範囲に同じ大きさの物体が散らばる
+    BenchmarkScene GenerateScatter(std::uint32_t frameCount) {
+        const std::uint32_t kBodyCount = 4000;
+        const float kWorldHalfSize = 100.0f;
+        std::mt19937 random(1);
+        std::uniform_real_distribution<float> position(-kWorldHalfSize, kWorldHalfSize);
+        std::uniform_real_distribution<float> velocity(-5.0f, 5.0f);
+
+        BenchmarkScene scene{ "Scatter", {} };
+        std::vector<Body> bodies(kBodyCount);
+        for (auto& body : bodies) {
+            body = { { position(random), position(random), position(random) }, { velocity(random), velocity(random), velocity(random) }, Vector3(0.5f) };
+        }
+        for (std::uint32_t frame = 0; frame < frameCount; ++frame) {
+            scene.recording.BeginFrame();
+            for (std::uint32_t i = 0; i < kBodyCount; ++i) {
+                if (frame == 0) {
+                    scene.recording.Insert(i, MakeAABB(bodies[i]));
+                }
+                else {
+                    scene.recording.Move(i, MakeAABB(bodies[i]));
+                }
+            }
+            StepBodies(bodies, kWorldHalfSize, 1.0f / 60.0f);
+        }
+        return scene;
+    }
+
+    // 狭い範囲に密集して重なりが多い
+    BenchmarkScene GenerateCluster(std::uint32_t frameCount) {
+        const std::uint32_t kBodyCount = 2000;
+        const float kWorldHalfSize = 12.0f;
+        std::mt19937 random(2);
+        std::uniform_real_distribution<float> position(-kWorldHalfSize, kWorldHalfSize);
+        std::uniform_real_distribution<float> velocity(-2.0f, 2.0f);
+        std::uniform_real_distribution<float> size(0.25f, 1.0f);
+
+        BenchmarkScene scene{ "Cluster", {} };
+        std::vector<Body> bodies(kBodyCount);
+        for (auto& body : bodies) {
+            body = { { position(random), position(random), position(random) }, { velocity(random), velocity(random), velocity(random) }, Vector3(size(random)) };
+        }
+        for (std::uint32_t frame = 0; frame < frameCount; ++frame) {
+            scene.recording.BeginFrame();
+            for (std::uint32_t i = 0; i < kBodyCount; ++i) {
+                if (frame == 0) {
+                    scene.recording.Insert(i, MakeAABB(bodies[i]));
+                }
+                else {
+                    scene.recording.Move(i, MakeAABB(bodies[i]));
+                }
+            }
+            StepBodies(bodies, kWorldHalfSize, 1.0f / 60.0f);
+        }
+        return scene;
+    }
+
+    // 動かない大きな床や壁と、小さな物体の出入り
+    BenchmarkScene GenerateLevel(std::uint32_t frameCount) {
+        const std::uint32_t kStaticCount = 200;
+        const std::uint32_t kDynamicCount = 1500;
+        const float kWorldHalfSize = 80.0f;
+        std::mt19937 random(3);
+        std::uniform_real_distribution<float> position(-kWorldHalfSize, kWorldHalfSize);
+        std::uniform_real_distribution<float> velocity(-8.0f, 8.0f);
+        std::uniform_real_distribution<float> staticSize(2.0f, 20.0f);
+        std::uniform_real_distribution<float> dynamicSize(0.3f, 0.8f);
+        std::uniform_int_distribution<std::uint32_t> pick(0, kDynamicCount - 1);
+
+        BenchmarkScene scene{ "Level", {} };
+        std::vector<Body> bodies(kStaticCount + kDynamicCount);
+        for (std::uint32_t i = 0; i < bodies.size(); ++i) {
+            bool isStatic = i < kStaticCount;
+            bodies[i].position = { position(random), position(random) * (isStatic ? 0.1f : 1.0f), position(random) };
+            bodies[i].velocity = isStatic ? Vector3::zero : Vector3(velocity(random), velocity(random), velocity(random));
+            bodies[i].halfSize = isStatic ? Vector3(staticSize(random), 0.5f, staticSize(random)) : Vector3(dynamicSize(random));
+        }
+        std::vector<bool> isAlive(bodies.size(), true);
+        for (std::uint32_t frame = 0; frame < frameCount; ++frame) {
+            scene.recording.BeginFrame();
+            // 毎フレームいくつかの物体を消したり出したりする
+            if (frame > 0) {
+                for (std::uint32_t n = 0; n < 10; ++n) {
+                    std::uint32_t i = kStaticCount + pick(random);
+                    if (isAlive[i]) {
+                        scene.recording.Remove(i);
+                    }
+                    else {
+                        scene.recording.Insert(i, MakeAABB(bodies[i]));
+                    }
+                    isAlive[i] = !isAlive[i];
+                }
+            }
+            for (std::uint32_t i = 0; i < bodies.size(); ++i) {
+                if (frame == 0) {
+                    scene.recording.Insert(i, MakeAABB(bodies[i]));
+                }
+                else if (i >= kStaticCount && isAlive[i]) {
+                    scene.recording.Move(i, MakeAABB(bodies[i]));
+                }
+            }
+            StepBodies(bodies, kWorldHalfSize, 1.0f / 60.0f);
+        }
+        return scene;
+    }
+
+    Result Run(const BroadphaseRecording& recording, BroadphaseType type) {
+        auto broadphase = CreateBroadphase(type);
+        Result result{};
+        std::vector<std::uint64_t> pairs;
+        for (std::uint32_t frame = 0; frame < recording.GetFrameCount(); ++frame) {
+            auto start = Clock::now();
+            recording.Replay(frame, *broadphase);
+            auto middle = Clock::now();
+            pairs.clear();
+            broadphase->ComputePairs(pairs);
+            auto end = Clock::now();
+
+            result.updateMilliseconds += std::chrono::duration<double, std::milli>(middle - start).count();
+            result.pairMilliseconds += std::chrono::duration<double, std::milli>(end - middle).count();
+            result.peakMemory = std::max(result.peakMemory, broadphase->GetMemoryUsage());
+            result.pairCount += pairs.size();
+            // 順序に依存しない和で集合を比べる
+            for (auto key : pairs) {
+                result.pairHash += key * 0x9E3779B97F4A7C15ull;
+            }
+        }
+        return result;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::uint32_t frameCount = 300;
+    std::filesystem::path saveDirectory;
+    std::vector<BenchmarkScene> scenes;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            frameCount = static_cast<std::uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (std::strcmp(argv[i], "--save") == 0 && i + 1 < argc) {
+            saveDirectory = argv[++i];
+        }
+        else {
+            BenchmarkScene scene;
+            scene.name = std::filesystem::path(argv[i]).stem().string();
+            if (!scene.recording.Load(argv[i])) {
+                std::fprintf(stderr, "Failed to load %s\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+            scenes.emplace_back(std::move(scene));
+        }
+    }
+    if (scenes.empty()) {
+        scenes.emplace_back(GenerateScatter(frameCount));
+        scenes.emplace_back(GenerateCluster(frameCount));
+        scenes.emplace_back(GenerateLevel(frameCount));
+    }
+    if (!saveDirectory.empty()) {
+        std::filesystem::create_directories(saveDirectory);
+        for (const auto& scene : scenes) {
+            scene.recording.Save(saveDirectory / (scene.name + ".bprc"));
+        }
+    }
+
+    bool isConsistent = true;
+    for (const auto& scene : scenes) {
+        std::printf("%s (%u frames)\n", scene.name.c_str(), scene.recording.GetFrameCount());
+        std::printf("  %-16s %12s %12s %12s %12s %14s\n", "Broadphase", "Update(ms)", "Pairs(ms)", "ms/frame", "Memory(KB)", "Pairs");
+        std::uint64_t referenceHash = 0;
+        for (std::uint32_t type = 0; type < static_cast<std::uint32_t>(BroadphaseType::kCount); ++type) {
+            Result result = Run(scene.recording, static_cast<BroadphaseType>(type));
+            double frames = std::max(scene.recording.GetFrameCount(), 1u);
+            std::printf("  %-16s %12.3f %12.3f %12.4f %12.1f %14llu\n",
+                GetBroadphaseName(static_cast<BroadphaseType>(type)),
+                result.updateMilliseconds,
+                result.pairMilliseconds,
+                (result.updateMilliseconds + result.pairMilliseconds) / frames,
+                static_cast<double>(result.peakMemory) / 1024.0,
+                static_cast<unsigned long long>(result.pairCount));
+            if (type == 0) {
+                referenceHash = result.pairHash;
+            }
+            else if (result.pairHash != referenceHash) {
+                std::printf("  ! %s reported a different pair set\n", GetBroadphaseName(static_cast<BroadphaseType>(type)));
+                isConsistent = false;
+            }
+        }
+    }
+    return isConsistent ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -21,6 +21,11 @@ public:
     Vector3 Extent() const { return max - min; }
     float Extent(size_t dim) const { return max[dim] - min[dim]; }
 
+    float SurfaceArea() const {
+        Vector3 extent = Extent();
+        return 2.0f * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+    }
+
     Vector3 Center() const { return (max + min) * 0.5f; }
     float Center(size_t dim) const { return (max[dim] + min[dim]) * 0.5f; }
 
@@ -29,7 +34,9 @@ public:
             min.x <= other.min.x &&
             other.max.x <= max.x &&
             min.y <= other.min.y &&
-            other.max.y <= max.y;
+            other.max.y <= max.y &&
+            min.z <= other.min.z &&
+            other.max.z <= max.z;
     }
     bool Contains(const Vector2& point) const {
         return
@@ -44,7 +51,39 @@ public:
             min.x <= other.max.x &&
             other.min.x <= max.x &&
             min.y <= other.max.y &&
-            other.min.y <= max.y;
+            other.min.y <= max.y &&
+            min.z <= other.max.z &&
+            other.min.z <= max.z;
+    }
+    // スラブ法。[tMin, tMax]に交差区間を返す
+    bool IntersectsRay(const Vector3& origin, const Vector3& direction, float& tMin, float& tMax) const {
+        for (size_t i = 0; i < 3; ++i) {
+            if (std::abs(direction[i]) < 1.0e-8f) {
+                if (origin[i] < min[i] || origin[i] > max[i]) { return false; }
+                continue;
+            }
+            float invDirection = 1.0f / direction[i];
+            float t0 = (min[i] - origin[i]) * invDirection;
+            float t1 = (max[i] - origin[i]) * invDirection;
+            if (t0 > t1) { std::swap(t0, t1); }
+            tMin = std::max(tMin, t0);
+            tMax = std::min(tMax, t1);
+            if (tMin > tMax) { return false; }
+        }
+        return true;
+    }
+    // アフィン変換した箱を包むAABB。中心を変換し、広がりは行列の絶対値で求める
+    AABB Transformed(const Matrix4x4& matrix) const {
+        Vector3 center = Center() * matrix;
+        Vector3 halfExtent = Extent() * 0.5f;
+        Vector3 extent;
+        for (size_t i = 0; i < 3; ++i) {
+            extent[i] =
+                std::abs(matrix.m[0][i]) * halfExtent.x +
+                std::abs(matrix.m[1][i]) * halfExtent.y +
+                std::abs(matrix.m[2][i]) * halfExtent.z;
+        }
+        return AABB(center - extent, center + extent);
     }
     size_t LongestAxis() const {
         Vector3 extent = Extent();
@@ -0,0 +1,50 @@
+#include "BoxCollider.hpp"
+
+#include "Externals/ImGui/imgui.h"
+
+#include "Transform.hpp"
+#include "Collision/Support.hpp"
+
+Vector3 BoxCollider::FindFurthestPoint(const Vector3& direction) const {
+    return ToWorldPoint(center_ + Support::Box(ToLocalDirection(direction), size_ * 0.5f));
+}
+
+void BoxCollider::UpdateAABB() {
+    // 中心と各軸の絶対値から求める（サポート写像6回より安い）
+    const Matrix4x4& world = GetTransform().GetWorldMatrix();
+    Vector3 center = ToWorldPoint(center_);
+    Vector3 halfSize = size_ * 0.5f;
+    Vector3 xAxis = world.GetXAxis() * halfSize.x;
+    Vector3 yAxis = world.GetYAxis() * halfSize.y;
+    Vector3 zAxis = world.GetZAxis() * halfSize.z;
+    Vector3 extent{
+        std::abs(xAxis.x) + std::abs(yAxis.x) + std::abs(zAxis.x),
+        std::abs(xAxis.y) + std::abs(yAxis.y) + std::abs(zAxis.y),
+        std::abs(xAxis.z) + std::abs(yAxis.z) + std::abs(zAxis.z) };
+    aabb_ = AABB(center - extent, center + extent);
+}
+
+std::uint32_t BoxCollider::GetLocalHull(Vector3(&points)[BoundingVolume::kMaxLocalPoints], float& radius) const {
+    Vector3 halfSize = size_ * 0.5f;
+    for (std::uint32_t i = 0; i < 8; ++i) {
+        points[i] = center_ + Vector3(
+            (i & 1) ? halfSize.x : -halfSize.x,
+            (i & 2) ? halfSize.y : -halfSize.y,
+            (i & 4) ? halfSize.z : -halfSize.z);
+    }
+    radius = 0.0f;
+    return 8;
+}
+
+void BoxCollider::ShowUI() {
+    if (ImGui::TreeNodeEx("BoxCollider", ImGuiTreeNodeFlags_DefaultOpen | ImGuiTreeNodeFlags_SpanAvailWidth)) {
+        ImGui::Unindent();
+        Collider::ShowUI();
+        bool isChanged = ImGui::DragFloat3("Center", &center_.x, 0.1f);
+        isChanged |= ImGui::DragFloat3("Size", &size_.x, 0.1f, 0.0f, Math::positiveInfinity);
+        if (isChanged) {
+            MarkShapeChanged();
+        }
+        ImGui::TreePop();
+    }
+}
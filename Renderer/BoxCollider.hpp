@@ -0,0 +1,27 @@
+#pragma once
+#include "Collider.hpp"
+
+class BoxCollider :
+    public Collider {
+public:
+    BoxCollider(GameObject* const gameObject) :
+        Collider(gameObject, Type::kBox),
+        center_(Vector3::zero),
+        size_(Vector3::one) {
+    }
+
+    Vector3 FindFurthestPoint(const Vector3& direction) const override;
+    std::uint32_t GetLocalHull(Vector3(&points)[BoundingVolume::kMaxLocalPoints], float& radius) const override;
+    void UpdateAABB() override;
+    void ShowUI() override;
+
+    void SetCenter(const Vector3& center) { center_ = center; MarkShapeChanged(); }
+    void SetSize(const Vector3& size) { size_ = size; MarkShapeChanged(); }
+
+    const Vector3& GetCenter() const { return center_; }
+    const Vector3& GetSize() const { return size_; }
+
+private:
+    Vector3 center_;
+    Vector3 size_;
+};
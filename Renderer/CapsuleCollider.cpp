@@ -0,0 +1,31 @@
+#include "CapsuleCollider.hpp"
+
+#include "Externals/ImGui/imgui.h"
+
+#include "Collision/Support.hpp"
+
+Vector3 CapsuleCollider::FindFurthestPoint(const Vector3& direction) const {
+    return ToWorldPoint(center_ + Support::Capsule(ToLocalDirection(direction), radius_, GetHalfSegment()));
+}
+
+std::uint32_t CapsuleCollider::GetLocalHull(Vector3(&points)[BoundingVolume::kMaxLocalPoints], float& radius) const {
+    float halfSegment = GetHalfSegment();
+    points[0] = center_ + Vector3(0.0f, halfSegment, 0.0f);
+    points[1] = center_ - Vector3(0.0f, halfSegment, 0.0f);
+    radius = radius_;
+    return 2;
+}
+
+void CapsuleCollider::ShowUI() {
+    if (ImGui::TreeNodeEx("CapsuleCollider", ImGuiTreeNodeFlags_DefaultOpen | ImGuiTreeNodeFlags_SpanAvailWidth)) {
+        ImGui::Unindent();
+        Collider::ShowUI();
+        bool isChanged = ImGui::DragFloat3("Center", &center_.x, 0.1f);
+        isChanged |= ImGui::DragFloat("Radius", &radius_, 0.1f, 0.0f, Math::positiveInfinity);
+        isChanged |= ImGui::DragFloat("Height", &height_, 0.1f, 0.0f, Math::positiveInfinity);
+        if (isChanged) {
+            MarkShapeChanged();
+        }
+        ImGui::TreePop();
+    }
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include "Collider.hpp"
+
+// ローカルY軸方向のカプセル
+class CapsuleCollider :
+    public Collider {
+public:
+    CapsuleCollider(GameObject* const gameObject) :
+        Collider(gameObject, Type::kCapsule),
+        center_(Vector3::zero),
+        radius_(0.5f),
+        height_(2.0f) {
+    }
+
+    Vector3 FindFurthestPoint(const Vector3& direction) const override;
+    std::uint32_t GetLocalHull(Vector3(&points)[BoundingVolume::kMaxLocalPoints], float& radius) const override;
+    void ShowUI() override;
+
+    void SetCenter(const Vector3& center) { center_ = center; MarkShapeChanged(); }
+    void SetRadius(float radius) { radius_ = radius; MarkShapeChanged(); }
+    void SetHeight(float height) { height_ = height; MarkShapeChanged(); }
+
+    const Vector3& GetCenter() const { return center_; }
+    float GetRadius() const { return radius_; }
+    // 半球を含めた全長
+    float GetHeight() const { return height_; }
+    // 半球の中心間の半分の長さ
+    float GetHalfSegment() const { return std::max(height_ * 0.5f - radius_, 0.0f); }
+
+private:
+    Vector3 center_;
+    float radius_;
+    float height_;
+};
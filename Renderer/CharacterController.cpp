@@ -0,0 +1,330 @@
+#include "CharacterController.hpp"
+
+#include "Externals/ImGui/imgui.h"
+
+#include "Collider.hpp"
+#include "DistanceFieldCollider.hpp"
+#include "GameObject.hpp"
+#include "Scene.hpp"
+#include "Collision/GJK.hpp"
+#include "Collision/EPA.hpp"
+#include "Collision/Support.hpp"
+
+namespace {
+    constexpr std::uint32_t kMaxSlideIterations = 4;
+    constexpr std::uint32_t kMaxDepenetrationIterations = 4;
+    // これより短い移動は無視する
+    constexpr float kMinMoveDistance = 1.0e-5f;
+    // 距離場の面に着いたとみなす隙間
+    constexpr float kFieldHitTolerance = 1.0e-3f;
+    constexpr std::uint32_t kMaxFieldSweepSteps = 64;
+    // カプセルの芯を距離場で測る点の数の上限
+    constexpr std::uint32_t kMaxSegmentSamples = 8;
+
+    // Y軸に沿ったカプセルの芯を半径おきに測り、最も面に近い点とその距離を返す
+    SignedDistanceField::Sample SampleSegment(const SignedDistanceField& field, const Matrix4x4& toLocal, const Vector3& center, float halfSegment, float radius, Vector3& point) {
+        std::uint32_t count = 1;
+        if (halfSegment > 0.0f) {
+            float spans = std::ceil(2.0f * halfSegment / std::max(radius, kMinMoveDistance));
+            count = static_cast<std::uint32_t>(std::min(spans, static_cast<float>(kMaxSegmentSamples - 1))) + 1;
+        }
+        SignedDistanceField::Sample nearest = { Math::positiveInfinity, Vector3::unitY };
+        point = center;
+        for (std::uint32_t i = 0; i < count; ++i) {
+            float t = count > 1 ? static_cast<float>(i) / static_cast<float>(count - 1) * 2.0f - 1.0f : 0.0f;
+            Vector3 samplePoint = center + Vector3(0.0f, halfSegment * t, 0.0f);
+            SignedDistanceField::Sample sample = field.Evaluate(samplePoint, toLocal);
+            if (sample.distance < nearest.distance) {
+                nearest = sample;
+                point = samplePoint;
+            }
+        }
+        return nearest;
+    }
+}
+
+std::uint32_t CharacterController::Move(const Vector3& displacement) {
+    Transform& transform = GetTransform();
+    Vector3 position = transform.translate;
+    const float cosSlopeLimit = std::cos(slopeLimit_ * Math::ToRadian);
+
+    Vector3 horizontal = { displacement.x, 0.0f, displacement.z };
+    float rise = std::max(displacement.y, 0.0f);
+    float fall = std::max(-displacement.y, 0.0f);
+    // 接地して横に歩くときだけ段差を上る
+    float stepUp = isGrounded_ && displacement.y <= 0.0f && horizontal.LengthSquare() > kMinMoveDistance * kMinMoveDistance ? stepOffset_ : 0.0f;
+    // 接地していれば下り段差や下り坂に吸い付かせる
+    float snap = isGrounded_ && displacement.y <= 0.0f ? stepOffset_ : 0.0f;
+
+    // 届きうる範囲の部品を一度だけ集め、以降の掃引で使い回す
+    float reach = displacement.Length() + stepUp + snap + radius_ + skinWidth_;
+    AABB bounds = GetBounds(position);
+    CollectParts(AABB(bounds.min - Vector3(reach, reach, reach), bounds.max + Vector3(reach, reach, reach)));
+
+    Depenetrate(position);
+
+    Vector3 start = position;
+    for (std::uint32_t attempt = 0; attempt < 2; ++attempt) {
+        collisionFlags_ = kCollisionNone;
+        isGrounded_ = false;
+        groundNormal_ = Vector3::unitY;
+
+        // 上り。天井に当たった分だけ段差の高さも減る
+        float climbed = 0.0f;
+        float up = rise + stepUp;
+        if (up > kMinMoveDistance) {
+            Hit hit;
+            climbed = up;
+            if (Sweep(position, Vector3::unitY, up + skinWidth_, hit)) {
+                climbed = std::max(hit.distance - skinWidth_, 0.0f);
+                if (rise > 0.0f) {
+                    collisionFlags_ |= kCollisionAbove;
+                }
+            }
+            position.y += climbed;
+        }
+        float stepped = std::min(climbed, stepUp);
+
+        SlideMove(position, horizontal, Pass::kSide);
+
+        // 下り。上った段差の分も下ろす
+        float down = fall + stepped;
+        Hit hit;
+        if (down + snap > kMinMoveDistance && Sweep(position, -Vector3::unitY, down + snap + skinWidth_, hit)) {
+            float travel = std::max(hit.distance - skinWidth_, 0.0f);
+            if (hit.normal.y >= cosSlopeLimit) {
+                position.y -= travel;
+                collisionFlags_ |= kCollisionBelow;
+                isGrounded_ = true;
+                groundNormal_ = hit.normal;
+            }
+            else if (travel < down) {
+                // 急な斜面は残りの分だけ滑り落ちる
+                position.y -= travel;
+                SlideMove(position, Vector3(0.0f, travel - down, 0.0f), Pass::kDown);
+            }
+            else {
+                position.y -= down;
+            }
+        }
+        else {
+            position.y -= down;
+        }
+
+        // 段差を上った先が歩ける面でなければ、上らずにやり直す
+        if (stepped <= 0.0f || isGrounded_) {
+            break;
+        }
+        position = start;
+        stepUp = 0.0f;
+    }
+
+    transform.translate = position;
+    transform.UpdateWorldMatrix();
+    return collisionFlags_;
+}
+
+void CharacterController::ShowUI() {
+    if (ImGui::TreeNodeEx("CharacterController", ImGuiTreeNodeFlags_DefaultOpen | ImGuiTreeNodeFlags_SpanAvailWidth)) {
+        ImGui::Unindent();
+        ImGui::DragFloat3("Center", &center_.x, 0.1f);
+        ImGui::DragFloat("Radius", &radius_, 0.1f, 0.0f, Math::positiveInfinity);
+        ImGui::DragFloat("Height", &height_, 0.1f, 0.0f, Math::positiveInfinity);
+        ImGui::DragFloat("SlopeLimit", &slopeLimit_, 1.0f, 0.0f, 90.0f);
+        ImGui::DragFloat("StepOffset", &stepOffset_, 0.01f, 0.0f, Math::positiveInfinity);
+        ImGui::DragFloat("SkinWidth", &skinWidth_, 0.001f, 0.0f, Math::positiveInfinity);
+        ImGui::Text("Grounded %s", isGrounded_ ? "true" : "false");
+        ImGui::TreePop();
+    }
+}
+
+void CharacterController::CollectParts(const AABB& bounds) {
+    colliders_.clear();
+    parts_.clear();
+    fields_.clear();
+    scratch_.triangles.clear();
+    Scene* scene = gameObject.GetScene();
+    if (!scene) {
+        return;
+    }
+    scene->GetCollisionWorld().Query(bounds, colliders_, ids_);
+    for (Collider* collider : colliders_) {
+        if (collider->IsTrigger() || &collider->gameObject == &gameObject) {
+            continue;
+        }
+        if (collider->GetType() == Collider::Type::kDistanceField) {
+            const SignedDistanceField& field = static_cast<const DistanceFieldCollider*>(collider)->GetField();
+            if (!field.IsEmpty()) {
+                fields_.push_back({ &field, collider->GetTransform().GetWorldMatrix().Inverse(), collider->GetAABB() });
+            }
+            continue;
+        }
+        Narrowphase::CollectParts(*collider, bounds, scratch_, parts_);
+    }
+}
+
+bool CharacterController::Sweep(const Vector3& position, const Vector3& direction, float distance, Hit& hit) const {
+    Vector3 capsuleCenter = position + center_;
+    float halfSegment = GetHalfSegment();
+    auto supportA = [&](const Vector3& d) { return capsuleCenter + Support::Capsule(d, radius_, halfSegment); };
+    AABB bounds = GetBounds(position);
+    bounds.Include(GetBounds(position + direction * distance));
+
+    bool isHit = false;
+    hit.distance = distance;
+    for (const auto& part : parts_) {
+        if (!part.aabb.Intersects(bounds)) {
+            continue;
+        }
+        auto supportB = [&](const Vector3& d) { return Narrowphase::FindPartFurthestPoint(part, scratch_.triangles, d); };
+        float partDistance;
+        Vector3 point, normal;
+        if (GJK::ShapeCast(supportA, supportB, direction, hit.distance, partDistance, point, normal) && partDistance <= hit.distance) {
+            hit.point = point;
+            hit.normal = normal;
+            hit.distance = partDistance;
+            isHit = true;
+        }
+    }
+    // 距離場はカプセルの芯と面の隙間だけ進めて辿る
+    for (const auto& fieldPart : fields_) {
+        if (!fieldPart.aabb.Intersects(bounds)) {
+            continue;
+        }
+        float travel = 0.0f;
+        for (std::uint32_t step = 0; travel <= hit.distance; ++step) {
+            Vector3 point;
+            SignedDistanceField::Sample sample = SampleSegment(*fieldPart.field, fieldPart.toLocal, capsuleCenter + direction * travel, halfSegment, radius_, point);
+            float gap = sample.distance - radius_;
+            // 面に着くか、面に沿って進み続けて上限に達したらそこで止める
+            if (gap <= kFieldHitTolerance || step + 1 == kMaxFieldSweepSteps) {
+                // 面から離れる向きなら当たりにしない
+                if (gap > kFieldHitTolerance || Vector3::Dot(direction, sample.gradient) < 0.0f) {
+                    hit.point = point - sample.gradient * sample.distance;
+                    hit.normal = sample.gradient;
+                    hit.distance = travel;
+                    isHit = true;
+                }
+                break;
+            }
+            travel += gap;
+        }
+    }
+    return isHit;
+}
+
+void CharacterController::Depenetrate(Vector3& position) const {
+    float halfSegment = GetHalfSegment();
+    for (std::uint32_t iteration = 0; iteration < kMaxDepenetrationIterations; ++iteration) {
+        bool isSeparated = true;
+        AABB bounds = GetBounds(position);
+        for (const auto& part : parts_) {
+            if (!part.aabb.Intersects(bounds)) {
+                continue;
+            }
+            Vector3 capsuleCenter = position + center_;
+            auto supportA = [&](const Vector3& d) { return capsuleCenter + Support::Capsule(d, radius_, halfSegment); };
+            auto supportB = [&](const Vector3& d) { return Narrowphase::FindPartFurthestPoint(part, scratch_.triangles, d); };
+            Simplex simplex;
+            GJK::Result result;
+            if (!GJK::Distance(supportA, supportB, result, simplex, skinWidth_, part.aabb.Center() - capsuleCenter)) {
+                continue;
+            }
+            if (!result.isIntersecting) {
+                // 接したままだと次の掃引が始めから当たるので隙間を戻す
+                if (result.distance > 0.0f && skinWidth_ - result.distance > kMinMoveDistance) {
+                    position += (result.pointA - result.pointB) * ((skinWidth_ - result.distance) / result.distance);
+                    isSeparated = false;
+                }
+                continue;
+            }
+            EPA::Result epa;
+            if (EPA::Penetration(supportA, supportB, simplex, epa)) {
+                position -= epa.normal * (epa.depth + skinWidth_);
+                isSeparated = false;
+            }
+        }
+        // 距離場は芯の最も近い点を勾配の向きに、面から半径とskinWidthの分だけ離す
+        for (const auto& fieldPart : fields_) {
+            if (!fieldPart.aabb.Intersects(bounds)) {
+                continue;
+            }
+            Vector3 point;
+            SignedDistanceField::Sample sample = SampleSegment(*fieldPart.field, fieldPart.toLocal, position + center_, halfSegment, radius_, point);
+            float push = radius_ + skinWidth_ - sample.distance;
+            if (push > kMinMoveDistance) {
+                position += sample.gradient * push;
+                isSeparated = false;
+            }
+        }
+        if (isSeparated) {
+            break;
+        }
+    }
+}
+
+void CharacterController::SlideMove(Vector3& position, const Vector3& displacement, Pass pass) {
+    const float cosSlopeLimit = std::cos(slopeLimit_ * Math::ToRadian);
+    Vector3 remaining = displacement;
+    Vector3 previousNormal = Vector3::zero;
+    for (std::uint32_t iteration = 0; iteration < kMaxSlideIterations; ++iteration) {
+        float length = remaining.Length();
+        if (length <= kMinMoveDistance) {
+            break;
+        }
+        Vector3 direction = remaining / length;
+        Hit hit;
+        if (!Sweep(position, direction, length + skinWidth_, hit)) {
+            position += remaining;
+            break;
+        }
+        float travel = std::max(hit.distance - skinWidth_, 0.0f);
+        position += direction * travel;
+
+        Vector3 normal = hit.normal;
+        if (normal.y >= cosSlopeLimit) {
+            collisionFlags_ |= kCollisionBelow;
+            isGrounded_ = true;
+            groundNormal_ = normal;
+            // 滑り落ちている途中で歩ける面に着いた
+            if (pass == Pass::kDown) {
+                break;
+            }
+        }
+        else {
+            collisionFlags_ |= normal.y <= -cosSlopeLimit ? kCollisionAbove : kCollisionSides;
+            // 横移動では急な斜面を垂直な壁とみなし、上らせない
+            if (pass == Pass::kSide) {
+                Vector3 wall = { normal.x, 0.0f, normal.z };
+                if (wall.LengthSquare() > kMinMoveDistance * kMinMoveDistance) {
+                    normal = wall.Normalized();
+                }
+            }
+        }
+
+        // 残りを面に沿わせる
+        remaining = direction * (length - travel);
+        remaining -= normal * Vector3::Dot(remaining, normal);
+        // 前の面に押し戻されるなら2枚の面の折り目に沿わせる
+        if (Vector3::Dot(remaining, previousNormal) < 0.0f) {
+            Vector3 crease = Vector3::Cross(previousNormal, normal);
+            float creaseLengthSquare = crease.LengthSquare();
+            if (creaseLengthSquare <= kMinMoveDistance * kMinMoveDistance) {
+                break;
+            }
+            crease /= std::sqrt(creaseLengthSquare);
+            remaining = crease * Vector3::Dot(remaining, crease);
+        }
+        // 元の向きに逆らう動きは捨てて振動を防ぐ
+        if (Vector3::Dot(remaining, displacement) <= 0.0f) {
+            break;
+        }
+        previousNormal = normal;
+    }
+}
+
+AABB CharacterController::GetBounds(const Vector3& position) const {
+    Vector3 capsuleCenter = position + center_;
+    Vector3 extent = { radius_ + skinWidth_, GetHalfSegment() + radius_ + skinWidth_, radius_ + skinWidth_ };
+    return AABB(capsuleCenter - extent, capsuleCenter + extent);
+}
@@ -0,0 +1,112 @@
+#pragma once
+#include "Component.hpp"
+
+#include <cstdint>
+#include <vector>
+
+#include "Math/MathUtils.hpp"
+#include "AABB.hpp"
+#include "Collision/Narrowphase.hpp"
+
+class Collider;
+class SignedDistanceField;
+
+// カプセルを掃引して動かす運動学的なキャラクター
+// 壁に沿って滑り、stepOffset以下の段差を上り、slopeLimitより急な斜面は上らない
+// カプセルはワールドY軸方向で回転しない。ルートのGameObjectに付ける
+// 同じGameObjectのコライダーとトリガーは無視する
+class CharacterController :
+    public Component {
+public:
+    // Moveで当たった向き
+    static constexpr std::uint32_t kCollisionNone = 0;
+    static constexpr std::uint32_t kCollisionSides = 1 << 0;
+    static constexpr std::uint32_t kCollisionAbove = 1 << 1;
+    static constexpr std::uint32_t kCollisionBelow = 1 << 2;
+
+    CharacterController(GameObject* const gameObject) :
+        Component(gameObject),
+        center_(Vector3::zero),
+        groundNormal_(Vector3::unitY),
+        radius_(0.5f),
+        height_(2.0f),
+        slopeLimit_(45.0f),
+        stepOffset_(0.3f),
+        skinWidth_(0.02f),
+        collisionFlags_(kCollisionNone),
+        isGrounded_(false) {
+    }
+
+    // ワールド空間の移動量だけ動かし、当たった向きを返す。重力も呼び出し側で足す
+    std::uint32_t Move(const Vector3& displacement);
+    void ShowUI() override;
+
+    void SetCenter(const Vector3& center) { center_ = center; }
+    void SetRadius(float radius) { radius_ = radius; }
+    void SetHeight(float height) { height_ = height; }
+    // 度
+    void SetSlopeLimit(float slopeLimit) { slopeLimit_ = slopeLimit; }
+    void SetStepOffset(float stepOffset) { stepOffset_ = stepOffset; }
+    // 周りと空けておく隙間。接したまま動いて引っかかるのを防ぐ
+    void SetSkinWidth(float skinWidth) { skinWidth_ = skinWidth; }
+
+    const Vector3& GetCenter() const { return center_; }
+    float GetRadius() const { return radius_; }
+    // 半球を含めた全長
+    float GetHeight() const { return height_; }
+    float GetSlopeLimit() const { return slopeLimit_; }
+    float GetStepOffset() const { return stepOffset_; }
+    float GetSkinWidth() const { return skinWidth_; }
+    std::uint32_t GetCollisionFlags() const { return collisionFlags_; }
+    // 直前のMoveで歩ける面に立ったか
+    bool IsGrounded() const { return isGrounded_; }
+    const Vector3& GetGroundNormal() const { return groundNormal_; }
+
+private:
+    struct Hit {
+        Vector3 point;
+        Vector3 normal;
+        float distance;
+    };
+    // 移動の区切り。上り、横、下りで面の扱いが違う
+    enum class Pass {
+        kUp,
+        kSide,
+        kDown
+    };
+
+    // 距離場は凸な部品に分けると中身の詰まった箱になるので、場のまま測る
+    struct FieldPart {
+        const SignedDistanceField* field;
+        Matrix4x4 toLocal;
+        AABB aabb;
+    };
+
+    // Moveで届きうる範囲のコライダーを部品に分けて集める。距離場はfields_に集める
+    void CollectParts(const AABB& bounds);
+    // カプセルをpositionからdirectionに掃引し、最も近い当たりを返す
+    bool Sweep(const Vector3& position, const Vector3& direction, float distance, Hit& hit) const;
+    // 重なっている部品から押し出し、skinWidthに満たない隙間を戻す
+    void Depenetrate(Vector3& position) const;
+    // 当たった面に沿わせながら動かす
+    void SlideMove(Vector3& position, const Vector3& displacement, Pass pass);
+    AABB GetBounds(const Vector3& position) const;
+    float GetHalfSegment() const { return std::max(height_ * 0.5f - radius_, 0.0f); }
+
+    Vector3 center_;
+    Vector3 groundNormal_;
+    float radius_;
+    float height_;
+    float slopeLimit_;
+    float stepOffset_;
+    float skinWidth_;
+    std::uint32_t collisionFlags_;
+    bool isGrounded_;
+
+    // 毎フレーム確保しないように使い回す作業領域
+    std::vector<Collider*> colliders_;
+    std::vector<std::uint32_t> ids_;
+    std::vector<Narrowphase::ConvexPart> parts_;
+    std::vector<FieldPart> fields_;
+    Narrowphase::Scratch scratch_;
+};
@@ -0,0 +1,425 @@
+#include "Cloth.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cmath>
+#include <unordered_map>
+
+#include "Externals/ImGui/imgui.h"
+
+#include "GameObject.hpp"
+#include "Renderer.hpp"
+#include "Scene.hpp"
+#include "ThreadPool.hpp"
+#include "Collider.hpp"
+#include "Collision/CollisionWorld.hpp"
+
+namespace {
+    // 1タスクで扱う頂点と拘束の数
+    constexpr std::uint32_t kVertexChunkSize = 1024;
+    constexpr std::uint32_t kConstraintChunkSize = 256;
+    // 頂点ごとに64ビットで使った色を覚える。最後の色は溢れた拘束を入れ、順に解く
+    constexpr std::uint32_t kOverflowColor = 63;
+    constexpr float kEpsilon = 1.0e-6f;
+
+    std::uint32_t GetChunkCount(std::uint32_t count, std::uint32_t chunkSize) {
+        return (count + chunkSize - 1) / chunkSize;
+    }
+}
+
+void Cloth::SetMesh(const std::vector<Vector3>& positions, const std::vector<std::uint16_t>& indices) {
+    assert(positions.size() <= kMaxVertexCount);
+    assert(indices.size() % 3 == 0);
+    localPositions_ = positions;
+    indices_ = indices;
+    mesh_ = kInvalidMesh;
+
+    const Matrix4x4& world = GetTransform().GetWorldMatrix();
+    for (size_t axis = 0; axis < 3; ++axis) {
+        positions_[axis].resize(positions.size());
+        previousPositions_[axis].resize(positions.size());
+        velocities_[axis].assign(positions.size(), 0.0f);
+    }
+    for (size_t i = 0; i < positions.size(); ++i) {
+        Vector3 position = positions[i] * world;
+        for (size_t axis = 0; axis < 3; ++axis) {
+            positions_[axis][i] = position[axis];
+        }
+    }
+    pinnedVertices_.clear();
+    pinnedLocalPositions_.clear();
+    UpdateInverseMasses();
+
+    // 辺ごとに最初の三角形の向かいの頂点を覚え、2つ目の三角形が来たら向かい同士を曲げの拘束にする
+    constraints_.clear();
+    std::unordered_map<std::uint64_t, std::uint32_t> edges;
+    auto addConstraint = [&](std::uint32_t v0, std::uint32_t v1, ConstraintType type) {
+        float restLength = (GetPosition(v1) - GetPosition(v0)).Length();
+        constraints_.push_back({ { v0, v1 }, restLength, type });
+        };
+    for (size_t i = 0; i < indices.size(); i += 3) {
+        for (size_t edge = 0; edge < 3; ++edge) {
+            std::uint32_t v0 = indices[i + edge];
+            std::uint32_t v1 = indices[i + (edge + 1) % 3];
+            std::uint32_t opposite = indices[i + (edge + 2) % 3];
+            std::uint64_t key = (static_cast<std::uint64_t>(std::min(v0, v1)) << 32) | std::max(v0, v1);
+            auto [iter, isInserted] = edges.emplace(key, opposite);
+            if (isInserted) {
+                addConstraint(v0, v1, ConstraintType::kStretch);
+            }
+            else if (iter->second != opposite) {
+                addConstraint(iter->second, opposite, ConstraintType::kBend);
+            }
+        }
+    }
+    ColorConstraints();
+    lambdas_.resize(constraints_.size());
+    restVolume_ = ComputeVolume();
+}
+
+void Cloth::Pin(std::uint32_t vertex) {
+    assert(vertex < GetVertexCount());
+    if (std::find(pinnedVertices_.begin(), pinnedVertices_.end(), vertex) != pinnedVertices_.end()) {
+        return;
+    }
+    pinnedVertices_.push_back(vertex);
+    pinnedLocalPositions_.push_back(localPositions_[vertex]);
+    UpdateInverseMasses();
+}
+
+void Cloth::Unpin(std::uint32_t vertex) {
+    auto iter = std::find(pinnedVertices_.begin(), pinnedVertices_.end(), vertex);
+    if (iter == pinnedVertices_.end()) {
+        return;
+    }
+    size_t index = iter - pinnedVertices_.begin();
+    pinnedVertices_.erase(iter);
+    pinnedLocalPositions_.erase(pinnedLocalPositions_.begin() + index);
+    UpdateInverseMasses();
+}
+
+void Cloth::SetMass(float mass) {
+    mass_ = mass;
+    UpdateInverseMasses();
+}
+
+void Cloth::Update(float deltaTime) {
+    std::uint32_t vertexCount = GetVertexCount();
+    if (vertexCount == 0 || deltaTime <= 0.0f || substepCount_ == 0) {
+        return;
+    }
+    CollectObstacles(deltaTime);
+
+    // 留めた頂点はUpdateの間にTransformの位置まで動かす
+    const Matrix4x4& world = GetTransform().GetWorldMatrix();
+    pinnedStartPositions_.resize(pinnedVertices_.size());
+    for (size_t i = 0; i < pinnedVertices_.size(); ++i) {
+        pinnedStartPositions_[i] = GetPosition(pinnedVertices_[i]);
+    }
+
+    ThreadPool& threadPool = ThreadPool::GetShared();
+    std::uint32_t vertexChunkCount = GetChunkCount(vertexCount, kVertexChunkSize);
+    float timeStep = deltaTime / static_cast<float>(substepCount_);
+    float stretchAlpha = stretchCompliance_ / (timeStep * timeStep);
+    float bendAlpha = bendCompliance_ / (timeStep * timeStep);
+    for (std::uint32_t substep = 0; substep < substepCount_; ++substep) {
+        threadPool.ParallelFor(vertexChunkCount, [&](std::uint32_t chunk) {
+            std::uint32_t begin = chunk * kVertexChunkSize;
+            Predict(begin, std::min(begin + kVertexChunkSize, vertexCount), timeStep);
+            });
+        float t = static_cast<float>(substep + 1) / static_cast<float>(substepCount_);
+        for (size_t i = 0; i < pinnedVertices_.size(); ++i) {
+            Vector3 position = Vector3::Lerp(t, pinnedStartPositions_[i], pinnedLocalPositions_[i] * world);
+            for (size_t axis = 0; axis < 3; ++axis) {
+                positions_[axis][pinnedVertices_[i]] = position[axis];
+            }
+        }
+
+        // サブステップごとに1回ずつ解くので、λも毎回0から
+        std::fill(lambdas_.begin(), lambdas_.end(), 0.0f);
+        for (std::uint32_t color = 0; color + 1 < colorStarts_.size(); ++color) {
+            std::uint32_t colorBegin = colorStarts_[color];
+            std::uint32_t colorEnd = colorStarts_[color + 1];
+            if (color == kOverflowColor) {
+                SolveConstraints(colorBegin, colorEnd, stretchAlpha, bendAlpha);
+                continue;
+            }
+            threadPool.ParallelFor(GetChunkCount(colorEnd - colorBegin, kConstraintChunkSize), [&](std::uint32_t chunk) {
+                std::uint32_t begin = colorBegin + chunk * kConstraintChunkSize;
+                SolveConstraints(begin, std::min(begin + kConstraintChunkSize, colorEnd), stretchAlpha, bendAlpha);
+                });
+        }
+        if (pressure_ > 0.0f) {
+            SolveVolume(timeStep);
+        }
+
+        threadPool.ParallelFor(vertexChunkCount, [&](std::uint32_t chunk) {
+            std::uint32_t begin = chunk * kVertexChunkSize;
+            std::uint32_t end = std::min(begin + kVertexChunkSize, vertexCount);
+            UpdateVelocities(begin, end, timeStep);
+            Collide(begin, end);
+            });
+    }
+}
+
+void Cloth::Draw(Renderer& renderer) {
+    if (GetVertexCount() == 0) {
+        return;
+    }
+    ComputeNormals();
+    if (mesh_ == kInvalidMesh) {
+        // 裏面は頂点を写し、三角形の向きを逆にする
+        std::vector<std::uint16_t> indices(indices_.size() * 2);
+        std::uint32_t vertexCount = GetVertexCount();
+        for (size_t i = 0; i < indices_.size(); i += 3) {
+            indices[i + 0] = indices_[i + 0];
+            indices[i + 1] = indices_[i + 1];
+            indices[i + 2] = indices_[i + 2];
+            indices[indices_.size() + i + 0] = static_cast<std::uint16_t>(indices_[i + 0] + vertexCount);
+            indices[indices_.size() + i + 1] = static_cast<std::uint16_t>(indices_[i + 2] + vertexCount);
+            indices[indices_.size() + i + 2] = static_cast<std::uint16_t>(indices_[i + 1] + vertexCount);
+        }
+        mesh_ = renderer.RegisterDynamicMesh(drawPositions_, indices);
+    }
+    else {
+        renderer.UpdateMesh(mesh_, drawPositions_, drawNormals_);
+    }
+    // 頂点はワールド空間
+    renderer.DrawObject(mesh_, Vector3::one, Quaternion::identity, Vector3::zero, color_);
+}
+
+void Cloth::ShowUI() {
+    if (ImGui::TreeNodeEx("Cloth", ImGuiTreeNodeFlags_DefaultOpen | ImGuiTreeNodeFlags_SpanAvailWidth)) {
+        ImGui::Unindent();
+        int substepCount = static_cast<int>(substepCount_);
+        if (ImGui::DragInt("SubstepCount", &substepCount, 1.0f, 1, 100)) {
+            substepCount_ = static_cast<std::uint32_t>(std::max(substepCount, 1));
+        }
+        float mass = mass_;
+        if (ImGui::DragFloat("Mass", &mass, 0.01f, 0.001f, Math::positiveInfinity)) {
+            SetMass(mass);
+        }
+        ImGui::DragFloat("StretchCompliance", &stretchCompliance_, 1.0e-5f, 0.0f, 1.0f, "%.6f");
+        ImGui::DragFloat("BendCompliance", &bendCompliance_, 1.0e-4f, 0.0f, 1.0f, "%.5f");
+        ImGui::DragFloat("Damping", &damping_, 0.01f, 0.0f, Math::positiveInfinity);
+        ImGui::DragFloat("Thickness", &thickness_, 0.001f, 0.0f, Math::positiveInfinity);
+        ImGui::DragFloat("Friction", &friction_, 0.01f, 0.0f, 1.0f);
+        ImGui::DragFloat("Pressure", &pressure_, 0.01f, 0.0f, Math::positiveInfinity);
+        ImGui::DragFloat3("Gravity", &gravity_.x, 0.1f);
+        ImGui::ColorEdit4("Color", &color_.x);
+        ImGui::Text("Vertices %u Constraints %u Colors %u", GetVertexCount(), GetConstraintCount(), GetColorCount());
+        ImGui::TreePop();
+    }
+}
+
+float Cloth::ComputeVolume() const {
+    // 原点と三角形で作る四面体の符号付き体積の和
+    float volume = 0.0f;
+    for (size_t i = 0; i < indices_.size(); i += 3) {
+        Vector3 p0 = GetPosition(indices_[i + 0]);
+        Vector3 p1 = GetPosition(indices_[i + 1]);
+        Vector3 p2 = GetPosition(indices_[i + 2]);
+        volume += Vector3::Dot(p0, Vector3::Cross(p1, p2));
+    }
+    return volume / 6.0f;
+}
+
+void Cloth::ColorConstraints() {
+    // 貪欲に、両端の頂点がまだ使っていない一番小さい色を選ぶ
+    std::vector<std::uint64_t> usedColors(GetVertexCount(), 0);
+    std::vector<std::uint32_t> colors(constraints_.size());
+    std::uint32_t colorCount = 0;
+    for (size_t i = 0; i < constraints_.size(); ++i) {
+        std::uint32_t v0 = constraints_[i].vertices[0];
+        std::uint32_t v1 = constraints_[i].vertices[1];
+        std::uint64_t used = usedColors[v0] | usedColors[v1];
+        std::uint32_t color = std::min(static_cast<std::uint32_t>(std::countr_zero(~used)), kOverflowColor);
+        if (color != kOverflowColor) {
+            usedColors[v0] |= 1ull << color;
+            usedColors[v1] |= 1ull << color;
+        }
+        colors[i] = color;
+        colorCount = std::max(colorCount, color + 1);
+    }
+
+    colorStarts_.assign(colorCount + 1, 0);
+    for (std::uint32_t color : colors) {
+        ++colorStarts_[color + 1];
+    }
+    for (std::uint32_t color = 0; color < colorCount; ++color) {
+        colorStarts_[color + 1] += colorStarts_[color];
+    }
+    std::vector<Constraint> sorted(constraints_.size());
+    std::vector<std::uint32_t> offsets(colorStarts_.begin(), colorStarts_.end() - 1);
+    for (size_t i = 0; i < constraints_.size(); ++i) {
+        sorted[offsets[colors[i]]++] = constraints_[i];
+    }
+    constraints_.swap(sorted);
+}
+
+void Cloth::Predict(std::uint32_t begin, std::uint32_t end, float timeStep) {
+    Vector3 gravityDelta = gravity_ * timeStep;
+    float damping = std::max(1.0f - damping_ * timeStep, 0.0f);
+    for (std::uint32_t i = begin; i < end; ++i) {
+        bool isFree = inverseMasses_[i] > 0.0f;
+        for (size_t axis = 0; axis < 3; ++axis) {
+            previousPositions_[axis][i] = positions_[axis][i];
+            if (isFree) {
+                velocities_[axis][i] = (velocities_[axis][i] + gravityDelta[axis]) * damping;
+                positions_[axis][i] += velocities_[axis][i] * timeStep;
+            }
+        }
+    }
+}
+
+void Cloth::SolveConstraints(std::uint32_t begin, std::uint32_t end, float stretchAlpha, float bendAlpha) {
+    for (std::uint32_t c = begin; c < end; ++c) {
+        const Constraint& constraint = constraints_[c];
+        std::uint32_t v0 = constraint.vertices[0];
+        std::uint32_t v1 = constraint.vertices[1];
+        float w0 = inverseMasses_[v0];
+        float w1 = inverseMasses_[v1];
+        float alpha = constraint.type == ConstraintType::kStretch ? stretchAlpha : bendAlpha;
+        float denominator = w0 + w1 + alpha;
+        if (denominator <= 0.0f) {
+            continue;
+        }
+        Vector3 delta = GetPosition(v1) - GetPosition(v0);
+        float length = delta.Length();
+        if (length < kEpsilon) {
+            continue;
+        }
+        // XPBDのλの増分。alphaはコンプライアンスをサブステップの2乗で割ったもの
+        float error = length - constraint.restLength;
+        float deltaLambda = (-error - alpha * lambdas_[c]) / denominator;
+        lambdas_[c] += deltaLambda;
+        Vector3 correction = delta * (deltaLambda / length);
+        for (size_t axis = 0; axis < 3; ++axis) {
+            positions_[axis][v0] -= correction[axis] * w0;
+            positions_[axis][v1] += correction[axis] * w1;
+        }
+    }
+}
+
+void Cloth::SolveVolume(float timeStep) {
+    // 体積の勾配は頂点を含む三角形の残り2頂点の外積の和
+    std::uint32_t vertexCount = GetVertexCount();
+    volumeGradients_.assign(vertexCount, Vector3::zero);
+    for (size_t i = 0; i < indices_.size(); i += 3) {
+        std::uint16_t i0 = indices_[i + 0];
+        std::uint16_t i1 = indices_[i + 1];
+        std::uint16_t i2 = indices_[i + 2];
+        Vector3 p0 = GetPosition(i0);
+        Vector3 p1 = GetPosition(i1);
+        Vector3 p2 = GetPosition(i2);
+        volumeGradients_[i0] += Vector3::Cross(p1, p2) / 6.0f;
+        volumeGradients_[i1] += Vector3::Cross(p2, p0) / 6.0f;
+        volumeGradients_[i2] += Vector3::Cross(p0, p1) / 6.0f;
+    }
+    float denominator = 0.0f;
+    for (std::uint32_t i = 0; i < vertexCount; ++i) {
+        denominator += inverseMasses_[i] * volumeGradients_[i].LengthSquare();
+    }
+    if (denominator < kEpsilon) {
+        return;
+    }
+    // 伸びの拘束と同じコンプライアンスで保つ
+    float alpha = stretchCompliance_ / (timeStep * timeStep);
+    float error = ComputeVolume() - restVolume_ * pressure_;
+    float deltaLambda = -error / (denominator + alpha);
+    for (std::uint32_t i = 0; i < vertexCount; ++i) {
+        Vector3 correction = volumeGradients_[i] * (deltaLambda * inverseMasses_[i]);
+        for (size_t axis = 0; axis < 3; ++axis) {
+            positions_[axis][i] += correction[axis];
+        }
+    }
+}
+
+void Cloth::UpdateVelocities(std::uint32_t begin, std::uint32_t end, float timeStep) {
+    float inverseTimeStep = 1.0f / timeStep;
+    for (size_t axis = 0; axis < 3; ++axis) {
+        for (std::uint32_t i = begin; i < end; ++i) {
+            velocities_[axis][i] = (positions_[axis][i] - previousPositions_[axis][i]) * inverseTimeStep;
+        }
+    }
+}
+
+void Cloth::Collide(std::uint32_t begin, std::uint32_t end) {
+    if (obstacles_.empty()) {
+        return;
+    }
+    ParticleCollision::Streams streams{
+        { positions_[0].data(), positions_[1].data(), positions_[2].data() },
+        { velocities_[0].data(), velocities_[1].data(), velocities_[2].data() } };
+    ParticleCollision::Response response{ thickness_, 0.0f, friction_ };
+    AABB bounds = ParticleCollision::ComputeBounds(streams, begin, end, thickness_);
+    for (size_t i = 0; i < obstacles_.size(); ++i) {
+        if (bounds.Intersects(obstacleBounds_[i])) {
+            ParticleCollision::Collide(obstacles_[i], streams, begin, end, response);
+        }
+    }
+}
+
+void Cloth::CollectObstacles(float deltaTime) {
+    obstacles_.clear();
+    obstacleBounds_.clear();
+    Scene* scene = gameObject.GetScene();
+    if (!scene) {
+        return;
+    }
+    // このUpdateで頂点が届きうる範囲
+    std::uint32_t vertexCount = GetVertexCount();
+    AABB bounds;
+    float maxSpeedSquare = 0.0f;
+    for (std::uint32_t i = 0; i < vertexCount; ++i) {
+        bounds.Include(GetPosition(i));
+        maxSpeedSquare = std::max(maxSpeedSquare, GetVelocity(i).LengthSquare());
+    }
+    float reach = thickness_ + (std::sqrt(maxSpeedSquare) + gravity_.Length() * deltaTime) * deltaTime;
+    bounds.min -= Vector3(reach, reach, reach);
+    bounds.max += Vector3(reach, reach, reach);
+
+    colliders_.clear();
+    scene->GetCollisionWorld().Query(bounds, colliders_, ids_);
+    for (Collider* collider : colliders_) {
+        if (collider->IsTrigger()) {
+            continue;
+        }
+        obstacles_.push_back(ParticleCollision::MakeObstacle(*collider));
+        obstacleBounds_.push_back(collider->GetAABB());
+    }
+}
+
+void Cloth::UpdateInverseMasses() {
+    std::uint32_t vertexCount = GetVertexCount();
+    float inverseMass = static_cast<float>(vertexCount) / std::max(mass_, kEpsilon);
+    inverseMasses_.assign(vertexCount, inverseMass);
+    for (std::uint32_t vertex : pinnedVertices_) {
+        inverseMasses_[vertex] = 0.0f;
+    }
+}
+
+void Cloth::ComputeNormals() {
+    // 面積で重み付けした面の法線の和。裏面は向きを逆にする
+    std::uint32_t vertexCount = GetVertexCount();
+    drawPositions_.resize(vertexCount * 2);
+    drawNormals_.assign(vertexCount * 2, Vector3::zero);
+    for (std::uint32_t i = 0; i < vertexCount; ++i) {
+        drawPositions_[i] = drawPositions_[vertexCount + i] = GetPosition(i);
+    }
+    for (size_t i = 0; i < indices_.size(); i += 3) {
+        std::uint16_t i0 = indices_[i + 0];
+        std::uint16_t i1 = indices_[i + 1];
+        std::uint16_t i2 = indices_[i + 2];
+        Vector3 normal = Vector3::Cross(drawPositions_[i1] - drawPositions_[i0], drawPositions_[i2] - drawPositions_[i1]);
+        drawNormals_[i0] += normal;
+        drawNormals_[i1] += normal;
+        drawNormals_[i2] += normal;
+    }
+    for (std::uint32_t i = 0; i < vertexCount; ++i) {
+        Vector3 normal = drawNormals_[i].LengthSquare() > kEpsilon * kEpsilon ? drawNormals_[i].Normalized() : Vector3::unitY;
+        drawNormals_[i] = normal;
+        drawNormals_[vertexCount + i] = -normal;
+    }
+}
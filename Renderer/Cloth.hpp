@@ -0,0 +1,153 @@
+#pragma once
+#include "Component.hpp"
+
+#include <cstdint>
+#include <vector>
+
+#include "Math/MathUtils.hpp"
+#include "AABB.hpp"
+#include "Collision/ParticleCollision.hpp"
+
+class Renderer;
+class Collider;
+
+// XPBDの布と軟体
+// SetMeshにRegisterMeshと同じ頂点とインデックスを渡す。辺を伸びの拘束、隣り合う三角形の向かいの頂点を曲げの拘束にする
+// 拘束は頂点を共有しないように色分けし、同じ色の拘束を並列に解く
+// 当たるのはシーンのアクティブなコライダー。箱は向きのある箱、球とカプセルはそのまま、それ以外はAABBとみなす
+class Cloth :
+    public Component {
+public:
+    // 両面を描くために頂点を倍にするので、16ビットのインデックスに収まる数
+    static constexpr std::uint32_t kMaxVertexCount = 32768;
+
+    Cloth(GameObject* const gameObject) :
+        Component(gameObject),
+        gravity_(0.0f, -9.8f, 0.0f),
+        color_(1.0f, 1.0f, 1.0f, 1.0f),
+        substepCount_(10),
+        mass_(1.0f),
+        stretchCompliance_(0.0f),
+        bendCompliance_(1.0e-3f),
+        damping_(0.1f),
+        thickness_(0.02f),
+        friction_(0.2f),
+        pressure_(0.0f),
+        restVolume_(0.0f),
+        mesh_(kInvalidMesh) {
+    }
+
+    // ローカル空間の頂点とインデックス。SetMeshの時点のTransformでワールド空間に置く
+    void SetMesh(const std::vector<Vector3>& positions, const std::vector<std::uint16_t>& indices);
+    // 頂点をTransformに付いて動くように留める
+    void Pin(std::uint32_t vertex);
+    void Unpin(std::uint32_t vertex);
+    void Update(float deltaTime);
+    // 初回にメッシュを登録し、以降は頂点を書き換える。裏面も描く
+    void Draw(Renderer& renderer);
+    void ShowUI() override;
+
+    void SetGravity(const Vector3& gravity) { gravity_ = gravity; }
+    void SetColor(const Vector4& color) { color_ = color; }
+    // 1回のUpdateを分ける数。拘束はサブステップごとに1回ずつ解く
+    void SetSubstepCount(std::uint32_t substepCount) { substepCount_ = substepCount; }
+    // 全体の質量。頂点に等しく分ける
+    void SetMass(float mass);
+    // 大きいほど伸びる。0で伸びない
+    void SetStretchCompliance(float stretchCompliance) { stretchCompliance_ = stretchCompliance; }
+    // 大きいほど曲がる
+    void SetBendCompliance(float bendCompliance) { bendCompliance_ = bendCompliance; }
+    // 毎秒失う速度の割合
+    void SetDamping(float damping) { damping_ = damping; }
+    // コライダーと空ける隙間
+    void SetThickness(float thickness) { thickness_ = thickness; }
+    void SetFriction(float friction) { friction_ = friction; }
+    // 閉じたメッシュの体積をSetMeshの時点のpressure倍に保つ。0で保たない
+    void SetPressure(float pressure) { pressure_ = pressure; }
+
+    const Vector3& GetGravity() const { return gravity_; }
+    const Vector4& GetColor() const { return color_; }
+    std::uint32_t GetSubstepCount() const { return substepCount_; }
+    float GetMass() const { return mass_; }
+    float GetStretchCompliance() const { return stretchCompliance_; }
+    float GetBendCompliance() const { return bendCompliance_; }
+    float GetDamping() const { return damping_; }
+    float GetThickness() const { return thickness_; }
+    float GetFriction() const { return friction_; }
+    float GetPressure() const { return pressure_; }
+    std::uint32_t GetVertexCount() const { return static_cast<std::uint32_t>(positions_[0].size()); }
+    std::uint32_t GetConstraintCount() const { return static_cast<std::uint32_t>(constraints_.size()); }
+    // 使った色の数。64番目の色は溢れた拘束で、順に解く
+    std::uint32_t GetColorCount() const { return static_cast<std::uint32_t>(colorStarts_.size()) - 1; }
+    // ワールド空間
+    Vector3 GetPosition(std::uint32_t i) const { return { positions_[0][i], positions_[1][i], positions_[2][i] }; }
+    Vector3 GetVelocity(std::uint32_t i) const { return { velocities_[0][i], velocities_[1][i], velocities_[2][i] }; }
+    // 閉じたメッシュの体積
+    float ComputeVolume() const;
+
+private:
+    static constexpr std::size_t kInvalidMesh = static_cast<std::size_t>(-1);
+
+    enum class ConstraintType : std::uint32_t {
+        kStretch,
+        kBend
+    };
+    // 2頂点の距離の拘束
+    struct Constraint {
+        std::uint32_t vertices[2];
+        float restLength;
+        ConstraintType type;
+    };
+
+    // 頂点を共有しない色に分け、色ごとに並べ替える
+    void ColorConstraints();
+    void Predict(std::uint32_t begin, std::uint32_t end, float timeStep);
+    void SolveConstraints(std::uint32_t begin, std::uint32_t end, float stretchAlpha, float bendAlpha);
+    void SolveVolume(float timeStep);
+    void UpdateVelocities(std::uint32_t begin, std::uint32_t end, float timeStep);
+    void Collide(std::uint32_t begin, std::uint32_t end);
+    // 当たりうるコライダーを形にして集める
+    void CollectObstacles(float deltaTime);
+    void UpdateInverseMasses();
+    void ComputeNormals();
+
+    // 成分ごとの配列
+    std::vector<float> positions_[3];
+    std::vector<float> previousPositions_[3];
+    std::vector<float> velocities_[3];
+    std::vector<float> inverseMasses_;
+    // 留めた頂点のローカル座標と、Update前のワールド座標
+    std::vector<std::uint32_t> pinnedVertices_;
+    std::vector<Vector3> pinnedLocalPositions_;
+    std::vector<Vector3> pinnedStartPositions_;
+
+    std::vector<Constraint> constraints_;
+    std::vector<float> lambdas_;
+    // 色ごとの拘束の先頭。末尾に総数
+    std::vector<std::uint32_t> colorStarts_;
+    std::vector<Vector3> localPositions_;
+    std::vector<std::uint16_t> indices_;
+
+    // 毎フレーム確保しないように使い回す作業領域
+    std::vector<Collider*> colliders_;
+    std::vector<std::uint32_t> ids_;
+    std::vector<ParticleCollision::Obstacle> obstacles_;
+    std::vector<AABB> obstacleBounds_;
+    std::vector<Vector3> volumeGradients_;
+    std::vector<Vector3> drawPositions_;
+    std::vector<Vector3> drawNormals_;
+
+    Vector3 gravity_;
+    Vector4 color_;
+    std::uint32_t substepCount_;
+    float mass_;
+    float stretchCompliance_;
+    float bendCompliance_;
+    float damping_;
+    float thickness_;
+    float friction_;
+    float pressure_;
+    // SetMeshの時点の体積
+    float restVolume_;
+    std::size_t mesh_;
+};
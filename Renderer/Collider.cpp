@@ -0,0 +1,98 @@
+#include "Collider.hpp"
+
+#include "Externals/ImGui/imgui.h"
+
+#include "GameObject.hpp"
+#include "Scene.hpp"
+#include "Collision/GJK.hpp"
+
+Collider::Collider(GameObject* const gameObject, Type type) :
+    Component(gameObject),
+    world_(nullptr),
+    id_(kInvalidID),
+    shapeRevision_(0),
+    type_(type),
+    boundingVolumeType_(BoundingVolumeType::kNone),
+    isActive_(true),
+    isTrigger_(false),
+    isStatic_(false) {
+    Scene* scene = gameObject->GetScene();
+    if (scene) {
+        scene->GetCollisionWorld().Register(this);
+    }
+}
+
+Collider::~Collider() {
+    if (world_) {
+        world_->Unregister(this);
+    }
+}
+
+void Collider::UpdateAABB() {
+    Vector3 min, max;
+    for (size_t i = 0; i < 3; ++i) {
+        Vector3 axis = Vector3::zero;
+        axis[i] = 1.0f;
+        max[i] = FindFurthestPoint(axis)[i];
+        min[i] = FindFurthestPoint(-axis)[i];
+    }
+    aabb_ = AABB(min, max);
+}
+
+bool Collider::Raycast(const Vector3& origin, const Vector3& direction, float maxDistance, RaycastHit& hit) const {
+    auto support = [this](const Vector3& d) { return FindFurthestPoint(d); };
+    float distance;
+    Vector3 normal;
+    if (!GJK::Raycast(support, origin, direction, maxDistance, distance, normal)) {
+        return false;
+    }
+    hit.point = origin + direction * distance;
+    hit.normal = normal;
+    hit.distance = distance;
+    hit.collider = const_cast<Collider*>(this);
+    return true;
+}
+
+std::uint32_t Collider::GetLocalHull(Vector3(&)[BoundingVolume::kMaxLocalPoints], float& radius) const {
+    radius = 0.0f;
+    return 0;
+}
+
+void Collider::UpdateBoundingVolume() {
+    const std::vector<Vector3>* vertices = boundingVolumeType_ != BoundingVolumeType::kNone ? GetLocalVertices() : nullptr;
+    if (vertices) {
+        boundingVolume_.UpdateFromVertices(boundingVolumeType_, vertices->data(), static_cast<std::uint32_t>(vertices->size()), shapeRevision_, GetTransform().GetWorldMatrix());
+        return;
+    }
+    Vector3 points[BoundingVolume::kMaxLocalPoints];
+    float radius = 0.0f;
+    std::uint32_t count = boundingVolumeType_ != BoundingVolumeType::kNone ? GetLocalHull(points, radius) : 0;
+    boundingVolume_.Update(boundingVolumeType_, points, count, radius, GetTransform().GetWorldMatrix());
+}
+
+void Collider::ShowUI() {
+    ImGui::Checkbox("Active", &isActive_);
+    ImGui::SameLine();
+    ImGui::Checkbox("Trigger", &isTrigger_);
+    ImGui::SameLine();
+    ImGui::Checkbox("Static", &isStatic_);
+    int volumeType = static_cast<int>(boundingVolumeType_);
+    if (ImGui::Combo("Volume", &volumeType, [](void*, int index, const char** text) {
+        *text = GetBoundingVolumeName(static_cast<BoundingVolumeType>(index));
+        return true;
+        }, nullptr, static_cast<int>(BoundingVolumeType::kCount))) {
+        boundingVolumeType_ = static_cast<BoundingVolumeType>(volumeType);
+    }
+}
+
+Vector3 Collider::ToLocalDirection(const Vector3& direction) const {
+    const Matrix4x4& world = GetTransform().GetWorldMatrix();
+    return {
+        Vector3::Dot(world.GetXAxis(), direction),
+        Vector3::Dot(world.GetYAxis(), direction),
+        Vector3::Dot(world.GetZAxis(), direction) };
+}
+
+Vector3 Collider::ToWorldPoint(const Vector3& point) const {
+    return point * GetTransform().GetWorldMatrix();
+}
@@ -1,38 +1,107 @@
 #pragma once
+#include "Component.hpp"
 
 #include "Math/MathUtils.hpp"
 #include "AABB.hpp"
+#include "Collision/BoundingVolume.hpp"
 
+#include <cstdint>
 #include <functional>
+#include <vector>
 
-class Collider {
+class Collider;
+class CollisionWorld;
+
+struct RaycastHit {
+    Vector3 point;
+    Vector3 normal;
+    float distance;
+    Collider* collider;
+};
+
+class Collider :
+    public Component {
 public:
     using CollBack = std::function<void(void)>;
 
-    virtual ~Collider() {}
+    // 狭域判定の振り分けに使う
+    enum class Type {
+        kSphere,
+        kBox,
+        kCapsule,
+        kHeightfield,
+        kCompound,
+        kMesh,
+        kConvexHull,
+        kDistanceField
+    };
+
+    static const std::uint32_t kInvalidID = 0xFFFFFFFF;
+
+    Collider(GameObject* const gameObject, Type type);
+    virtual ~Collider();
     virtual Vector3 FindFurthestPoint(const Vector3& direction) const = 0;
+    // ワールド行列からAABBを更新
+    virtual void UpdateAABB();
+    // directionは正規化済み。既定はサポート写像による保守的前進
+    virtual bool Raycast(const Vector3& origin, const Vector3& direction, float maxDistance, RaycastHit& hit) const;
+    // 形状をローカル空間の点群をradiusだけ膨らませたものとして返す。中域判定の当てはめに使う
+    // 返り値は点の数。0なら対応しない（AABBのみ）
+    virtual std::uint32_t GetLocalHull(Vector3(&points)[BoundingVolume::kMaxLocalPoints], float& radius) const;
+    // 点の多い形のローカル空間の頂点。GetLocalHullより優先し、形の版が変わったときだけ当てはめ直す
+    virtual const std::vector<Vector3>* GetLocalVertices() const { return nullptr; }
+    // UpdateAABBの後に呼ぶ
+    void UpdateBoundingVolume();
+    void ShowUI() override;
 
     void SetIsActive(bool isActive) { isActive_ = isActive; }
     void SetIsTrigger(bool isTrigger) { isTrigger_ = isTrigger; }
+    // 静的なコライダーは静的な木に入り、AABBを更新しない。動かすときは先に解除する
+    void SetIsStatic(bool isStatic) { isStatic_ = isStatic; }
+    // 広域判定を通ったペアを狭域判定の前に絞る形
+    void SetBoundingVolumeType(BoundingVolumeType type) { boundingVolumeType_ = type; }
     void SetEnterCollBack(const CollBack& collBack) { enterCollBack_ = collBack; }
     void SetStayCollBack(const CollBack& collBack) { stayCollBack_ = collBack; }
     void SetExitCollBack(const CollBack& collBack) { exitCollBack_ = collBack; }
- 
+
+    Type GetType() const { return type_; }
+    // 凸形状ならGJKでそのまま判定できる
+    bool IsConvex() const { return type_ == Type::kSphere || type_ == Type::kBox || type_ == Type::kCapsule || type_ == Type::kConvexHull; }
     bool IsActive() const { return isActive_; }
     bool IsTrigger() const { return isTrigger_; }
+    bool IsStatic() const { return isStatic_; }
     const CollBack& GetEnterCollBack() const { return enterCollBack_; }
     const CollBack& GetStayCollBack() const { return stayCollBack_; }
     const CollBack& GetExitCollBack() const { return exitCollBack_; }
     const AABB& GetAABB() const { return aabb_; }
+    BoundingVolumeType GetBoundingVolumeType() const { return boundingVolumeType_; }
+    const BoundingVolume& GetBoundingVolume() const { return boundingVolume_; }
+    std::uint32_t GetID() const { return id_; }
+    // 形を変えるたびに進む。中域判定の当てはめ直しや接触の使い回しの判定に使う
+    std::uint32_t GetShapeRevision() const { return shapeRevision_; }
 
 protected:
+    // 形を変えたら呼ぶ
+    void MarkShapeChanged() { ++shapeRevision_; }
+    // ワールド方向をローカル方向に変換（スケールを含む線形部の転置を掛ける）
+    Vector3 ToLocalDirection(const Vector3& direction) const;
+    Vector3 ToWorldPoint(const Vector3& point) const;
+
     AABB aabb_{};
 
 private:
     CollBack enterCollBack_;
     CollBack stayCollBack_;
     CollBack exitCollBack_;
+    CollisionWorld* world_;
+    BoundingVolume boundingVolume_;
+    std::uint32_t id_;
+    std::uint32_t shapeRevision_;
+    Type type_;
+    BoundingVolumeType boundingVolumeType_;
     bool isActive_;
     bool isTrigger_;
-};
+    bool isStatic_;
 
+    friend class CollisionWorld;
+};
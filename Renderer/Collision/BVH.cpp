@@ -0,0 +1,123 @@
+#include "BVH.hpp"
+
+#include <algorithm>
+
+void BVH::Build(const std::vector<AABB>& bounds, SplitMethod splitMethod) {
+    Clear();
+    splitMethod_ = splitMethod;
+    if (bounds.empty()) {
+        return;
+    }
+    indices_.resize(bounds.size());
+    for (std::uint32_t i = 0; i < indices_.size(); ++i) {
+        indices_[i] = i;
+    }
+    nodes_.reserve(bounds.size() * 2);
+    BuildRecursive(bounds, 0, static_cast<std::uint32_t>(bounds.size()), 0);
+}
+
+void BVH::Clear() {
+    nodes_.clear();
+    indices_.clear();
+}
+
+std::uint32_t BVH::BuildRecursive(const std::vector<AABB>& bounds, std::uint32_t begin, std::uint32_t end, std::uint32_t depth) {
+    std::uint32_t nodeIndex = static_cast<std::uint32_t>(nodes_.size());
+    nodes_.emplace_back();
+
+    AABB aabb;
+    AABB centerBounds;
+    for (std::uint32_t i = begin; i < end; ++i) {
+        aabb.Include(bounds[indices_[i]]);
+        centerBounds.Include(bounds[indices_[i]].Center());
+    }
+    nodes_[nodeIndex].aabb = aabb;
+
+    if (end - begin <= kMaxLeafSize) {
+        nodes_[nodeIndex].firstIndex = begin;
+        nodes_[nodeIndex].count = end - begin;
+        return nodeIndex;
+    }
+
+    // 偏った入力でSAHが数個ずつしか剥がさないと木が深くなり、探索の積み残しが溢れる
+    std::uint32_t middle = begin;
+    if (splitMethod_ == SplitMethod::kSAH && depth < kMaxSAHDepth) {
+        middle = PartitionSAH(bounds, begin, end, centerBounds);
+    }
+    if (middle == begin) {
+        // 中心の広がりが最大の軸で中央値分割
+        size_t axis = centerBounds.LongestAxis();
+        middle = begin + (end - begin) / 2;
+        std::nth_element(indices_.begin() + begin, indices_.begin() + middle, indices_.begin() + end,
+            [&](std::uint32_t lhs, std::uint32_t rhs) { return bounds[lhs].Center(axis) < bounds[rhs].Center(axis); });
+    }
+
+    BuildRecursive(bounds, begin, middle, depth + 1);
+    std::uint32_t rightChild = BuildRecursive(bounds, middle, end, depth + 1);
+    nodes_[nodeIndex].rightChild = rightChild;
+    nodes_[nodeIndex].count = 0;
+    return nodeIndex;
+}
+
+std::uint32_t BVH::PartitionSAH(const std::vector<AABB>& bounds, std::uint32_t begin, std::uint32_t end, const AABB& centerBounds) {
+    struct Bin {
+        AABB aabb;
+        std::uint32_t count = 0;
+    };
+
+    // 3軸それぞれで中心をビンに分け、表面積×個数の和が最小の境界を探す
+    float bestCost = Math::positiveInfinity;
+    size_t bestAxis = 0;
+    std::uint32_t bestSplit = 0;
+    for (size_t axis = 0; axis < 3; ++axis) {
+        float extent = centerBounds.Extent(axis);
+        if (extent <= 0.0f) {
+            continue;
+        }
+        float scale = static_cast<float>(kSAHBinCount) / extent;
+        Bin bins[kSAHBinCount];
+        for (std::uint32_t i = begin; i < end; ++i) {
+            const AABB& aabb = bounds[indices_[i]];
+            std::uint32_t bin = std::min(static_cast<std::uint32_t>((aabb.Center(axis) - centerBounds.min[axis]) * scale), kSAHBinCount - 1);
+            bins[bin].aabb.Include(aabb);
+            ++bins[bin].count;
+        }
+
+        // 右から累積した表面積と個数
+        float rightArea[kSAHBinCount];
+        std::uint32_t rightCount[kSAHBinCount];
+        AABB accumulated;
+        std::uint32_t count = 0;
+        for (std::uint32_t i = kSAHBinCount - 1; i > 0; --i) {
+            accumulated.Include(bins[i].aabb);
+            count += bins[i].count;
+            rightArea[i] = count > 0 ? accumulated.SurfaceArea() : 0.0f;
+            rightCount[i] = count;
+        }
+        accumulated = AABB();
+        count = 0;
+        for (std::uint32_t i = 0; i < kSAHBinCount - 1; ++i) {
+            accumulated.Include(bins[i].aabb);
+            count += bins[i].count;
+            if (count == 0 || rightCount[i + 1] == 0) {
+                continue;
+            }
+            float cost = accumulated.SurfaceArea() * static_cast<float>(count) + rightArea[i + 1] * static_cast<float>(rightCount[i + 1]);
+            if (cost < bestCost) {
+                bestCost = cost;
+                bestAxis = axis;
+                bestSplit = i;
+            }
+        }
+    }
+    if (bestCost == Math::positiveInfinity) {
+        return begin;
+    }
+
+    float scale = static_cast<float>(kSAHBinCount) / centerBounds.Extent(bestAxis);
+    auto middle = std::partition(indices_.begin() + begin, indices_.begin() + end, [&](std::uint32_t index) {
+        std::uint32_t bin = std::min(static_cast<std::uint32_t>((bounds[index].Center(bestAxis) - centerBounds.min[bestAxis]) * scale), kSAHBinCount - 1);
+        return bin <= bestSplit;
+        });
+    return static_cast<std::uint32_t>(middle - indices_.begin());
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+#include "../AABB.hpp"
+
+// 構築後は変更しない境界ボリューム階層
+// ノードは配列に並べ、左の子は親の直後に置く
+class BVH {
+public:
+    static const std::uint32_t kMaxLeafSize = 2;
+    static constexpr std::uint32_t kSAHBinCount = 16;
+    // これより深いところはSAHをやめて中央値で分ける。中央値なら32bitの要素数でも32段で葉に届く
+    static constexpr std::uint32_t kMaxSAHDepth = 32;
+    // 木の深さはkMaxSAHDepth + 32以下で、深さ優先の積み残しは深さ+1以下
+    static constexpr std::uint32_t kStackSize = kMaxSAHDepth + 33;
+
+    enum class SplitMethod {
+        kMedian,    // 構築が速い
+        kSAH        // 探索が速い。動かないものに使う
+    };
+
+    struct Node {
+        AABB aabb;
+        std::uint32_t rightChild;   // 内部ノードのみ
+        std::uint32_t firstIndex;   // 葉のみ
+        std::uint32_t count;        // 0なら内部ノード
+
+        bool IsLeaf() const { return count > 0; }
+    };
+
+    void Build(const std::vector<AABB>& bounds, SplitMethod splitMethod = SplitMethod::kMedian);
+    void Clear();
+
+    // boundsと交差する葉の要素番号についてfuncを呼ぶ
+    template<class Func>
+    void Query(const AABB& bounds, Func&& func) const {
+        if (nodes_.empty()) { return; }
+        std::uint32_t stack[kStackSize];
+        std::uint32_t stackSize = 0;
+        stack[stackSize++] = 0;
+        while (stackSize > 0) {
+            const Node& node = nodes_[stack[--stackSize]];
+            if (!node.aabb.Intersects(bounds)) {
+                continue;
+            }
+            if (node.IsLeaf()) {
+                for (std::uint32_t i = 0; i < node.count; ++i) {
+                    func(indices_[node.firstIndex + i]);
+                }
+                continue;
+            }
+            std::uint32_t self = static_cast<std::uint32_t>(&node - nodes_.data());
+            assert(stackSize + 2 <= kStackSize);
+            stack[stackSize++] = node.rightChild;
+            stack[stackSize++] = self + 1;
+        }
+    }
+
+    // 線分[origin, origin + direction * maxDistance]と交差する葉の要素番号についてfuncを呼ぶ
+    template<class Func>
+    void Raycast(const Vector3& origin, const Vector3& direction, float maxDistance, Func&& func) const {
+        if (nodes_.empty()) { return; }
+        std::uint32_t stack[kStackSize];
+        std::uint32_t stackSize = 0;
+        stack[stackSize++] = 0;
+        while (stackSize > 0) {
+            const Node& node = nodes_[stack[--stackSize]];
+            float tMin = 0.0f, tMax = maxDistance;
+            if (!node.aabb.IntersectsRay(origin, direction, tMin, tMax)) {
+                continue;
+            }
+            if (node.IsLeaf()) {
+                for (std::uint32_t i = 0; i < node.count; ++i) {
+                    func(indices_[node.firstIndex + i]);
+                }
+                continue;
+            }
+            std::uint32_t self = static_cast<std::uint32_t>(&node - nodes_.data());
+            assert(stackSize + 2 <= kStackSize);
+            stack[stackSize++] = node.rightChild;
+            stack[stackSize++] = self + 1;
+        }
+    }
+
+    bool IsEmpty() const { return nodes_.empty(); }
+    const AABB& GetBounds() const { return nodes_.front().aabb; }
+    const std::vector<Node>& GetNodes() const { return nodes_; }
+    const std::vector<std::uint32_t>& GetIndices() const { return indices_; }
+
+private:
+    std::uint32_t BuildRecursive(const std::vector<AABB>& bounds, std::uint32_t begin, std::uint32_t end, std::uint32_t depth);
+    // 分割位置を返す。分けられなければbegin
+    std::uint32_t PartitionSAH(const std::vector<AABB>& bounds, std::uint32_t begin, std::uint32_t end, const AABB& centerBounds);
+
+    std::vector<Node> nodes_;
+    std::vector<std::uint32_t> indices_;
+    SplitMethod splitMethod_ = SplitMethod::kMedian;
+};
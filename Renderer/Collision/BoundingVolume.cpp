@@ -0,0 +1,505 @@
+#include "BoundingVolume.hpp"
+
+#include <cassert>
+#include <vector>
+
+namespace {
+    const Vector3 kDOP14Directions[] = {
+        { 1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f },
+        { 1.0f, 1.0f, 1.0f }, { 1.0f, -1.0f, 1.0f }, { 1.0f, 1.0f, -1.0f }, { 1.0f, -1.0f, -1.0f } };
+    const Vector3 kDOP18Directions[] = {
+        { 1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f },
+        { 1.0f, 1.0f, 0.0f }, { 1.0f, -1.0f, 0.0f }, { 1.0f, 0.0f, 1.0f },
+        { 1.0f, 0.0f, -1.0f }, { 0.0f, 1.0f, 1.0f }, { 0.0f, 1.0f, -1.0f } };
+    const Vector3 kDOP26Directions[] = {
+        { 1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f },
+        { 1.0f, 1.0f, 1.0f }, { 1.0f, -1.0f, 1.0f }, { 1.0f, 1.0f, -1.0f }, { 1.0f, -1.0f, -1.0f },
+        { 1.0f, 1.0f, 0.0f }, { 1.0f, -1.0f, 0.0f }, { 1.0f, 0.0f, 1.0f },
+        { 1.0f, 0.0f, -1.0f }, { 0.0f, 1.0f, 1.0f }, { 0.0f, 1.0f, -1.0f } };
+
+    // 丸め誤差で境界上の点を外と判定しないための許容量
+    bool IsInside(const BoundingSphere& sphere, const Vector3& point) {
+        float radiusSquare = sphere.radius * sphere.radius;
+        return (point - sphere.center).LengthSquare() <= radiusSquare + radiusSquare * 1.0e-5f + 1.0e-10f;
+    }
+
+    BoundingSphere MakeSphere(const Vector3& a, const Vector3& b) {
+        Vector3 center = (a + b) * 0.5f;
+        return { center, (a - center).Length() };
+    }
+
+    BoundingSphere MakeSphere(const Vector3& a, const Vector3& b, const Vector3& c) {
+        Vector3 ab = b - a, ac = c - a;
+        Vector3 normal = Cross(ab, ac);
+        float denominator = 2.0f * normal.LengthSquare();
+        if (denominator <= 1.0e-12f * ab.LengthSquare() * ac.LengthSquare()) {
+            // 一直線上なら最も離れた2点
+            BoundingSphere sphere = MakeSphere(a, b);
+            BoundingSphere other = MakeSphere(a, c);
+            if (other.radius > sphere.radius) { sphere = other; }
+            other = MakeSphere(b, c);
+            if (other.radius > sphere.radius) { sphere = other; }
+            return sphere;
+        }
+        Vector3 offset = (Cross(normal, ab) * ac.LengthSquare() + Cross(ac, normal) * ab.LengthSquare()) / denominator;
+        return { a + offset, offset.Length() };
+    }
+
+    BoundingSphere MakeSphere(const Vector3& a, const Vector3& b, const Vector3& c, const Vector3& d) {
+        Vector3 ab = b - a, ac = c - a, ad = d - a;
+        float denominator = 2.0f * Dot(ab, Cross(ac, ad));
+        float scale = ab.Length() * ac.Length() * ad.Length();
+        if (std::abs(denominator) <= 1.0e-6f * scale) {
+            // 同一平面上なら4点を含む3点の外接球のうち最小のもの
+            const Vector3* points[] = { &a, &b, &c, &d };
+            BoundingSphere best{ Vector3::zero, Math::positiveInfinity };
+            BoundingSphere largest{ Vector3::zero, 0.0f };
+            for (std::uint32_t skip = 0; skip < 4; ++skip) {
+                const Vector3* triangle[3];
+                for (std::uint32_t i = 0, n = 0; i < 4; ++i) {
+                    if (i != skip) { triangle[n++] = points[i]; }
+                }
+                BoundingSphere sphere = MakeSphere(*triangle[0], *triangle[1], *triangle[2]);
+                if (IsInside(sphere, *points[skip]) && sphere.radius < best.radius) { best = sphere; }
+                if (sphere.radius > largest.radius) { largest = sphere; }
+            }
+            return best.radius < Math::positiveInfinity ? best : largest;
+        }
+        Vector3 offset = (Cross(ac, ad) * ab.LengthSquare() + Cross(ad, ab) * ac.LengthSquare() + Cross(ab, ac) * ad.LengthSquare()) / denominator;
+        return { a + offset, offset.Length() };
+    }
+
+    // 境界に乗る点を固定しながら含まない点を取り込む（Welzlの反復版）
+    BoundingSphere WelzlWith3(const Vector3* points, std::uint32_t count, const Vector3& p, const Vector3& q, const Vector3& r) {
+        BoundingSphere sphere = MakeSphere(p, q, r);
+        for (std::uint32_t i = 0; i < count; ++i) {
+            if (!IsInside(sphere, points[i])) {
+                sphere = MakeSphere(p, q, r, points[i]);
+            }
+        }
+        return sphere;
+    }
+
+    BoundingSphere WelzlWith2(const Vector3* points, std::uint32_t count, const Vector3& p, const Vector3& q) {
+        BoundingSphere sphere = MakeSphere(p, q);
+        for (std::uint32_t i = 0; i < count; ++i) {
+            if (!IsInside(sphere, points[i])) {
+                sphere = WelzlWith3(points, i, p, q, points[i]);
+            }
+        }
+        return sphere;
+    }
+
+    BoundingSphere WelzlWith1(const Vector3* points, std::uint32_t count, const Vector3& p) {
+        BoundingSphere sphere{ p, 0.0f };
+        for (std::uint32_t i = 0; i < count; ++i) {
+            if (!IsInside(sphere, points[i])) {
+                sphere = WelzlWith2(points, i, p, points[i]);
+            }
+        }
+        return sphere;
+    }
+
+    // 対称行列の固有ベクトルをヤコビ法で求める。vectorsは列が固有ベクトル
+    void ComputeEigenVectors(float (&a)[3][3], float (&vectors)[3][3]) {
+        static const std::uint32_t kMaxSweepCount = 32;
+        for (std::uint32_t i = 0; i < 3; ++i) {
+            for (std::uint32_t j = 0; j < 3; ++j) {
+                vectors[i][j] = i == j ? 1.0f : 0.0f;
+            }
+        }
+        for (std::uint32_t sweep = 0; sweep < kMaxSweepCount; ++sweep) {
+            float offDiagonal = a[0][1] * a[0][1] + a[0][2] * a[0][2] + a[1][2] * a[1][2];
+            float diagonal = a[0][0] * a[0][0] + a[1][1] * a[1][1] + a[2][2] * a[2][2];
+            if (offDiagonal <= 1.0e-12f * diagonal || offDiagonal == 0.0f) {
+                break;
+            }
+            for (std::uint32_t p = 0; p < 2; ++p) {
+                for (std::uint32_t q = p + 1; q < 3; ++q) {
+                    if (std::abs(a[p][q]) < 1.0e-20f) {
+                        continue;
+                    }
+                    // a[p][q]を0にする回転
+                    float theta = (a[q][q] - a[p][p]) / (2.0f * a[p][q]);
+                    float t = (theta >= 0.0f ? 1.0f : -1.0f) / (std::abs(theta) + std::sqrt(theta * theta + 1.0f));
+                    float c = 1.0f / std::sqrt(t * t + 1.0f);
+                    float s = t * c;
+                    for (std::uint32_t k = 0; k < 3; ++k) {
+                        float akp = a[k][p], akq = a[k][q];
+                        a[k][p] = c * akp - s * akq;
+                        a[k][q] = s * akp + c * akq;
+                    }
+                    for (std::uint32_t k = 0; k < 3; ++k) {
+                        float apk = a[p][k], aqk = a[q][k];
+                        a[p][k] = c * apk - s * aqk;
+                        a[q][k] = s * apk + c * aqk;
+                    }
+                    for (std::uint32_t k = 0; k < 3; ++k) {
+                        float vkp = vectors[k][p], vkq = vectors[k][q];
+                        vectors[k][p] = c * vkp - s * vkq;
+                        vectors[k][q] = s * vkp + c * vkq;
+                    }
+                }
+            }
+        }
+    }
+
+    // 点群を軸に射影した区間から箱を作る
+    OBB FitToAxes(const Vector3* points, std::uint32_t count, float radius, const Vector3 (&axes)[3]) {
+        OBB obb;
+        Vector3 min(Math::positiveInfinity), max(-Math::positiveInfinity);
+        for (std::uint32_t i = 0; i < count; ++i) {
+            for (size_t axis = 0; axis < 3; ++axis) {
+                float d = Dot(points[i], axes[axis]);
+                min[axis] = std::min(min[axis], d);
+                max[axis] = std::max(max[axis], d);
+            }
+        }
+        for (size_t axis = 0; axis < 3; ++axis) {
+            obb.axes[axis] = axes[axis];
+        }
+        Vector3 center = (min + max) * 0.5f;
+        obb.center = axes[0] * center.x + axes[1] * center.y + axes[2] * center.z;
+        obb.halfExtent = (max - min) * 0.5f + Vector3(radius);
+        return obb;
+    }
+
+    Vector3 TransformDirection(const Vector3& direction, const Matrix4x4& matrix) {
+        return matrix.GetXAxis() * direction.x + matrix.GetYAxis() * direction.y + matrix.GetZAxis() * direction.z;
+    }
+
+    float GetMaxScale(const Matrix4x4& matrix) {
+        return std::sqrt(std::max({ matrix.GetXAxis().LengthSquare(), matrix.GetYAxis().LengthSquare(), matrix.GetZAxis().LengthSquare() }));
+    }
+
+    __m128 Abs(__m128 v) {
+        return _mm_andnot_ps(_mm_set1_ps(-0.0f), v);
+    }
+}
+
+const char* GetBoundingVolumeName(BoundingVolumeType type) {
+    switch (type) {
+    case BoundingVolumeType::kNone: return "None";
+    case BoundingVolumeType::kSphere: return "Sphere";
+    case BoundingVolumeType::kOBB: return "OBB";
+    case BoundingVolumeType::kDOP14: return "14-DOP";
+    case BoundingVolumeType::kDOP18: return "18-DOP";
+    case BoundingVolumeType::kDOP26: return "26-DOP";
+    default: return "Unknown";
+    }
+}
+
+BoundingSphere BoundingSphere::Fit(const Vector3* points, std::uint32_t count, float radius) {
+    if (count == 0) {
+        return { Vector3::zero, radius };
+    }
+    // 決まった種で混ぜて最悪ケースを避ける
+    std::vector<Vector3> shuffled(points, points + count);
+    std::uint32_t state = 0x9E3779B9u;
+    for (std::uint32_t i = count - 1; i > 0; --i) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        std::swap(shuffled[i], shuffled[state % (i + 1)]);
+    }
+    BoundingSphere sphere{ shuffled[0], 0.0f };
+    for (std::uint32_t i = 1; i < count; ++i) {
+        if (!IsInside(sphere, shuffled[i])) {
+            sphere = WelzlWith1(shuffled.data(), i, shuffled[i]);
+        }
+    }
+    // 許容量の分を含めて全ての点を確実に包む
+    float radiusSquare = 0.0f;
+    for (std::uint32_t i = 0; i < count; ++i) {
+        radiusSquare = std::max(radiusSquare, (points[i] - sphere.center).LengthSquare());
+    }
+    sphere.radius = std::sqrt(radiusSquare) + radius;
+    return sphere;
+}
+
+BoundingSphere BoundingSphere::Transform(const Matrix4x4& matrix) const {
+    return { center * matrix, radius * GetMaxScale(matrix) };
+}
+
+bool BoundingSphere::Intersects(const BoundingSphere& other) const {
+    float radiusSum = radius + other.radius;
+    return (other.center - center).LengthSquare() <= radiusSum * radiusSum;
+}
+
+OBB OBB::Fit(const Vector3* points, std::uint32_t count, float radius) {
+    static const Vector3 kWorldAxes[3] = { Vector3::unitX, Vector3::unitY, Vector3::unitZ };
+    if (count == 0) {
+        OBB obb;
+        obb.halfExtent = Vector3(radius);
+        return obb;
+    }
+    Vector3 mean = Vector3::zero;
+    for (std::uint32_t i = 0; i < count; ++i) {
+        mean += points[i];
+    }
+    mean /= static_cast<float>(count);
+    float covariance[3][3] = {};
+    for (std::uint32_t i = 0; i < count; ++i) {
+        Vector3 d = points[i] - mean;
+        for (size_t row = 0; row < 3; ++row) {
+            for (size_t column = row; column < 3; ++column) {
+                covariance[row][column] += d[row] * d[column];
+            }
+        }
+    }
+    covariance[1][0] = covariance[0][1];
+    covariance[2][0] = covariance[0][2];
+    covariance[2][1] = covariance[1][2];
+
+    float vectors[3][3];
+    ComputeEigenVectors(covariance, vectors);
+    Vector3 axes[3];
+    axes[0] = Vector3(vectors[0][0], vectors[1][0], vectors[2][0]).Normalized();
+    axes[1] = Vector3(vectors[0][1], vectors[1][1], vectors[2][1]);
+    axes[1] = (axes[1] - axes[0] * Dot(axes[1], axes[0])).Normalized();
+    axes[2] = Cross(axes[0], axes[1]);
+
+    // 点の分布が偏ると主成分が箱の向きとずれるので座標軸の箱と比べる
+    OBB pca = FitToAxes(points, count, radius, axes);
+    OBB aligned = FitToAxes(points, count, radius, kWorldAxes);
+    float pcaVolume = pca.halfExtent.x * pca.halfExtent.y * pca.halfExtent.z;
+    float alignedVolume = aligned.halfExtent.x * aligned.halfExtent.y * aligned.halfExtent.z;
+    return pcaVolume < alignedVolume ? pca : aligned;
+}
+
+OBB OBB::Transform(const Matrix4x4& matrix) const {
+    // 変換後の辺ベクトル。スケール次第で直交しないので直交化した軸に射影し直す
+    Vector3 edges[3];
+    for (size_t i = 0; i < 3; ++i) {
+        edges[i] = TransformDirection(axes[i] * halfExtent[i], matrix);
+    }
+    OBB result;
+    result.center = center * matrix;
+    result.axes[0] = TransformDirection(axes[0], matrix).Normalized();
+    Vector3 y = TransformDirection(axes[1], matrix);
+    result.axes[1] = (y - result.axes[0] * Dot(y, result.axes[0])).Normalized();
+    result.axes[2] = Cross(result.axes[0], result.axes[1]);
+    for (size_t i = 0; i < 3; ++i) {
+        result.halfExtent[i] =
+            std::abs(Dot(edges[0], result.axes[i])) +
+            std::abs(Dot(edges[1], result.axes[i])) +
+            std::abs(Dot(edges[2], result.axes[i]));
+    }
+    return result;
+}
+
+bool OBB::Intersects(const OBB& other) const {
+    // r[i][j] = axes[i]・other.axes[j]。4要素目は0で、どの判定でも分離しない
+    __m128 rows[3], absRows[3];
+    const __m128 epsilon = _mm_set1_ps(1.0e-6f);
+    for (size_t i = 0; i < 3; ++i) {
+        rows[i] = _mm_setr_ps(Dot(axes[i], other.axes[0]), Dot(axes[i], other.axes[1]), Dot(axes[i], other.axes[2]), 0.0f);
+        // 平行な辺同士の外積が0になっても誤って分離しないよう少し足す
+        absRows[i] = _mm_add_ps(Abs(rows[i]), epsilon);
+    }
+    __m128 columns[4] = { absRows[0], absRows[1], absRows[2], _mm_setzero_ps() };
+    _MM_TRANSPOSE4_PS(columns[0], columns[1], columns[2], columns[3]);
+
+    Vector3 d = other.center - center;
+    float t[3] = { Dot(d, axes[0]), Dot(d, axes[1]), Dot(d, axes[2]) };
+    __m128 a = _mm_setr_ps(halfExtent.x, halfExtent.y, halfExtent.z, 0.0f);
+    __m128 b = _mm_setr_ps(other.halfExtent.x, other.halfExtent.y, other.halfExtent.z, 0.0f);
+    __m128 tv = _mm_setr_ps(t[0], t[1], t[2], 0.0f);
+    __m128 separated;
+
+    // 自分の3軸
+    {
+        __m128 rb = _mm_add_ps(_mm_add_ps(
+            _mm_mul_ps(_mm_set1_ps(other.halfExtent.x), columns[0]),
+            _mm_mul_ps(_mm_set1_ps(other.halfExtent.y), columns[1])),
+            _mm_mul_ps(_mm_set1_ps(other.halfExtent.z), columns[2]));
+        separated = _mm_cmpgt_ps(Abs(tv), _mm_add_ps(a, rb));
+    }
+    // 相手の3軸
+    {
+        __m128 distance = Abs(_mm_add_ps(_mm_add_ps(
+            _mm_mul_ps(_mm_set1_ps(t[0]), rows[0]),
+            _mm_mul_ps(_mm_set1_ps(t[1]), rows[1])),
+            _mm_mul_ps(_mm_set1_ps(t[2]), rows[2])));
+        __m128 ra = _mm_add_ps(_mm_add_ps(
+            _mm_mul_ps(_mm_set1_ps(halfExtent.x), absRows[0]),
+            _mm_mul_ps(_mm_set1_ps(halfExtent.y), absRows[1])),
+            _mm_mul_ps(_mm_set1_ps(halfExtent.z), absRows[2]));
+        separated = _mm_or_ps(separated, _mm_cmpgt_ps(distance, _mm_add_ps(ra, b)));
+    }
+    // 辺同士の外積9軸。axes[i]×other.axes[j]をjについてまとめる
+    {
+        __m128 b1 = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+        __m128 b2 = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 1, 0, 2));
+        for (size_t i = 0; i < 3; ++i) {
+            size_t i1 = (i + 1) % 3, i2 = (i + 2) % 3;
+            __m128 distance = Abs(_mm_sub_ps(
+                _mm_mul_ps(_mm_set1_ps(t[i2]), rows[i1]),
+                _mm_mul_ps(_mm_set1_ps(t[i1]), rows[i2])));
+            __m128 ra = _mm_add_ps(
+                _mm_mul_ps(_mm_set1_ps(halfExtent[i1]), absRows[i2]),
+                _mm_mul_ps(_mm_set1_ps(halfExtent[i2]), absRows[i1]));
+            __m128 rb = _mm_add_ps(
+                _mm_mul_ps(b1, _mm_shuffle_ps(absRows[i], absRows[i], _MM_SHUFFLE(3, 1, 0, 2))),
+                _mm_mul_ps(b2, _mm_shuffle_ps(absRows[i], absRows[i], _MM_SHUFFLE(3, 0, 2, 1))));
+            separated = _mm_or_ps(separated, _mm_cmpgt_ps(distance, _mm_add_ps(ra, rb)));
+        }
+    }
+    return _mm_movemask_ps(separated) == 0;
+}
+
+bool OBB::Intersects(const BoundingSphere& sphere) const {
+    // 箱の中の最近点までの距離
+    Vector3 d = sphere.center - center;
+    float distanceSquare = 0.0f;
+    for (size_t i = 0; i < 3; ++i) {
+        float projection = Dot(d, axes[i]);
+        float excess = std::abs(projection) - halfExtent[i];
+        if (excess > 0.0f) {
+            distanceSquare += excess * excess;
+        }
+    }
+    return distanceSquare <= sphere.radius * sphere.radius;
+}
+
+const Vector3* GetKDOPDirections(std::uint32_t k) {
+    switch (k) {
+    case 14: return kDOP14Directions;
+    case 18: return kDOP18Directions;
+    case 26:
+    default: return kDOP26Directions;
+    }
+}
+
+void BoundingVolume::Update(BoundingVolumeType type, const Vector3* localPoints, std::uint32_t count, float localRadius, const Matrix4x4& world) {
+    if (type == BoundingVolumeType::kNone || count == 0) {
+        type_ = BoundingVolumeType::kNone;
+        return;
+    }
+    // 多い点群はUpdateFromVerticesに渡す
+    assert(count <= kMaxLocalPoints);
+    count = std::min(count, kMaxLocalPoints);
+    type_ = type;
+    if (revision_ != kNoRevision || count != localCount_ || localRadius != localRadius_ || !std::equal(localPoints, localPoints + count, localPoints_)) {
+        std::copy(localPoints, localPoints + count, localPoints_);
+        localCount_ = count;
+        localRadius_ = localRadius;
+        revision_ = kNoRevision;
+        isSphereFitted_ = false;
+        isOBBFitted_ = false;
+    }
+    UpdateWorld(world);
+}
+
+void BoundingVolume::UpdateFromVertices(BoundingVolumeType type, const Vector3* localPoints, std::uint32_t count, std::uint32_t revision, const Matrix4x4& world) {
+    if (type == BoundingVolumeType::kNone || count == 0) {
+        type_ = BoundingVolumeType::kNone;
+        return;
+    }
+    type_ = type;
+    if (revision != revision_) {
+        // 全ての頂点から一度だけ当てはめる
+        localSphere_ = BoundingSphere::Fit(localPoints, count, 0.0f);
+        localOBB_ = OBB::Fit(localPoints, count, 0.0f);
+        for (std::uint32_t i = 0; i < 8; ++i) {
+            localPoints_[i] = localOBB_.center +
+                localOBB_.axes[0] * ((i & 1) ? localOBB_.halfExtent.x : -localOBB_.halfExtent.x) +
+                localOBB_.axes[1] * ((i & 2) ? localOBB_.halfExtent.y : -localOBB_.halfExtent.y) +
+                localOBB_.axes[2] * ((i & 4) ? localOBB_.halfExtent.z : -localOBB_.halfExtent.z);
+        }
+        localCount_ = 8;
+        localRadius_ = 0.0f;
+        revision_ = revision;
+        isSphereFitted_ = true;
+        isOBBFitted_ = true;
+    }
+    UpdateWorld(world);
+}
+
+void BoundingVolume::UpdateWorld(const Matrix4x4& world) {
+    switch (type_) {
+    case BoundingVolumeType::kSphere:
+        if (!isSphereFitted_) {
+            localSphere_ = BoundingSphere::Fit(localPoints_, localCount_, localRadius_);
+            isSphereFitted_ = true;
+        }
+        sphere_ = localSphere_.Transform(world);
+        break;
+    case BoundingVolumeType::kOBB:
+        if (!isOBBFitted_) {
+            localOBB_ = OBB::Fit(localPoints_, localCount_, localRadius_);
+            isOBBFitted_ = true;
+        }
+        obb_ = localOBB_.Transform(world);
+        break;
+    default:
+    {
+        Vector3 worldPoints[kMaxLocalPoints];
+        for (std::uint32_t i = 0; i < localCount_; ++i) {
+            worldPoints[i] = localPoints_[i] * world;
+        }
+        float worldRadius = localRadius_ * GetMaxScale(world);
+        if (type_ == BoundingVolumeType::kDOP14) {
+            dop14_.Fit(worldPoints, localCount_, worldRadius);
+        }
+        else if (type_ == BoundingVolumeType::kDOP18) {
+            dop18_.Fit(worldPoints, localCount_, worldRadius);
+        }
+        else {
+            dop26_.Fit(worldPoints, localCount_, worldRadius);
+        }
+        break;
+    }
+    }
+}
+
+bool BoundingVolume::Intersects(const BoundingVolume& other) const {
+    if (type_ == BoundingVolumeType::kNone || other.type_ == BoundingVolumeType::kNone) {
+        return true;
+    }
+    if (type_ == other.type_) {
+        switch (type_) {
+        case BoundingVolumeType::kSphere: return sphere_.Intersects(other.sphere_);
+        case BoundingVolumeType::kOBB: return obb_.Intersects(other.obb_);
+        case BoundingVolumeType::kDOP14: return dop14_.Intersects(other.dop14_);
+        case BoundingVolumeType::kDOP18: return dop18_.Intersects(other.dop18_);
+        case BoundingVolumeType::kDOP26: return dop26_.Intersects(other.dop26_);
+        default: return true;
+        }
+    }
+    switch (other.type_) {
+    case BoundingVolumeType::kSphere:
+        if (type_ == BoundingVolumeType::kOBB) { return obb_.Intersects(other.sphere_); }
+        break;
+    case BoundingVolumeType::kOBB:
+        if (type_ == BoundingVolumeType::kSphere) { return other.obb_.Intersects(sphere_); }
+        break;
+    case BoundingVolumeType::kDOP14: return IntersectsDOP(other.dop14_);
+    case BoundingVolumeType::kDOP18: return IntersectsDOP(other.dop18_);
+    case BoundingVolumeType::kDOP26: return IntersectsDOP(other.dop26_);
+    default: break;
+    }
+    // 相手が球かOBBでこちらがk-DOP。相手の形をk-DOPに変換して比べる
+    switch (type_) {
+    case BoundingVolumeType::kDOP14: return other.IntersectsDOP(dop14_);
+    case BoundingVolumeType::kDOP18: return other.IntersectsDOP(dop18_);
+    case BoundingVolumeType::kDOP26: return other.IntersectsDOP(dop26_);
+    default: return true;
+    }
+}
+
+template<std::uint32_t K>
+bool BoundingVolume::IntersectsDOP(const KDOP<K>& dop) const {
+    KDOP<K> converted;
+    switch (type_) {
+    case BoundingVolumeType::kSphere:
+        converted.Fit(sphere_);
+        return converted.Intersects(dop);
+    case BoundingVolumeType::kOBB:
+        converted.Fit(obb_);
+        return converted.Intersects(dop);
+    default:
+        // kの違うk-DOP同士。共通の座標軸はAABBで判定済み
+        return true;
+    }
+}
@@ -0,0 +1,171 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+
+#include <xmmintrin.h>
+
+#include "../Math/MathUtils.hpp"
+
+// 広域判定の後、狭域判定の前にAABBより細い形で絞る
+enum class BoundingVolumeType : std::uint8_t {
+    kNone,      // AABBのみ
+    kSphere,
+    kOBB,
+    kDOP14,
+    kDOP18,
+    kDOP26,
+
+    kCount
+};
+
+const char* GetBoundingVolumeName(BoundingVolumeType type);
+
+// 当てはめはどれも点群をradiusだけ膨らませた形を包む（球やカプセルの丸み）
+
+struct BoundingSphere {
+    // Welzlの最小包含球（点の順番を混ぜて期待線形時間）
+    static BoundingSphere Fit(const Vector3* points, std::uint32_t count, float radius);
+
+    BoundingSphere Transform(const Matrix4x4& matrix) const;
+    bool Intersects(const BoundingSphere& other) const;
+
+    Vector3 center;
+    float radius = 0.0f;
+};
+
+struct OBB {
+    // 共分散行列の固有ベクトルを軸にする。座標軸に沿った箱の方が小さければそちらを使う
+    static OBB Fit(const Vector3* points, std::uint32_t count, float radius);
+
+    // 非一様スケールで軸が直交しなくなっても包むように広げる
+    OBB Transform(const Matrix4x4& matrix) const;
+    // 分離軸15本をSSEで3本ずつ判定する
+    bool Intersects(const OBB& other) const;
+    bool Intersects(const BoundingSphere& sphere) const;
+
+    Vector3 center;
+    Vector3 axes[3] = { Vector3::unitX, Vector3::unitY, Vector3::unitZ };
+    Vector3 halfExtent;
+};
+
+// k = 14, 18, 26の方向。どれも座標軸を先頭に置く
+const Vector3* GetKDOPDirections(std::uint32_t k);
+
+// k-DOP。k/2本の固定方向への射影区間
+// 回転に追従できないので毎回ワールドの点群から作る
+template<std::uint32_t K>
+class KDOP {
+public:
+    static_assert(K == 14 || K == 18 || K == 26);
+    static constexpr std::uint32_t kAxisCount = K / 2;
+    // SSEで4本ずつ比べるため詰め物をする
+    static constexpr std::uint32_t kPaddedCount = (kAxisCount + 3) & ~3u;
+
+    void Fit(const Vector3* points, std::uint32_t count, float radius) {
+        const Vector3* directions = GetKDOPDirections(K);
+        for (std::uint32_t axis = 0; axis < kAxisCount; ++axis) {
+            float lo = Math::positiveInfinity, hi = -Math::positiveInfinity;
+            for (std::uint32_t i = 0; i < count; ++i) {
+                float d = Dot(points[i], directions[axis]);
+                lo = std::min(lo, d);
+                hi = std::max(hi, d);
+            }
+            float margin = radius * directions[axis].Length();
+            min[axis] = lo - margin;
+            max[axis] = hi + margin;
+        }
+        ClearPadding();
+    }
+    void Fit(const BoundingSphere& sphere) {
+        const Vector3* directions = GetKDOPDirections(K);
+        for (std::uint32_t axis = 0; axis < kAxisCount; ++axis) {
+            float d = Dot(sphere.center, directions[axis]);
+            float margin = sphere.radius * directions[axis].Length();
+            min[axis] = d - margin;
+            max[axis] = d + margin;
+        }
+        ClearPadding();
+    }
+    void Fit(const OBB& obb) {
+        const Vector3* directions = GetKDOPDirections(K);
+        for (std::uint32_t axis = 0; axis < kAxisCount; ++axis) {
+            float d = Dot(obb.center, directions[axis]);
+            float margin =
+                obb.halfExtent.x * std::abs(Dot(obb.axes[0], directions[axis])) +
+                obb.halfExtent.y * std::abs(Dot(obb.axes[1], directions[axis])) +
+                obb.halfExtent.z * std::abs(Dot(obb.axes[2], directions[axis]));
+            min[axis] = d - margin;
+            max[axis] = d + margin;
+        }
+        ClearPadding();
+    }
+
+    bool Intersects(const KDOP& other) const {
+        for (std::uint32_t i = 0; i < kPaddedCount; i += 4) {
+            __m128 overlap = _mm_and_ps(
+                _mm_cmple_ps(_mm_load_ps(min + i), _mm_load_ps(other.max + i)),
+                _mm_cmple_ps(_mm_load_ps(other.min + i), _mm_load_ps(max + i)));
+            if (_mm_movemask_ps(overlap) != 0xF) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    alignas(16) float min[kPaddedCount] = {};
+    alignas(16) float max[kPaddedCount] = {};
+
+private:
+    // 詰め物は常に重なる
+    void ClearPadding() {
+        for (std::uint32_t axis = kAxisCount; axis < kPaddedCount; ++axis) {
+            min[axis] = 0.0f;
+            max[axis] = 0.0f;
+        }
+    }
+};
+
+// コライダーが持つ中域判定の境界ボリューム
+// 球とOBBはローカル空間で当てはめて行列で移し、点群が変わったときだけ当てはめ直す
+class BoundingVolume {
+public:
+    static constexpr std::uint32_t kMaxLocalPoints = 8;
+
+    // countが0ならAABBのみ（kNone）になる
+    void Update(BoundingVolumeType type, const Vector3* localPoints, std::uint32_t count, float localRadius, const Matrix4x4& world);
+    // 凸包やメッシュの頂点のように点の多い形。点は写さず比べもしないので、revisionが変わったときだけ全ての点から当てはめ直す
+    // k-DOPはローカルのOBBの角から作る
+    void UpdateFromVertices(BoundingVolumeType type, const Vector3* localPoints, std::uint32_t count, std::uint32_t revision, const Matrix4x4& world);
+    // 種類が違う場合は球やOBBをk-DOPに直して比べる。どちらかがkNoneなら常にtrue
+    bool Intersects(const BoundingVolume& other) const;
+
+    BoundingVolumeType GetType() const { return type_; }
+    const BoundingSphere& GetSphere() const { return sphere_; }
+    const OBB& GetOBB() const { return obb_; }
+
+private:
+    static constexpr std::uint32_t kNoRevision = 0xFFFFFFFF;
+
+    template<std::uint32_t K>
+    bool IntersectsDOP(const KDOP<K>& dop) const;
+    // ローカルの形をworldで移す
+    void UpdateWorld(const Matrix4x4& world);
+
+    Vector3 localPoints_[kMaxLocalPoints];
+    std::uint32_t localCount_ = 0;
+    float localRadius_ = 0.0f;
+    // UpdateFromVerticesで当てはめた形の版。Updateの点群ならkNoRevision
+    std::uint32_t revision_ = kNoRevision;
+    bool isSphereFitted_ = false;
+    bool isOBBFitted_ = false;
+    BoundingSphere localSphere_;
+    OBB localOBB_;
+
+    BoundingVolumeType type_ = BoundingVolumeType::kNone;
+    BoundingSphere sphere_;
+    OBB obb_;
+    KDOP<14> dop14_;
+    KDOP<18> dop18_;
+    KDOP<26> dop26_;
+};
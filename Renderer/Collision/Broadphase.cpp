@@ -0,0 +1,34 @@
+#include "Broadphase.hpp"
+
+#include "SweepAndPruneBroadphase.hpp"
+#include "DynamicTreeBroadphase.hpp"
+#include "UniformGridBroadphase.hpp"
+#include "LooseOctreeBroadphase.hpp"
+#include "LinearBVHBroadphase.hpp"
+
+std::unique_ptr<Broadphase> CreateBroadphase(BroadphaseType type) {
+    switch (type) {
+    case BroadphaseType::kDynamicTree:
+        return std::make_unique<DynamicTreeBroadphase>();
+    case BroadphaseType::kUniformGrid:
+        return std::make_unique<UniformGridBroadphase>();
+    case BroadphaseType::kLooseOctree:
+        return std::make_unique<LooseOctreeBroadphase>();
+    case BroadphaseType::kLinearBVH:
+        return std::make_unique<LinearBVHBroadphase>();
+    case BroadphaseType::kSweepAndPrune:
+    default:
+        return std::make_unique<SweepAndPruneBroadphase>();
+    }
+}
+
+const char* GetBroadphaseName(BroadphaseType type) {
+    switch (type) {
+    case BroadphaseType::kSweepAndPrune: return "SweepAndPrune";
+    case BroadphaseType::kDynamicTree: return "DynamicTree";
+    case BroadphaseType::kUniformGrid: return "UniformGrid";
+    case BroadphaseType::kLooseOctree: return "LooseOctree";
+    case BroadphaseType::kLinearBVH: return "LinearBVH";
+    default: return "Unknown";
+    }
+}
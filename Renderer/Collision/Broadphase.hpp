@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "../Math/MathUtils.hpp"
+#include "../AABB.hpp"
+
+enum class BroadphaseType {
+    kSweepAndPrune,
+    kDynamicTree,
+    kUniformGrid,
+    kLooseOctree,
+    kLinearBVH,
+
+    kCount
+};
+
+// 広域判定の共通インターフェース
+// 要素は呼び出し側が決めるIDで管理する
+class Broadphase {
+public:
+    virtual ~Broadphase() {}
+
+    virtual void Insert(std::uint32_t id, const AABB& aabb) = 0;
+    virtual void Remove(std::uint32_t id) = 0;
+    virtual void Move(std::uint32_t id, const AABB& aabb) = 0;
+    virtual void Clear() = 0;
+
+    // AABBが重なる全てのペアのキーをpairsに追加する（順不同、重複なし）
+    virtual void ComputePairs(std::vector<std::uint64_t>& pairs) = 0;
+    // boundsと重なる要素のIDを追加する
+    virtual void Query(const AABB& bounds, std::vector<std::uint32_t>& ids) const = 0;
+    // 線分[origin, origin + direction * maxDistance]とAABBが交差する要素のIDを追加する
+    virtual void Raycast(const Vector3& origin, const Vector3& direction, float maxDistance, std::vector<std::uint32_t>& ids) const = 0;
+
+    virtual BroadphaseType GetType() const = 0;
+    virtual std::uint32_t GetCount() const = 0;
+    // 確保済みのバイト数
+    virtual size_t GetMemoryUsage() const = 0;
+
+    // IDの小さい方を上位に詰めたペアのキー
+    static std::uint64_t MakePairKey(std::uint32_t idA, std::uint32_t idB) {
+        if (idA > idB) { std::swap(idA, idB); }
+        return (static_cast<std::uint64_t>(idA) << 32) | idB;
+    }
+    static std::uint32_t PairKeyFirst(std::uint64_t key) { return static_cast<std::uint32_t>(key >> 32); }
+    static std::uint32_t PairKeySecond(std::uint64_t key) { return static_cast<std::uint32_t>(key & 0xFFFFFFFF); }
+};
+
+std::unique_ptr<Broadphase> CreateBroadphase(BroadphaseType type);
+const char* GetBroadphaseName(BroadphaseType type);
+
+// vectorの確保済みバイト数
+template<class T>
+size_t GetCapacityBytes(const std::vector<T>& v) {
+    return v.capacity() * sizeof(T);
+}
@@ -0,0 +1,103 @@
+#include "BroadphaseRecording.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <fstream>
+
+namespace {
+    const char kSignature[4] = { 'B', 'P', 'R', 'C' };
+    const std::uint32_t kVersion = 1;
+}
+
+void BroadphaseRecording::Clear() {
+    records_.clear();
+    frameOffsets_.clear();
+}
+
+bool BroadphaseRecording::Save(const std::filesystem::path& path) const {
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    std::uint32_t frameCount = GetFrameCount();
+    std::uint32_t recordCount = static_cast<std::uint32_t>(records_.size());
+    file.write(kSignature, sizeof(kSignature));
+    file.write(reinterpret_cast<const char*>(&kVersion), sizeof(kVersion));
+    file.write(reinterpret_cast<const char*>(&frameCount), sizeof(frameCount));
+    file.write(reinterpret_cast<const char*>(&recordCount), sizeof(recordCount));
+    file.write(reinterpret_cast<const char*>(frameOffsets_.data()), frameCount * sizeof(std::uint32_t));
+    file.write(reinterpret_cast<const char*>(records_.data()), recordCount * sizeof(Record));
+    return file.good();
+}
+
+bool BroadphaseRecording::Load(const std::filesystem::path& path) {
+    Clear();
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    char signature[4];
+    std::uint32_t version, frameCount, recordCount;
+    file.read(signature, sizeof(signature));
+    file.read(reinterpret_cast<char*>(&version), sizeof(version));
+    file.read(reinterpret_cast<char*>(&frameCount), sizeof(frameCount));
+    file.read(reinterpret_cast<char*>(&recordCount), sizeof(recordCount));
+    if (!file || !std::equal(signature, signature + 4, kSignature) || version != kVersion) {
+        return false;
+    }
+    // 壊れたヘッダーで巨大な確保をしないよう、残りの大きさと突き合わせてから読む
+    std::streamoff headerSize = file.tellg();
+    file.seekg(0, std::ios::end);
+    std::uint64_t bodySize = static_cast<std::uint64_t>(file.tellg() - headerSize);
+    file.seekg(headerSize);
+    if (bodySize != static_cast<std::uint64_t>(frameCount) * sizeof(std::uint32_t) + static_cast<std::uint64_t>(recordCount) * sizeof(Record)) {
+        return false;
+    }
+    frameOffsets_.resize(frameCount);
+    records_.resize(recordCount);
+    file.read(reinterpret_cast<char*>(frameOffsets_.data()), frameCount * sizeof(std::uint32_t));
+    file.read(reinterpret_cast<char*>(records_.data()), recordCount * sizeof(Record));
+    if (!file) {
+        Clear();
+        return false;
+    }
+    // Replayが範囲外を読まないよう、フレームの開始は減らず記録の数を越えないこと
+    std::uint32_t previousOffset = 0;
+    for (std::uint32_t offset : frameOffsets_) {
+        if (offset < previousOffset || offset > recordCount) {
+            Clear();
+            return false;
+        }
+        previousOffset = offset;
+    }
+    for (const Record& record : records_) {
+        if (record.command != Command::kInsert && record.command != Command::kRemove && record.command != Command::kMove) {
+            Clear();
+            return false;
+        }
+    }
+    return true;
+}
+
+void BroadphaseRecording::Replay(std::uint32_t frame, Broadphase& broadphase) const {
+    assert(frame < frameOffsets_.size());
+    if (frame >= frameOffsets_.size()) {
+        return;
+    }
+    std::uint32_t begin = frameOffsets_[frame];
+    std::uint32_t end = frame + 1 < frameOffsets_.size() ? frameOffsets_[frame + 1] : static_cast<std::uint32_t>(records_.size());
+    for (std::uint32_t i = begin; i < end; ++i) {
+        const Record& record = records_[i];
+        switch (record.command) {
+        case Command::kInsert:
+            broadphase.Insert(record.id, record.aabb);
+            break;
+        case Command::kRemove:
+            broadphase.Remove(record.id);
+            break;
+        case Command::kMove:
+            broadphase.Move(record.id, record.aabb);
+            break;
+        }
+    }
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+#include "Broadphase.hpp"
+
+// 広域判定への操作をフレームごとに記録する
+// 同じ記録を各実装で再生して比較するために使う
+class BroadphaseRecording {
+public:
+    enum class Command : std::uint32_t {
+        kInsert,
+        kRemove,
+        kMove
+    };
+    struct Record {
+        Command command;
+        std::uint32_t id;
+        AABB aabb;      // kRemoveでは未使用
+    };
+
+    void BeginFrame() { frameOffsets_.emplace_back(static_cast<std::uint32_t>(records_.size())); }
+    void Insert(std::uint32_t id, const AABB& aabb) { records_.push_back({ Command::kInsert, id, aabb }); }
+    void Remove(std::uint32_t id) { records_.push_back({ Command::kRemove, id, AABB() }); }
+    void Move(std::uint32_t id, const AABB& aabb) { records_.push_back({ Command::kMove, id, aabb }); }
+    void Clear();
+
+    bool Save(const std::filesystem::path& path) const;
+    // 大きさやフレームの範囲が合わないファイルは読まずにfalse
+    bool Load(const std::filesystem::path& path);
+
+    // frameの操作をbroadphaseに適用する。frameはGetFrameCount()未満
+    void Replay(std::uint32_t frame, Broadphase& broadphase) const;
+
+    std::uint32_t GetFrameCount() const { return static_cast<std::uint32_t>(frameOffsets_.size()); }
+    const std::vector<Record>& GetRecords() const { return records_; }
+
+private:
+    std::vector<Record> records_;
+    // フレームの最初の記録の番号
+    std::vector<std::uint32_t> frameOffsets_;
+};
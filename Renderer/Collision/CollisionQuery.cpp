@@ -0,0 +1,52 @@
+#include "CollisionQuery.hpp"
+
+#include "../Collider.hpp"
+#include "GJK.hpp"
+
+namespace Collision {
+
+    bool Distance(const Collider& colliderA, const Collider& colliderB, DistanceResult& result, float maxDistance) {
+        auto supportA = [&](const Vector3& direction) { return colliderA.FindFurthestPoint(direction); };
+        auto supportB = [&](const Vector3& direction) { return colliderB.FindFurthestPoint(direction); };
+        // 中心の差を初期方向にすると離れている場合は数回で打ち切られる
+        Vector3 initialDirection = colliderB.GetAABB().Center() - colliderA.GetAABB().Center();
+        if (initialDirection.LengthSquare() <= GJK::kAbsoluteTolerance) {
+            initialDirection = Vector3::unitX;
+        }
+
+        GJK::Result gjk;
+        bool isWithin = GJK::Distance(supportA, supportB, gjk, maxDistance, initialDirection);
+        result.pointA = gjk.pointA;
+        result.pointB = gjk.pointB;
+        result.distance = gjk.distance;
+        result.isIntersecting = gjk.isIntersecting;
+        return isWithin;
+    }
+
+    float Distance(const Collider& colliderA, const Collider& colliderB) {
+        DistanceResult result{};
+        Distance(colliderA, colliderB, result);
+        return result.distance;
+    }
+
+    bool ClosestPoint(const Collider& collider, const Vector3& point, Vector3& closestPoint, float maxDistance) {
+        auto supportA = [&](const Vector3& direction) { return collider.FindFurthestPoint(direction); };
+        auto supportB = [&](const Vector3&) { return point; };
+        Vector3 initialDirection = point - collider.GetAABB().Center();
+        if (initialDirection.LengthSquare() <= GJK::kAbsoluteTolerance) {
+            initialDirection = Vector3::unitX;
+        }
+
+        GJK::Result gjk;
+        bool isWithin = GJK::Distance(supportA, supportB, gjk, maxDistance, initialDirection);
+        closestPoint = gjk.isIntersecting ? point : gjk.pointA;
+        return isWithin;
+    }
+
+    Vector3 ClosestPoint(const Collider& collider, const Vector3& point) {
+        Vector3 closestPoint;
+        ClosestPoint(collider, point, closestPoint);
+        return closestPoint;
+    }
+
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "../Math/MathUtils.hpp"
+
+class Collider;
+
+namespace Collision {
+
+    struct DistanceResult {
+        Vector3 pointA;     // colliderA上の最近点
+        Vector3 pointB;     // colliderB上の最近点
+        float distance;     // 打ち切られた場合は距離の下限
+        bool isIntersecting;
+    };
+
+    // コライダー間の距離と最近点を求める
+    // 距離がmaxDistance以下の場合true
+    bool Distance(const Collider& colliderA, const Collider& colliderB, DistanceResult& result, float maxDistance = Math::positiveInfinity);
+    float Distance(const Collider& colliderA, const Collider& colliderB);
+
+    // コライダー上でpointに最も近い点を求める
+    // pointが内部にある場合はpointを返す
+    bool ClosestPoint(const Collider& collider, const Vector3& point, Vector3& closestPoint, float maxDistance = Math::positiveInfinity);
+    Vector3 ClosestPoint(const Collider& collider, const Vector3& point);
+
+}
@@ -0,0 +1,181 @@
+#include "CollisionSnapshot.hpp"
+
+#include "../BoxCollider.hpp"
+#include "../CapsuleCollider.hpp"
+#include "../CompoundCollider.hpp"
+#include "../ConvexHullCollider.hpp"
+#include "../DistanceFieldCollider.hpp"
+#include "../HeightfieldCollider.hpp"
+#include "../MeshCollider.hpp"
+#include "../SphereCollider.hpp"
+#include "../Transform.hpp"
+#include "GJK.hpp"
+#include "Support.hpp"
+
+bool CollisionSnapshot::Raycast(const Vector3& origin, const Vector3& direction, float maxDistance, RaycastHit& hit, std::uint32_t& colliderID) const {
+    bool isHit = false;
+    hit.distance = maxDistance;
+    hit.collider = nullptr;
+    auto test = [&](const Layer& layer, const Entry& entry) {
+        float tMin = 0.0f, tMax = hit.distance;
+        if (!entry.aabb.IntersectsRay(origin, direction, tMin, tMax)) {
+            return;
+        }
+        RaycastHit entryHit;
+        if (layer.RaycastEntry(entry, origin, direction, hit.distance, entryHit) && entryHit.distance <= hit.distance) {
+            hit.point = entryHit.point;
+            hit.normal = entryHit.normal;
+            hit.distance = entryHit.distance;
+            colliderID = entry.colliderID;
+            isHit = true;
+        }
+        };
+    dynamicLayer_.bvh.Raycast(origin, direction, maxDistance, [&](std::uint32_t index) { test(dynamicLayer_, dynamicLayer_.entries[index]); });
+    if (staticLayer_) {
+        staticLayer_->bvh.Raycast(origin, direction, maxDistance, [&](std::uint32_t index) { test(*staticLayer_, staticLayer_->entries[index]); });
+    }
+    return isHit;
+}
+
+void CollisionSnapshot::Query(const AABB& bounds, std::vector<std::uint32_t>& colliderIDs) const {
+    auto query = [&](const Layer& layer) {
+        layer.bvh.Query(bounds, [&](std::uint32_t index) {
+            const Entry& entry = layer.entries[index];
+            if (entry.aabb.Intersects(bounds)) {
+                colliderIDs.emplace_back(entry.colliderID);
+            }
+            });
+        };
+    query(dynamicLayer_);
+    if (staticLayer_) {
+        query(*staticLayer_);
+    }
+}
+
+std::uint32_t CollisionSnapshot::GetCount() const {
+    size_t count = dynamicLayer_.entries.size() + (staticLayer_ ? staticLayer_->entries.size() : 0);
+    return static_cast<std::uint32_t>(count);
+}
+
+void CollisionSnapshot::Layer::Clear() {
+    // 共有の形を手放す
+    entries.clear();
+    points.clear();
+}
+
+void CollisionSnapshot::Layer::Add(const Collider& collider) {
+    Entry entry{};
+    entry.aabb = collider.GetAABB();
+    entry.worldMatrix = collider.GetTransform().GetWorldMatrix();
+    entry.type = collider.GetType();
+    entry.colliderID = collider.GetID();
+    switch (entry.type) {
+    case Collider::Type::kSphere: {
+        const auto& sphere = static_cast<const SphereCollider&>(collider);
+        entry.center = sphere.GetCenter();
+        entry.radius = sphere.GetRadius();
+        break;
+    }
+    case Collider::Type::kBox: {
+        const auto& box = static_cast<const BoxCollider&>(collider);
+        entry.center = box.GetCenter();
+        entry.halfSize = box.GetSize() * 0.5f;
+        break;
+    }
+    case Collider::Type::kCapsule: {
+        const auto& capsule = static_cast<const CapsuleCollider&>(collider);
+        entry.center = capsule.GetCenter();
+        entry.radius = capsule.GetRadius();
+        entry.halfSegment = capsule.GetHalfSegment();
+        break;
+    }
+    case Collider::Type::kConvexHull: {
+        const auto& vertices = static_cast<const ConvexHullCollider&>(collider).GetHull().GetVertices();
+        entry.firstPoint = static_cast<std::uint32_t>(points.size());
+        entry.pointCount = static_cast<std::uint32_t>(vertices.size());
+        points.insert(points.end(), vertices.begin(), vertices.end());
+        break;
+    }
+    case Collider::Type::kMesh:
+        entry.shape = static_cast<const MeshCollider&>(collider).GetShape();
+        break;
+    case Collider::Type::kHeightfield:
+        entry.shape = static_cast<const HeightfieldCollider&>(collider).GetShape();
+        break;
+    case Collider::Type::kCompound:
+        entry.shape = static_cast<const CompoundCollider&>(collider).GetShape();
+        break;
+    case Collider::Type::kDistanceField:
+        entry.shape = static_cast<const DistanceFieldCollider&>(collider).GetSharedField();
+        break;
+    }
+    entries.emplace_back(std::move(entry));
+}
+
+void CollisionSnapshot::Layer::Build(BVH::SplitMethod splitMethod) {
+    bounds.resize(entries.size());
+    for (size_t i = 0; i < entries.size(); ++i) {
+        bounds[i] = entries[i].aabb;
+    }
+    bvh.Build(bounds, splitMethod);
+}
+
+bool CollisionSnapshot::Layer::RaycastEntry(const Entry& entry, const Vector3& origin, const Vector3& direction, float maxDistance, RaycastHit& hit) const {
+    const Matrix4x4& world = entry.worldMatrix;
+    switch (entry.type) {
+    case Collider::Type::kMesh:
+        return static_cast<const MeshCollider::Shape*>(entry.shape.get())->Raycast(world, origin, direction, maxDistance, hit);
+    case Collider::Type::kHeightfield:
+        return static_cast<const HeightfieldCollider::Shape*>(entry.shape.get())->Raycast(world, origin, direction, maxDistance, hit);
+    case Collider::Type::kCompound:
+        return static_cast<const CompoundCollider::Shape*>(entry.shape.get())->Raycast(world, origin, direction, maxDistance, hit);
+    case Collider::Type::kDistanceField:
+        return DistanceFieldCollider::RaycastField(*static_cast<const SignedDistanceField*>(entry.shape.get()), world, origin, direction, maxDistance, hit);
+    default:
+        break;
+    }
+
+    // 凸形状はコライダーと同じくサポート写像で保守的前進する
+    auto support = [&](const Vector3& supportDirection) {
+        Vector3 localDirection{
+            Vector3::Dot(world.GetXAxis(), supportDirection),
+            Vector3::Dot(world.GetYAxis(), supportDirection),
+            Vector3::Dot(world.GetZAxis(), supportDirection) };
+        Vector3 point;
+        switch (entry.type) {
+        case Collider::Type::kSphere:
+            point = entry.center + Support::Sphere(localDirection, entry.radius);
+            break;
+        case Collider::Type::kBox:
+            point = entry.center + Support::Box(localDirection, entry.halfSize);
+            break;
+        case Collider::Type::kCapsule:
+            point = entry.center + Support::Capsule(localDirection, entry.radius, entry.halfSegment);
+            break;
+        default: {
+            // 凸包。頂点が無ければ原点
+            point = Vector3::zero;
+            float maxDot = -Math::positiveInfinity;
+            for (std::uint32_t i = 0; i < entry.pointCount; ++i) {
+                const Vector3& vertex = points[entry.firstPoint + i];
+                float dot = Vector3::Dot(vertex, localDirection);
+                if (dot > maxDot) {
+                    maxDot = dot;
+                    point = vertex;
+                }
+            }
+            break;
+        }
+        }
+        return point * world;
+        };
+    float distance;
+    Vector3 normal;
+    if (!GJK::Raycast(support, origin, direction, maxDistance, distance, normal)) {
+        return false;
+    }
+    hit.point = origin + direction * distance;
+    hit.normal = normal;
+    hit.distance = distance;
+    return true;
+}
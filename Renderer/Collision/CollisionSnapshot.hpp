@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "../Math/MathUtils.hpp"
+#include "../AABB.hpp"
+#include "../Collider.hpp"
+#include "BVH.hpp"
+#include "EpochReclamation.hpp"
+
+class CollisionWorld;
+
+// Stepの終わりに作る広域判定と形の読み取り専用の写し
+// 形の値とワールド行列を写し取り、大きい形は書き換えない共有の形を持つので、コライダーは見ない
+// 公開後は変更しないので、次のStepやコライダーの移動、削除と並行にどのスレッドからでも問い合わせられる
+class CollisionSnapshot {
+public:
+    struct Entry {
+        AABB aabb;
+        Matrix4x4 worldMatrix;
+        Collider::Type type;
+        // 作ったときのCollisionWorldのID。削除されると別のコライダーに再利用されうる
+        std::uint32_t colliderID;
+        // 球、箱、カプセル
+        Vector3 center;
+        Vector3 halfSize;
+        float radius;
+        float halfSegment;
+        // 凸包の頂点。Layer::pointsの中
+        std::uint32_t firstPoint;
+        std::uint32_t pointCount;
+        // メッシュ、高さ場、コンパウンド、距離場の共有の形
+        std::shared_ptr<const void> shape;
+    };
+
+    // directionは正規化済み。最も近いヒットを返す。hit.colliderはnullptrで、コライダーはcolliderIDで返す
+    bool Raycast(const Vector3& origin, const Vector3& direction, float maxDistance, RaycastHit& hit, std::uint32_t& colliderID) const;
+    // AABBがboundsと重なるコライダーのIDを追加する
+    void Query(const AABB& bounds, std::vector<std::uint32_t>& colliderIDs) const;
+
+    // 何回目のStepで作られたか
+    std::uint64_t GetEpoch() const { return epoch_; }
+    std::uint32_t GetCount() const;
+
+private:
+    friend class CollisionWorld;
+
+    // 要素とその上の木。静的な層は変わるまで次の写しと共有する
+    struct Layer {
+        std::vector<Entry> entries;
+        std::vector<Vector3> points;
+        std::vector<AABB> bounds;
+        BVH bvh;
+
+        void Clear();
+        // colliderの今の形を写し取って加える
+        void Add(const Collider& collider);
+        void Build(BVH::SplitMethod splitMethod);
+        bool RaycastEntry(const Entry& entry, const Vector3& origin, const Vector3& direction, float maxDistance, RaycastHit& hit) const;
+    };
+
+    std::uint64_t epoch_ = 0;
+    Layer dynamicLayer_;
+    std::shared_ptr<const Layer> staticLayer_;
+};
+
+// 写しとそれを解放させないガードの組
+// 長く持つと古い写しが溜まるので、問い合わせが済んだら手放す
+class CollisionSnapshotHandle {
+public:
+    CollisionSnapshotHandle() : snapshot_(nullptr) {}
+    CollisionSnapshotHandle(const CollisionSnapshot* snapshot, EpochReclamation::Guard&& guard) :
+        snapshot_(snapshot), guard_(std::move(guard)) {}
+
+    const CollisionSnapshot* operator->() const { return snapshot_; }
+    const CollisionSnapshot& operator*() const { return *snapshot_; }
+    // まだ一度もStepしていないか、読み手の枠が埋まっていればfalse
+    explicit operator bool() const { return snapshot_ != nullptr; }
+
+private:
+    const CollisionSnapshot* snapshot_;
+    EpochReclamation::Guard guard_;
+};
@@ -0,0 +1,417 @@
+#include "CollisionWorld.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+
+#include "BroadphaseRecording.hpp"
+#include "../Collider.hpp"
+#include "../GameObject.hpp"
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    float ElapsedMilliseconds(const Clock::time_point& start) {
+        return std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+    }
+
+    void RemovePairs(std::vector<std::uint64_t>& pairs, std::uint32_t id) {
+        auto end = std::remove_if(pairs.begin(), pairs.end(),
+            [id](std::uint64_t key) { return Broadphase::PairKeyFirst(key) == id || Broadphase::PairKeySecond(key) == id; });
+        pairs.erase(end, pairs.end());
+    }
+}
+
+CollisionWorld::CollisionWorld(BroadphaseType broadphaseType) :
+    broadphase_(CreateBroadphase(broadphaseType)),
+    recording_(nullptr),
+    snapshot_(nullptr),
+    isStaticLayerDirty_(true),
+    stepCount_(0),
+    profile_{} {
+}
+
+void CollisionWorld::Register(Collider* collider) {
+    assert(collider && !collider->world_);
+    std::uint32_t id;
+    if (!freeIDs_.empty()) {
+        id = freeIDs_.back();
+        freeIDs_.pop_back();
+        colliders_[id] = collider;
+    }
+    else {
+        id = static_cast<std::uint32_t>(colliders_.size());
+        colliders_.emplace_back(collider);
+        proxyStates_.emplace_back(ProxyState::kNone);
+    }
+    collider->world_ = this;
+    collider->id_ = id;
+}
+
+void CollisionWorld::Unregister(Collider* collider) {
+    assert(collider && collider->world_ == this);
+    std::uint32_t id = collider->id_;
+    if (proxyStates_[id] != ProxyState::kNone) {
+        RemoveProxy(id);
+    }
+    // 先に外れた相手として残っていれば伝えない
+    pendingExitIDs_.erase(std::remove(pendingExitIDs_.begin(), pendingExitIDs_.end(), id), pendingExitIDs_.end());
+    // 接触していた相手はIDで覚えておく。ペアのキーは同じIDが再利用されると別のコライダーを指す
+    for (std::uint64_t key : previousPairs_) {
+        std::uint32_t first = Broadphase::PairKeyFirst(key), second = Broadphase::PairKeySecond(key);
+        if (first == id || second == id) {
+            pendingExitIDs_.emplace_back(first == id ? second : first);
+        }
+    }
+    // 同じIDが再利用されても古いペアが残らないようにする
+    RemovePairs(previousPairs_, id);
+    RemovePairs(currentPairs_, id);
+    contactCache_.RemoveID(id);
+    auto end = std::remove_if(collisionPairs_.begin(), collisionPairs_.end(),
+        [collider](const CollisionPair& pair) { return pair.colliderA == collider || pair.colliderB == collider; });
+    collisionPairs_.erase(end, collisionPairs_.end());
+    colliders_[id] = nullptr;
+    freeIDs_.emplace_back(id);
+    collider->world_ = nullptr;
+    collider->id_ = Collider::kInvalidID;
+}
+
+void CollisionWorld::Step() {
+    auto start = Clock::now();
+    UpdateAABBs();
+    profile_.updateAABB = ElapsedMilliseconds(start);
+
+    start = Clock::now();
+    FindCandidatePairs();
+    profile_.broadphase = ElapsedMilliseconds(start);
+
+    start = Clock::now();
+    Narrowphase();
+    profile_.narrowphase = ElapsedMilliseconds(start);
+
+    start = Clock::now();
+    DispatchEvents();
+    profile_.dispatch = ElapsedMilliseconds(start);
+
+    start = Clock::now();
+    PublishSnapshot();
+    profile_.snapshot = ElapsedMilliseconds(start);
+
+    profile_.candidatePairCount = static_cast<std::uint32_t>(candidatePairs_.size());
+    profile_.contactCount = static_cast<std::uint32_t>(collisionPairs_.size());
+    profile_.staticCount = staticTree_.GetCount();
+    profile_.retiredSnapshotCount = static_cast<std::uint32_t>(retiredSnapshots_.size());
+    profile_.broadphaseMemory = broadphase_->GetMemoryUsage() + staticTree_.GetMemoryUsage();
+}
+
+bool CollisionWorld::Raycast(const Vector3& origin, const Vector3& direction, float maxDistance, RaycastHit& hit) const {
+    std::vector<std::uint32_t>& ids = queryIDs_;
+    ids.clear();
+    broadphase_->Raycast(origin, direction, maxDistance, ids);
+    staticTree_.Raycast(origin, direction, maxDistance, [&ids](std::uint32_t id) { ids.emplace_back(id); });
+    bool isHit = false;
+    hit.distance = maxDistance;
+    for (std::uint32_t id : ids) {
+        Collider* collider = colliders_[id];
+        if (!collider || !IsColliderActive(*collider)) {
+            continue;
+        }
+        float tMin = 0.0f, tMax = hit.distance;
+        if (!collider->GetAABB().IntersectsRay(origin, direction, tMin, tMax)) {
+            continue;
+        }
+        RaycastHit colliderHit;
+        if (collider->Raycast(origin, direction, hit.distance, colliderHit) && colliderHit.distance <= hit.distance) {
+            hit = colliderHit;
+            isHit = true;
+        }
+    }
+    return isHit;
+}
+
+void CollisionWorld::Query(const AABB& bounds, std::vector<Collider*>& colliders) const {
+    Query(bounds, colliders, queryIDs_);
+}
+
+void CollisionWorld::Query(const AABB& bounds, std::vector<Collider*>& colliders, std::vector<std::uint32_t>& ids) const {
+    ids.clear();
+    broadphase_->Query(bounds, ids);
+    staticTree_.Query(bounds, [&ids](std::uint32_t id) { ids.emplace_back(id); });
+    for (std::uint32_t id : ids) {
+        Collider* collider = colliders_[id];
+        if (collider && IsColliderActive(*collider) && collider->GetAABB().Intersects(bounds)) {
+            colliders.emplace_back(collider);
+        }
+    }
+}
+
+CollisionSnapshotHandle CollisionWorld::AcquireSnapshot() const {
+    // 先にエポックを書いてから読む。逆だと読んだ直後に解放されうる
+    EpochReclamation::Guard guard;
+    if (!epochReclamation_.TryPin(guard)) {
+        return CollisionSnapshotHandle();
+    }
+    return CollisionSnapshotHandle(snapshot_.load(), std::move(guard));
+}
+
+void CollisionWorld::InsertProxy(std::uint32_t id, const AABB& aabb) {
+    if (colliders_[id]->IsStatic()) {
+        staticTree_.Insert(id, aabb);
+        proxyStates_[id] = ProxyState::kStatic;
+        isStaticLayerDirty_ = true;
+        return;
+    }
+    broadphase_->Insert(id, aabb);
+    proxyStates_[id] = ProxyState::kDynamic;
+    if (recording_) { recording_->Insert(id, aabb); }
+}
+
+void CollisionWorld::RemoveProxy(std::uint32_t id) {
+    if (proxyStates_[id] == ProxyState::kStatic) {
+        staticTree_.Remove(id);
+        isStaticLayerDirty_ = true;
+    }
+    else {
+        broadphase_->Remove(id);
+        if (recording_) { recording_->Remove(id); }
+    }
+    proxyStates_[id] = ProxyState::kNone;
+}
+
+void CollisionWorld::MoveProxy(std::uint32_t id, const AABB& aabb) {
+    broadphase_->Move(id, aabb);
+    if (recording_) { recording_->Move(id, aabb); }
+}
+
+void CollisionWorld::UpdateAABBs() {
+    if (recording_) { recording_->BeginFrame(); }
+    for (std::uint32_t id = 0; id < colliders_.size(); ++id) {
+        Collider* collider = colliders_[id];
+        if (!collider) {
+            continue;
+        }
+        ProxyState state = proxyStates_[id];
+        // 非アクティブなコライダーは広域判定から外す
+        if (!IsColliderActive(*collider)) {
+            if (state != ProxyState::kNone) {
+                RemoveProxy(id);
+            }
+            continue;
+        }
+        // 静的な木に入ったものは更新しない
+        if (state == ProxyState::kStatic && collider->IsStatic()) {
+            continue;
+        }
+        // 静的と動的が切り替わったら木を移す
+        if (state != ProxyState::kNone && (state == ProxyState::kStatic) != collider->IsStatic()) {
+            RemoveProxy(id);
+            state = ProxyState::kNone;
+        }
+        collider->UpdateAABB();
+        collider->UpdateBoundingVolume();
+        if (state == ProxyState::kDynamic) {
+            MoveProxy(id, collider->GetAABB());
+        }
+        else {
+            InsertProxy(id, collider->GetAABB());
+        }
+    }
+    if (staticTree_.NeedsRebuild()) {
+        staticTree_.Rebuild();
+    }
+}
+
+void CollisionWorld::FindCandidatePairs() {
+    candidatePairs_.clear();
+    // 動的同士
+    broadphase_->ComputePairs(candidatePairs_);
+    // 動的と静的。静的同士は作らない
+    for (std::uint32_t id = 0; id < proxyStates_.size(); ++id) {
+        if (proxyStates_[id] != ProxyState::kDynamic) {
+            continue;
+        }
+        staticTree_.Query(colliders_[id]->GetAABB(), [this, id](std::uint32_t staticID) {
+            candidatePairs_.emplace_back(Broadphase::MakePairKey(id, staticID));
+            });
+    }
+    // 同じゲームオブジェクトのコライダー同士は判定しない
+    // 中域判定の境界ボリュームが離れていれば狭域判定に回さない
+    // 残りは重複を除き、キー順に並べて狭域判定とイベントの順序を決める
+    profile_.culledPairCount = 0;
+    pairSet_.Clear();
+    for (auto key : candidatePairs_) {
+        const Collider& colliderA = *colliders_[Broadphase::PairKeyFirst(key)];
+        const Collider& colliderB = *colliders_[Broadphase::PairKeySecond(key)];
+        if (&colliderA.GetGameObject() == &colliderB.GetGameObject()) {
+            continue;
+        }
+        if (!colliderA.GetBoundingVolume().Intersects(colliderB.GetBoundingVolume())) {
+            ++profile_.culledPairCount;
+            continue;
+        }
+        pairSet_.Insert(key);
+    }
+    pairSet_.GetSortedKeys(candidatePairs_);
+}
+
+void CollisionWorld::Narrowphase() {
+    currentPairs_.clear();
+    collisionPairs_.clear();
+
+    // 前回からほとんど動いていないペアは結果を使い回す
+    // 残りのうち基本形状同士はまとめて先に解く
+    std::uint32_t pairCount = static_cast<std::uint32_t>(candidatePairs_.size());
+    contactCache_.Begin(pairCount);
+    primitiveBatch_.Clear();
+    batchResults_.assign(pairCount, PrimitiveBatch::Result::kNotBatched);
+    batchContacts_.resize(pairCount);
+    profile_.batchedPairCount = 0;
+    for (std::uint32_t i = 0; i < pairCount; ++i) {
+        std::uint64_t key = candidatePairs_[i];
+        const Collider& colliderA = *colliders_[Broadphase::PairKeyFirst(key)];
+        const Collider& colliderB = *colliders_[Broadphase::PairKeySecond(key)];
+        bool isHit;
+        if (contactCache_.Reuse(i, key, colliderA, colliderB, isHit, batchContacts_[i])) {
+            batchResults_[i] = isHit ? PrimitiveBatch::Result::kHit : PrimitiveBatch::Result::kMiss;
+            continue;
+        }
+        if (primitiveBatch_.Add(colliderA, colliderB, i)) {
+            ++profile_.batchedPairCount;
+        }
+    }
+    primitiveBatch_.Execute(batchResults_, batchContacts_);
+    profile_.cachedPairCount = contactCache_.GetReusedCount();
+
+    for (std::uint32_t i = 0; i < pairCount; ++i) {
+        std::uint64_t key = candidatePairs_[i];
+        Collider* colliderA = colliders_[Broadphase::PairKeyFirst(key)];
+        Collider* colliderB = colliders_[Broadphase::PairKeySecond(key)];
+        // トリガーは重なったかどうかだけ分かればよい
+        bool isTrigger = colliderA->IsTrigger() || colliderB->IsTrigger();
+        Contact contact{};
+        bool isHit = false;
+        switch (batchResults_[i]) {
+        case PrimitiveBatch::Result::kMiss:
+            break;
+        case PrimitiveBatch::Result::kHit:
+            isHit = true;
+            if (!isTrigger) {
+                contact = batchContacts_[i];
+            }
+            break;
+        default:
+            isHit = isTrigger ?
+                Narrowphase::Overlap(*colliderA, *colliderB, scratch_) :
+                Narrowphase::Collide(*colliderA, *colliderB, scratch_, contact);
+            break;
+        }
+        if (!contactCache_.IsReused(i)) {
+            contactCache_.Store(i, key, *colliderA, *colliderB, isHit, contact);
+        }
+        if (!isHit) {
+            continue;
+        }
+        collisionPairs_.push_back({ colliderA, colliderB, contact, isTrigger });
+        currentPairs_.emplace_back(key);
+    }
+}
+
+void CollisionWorld::DispatchEvents() {
+    // 外されたコライダーと接触していた相手に先に伝える。コールバック中のUnregisterで増えた分は次のStepで伝える
+    if (!pendingExitIDs_.empty()) {
+        std::vector<std::uint32_t> exitIDs;
+        exitIDs.swap(pendingExitIDs_);
+        for (std::uint32_t id : exitIDs) {
+            Collider* collider = colliders_[id];
+            if (collider && collider->GetExitCollBack()) { collider->GetExitCollBack()(); }
+        }
+    }
+
+    // 両方ともキー順なので併合しながら分類する
+    events_.clear();
+    size_t current = 0, previous = 0;
+    while (current < currentPairs_.size() || previous < previousPairs_.size()) {
+        if (previous >= previousPairs_.size() || (current < currentPairs_.size() && currentPairs_[current] < previousPairs_[previous])) {
+            events_.push_back({ currentPairs_[current++], EventType::kEnter });
+        }
+        else if (current >= currentPairs_.size() || previousPairs_[previous] < currentPairs_[current]) {
+            events_.push_back({ previousPairs_[previous++], EventType::kExit });
+        }
+        else {
+            events_.push_back({ currentPairs_[current++], EventType::kStay });
+            ++previous;
+        }
+    }
+    previousPairs_.swap(currentPairs_);
+
+    // コールバック中にコライダーが削除されることがあるので毎回引き直す
+    for (const auto& event : events_) {
+        for (std::uint32_t id : { Broadphase::PairKeyFirst(event.key), Broadphase::PairKeySecond(event.key) }) {
+            Collider* collider = colliders_[id];
+            if (!collider) { continue; }
+            const Collider::CollBack& collBack =
+                event.type == EventType::kEnter ? collider->GetEnterCollBack() :
+                event.type == EventType::kStay ? collider->GetStayCollBack() :
+                collider->GetExitCollBack();
+            if (collBack) { collBack(); }
+        }
+    }
+}
+
+void CollisionWorld::PublishSnapshot() {
+    // どの読み手も引退後のエポックに進んでいれば、その写しを見ている者はいない
+    std::uint64_t oldestPinned = epochReclamation_.GetOldestPinnedEpoch();
+    size_t retainedCount = 0;
+    for (auto& retired : retiredSnapshots_) {
+        if (retired.epoch > oldestPinned) {
+            retiredSnapshots_[retainedCount++] = std::move(retired);
+            continue;
+        }
+        // 共有の形を早く手放す
+        retired.snapshot->dynamicLayer_.Clear();
+        retired.snapshot->staticLayer_.reset();
+        freeSnapshots_.emplace_back(std::move(retired.snapshot));
+    }
+    retiredSnapshots_.resize(retainedCount);
+
+    std::unique_ptr<CollisionSnapshot> snapshot;
+    if (!freeSnapshots_.empty()) {
+        snapshot = std::move(freeSnapshots_.back());
+        freeSnapshots_.pop_back();
+    }
+    else {
+        snapshot = std::make_unique<CollisionSnapshot>();
+    }
+    snapshot->epoch_ = ++stepCount_;
+    auto& dynamicLayer = snapshot->dynamicLayer_;
+    dynamicLayer.Clear();
+    for (std::uint32_t id = 0; id < proxyStates_.size(); ++id) {
+        if (proxyStates_[id] == ProxyState::kDynamic) {
+            dynamicLayer.Add(*colliders_[id]);
+        }
+    }
+    dynamicLayer.Build(BVH::SplitMethod::kMedian);
+    if (isStaticLayerDirty_) {
+        auto layer = std::make_shared<CollisionSnapshot::Layer>();
+        for (std::uint32_t id = 0; id < proxyStates_.size(); ++id) {
+            if (proxyStates_[id] == ProxyState::kStatic) {
+                layer->Add(*colliders_[id]);
+            }
+        }
+        layer->Build(BVH::SplitMethod::kSAH);
+        staticLayer_ = std::move(layer);
+        isStaticLayerDirty_ = false;
+    }
+    snapshot->staticLayer_ = staticLayer_;
+
+    // 差し替えてからエポックを進める。進めた後にPinした読み手は新しい写ししか見ない
+    snapshot_.store(snapshot.get());
+    if (currentSnapshot_) {
+        retiredSnapshots_.push_back({ std::move(currentSnapshot_), epochReclamation_.Advance() });
+    }
+    currentSnapshot_ = std::move(snapshot);
+}
+
+bool CollisionWorld::IsColliderActive(const Collider& collider) const {
+    return collider.IsActive() && collider.GetGameObject().IsActive();
+}
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "../Math/MathUtils.hpp"
+#include "../AABB.hpp"
+#include "Broadphase.hpp"
+#include "CollisionSnapshot.hpp"
+#include "ContactCache.hpp"
+#include "EpochReclamation.hpp"
+#include "Narrowphase.hpp"
+#include "PairSet.hpp"
+#include "PrimitiveBatch.hpp"
+#include "StaticTree.hpp"
+
+class Collider;
+class BroadphaseRecording;
+struct RaycastHit;
+
+struct CollisionPair {
+    Collider* colliderA;
+    Collider* colliderB;
+    Contact contact;    // isTriggerなら求めない
+    bool isTrigger;
+};
+
+class CollisionWorld {
+public:
+    // 各フェーズの処理時間（ミリ秒）
+    struct Profile {
+        float updateAABB;
+        float broadphase;
+        float narrowphase;
+        float dispatch;
+        float snapshot;
+        std::uint32_t candidatePairCount;
+        // 中域判定で落としたペア
+        std::uint32_t culledPairCount;
+        // 閉じた式でまとめて解いたペア
+        std::uint32_t batchedPairCount;
+        // 前回の結果を使い回したペア
+        std::uint32_t cachedPairCount;
+        std::uint32_t contactCount;
+        std::uint32_t staticCount;
+        // 読み手が残っていてまだ解放できない写し
+        std::uint32_t retiredSnapshotCount;
+        size_t broadphaseMemory;
+    };
+
+    explicit CollisionWorld(BroadphaseType broadphaseType = BroadphaseType::kSweepAndPrune);
+
+    void Register(Collider* collider);
+    // 接触していた相手には次のStepの最初に離れたときのコールバックを呼ぶ。外すコライダー自身には呼ばない
+    void Unregister(Collider* collider);
+
+    void Step();
+
+    // directionは正規化済み。最も近いヒットを返す
+    bool Raycast(const Vector3& origin, const Vector3& direction, float maxDistance, RaycastHit& hit) const;
+    // AABBがboundsと重なるアクティブなコライダーを追加する
+    void Query(const AABB& bounds, std::vector<Collider*>& colliders) const;
+    // idsを作業領域として使い回す。毎フレーム何度も問い合わせる側が確保を避けるのに使う
+    void Query(const AABB& bounds, std::vector<Collider*>& colliders, std::vector<std::uint32_t>& ids) const;
+    // 直前のStepの終わりに公開した写しを取る。どのスレッドからでも呼べ、Stepやコライダーの変更と並行に問い合わせられる
+    // RaycastとQueryはStepと同じスレッドからのみ
+    // 読み手の枠が全て使用中なら待たずに空のハンドルを返す
+    CollisionSnapshotHandle AcquireSnapshot() const;
+
+    Collider* GetCollider(std::uint32_t id) const { return colliders_[id]; }
+    const std::vector<CollisionPair>& GetCollisionPairs() const { return collisionPairs_; }
+    const Profile& GetProfile() const { return profile_; }
+    const Broadphase& GetBroadphase() const { return *broadphase_; }
+    const StaticTree& GetStaticTree() const { return staticTree_; }
+
+    // レベルの読み込み後などに呼ぶと、保留中の静的コライダーをすぐ木に入れる
+    void RebuildStaticTree() { staticTree_.Rebuild(); }
+
+    void SetContactCacheSettings(const ContactCache::Settings& settings) { contactCache_.SetSettings(settings); }
+    const ContactCache::Settings& GetContactCacheSettings() const { return contactCache_.GetSettings(); }
+
+    // 設定中は広域判定への操作を記録する。nullptrで解除
+    void SetRecording(BroadphaseRecording* recording) { recording_ = recording; }
+
+private:
+    // コライダーがどちらの広域判定に入っているか
+    enum class ProxyState : std::uint8_t {
+        kNone,
+        kDynamic,
+        kStatic
+    };
+    enum class EventType {
+        kEnter,
+        kStay,
+        kExit
+    };
+    struct Event {
+        std::uint64_t key;
+        EventType type;
+    };
+
+    void InsertProxy(std::uint32_t id, const AABB& aabb);
+    void RemoveProxy(std::uint32_t id);
+    void MoveProxy(std::uint32_t id, const AABB& aabb);
+
+    void UpdateAABBs();
+    void FindCandidatePairs();
+    void Narrowphase();
+    void DispatchEvents();
+    // 写しを作って差し替え、読み手のいなくなった古い写しを回収する
+    void PublishSnapshot();
+
+    bool IsColliderActive(const Collider& collider) const;
+
+    // IDで引く。解放されたスロットはnullptr
+    std::vector<Collider*> colliders_;
+    std::vector<std::uint32_t> freeIDs_;
+
+    // 動くコライダー
+    std::unique_ptr<Broadphase> broadphase_;
+    // 動かないコライダー
+    StaticTree staticTree_;
+    std::vector<ProxyState> proxyStates_;
+    BroadphaseRecording* recording_;
+    // 候補ペアの重複除去と並べ替え
+    PairSet pairSet_;
+    std::vector<std::uint64_t> candidatePairs_;
+    // 接触中のペア（キー順）
+    std::vector<std::uint64_t> currentPairs_;
+    std::vector<std::uint64_t> previousPairs_;
+    std::vector<CollisionPair> collisionPairs_;
+    std::vector<Event> events_;
+    // Unregisterで外したコライダーと接触していた相手のID。次のDispatchEventsで離れたことを伝える
+    std::vector<std::uint32_t> pendingExitIDs_;
+    // RaycastとidsをとらないQueryの作業領域。どちらもStepと同じスレッドからだけ呼ぶので共有できる
+    mutable std::vector<std::uint32_t> queryIDs_;
+    Narrowphase::Scratch scratch_;
+    ContactCache contactCache_;
+    PrimitiveBatch primitiveBatch_;
+    // candidatePairs_と同じ並び
+    std::vector<PrimitiveBatch::Result> batchResults_;
+    std::vector<Contact> batchContacts_;
+
+    // 読み手はsnapshot_を読む。持ち主はcurrentSnapshot_
+    EpochReclamation epochReclamation_;
+    std::atomic<const CollisionSnapshot*> snapshot_;
+    std::unique_ptr<CollisionSnapshot> currentSnapshot_;
+    struct RetiredSnapshot {
+        std::unique_ptr<CollisionSnapshot> snapshot;
+        std::uint64_t epoch;    // 全ての読み手がこのエポックに達したら解放できる
+    };
+    std::vector<RetiredSnapshot> retiredSnapshots_;
+    // 回収した写し。配列の容量ごと使い回す
+    std::vector<std::unique_ptr<CollisionSnapshot>> freeSnapshots_;
+    // 静的な層は静的なコライダーが変わったときだけ作り直す
+    std::shared_ptr<const CollisionSnapshot::Layer> staticLayer_;
+    bool isStaticLayerDirty_;
+    std::uint64_t stepCount_;
+
+    Profile profile_;
+};
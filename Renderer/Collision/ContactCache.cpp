@@ -0,0 +1,108 @@
+#include "ContactCache.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+#include "../Collider.hpp"
+#include "../Transform.hpp"
+#include "Broadphase.hpp"
+
+void ContactCache::Begin(std::uint32_t pairCount) {
+    previousEntries_.swap(entries_);
+    entries_.resize(pairCount);
+    cursor_ = 0;
+    reusedCount_ = 0;
+    ++frame_;
+}
+
+bool ContactCache::Reuse(std::uint32_t index, std::uint64_t key, const Collider& colliderA, const Collider& colliderB, bool& isHit, Contact& contact) {
+    Entry& entry = entries_[index];
+    entry.age = 0;
+    if (!settings_.isEnabled) {
+        return false;
+    }
+    // 前フレームの記録もキー順なので、先頭から一度だけ進めればよい
+    while (cursor_ < previousEntries_.size() && previousEntries_[cursor_].key < key) {
+        ++cursor_;
+    }
+    if (cursor_ >= previousEntries_.size() || previousEntries_[cursor_].key != key) {
+        return false;
+    }
+    // refreshInterval回に一度は解き直す。ペアごとに周期をずらして同じフレームに集めない
+    std::uint32_t phase = static_cast<std::uint32_t>((key * 0x9E3779B97F4A7C15ull) >> 32);
+    if (settings_.refreshInterval <= 1 || (frame_ + phase) % settings_.refreshInterval == 0) {
+        return false;
+    }
+    const Entry& previous = previousEntries_[cursor_];
+    // 形や大きさ、トリガーかどうかが変わっていれば相対姿勢だけでは決まらない
+    bool isTrigger = colliderA.IsTrigger() || colliderB.IsTrigger();
+    if (isTrigger || previous.isTrigger ||
+        previous.shapeRevisionA != colliderA.GetShapeRevision() || previous.shapeRevisionB != colliderB.GetShapeRevision()) {
+        return false;
+    }
+
+    // 解いた時の相対姿勢のままAに付いて来た場合のBと、実際のBを比べる
+    const Matrix4x4& worldA = colliderA.GetTransform().GetWorldMatrix();
+    const Matrix4x4& worldB = colliderB.GetTransform().GetWorldMatrix();
+    Matrix4x4 predicted = previous.relative * worldA;
+    if ((predicted.GetTranslate() - worldB.GetTranslate()).LengthSquare() > settings_.maxTranslation * settings_.maxTranslation) {
+        return false;
+    }
+    const Vector3 predictedAxes[3] = { predicted.GetXAxis(), predicted.GetYAxis(), predicted.GetZAxis() };
+    const Vector3 axes[3] = { worldB.GetXAxis(), worldB.GetYAxis(), worldB.GetZAxis() };
+    for (size_t i = 0; i < 3; ++i) {
+        float limit = settings_.maxRotation * settings_.maxRotation * axes[i].LengthSquare();
+        if ((predictedAxes[i] - axes[i]).LengthSquare() > limit) {
+            return false;
+        }
+    }
+
+    entry = previous;
+    ++entry.age;
+    ++reusedCount_;
+    isHit = entry.isHit;
+    if (isHit) {
+        // 点はそれぞれの今の姿勢へ。深さは動いた分だけ法線方向に測り直す
+        contact.normal = worldA.ApplyRotation(entry.normal).Normalized();
+        contact.pointA = entry.pointA * worldA;
+        contact.pointB = entry.pointB * worldB;
+        contact.depth = std::max(Dot(contact.pointA - contact.pointB, contact.normal), 0.0f);
+    }
+    return true;
+}
+
+void ContactCache::Store(std::uint32_t index, std::uint64_t key, const Collider& colliderA, const Collider& colliderB, bool isHit, const Contact& contact) {
+    assert(!IsReused(index));
+    const Matrix4x4& worldA = colliderA.GetTransform().GetWorldMatrix();
+    const Matrix4x4& worldB = colliderB.GetTransform().GetWorldMatrix();
+    Matrix4x4 inverseA = worldA.Inverse();
+
+    Entry& entry = entries_[index];
+    entry.key = key;
+    entry.relative = worldB * inverseA;
+    entry.shapeRevisionA = colliderA.GetShapeRevision();
+    entry.shapeRevisionB = colliderB.GetShapeRevision();
+    entry.age = 0;
+    entry.isHit = isHit;
+    entry.isTrigger = colliderA.IsTrigger() || colliderB.IsTrigger();
+    if (isHit) {
+        entry.normal = inverseA.ApplyRotation(contact.normal);
+        entry.pointA = contact.pointA * inverseA;
+        entry.pointB = contact.pointB * worldB.Inverse();
+    }
+}
+
+void ContactCache::RemoveID(std::uint32_t id) {
+    // 次のBeginで前フレームの記録になる側。キー順は崩さない
+    auto end = std::remove_if(entries_.begin(), entries_.end(), [id](const Entry& entry) {
+        return Broadphase::PairKeyFirst(entry.key) == id || Broadphase::PairKeySecond(entry.key) == id;
+        });
+    entries_.erase(end, entries_.end());
+}
+
+void ContactCache::Clear() {
+    previousEntries_.clear();
+    entries_.clear();
+    cursor_ = 0;
+    reusedCount_ = 0;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "../Math/MathUtils.hpp"
+#include "Narrowphase.hpp"
+
+class Collider;
+
+// ペアごとに前回の狭域判定の結果を覚えておく
+// 解いた時点からの相対的な動きが閾値以下なら、結果を今の姿勢へ移して使い回す
+// ずれが溜まらないよう、refreshIntervalフレームに一度は必ず解き直す
+// 形の版が変わったペアとトリガーを含むペアは使い回さない
+class ContactCache {
+public:
+    struct Settings {
+        bool isEnabled = true;
+        // 解いた時点の相対姿勢から予測したBと実際のBの差（ワールド）
+        float maxTranslation = 0.005f;
+        // 軸の向きの差（ラジアン相当）
+        float maxRotation = 0.01f;
+        std::uint32_t refreshInterval = 8;
+    };
+
+    // ペアの数を決めて前フレームの記録と入れ替える
+    void Begin(std::uint32_t pairCount);
+    // キー順に呼ぶ。使い回せればisHitとcontactを書いてtrue
+    bool Reuse(std::uint32_t index, std::uint64_t key, const Collider& colliderA, const Collider& colliderB, bool& isHit, Contact& contact);
+    // 解き直した結果を記録する
+    void Store(std::uint32_t index, std::uint64_t key, const Collider& colliderA, const Collider& colliderB, bool isHit, const Contact& contact);
+    // idを含む記録を捨てる。IDが再利用されても古い結果を使わない
+    void RemoveID(std::uint32_t id);
+    void Clear();
+
+    bool IsReused(std::uint32_t index) const { return entries_[index].age > 0; }
+    std::uint32_t GetReusedCount() const { return reusedCount_; }
+
+    void SetSettings(const Settings& settings) { settings_ = settings; }
+    const Settings& GetSettings() const { return settings_; }
+
+private:
+    struct Entry {
+        std::uint64_t key;
+        // Aから見たBの姿勢（worldB * worldA^-1）
+        Matrix4x4 relative;
+        // 法線はAのローカル、点はそれぞれのローカル
+        Vector3 normal;
+        Vector3 pointA;
+        Vector3 pointB;
+        // 解いた時点の形の版
+        std::uint32_t shapeRevisionA;
+        std::uint32_t shapeRevisionB;
+        // 解き直してから使い回した回数。0なら今回解いた
+        std::uint32_t age;
+        bool isHit;
+        // トリガーとして重なりだけ調べた。接触は空
+        bool isTrigger;
+    };
+
+    Settings settings_;
+    // 前フレームと今フレーム（どちらもキー順）
+    std::vector<Entry> previousEntries_;
+    std::vector<Entry> entries_;
+    size_t cursor_ = 0;
+    std::uint32_t frame_ = 0;
+    std::uint32_t reusedCount_ = 0;
+};
@@ -0,0 +1,313 @@
+#include "ConvexDecomposition.hpp"
+
+#include <algorithm>
+
+#include "../AABB.hpp"
+
+namespace {
+    // 軸ごとに試す割る位置の数
+    constexpr std::uint32_t kSplitCandidates = 8;
+    // 凹みを測るときは頂点数を絞らない（絞ると体積が小さく出て割り方がぶれる）
+    constexpr std::uint32_t kUnlimitedVertices = ~0u;
+    // 凹みが同程度なら半々に近い割り方を選ばせる。端を薄く削るだけの割り方を避ける
+    constexpr float kBalanceWeight = 0.2f;
+    // 短い軸で割ると薄い板が穴をまたいで残りやすいので、長い軸を選ばせる
+    constexpr float kShortAxisPenalty = 0.1f;
+
+    enum Voxel : std::uint8_t {
+        kEmpty,     // 中身か、閉じていなければ穴
+        kSurface,
+        kExterior
+    };
+
+    struct Grid {
+        std::uint32_t Index(std::uint32_t x, std::uint32_t y, std::uint32_t z) const { return (z * size[1] + y) * size[0] + x; }
+        std::uint32_t Coordinate(std::uint32_t index, size_t axis) const {
+            switch (axis) {
+            case 0: return index % size[0];
+            case 1: return index / size[0] % size[1];
+            default: return index / (size[0] * size[1]);
+            }
+        }
+
+        std::vector<std::uint8_t> voxels;
+        std::uint32_t size[3];
+        Vector3 origin;
+        float voxelSize;
+    };
+
+    struct Part {
+        std::vector<std::uint32_t> voxels;  // 番号の昇順
+        float concavity;                    // ボクセルの数を単位とした体積
+    };
+
+    // 三角形と箱の分離軸判定（Akenine-Moller）。頂点は箱の中心からの相対位置
+    bool TriangleOverlapsBox(const Vector3 (&vertices)[3], const Vector3& halfSize) {
+        Vector3 edges[3] = { vertices[1] - vertices[0], vertices[2] - vertices[1], vertices[0] - vertices[2] };
+        auto isSeparated = [&](const Vector3& axis) {
+            float p0 = Vector3::Dot(vertices[0], axis);
+            float p1 = Vector3::Dot(vertices[1], axis);
+            float p2 = Vector3::Dot(vertices[2], axis);
+            float radius = halfSize.x * std::abs(axis.x) + halfSize.y * std::abs(axis.y) + halfSize.z * std::abs(axis.z);
+            return std::min({ p0, p1, p2 }) > radius || std::max({ p0, p1, p2 }) < -radius;
+        };
+        for (size_t i = 0; i < 3; ++i) {
+            Vector3 boxAxis = Vector3::zero;
+            boxAxis[i] = 1.0f;
+            if (isSeparated(boxAxis)) {
+                return false;
+            }
+            for (const auto& edge : edges) {
+                if (isSeparated(Vector3::Cross(boxAxis, edge))) {
+                    return false;
+                }
+            }
+        }
+        return !isSeparated(Vector3::Cross(edges[0], edges[1]));
+    }
+
+    void Voxelize(const std::vector<Vector3>& vertices, const std::vector<std::uint32_t>& indices, std::uint32_t resolution, Grid& grid) {
+        AABB bounds;
+        for (const auto& vertex : vertices) {
+            bounds.Include(vertex);
+        }
+        Vector3 extent = bounds.Extent();
+        grid.voxelSize = std::max({ extent.x, extent.y, extent.z }) / static_cast<float>(std::max(resolution, 1u));
+        if (grid.voxelSize <= 0.0f) {
+            grid.voxelSize = 1.0f;
+        }
+        // 外側を塗るために周りを1つずつ空ける。軸に沿った面がボクセルの中心を通るように半分ずらす
+        grid.origin = bounds.min - Vector3::one * (grid.voxelSize * 1.5f);
+        for (size_t i = 0; i < 3; ++i) {
+            grid.size[i] = static_cast<std::uint32_t>(extent[i] / grid.voxelSize) + 4;
+        }
+        grid.voxels.assign(static_cast<size_t>(grid.size[0]) * grid.size[1] * grid.size[2], kEmpty);
+
+        // 表面
+        Vector3 halfSize = Vector3::one * (grid.voxelSize * 0.5f);
+        for (size_t t = 0; t + 2 < indices.size(); t += 3) {
+            Vector3 triangle[3] = { vertices[indices[t]], vertices[indices[t + 1]], vertices[indices[t + 2]] };
+            AABB triangleBounds(triangle[0], triangle[1], triangle[2]);
+            std::uint32_t first[3], last[3];
+            for (size_t i = 0; i < 3; ++i) {
+                // 境界に乗った頂点のために1つ広く見る
+                float min = (triangleBounds.min[i] - grid.origin[i]) / grid.voxelSize;
+                float max = (triangleBounds.max[i] - grid.origin[i]) / grid.voxelSize;
+                first[i] = static_cast<std::uint32_t>(std::max(min - 1.0f, 0.0f));
+                last[i] = std::min(static_cast<std::uint32_t>(std::max(max + 1.0f, 0.0f)), grid.size[i] - 1);
+            }
+            for (std::uint32_t z = first[2]; z <= last[2]; ++z) {
+                for (std::uint32_t y = first[1]; y <= last[1]; ++y) {
+                    for (std::uint32_t x = first[0]; x <= last[0]; ++x) {
+                        std::uint8_t& voxel = grid.voxels[grid.Index(x, y, z)];
+                        if (voxel == kSurface) {
+                            continue;
+                        }
+                        Vector3 center = grid.origin + Vector3(static_cast<float>(x) + 0.5f, static_cast<float>(y) + 0.5f, static_cast<float>(z) + 0.5f) * grid.voxelSize;
+                        Vector3 relative[3] = { triangle[0] - center, triangle[1] - center, triangle[2] - center };
+                        if (TriangleOverlapsBox(relative, halfSize)) {
+                            voxel = kSurface;
+                        }
+                    }
+                }
+            }
+        }
+
+        // 角から外側を塗り、残った空きを中身とする
+        std::vector<std::uint32_t> stack{ 0 };
+        grid.voxels[0] = kExterior;
+        while (!stack.empty()) {
+            std::uint32_t index = stack.back();
+            stack.pop_back();
+            std::uint32_t coordinate[3] = { grid.Coordinate(index, 0), grid.Coordinate(index, 1), grid.Coordinate(index, 2) };
+            std::uint32_t strides[3] = { 1, grid.size[0], grid.size[0] * grid.size[1] };
+            for (size_t axis = 0; axis < 3; ++axis) {
+                if (coordinate[axis] > 0 && grid.voxels[index - strides[axis]] == kEmpty) {
+                    grid.voxels[index - strides[axis]] = kExterior;
+                    stack.emplace_back(index - strides[axis]);
+                }
+                if (coordinate[axis] + 1 < grid.size[axis] && grid.voxels[index + strides[axis]] == kEmpty) {
+                    grid.voxels[index + strides[axis]] = kExterior;
+                    stack.emplace_back(index + strides[axis]);
+                }
+            }
+        }
+    }
+
+    // predicateを満たすボクセルを包む凸包をボクセル単位で作る
+    // X方向の列の両端のボクセルの外側の角だけで列全体の凸包になる
+    template<class Predicate>
+    std::uint32_t BuildHull(const Grid& grid, const std::vector<std::uint32_t>& voxels, Predicate predicate, std::uint32_t maxVertices, std::vector<Vector3>& points, ConvexHull& hull) {
+        points.clear();
+        std::uint32_t count = 0;
+        std::uint32_t currentRow = ~0u;
+        std::uint32_t minX = 0, maxX = 0;
+        auto flush = [&]() {
+            if (currentRow == ~0u) {
+                return;
+            }
+            float y = static_cast<float>(currentRow % grid.size[1]);
+            float z = static_cast<float>(currentRow / grid.size[1]);
+            for (std::uint32_t i = 0; i < 4; ++i) {
+                float cornerY = y + static_cast<float>(i & 1);
+                float cornerZ = z + static_cast<float>(i >> 1);
+                points.emplace_back(static_cast<float>(minX), cornerY, cornerZ);
+                points.emplace_back(static_cast<float>(maxX + 1), cornerY, cornerZ);
+            }
+        };
+        for (std::uint32_t index : voxels) {
+            if (!predicate(index)) {
+                continue;
+            }
+            ++count;
+            std::uint32_t row = index / grid.size[0];
+            std::uint32_t x = index % grid.size[0];
+            if (row != currentRow) {
+                flush();
+                currentRow = row;
+                minX = x;
+            }
+            maxX = x;
+        }
+        flush();
+        hull.Build(points, maxVertices);
+        return count;
+    }
+
+    float Concavity(const ConvexHull& hull, std::uint32_t count) {
+        return std::max(hull.Volume() - static_cast<float>(count), 0.0f);
+    }
+
+    void EvaluatePart(const Grid& grid, std::vector<Vector3>& points, ConvexHull& hull, Part& part) {
+        std::uint32_t count = BuildHull(grid, part.voxels, [](std::uint32_t) { return true; }, kUnlimitedVertices, points, hull);
+        part.concavity = Concavity(hull, count);
+    }
+
+    // 両側の凹みの和が最も小さくなる軸に沿った平面で割る
+    bool SplitPart(const Grid& grid, const Part& part, std::vector<Vector3>& points, Part& left, Part& right) {
+        std::uint32_t min[3] = { ~0u, ~0u, ~0u };
+        std::uint32_t max[3] = {};
+        for (std::uint32_t index : part.voxels) {
+            for (size_t axis = 0; axis < 3; ++axis) {
+                std::uint32_t coordinate = grid.Coordinate(index, axis);
+                min[axis] = std::min(min[axis], coordinate);
+                max[axis] = std::max(max[axis], coordinate);
+            }
+        }
+
+        std::uint32_t maxLength = std::max({ max[0] - min[0], max[1] - min[1], max[2] - min[2] }) + 1;
+        ConvexHull hull;
+        float bestCost = Math::positiveInfinity;
+        size_t bestAxis = 0;
+        std::uint32_t bestPlane = 0;
+        for (size_t axis = 0; axis < 3; ++axis) {
+            std::uint32_t length = max[axis] - min[axis] + 1;
+            std::uint32_t previousPlane = min[axis];
+            for (std::uint32_t i = 1; i <= kSplitCandidates; ++i) {
+                std::uint32_t plane = min[axis] + length * i / (kSplitCandidates + 1);
+                if (plane <= previousPlane) {
+                    continue;
+                }
+                previousPlane = plane;
+                auto isLeft = [&](std::uint32_t index) { return grid.Coordinate(index, axis) < plane; };
+                auto isRight = [&](std::uint32_t index) { return grid.Coordinate(index, axis) >= plane; };
+                std::uint32_t leftCount = BuildHull(grid, part.voxels, isLeft, kUnlimitedVertices, points, hull);
+                float cost = Concavity(hull, leftCount);
+                std::uint32_t rightCount = BuildHull(grid, part.voxels, isRight, kUnlimitedVertices, points, hull);
+                cost += Concavity(hull, rightCount);
+                float balance = std::abs(static_cast<float>(leftCount) - static_cast<float>(rightCount)) / static_cast<float>(part.voxels.size());
+                cost += kBalanceWeight * part.concavity * balance;
+                cost *= 1.0f + kShortAxisPenalty * (1.0f - static_cast<float>(length) / static_cast<float>(maxLength));
+                if (leftCount > 0 && rightCount > 0 && cost < bestCost) {
+                    bestCost = cost;
+                    bestAxis = axis;
+                    bestPlane = plane;
+                }
+            }
+        }
+        if (bestCost == Math::positiveInfinity) {
+            return false;
+        }
+        left.voxels.clear();
+        right.voxels.clear();
+        for (std::uint32_t index : part.voxels) {
+            (grid.Coordinate(index, bestAxis) < bestPlane ? left : right).voxels.emplace_back(index);
+        }
+        return true;
+    }
+}
+
+namespace ConvexDecomposition {
+
+    void Decompose(const std::vector<Vector3>& vertices, const std::vector<std::uint32_t>& indices, const Settings& settings, std::vector<ConvexHull>& hulls) {
+        hulls.clear();
+        if (vertices.empty() || indices.size() < 3) {
+            return;
+        }
+        Grid grid;
+        Voxelize(vertices, indices, settings.resolution, grid);
+
+        std::vector<Part> parts(1);
+        for (std::uint32_t i = 0; i < grid.voxels.size(); ++i) {
+            if (grid.voxels[i] != kExterior) {
+                parts[0].voxels.emplace_back(i);
+            }
+        }
+        std::vector<Vector3> points;
+        ConvexHull hull;
+        EvaluatePart(grid, points, hull, parts[0]);
+        float maxConcavity = settings.maxConcavity * static_cast<float>(parts[0].voxels.size());
+
+        // 最も凹んだ部分から割る
+        while (parts.size() < settings.maxHulls) {
+            auto worst = std::max_element(parts.begin(), parts.end(), [](const Part& a, const Part& b) { return a.concavity < b.concavity; });
+            if (worst->concavity <= maxConcavity) {
+                break;
+            }
+            Part left, right;
+            if (!SplitPart(grid, *worst, points, left, right)) {
+                // 1つのボクセルの列などでもう割れない
+                worst->concavity = 0.0f;
+                continue;
+            }
+            EvaluatePart(grid, points, hull, left);
+            EvaluatePart(grid, points, hull, right);
+            *worst = std::move(left);
+            parts.emplace_back(std::move(right));
+        }
+
+        // 最後の凸包はボクセルの中心と、そのボクセルに入るメッシュの頂点から作る
+        // 角で包むより面に沿い、ずれはボクセル半分ほどに収まる
+        std::vector<std::uint32_t> owners(grid.voxels.size(), ~0u);
+        for (std::uint32_t i = 0; i < parts.size(); ++i) {
+            for (std::uint32_t index : parts[i].voxels) {
+                owners[index] = i;
+            }
+        }
+        std::vector<std::vector<Vector3>> partVertices(parts.size());
+        for (const auto& vertex : vertices) {
+            std::uint32_t coordinate[3];
+            for (size_t axis = 0; axis < 3; ++axis) {
+                float voxel = (vertex[axis] - grid.origin[axis]) / grid.voxelSize;
+                coordinate[axis] = std::min(static_cast<std::uint32_t>(std::max(voxel, 0.0f)), grid.size[axis] - 1);
+            }
+            std::uint32_t owner = owners[grid.Index(coordinate[0], coordinate[1], coordinate[2])];
+            if (owner != ~0u) {
+                partVertices[owner].emplace_back(vertex);
+            }
+        }
+        hulls.resize(parts.size());
+        for (size_t i = 0; i < parts.size(); ++i) {
+            points = std::move(partVertices[i]);
+            for (std::uint32_t index : parts[i].voxels) {
+                Vector3 center(
+                    static_cast<float>(grid.Coordinate(index, 0)) + 0.5f,
+                    static_cast<float>(grid.Coordinate(index, 1)) + 0.5f,
+                    static_cast<float>(grid.Coordinate(index, 2)) + 0.5f);
+                points.emplace_back(grid.origin + center * grid.voxelSize);
+            }
+            hulls[i].Build(points, settings.maxHullVertices);
+        }
+    }
+
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "../Math/MathUtils.hpp"
+#include "ConvexHull.hpp"
+
+// 凹メッシュの近似凸分解（V-HACDに倣ったボクセルの階層分割）
+// メッシュを中身ごとボクセル化し、凸包との体積差（凹み）が最も大きい部分を
+// 軸に沿った平面で2つに割ることを繰り返す。割る位置は両側の凹みの和が最小になる所
+// 凸包は元の面からボクセル半分ほどずれる（頂点数を絞るとその分も削れる）
+namespace ConvexDecomposition {
+
+    struct Settings {
+        std::uint32_t resolution = 32;      // 最も長い辺のボクセル数
+        std::uint32_t maxHulls = 16;
+        std::uint32_t maxHullVertices = 32;
+        float maxConcavity = 0.02f;         // 凹みの体積がメッシュの体積に対してこれ以下なら割らない
+    };
+
+    // indicesは3つずつで1枚。閉じていないメッシュは表面のボクセルだけで分ける
+    // 凸包はメッシュと同じ空間でhullsに書く
+    void Decompose(const std::vector<Vector3>& vertices, const std::vector<std::uint32_t>& indices, const Settings& settings, std::vector<ConvexHull>& hulls);
+
+}
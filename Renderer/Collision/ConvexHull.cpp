@@ -0,0 +1,245 @@
+#include "ConvexHull.hpp"
+
+#include <algorithm>
+
+namespace {
+    // 平面上とみなす距離（点群の大きさに対する比）
+    constexpr float kRelativeEpsilon = 1.0e-5f;
+
+    struct Face {
+        std::uint32_t vertices[3];
+        Vector3 normal;
+        float offset;
+        std::vector<std::uint32_t> outside;  // この面より外側にある点
+        bool isAlive;
+    };
+
+    Face MakeFace(const std::vector<Vector3>& points, std::uint32_t a, std::uint32_t b, std::uint32_t c) {
+        Face face{};
+        face.vertices[0] = a;
+        face.vertices[1] = b;
+        face.vertices[2] = c;
+        Vector3 normal = Vector3::Cross(points[b] - points[a], points[c] - points[a]);
+        float length = normal.Length();
+        face.normal = length > 0.0f ? normal / length : Vector3::zero;
+        face.offset = Vector3::Dot(face.normal, points[a]);
+        face.isAlive = true;
+        return face;
+    }
+
+    float Distance(const Face& face, const Vector3& point) {
+        return Vector3::Dot(face.normal, point) - face.offset;
+    }
+
+    std::uint64_t EdgeKey(std::uint32_t from, std::uint32_t to) {
+        return (static_cast<std::uint64_t>(from) << 32) | to;
+    }
+
+    // 最初に外側にある面へ振り分ける。どの面の外側でもなければ捨てる
+    void AssignPoint(const std::vector<Vector3>& points, std::uint32_t index, std::vector<Face>& faces, size_t firstFace, float epsilon) {
+        for (size_t i = firstFace; i < faces.size(); ++i) {
+            if (Distance(faces[i], points[index]) > epsilon) {
+                faces[i].outside.emplace_back(index);
+                return;
+            }
+        }
+    }
+}
+
+void ConvexHull::Build(const std::vector<Vector3>& points, std::uint32_t maxVertices) {
+    Clear();
+    if (points.empty()) {
+        return;
+    }
+    maxVertices = std::max(maxVertices, 4u);
+    std::uint32_t pointCount = static_cast<std::uint32_t>(points.size());
+
+    // 各軸の端の点
+    std::uint32_t extremes[6] = {};
+    float scale = 0.0f;
+    for (std::uint32_t i = 0; i < pointCount; ++i) {
+        for (size_t axis = 0; axis < 3; ++axis) {
+            if (points[i][axis] < points[extremes[axis * 2]][axis]) { extremes[axis * 2] = i; }
+            if (points[i][axis] > points[extremes[axis * 2 + 1]][axis]) { extremes[axis * 2 + 1] = i; }
+            scale = std::max(scale, std::abs(points[i][axis]));
+        }
+    }
+    float epsilon = kRelativeEpsilon * std::max(scale, 1.0f);
+
+    // 最初の四面体。端の点のうち最も離れた2点から広げていく
+    std::uint32_t simplex[4] = {};
+    float maxDistance = -1.0f;
+    for (size_t i = 0; i < 6; ++i) {
+        for (size_t j = i + 1; j < 6; ++j) {
+            float distance = (points[extremes[i]] - points[extremes[j]]).LengthSquare();
+            if (distance > maxDistance) {
+                maxDistance = distance;
+                simplex[0] = extremes[i];
+                simplex[1] = extremes[j];
+            }
+        }
+    }
+    if (std::sqrt(maxDistance) <= epsilon) {
+        vertices_.emplace_back(points[simplex[0]]);
+        return;
+    }
+    Vector3 lineDirection = points[simplex[1]] - points[simplex[0]];
+    maxDistance = -1.0f;
+    for (std::uint32_t i = 0; i < pointCount; ++i) {
+        float distance = Vector3::Cross(points[i] - points[simplex[0]], lineDirection).LengthSquare();
+        if (distance > maxDistance) {
+            maxDistance = distance;
+            simplex[2] = i;
+        }
+    }
+    if (std::sqrt(maxDistance / lineDirection.LengthSquare()) <= epsilon) {
+        vertices_ = { points[simplex[0]], points[simplex[1]] };
+        return;
+    }
+    Face base = MakeFace(points, simplex[0], simplex[1], simplex[2]);
+    maxDistance = -1.0f;
+    for (std::uint32_t i = 0; i < pointCount; ++i) {
+        float distance = std::abs(Distance(base, points[i]));
+        if (distance > maxDistance) {
+            maxDistance = distance;
+            simplex[3] = i;
+        }
+    }
+    if (maxDistance <= epsilon) {
+        vertices_ = { points[simplex[0]], points[simplex[1]], points[simplex[2]] };
+        return;
+    }
+
+    std::vector<Face> faces;
+    constexpr std::uint32_t kTetrahedron[4][3] = { { 0, 1, 2 }, { 0, 3, 1 }, { 1, 3, 2 }, { 2, 3, 0 } };
+    for (std::uint32_t i = 0; i < 4; ++i) {
+        std::uint32_t a = simplex[kTetrahedron[i][0]];
+        std::uint32_t b = simplex[kTetrahedron[i][1]];
+        std::uint32_t c = simplex[kTetrahedron[i][2]];
+        // 残りの頂点が内側に来る向きにする
+        std::uint32_t opposite = simplex[6 - kTetrahedron[i][0] - kTetrahedron[i][1] - kTetrahedron[i][2]];
+        Face face = MakeFace(points, a, b, c);
+        if (Distance(face, points[opposite]) > 0.0f) {
+            face = MakeFace(points, a, c, b);
+        }
+        faces.emplace_back(std::move(face));
+    }
+    for (std::uint32_t i = 0; i < pointCount; ++i) {
+        if (i != simplex[0] && i != simplex[1] && i != simplex[2] && i != simplex[3]) {
+            AssignPoint(points, i, faces, 0, epsilon);
+        }
+    }
+
+    std::vector<std::uint64_t> visibleEdges;
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> horizon;
+    std::vector<std::uint32_t> orphans;
+    std::uint32_t vertexCount = 4;
+    while (vertexCount < maxVertices) {
+        // 全ての面の外側で最も遠い点を加える
+        std::uint32_t eye = 0;
+        maxDistance = 0.0f;
+        for (const Face& face : faces) {
+            for (std::uint32_t index : face.outside) {
+                float distance = Distance(face, points[index]);
+                if (distance > maxDistance) {
+                    maxDistance = distance;
+                    eye = index;
+                }
+            }
+        }
+        if (maxDistance <= 0.0f) {
+            break;
+        }
+
+        // 見える面を消し、その縁（裏の辺が見えない面にある辺）から張り直す
+        visibleEdges.clear();
+        orphans.clear();
+        for (Face& face : faces) {
+            if (Distance(face, points[eye]) <= epsilon) {
+                continue;
+            }
+            face.isAlive = false;
+            for (size_t i = 0; i < 3; ++i) {
+                visibleEdges.emplace_back(EdgeKey(face.vertices[i], face.vertices[(i + 1) % 3]));
+            }
+            for (std::uint32_t index : face.outside) {
+                if (index != eye) {
+                    orphans.emplace_back(index);
+                }
+            }
+        }
+        std::sort(visibleEdges.begin(), visibleEdges.end());
+        horizon.clear();
+        for (std::uint64_t edge : visibleEdges) {
+            std::uint32_t from = static_cast<std::uint32_t>(edge >> 32);
+            std::uint32_t to = static_cast<std::uint32_t>(edge);
+            if (!std::binary_search(visibleEdges.begin(), visibleEdges.end(), EdgeKey(to, from))) {
+                horizon.emplace_back(from, to);
+            }
+        }
+        faces.erase(std::remove_if(faces.begin(), faces.end(), [](const Face& face) { return !face.isAlive; }), faces.end());
+        size_t firstNewFace = faces.size();
+        for (const auto& [from, to] : horizon) {
+            faces.emplace_back(MakeFace(points, from, to, eye));
+        }
+        for (std::uint32_t index : orphans) {
+            AssignPoint(points, index, faces, firstNewFace, epsilon);
+        }
+        ++vertexCount;
+    }
+
+    // 使われている点だけを詰める
+    std::vector<std::uint32_t> remap(pointCount, ~0u);
+    indices_.reserve(faces.size() * 3);
+    for (const Face& face : faces) {
+        for (std::uint32_t index : face.vertices) {
+            if (remap[index] == ~0u) {
+                remap[index] = static_cast<std::uint32_t>(vertices_.size());
+                vertices_.emplace_back(points[index]);
+            }
+            indices_.emplace_back(remap[index]);
+        }
+    }
+}
+
+void ConvexHull::Clear() {
+    vertices_.clear();
+    indices_.clear();
+}
+
+Vector3 ConvexHull::FindFurthestPoint(const Vector3& direction) const {
+    Vector3 furthest = Vector3::zero;
+    float maxDot = -Math::positiveInfinity;
+    for (const auto& vertex : vertices_) {
+        float dot = Vector3::Dot(vertex, direction);
+        if (dot > maxDot) {
+            maxDot = dot;
+            furthest = vertex;
+        }
+    }
+    return furthest;
+}
+
+bool ConvexHull::Contains(const Vector3& point, float tolerance) const {
+    if (indices_.empty()) {
+        return false;
+    }
+    for (size_t i = 0; i < indices_.size(); i += 3) {
+        const Vector3& a = vertices_[indices_[i]];
+        Vector3 normal = Vector3::Cross(vertices_[indices_[i + 1]] - a, vertices_[indices_[i + 2]] - a);
+        float length = normal.Length();
+        if (length > 0.0f && Vector3::Dot(normal, point - a) > tolerance * length) {
+            return false;
+        }
+    }
+    return true;
+}
+
+float ConvexHull::Volume() const {
+    // 原点を頂点とする四面体の符号付き体積の和
+    float volume = 0.0f;
+    for (size_t i = 0; i < indices_.size(); i += 3) {
+        volume += Vector3::Dot(vertices_[indices_[i]], Vector3::Cross(vertices_[indices_[i + 1]], vertices_[indices_[i + 2]]));
+    }
+    return volume / 6.0f;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "../Math/MathUtils.hpp"
+
+// 点群の凸包（Quickhull）
+// 面は外向きに反時計回りの三角形。サポート写像は頂点を総当たりする
+class ConvexHull {
+public:
+    static constexpr std::uint32_t kDefaultMaxVertices = 64;
+
+    // 最も外側の点から順に加えるので、maxVerticesで打ち切っても形は大きく崩れない
+    // 点が同一平面上にしかなければ面を作らず、端の点だけを頂点に残す
+    void Build(const std::vector<Vector3>& points, std::uint32_t maxVertices = kDefaultMaxVertices);
+    void Clear();
+
+    Vector3 FindFurthestPoint(const Vector3& direction) const;
+    // 全ての面の内側（tolerance以内）にあるか
+    bool Contains(const Vector3& point, float tolerance = 0.0f) const;
+    float Volume() const;
+
+    bool IsEmpty() const { return vertices_.empty(); }
+    const std::vector<Vector3>& GetVertices() const { return vertices_; }
+    // 3つずつで1枚
+    const std::vector<std::uint32_t>& GetIndices() const { return indices_; }
+
+private:
+    std::vector<Vector3> vertices_;
+    std::vector<std::uint32_t> indices_;
+};
@@ -0,0 +1,348 @@
+#include "DynamicTreeBroadphase.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+DynamicTreeBroadphase::DynamicTreeBroadphase() :
+    root_(kNullNode),
+    freeList_(kNullNode),
+    count_(0) {
+}
+
+void DynamicTreeBroadphase::Insert(std::uint32_t id, const AABB& aabb) {
+    if (id >= proxies_.size()) {
+        proxies_.resize(id + 1, { AABB(), kNullNode });
+    }
+    assert(proxies_[id].node == kNullNode);
+    std::uint32_t leaf = AllocateNode();
+    nodes_[leaf].aabb = AABB(aabb.min - Vector3(kMargin), aabb.max + Vector3(kMargin));
+    nodes_[leaf].id = id;
+    InsertLeaf(leaf);
+    proxies_[id] = { aabb, leaf };
+    ++count_;
+}
+
+void DynamicTreeBroadphase::Remove(std::uint32_t id) {
+    assert(id < proxies_.size() && proxies_[id].node != kNullNode);
+    std::uint32_t leaf = proxies_[id].node;
+    RemoveLeaf(leaf);
+    FreeNode(leaf);
+    proxies_[id].node = kNullNode;
+    --count_;
+}
+
+void DynamicTreeBroadphase::Move(std::uint32_t id, const AABB& aabb) {
+    assert(id < proxies_.size() && proxies_[id].node != kNullNode);
+    Proxy& proxy = proxies_[id];
+    Vector3 displacement = aabb.Center() - proxy.aabb.Center();
+    proxy.aabb = aabb;
+    std::uint32_t leaf = proxy.node;
+    if (nodes_[leaf].aabb.Contains(aabb)) {
+        return;
+    }
+
+    // 進行方向に余分に広げて付け替えの頻度を下げる
+    AABB fatAABB(aabb.min - Vector3(kMargin), aabb.max + Vector3(kMargin));
+    for (size_t i = 0; i < 3; ++i) {
+        float d = displacement[i] * kDisplacementMultiplier;
+        if (d < 0.0f) {
+            fatAABB.min[i] += d;
+        }
+        else {
+            fatAABB.max[i] += d;
+        }
+    }
+    RemoveLeaf(leaf);
+    nodes_[leaf].aabb = fatAABB;
+    InsertLeaf(leaf);
+}
+
+void DynamicTreeBroadphase::Clear() {
+    nodes_.clear();
+    proxies_.clear();
+    root_ = kNullNode;
+    freeList_ = kNullNode;
+    count_ = 0;
+}
+
+void DynamicTreeBroadphase::ComputePairs(std::vector<std::uint64_t>& pairs) {
+    if (root_ == kNullNode) {
+        return;
+    }
+    // 木を自分自身と同時に辿る。同じノードの組は子同士の組に分ける
+    pairStack_.clear();
+    pairStack_.emplace_back(root_, root_);
+    while (!pairStack_.empty()) {
+        auto [a, b] = pairStack_.back();
+        pairStack_.pop_back();
+        const Node& nodeA = nodes_[a];
+        const Node& nodeB = nodes_[b];
+        if (a == b) {
+            if (!nodeA.IsLeaf()) {
+                pairStack_.emplace_back(nodeA.child1, nodeA.child1);
+                pairStack_.emplace_back(nodeA.child2, nodeA.child2);
+                pairStack_.emplace_back(nodeA.child1, nodeA.child2);
+            }
+            continue;
+        }
+        if (!nodeA.aabb.Intersects(nodeB.aabb)) {
+            continue;
+        }
+        if (nodeA.IsLeaf() && nodeB.IsLeaf()) {
+            if (proxies_[nodeA.id].aabb.Intersects(proxies_[nodeB.id].aabb)) {
+                pairs.emplace_back(MakePairKey(nodeA.id, nodeB.id));
+            }
+            continue;
+        }
+        // 大きい方を分割する
+        if (nodeB.IsLeaf() || (!nodeA.IsLeaf() && nodeA.aabb.SurfaceArea() >= nodeB.aabb.SurfaceArea())) {
+            pairStack_.emplace_back(nodeA.child1, b);
+            pairStack_.emplace_back(nodeA.child2, b);
+        }
+        else {
+            pairStack_.emplace_back(a, nodeB.child1);
+            pairStack_.emplace_back(a, nodeB.child2);
+        }
+    }
+}
+
+void DynamicTreeBroadphase::Query(const AABB& bounds, std::vector<std::uint32_t>& ids) const {
+    if (root_ == kNullNode) {
+        return;
+    }
+    std::uint32_t stack[kStackSize];
+    std::uint32_t stackSize = 0;
+    stack[stackSize++] = root_;
+    while (stackSize > 0) {
+        const Node& node = nodes_[stack[--stackSize]];
+        if (!node.aabb.Intersects(bounds)) {
+            continue;
+        }
+        if (node.IsLeaf()) {
+            if (proxies_[node.id].aabb.Intersects(bounds)) {
+                ids.emplace_back(node.id);
+            }
+            continue;
+        }
+        assert(stackSize + 2 <= kStackSize);
+        stack[stackSize++] = node.child1;
+        stack[stackSize++] = node.child2;
+    }
+}
+
+void DynamicTreeBroadphase::Raycast(const Vector3& origin, const Vector3& direction, float maxDistance, std::vector<std::uint32_t>& ids) const {
+    if (root_ == kNullNode) {
+        return;
+    }
+    std::uint32_t stack[kStackSize];
+    std::uint32_t stackSize = 0;
+    stack[stackSize++] = root_;
+    while (stackSize > 0) {
+        const Node& node = nodes_[stack[--stackSize]];
+        float tMin = 0.0f, tMax = maxDistance;
+        if (!node.aabb.IntersectsRay(origin, direction, tMin, tMax)) {
+            continue;
+        }
+        if (node.IsLeaf()) {
+            tMin = 0.0f, tMax = maxDistance;
+            if (proxies_[node.id].aabb.IntersectsRay(origin, direction, tMin, tMax)) {
+                ids.emplace_back(node.id);
+            }
+            continue;
+        }
+        assert(stackSize + 2 <= kStackSize);
+        stack[stackSize++] = node.child1;
+        stack[stackSize++] = node.child2;
+    }
+}
+
+size_t DynamicTreeBroadphase::GetMemoryUsage() const {
+    return GetCapacityBytes(nodes_) + GetCapacityBytes(proxies_) + GetCapacityBytes(pairStack_);
+}
+
+std::uint32_t DynamicTreeBroadphase::AllocateNode() {
+    std::uint32_t node;
+    if (freeList_ != kNullNode) {
+        node = freeList_;
+        freeList_ = nodes_[node].parent;
+    }
+    else {
+        node = static_cast<std::uint32_t>(nodes_.size());
+        nodes_.emplace_back();
+    }
+    nodes_[node].parent = kNullNode;
+    nodes_[node].child1 = kNullNode;
+    nodes_[node].child2 = kNullNode;
+    nodes_[node].id = 0;
+    nodes_[node].height = 0;
+    return node;
+}
+
+void DynamicTreeBroadphase::FreeNode(std::uint32_t node) {
+    nodes_[node].parent = freeList_;
+    nodes_[node].height = -1;
+    freeList_ = node;
+}
+
+void DynamicTreeBroadphase::InsertLeaf(std::uint32_t leaf) {
+    if (root_ == kNullNode) {
+        root_ = leaf;
+        nodes_[leaf].parent = kNullNode;
+        return;
+    }
+
+    // 表面積の増加が最小になる兄弟を探す
+    AABB leafAABB = nodes_[leaf].aabb;
+    std::uint32_t index = root_;
+    while (!nodes_[index].IsLeaf()) {
+        const Node& node = nodes_[index];
+        AABB combined = node.aabb;
+        combined.Include(leafAABB);
+        float combinedArea = combined.SurfaceArea();
+        // ここで兄弟にする場合のコスト
+        float cost = 2.0f * combinedArea;
+        // 下に降りる場合に祖先が負担する増加分
+        float inheritanceCost = 2.0f * (combinedArea - node.aabb.SurfaceArea());
+
+        auto descendCost = [&](std::uint32_t child) {
+            AABB aabb = nodes_[child].aabb;
+            aabb.Include(leafAABB);
+            float childCost = aabb.SurfaceArea() + inheritanceCost;
+            if (!nodes_[child].IsLeaf()) {
+                childCost -= nodes_[child].aabb.SurfaceArea();
+            }
+            return childCost;
+        };
+        float cost1 = descendCost(node.child1);
+        float cost2 = descendCost(node.child2);
+        if (cost < cost1 && cost < cost2) {
+            break;
+        }
+        index = cost1 < cost2 ? node.child1 : node.child2;
+    }
+
+    std::uint32_t sibling = index;
+    std::uint32_t oldParent = nodes_[sibling].parent;
+    std::uint32_t newParent = AllocateNode();
+    nodes_[newParent].parent = oldParent;
+    nodes_[newParent].aabb = leafAABB;
+    nodes_[newParent].aabb.Include(nodes_[sibling].aabb);
+    nodes_[newParent].height = nodes_[sibling].height + 1;
+    nodes_[newParent].child1 = sibling;
+    nodes_[newParent].child2 = leaf;
+    if (oldParent != kNullNode) {
+        if (nodes_[oldParent].child1 == sibling) {
+            nodes_[oldParent].child1 = newParent;
+        }
+        else {
+            nodes_[oldParent].child2 = newParent;
+        }
+    }
+    else {
+        root_ = newParent;
+    }
+    nodes_[sibling].parent = newParent;
+    nodes_[leaf].parent = newParent;
+
+    Refit(nodes_[leaf].parent);
+}
+
+void DynamicTreeBroadphase::RemoveLeaf(std::uint32_t leaf) {
+    if (leaf == root_) {
+        root_ = kNullNode;
+        return;
+    }
+    std::uint32_t parent = nodes_[leaf].parent;
+    std::uint32_t grandParent = nodes_[parent].parent;
+    std::uint32_t sibling = nodes_[parent].child1 == leaf ? nodes_[parent].child2 : nodes_[parent].child1;
+    // 親を消して兄弟を繰り上げる
+    if (grandParent != kNullNode) {
+        if (nodes_[grandParent].child1 == parent) {
+            nodes_[grandParent].child1 = sibling;
+        }
+        else {
+            nodes_[grandParent].child2 = sibling;
+        }
+        nodes_[sibling].parent = grandParent;
+        FreeNode(parent);
+        Refit(grandParent);
+    }
+    else {
+        root_ = sibling;
+        nodes_[sibling].parent = kNullNode;
+        FreeNode(parent);
+    }
+}
+
+void DynamicTreeBroadphase::Refit(std::uint32_t node) {
+    while (node != kNullNode) {
+        node = Balance(node);
+        Node& current = nodes_[node];
+        const Node& child1 = nodes_[current.child1];
+        const Node& child2 = nodes_[current.child2];
+        current.height = 1 + std::max(child1.height, child2.height);
+        current.aabb = child1.aabb;
+        current.aabb.Include(child2.aabb);
+        node = current.parent;
+    }
+}
+
+std::uint32_t DynamicTreeBroadphase::Balance(std::uint32_t a) {
+    const Node& nodeA = nodes_[a];
+    if (nodeA.IsLeaf() || nodeA.height < 2) {
+        return a;
+    }
+    std::int32_t balance = nodes_[nodeA.child2].height - nodes_[nodeA.child1].height;
+    if (balance > 1) {
+        return Rotate(a, nodeA.child2);
+    }
+    if (balance < -1) {
+        return Rotate(a, nodeA.child1);
+    }
+    return a;
+}
+
+std::uint32_t DynamicTreeBroadphase::Rotate(std::uint32_t a, std::uint32_t c) {
+    // aの子cをaの位置へ持ち上げ、cの低い方の子をaへ渡す
+    Node& nodeA = nodes_[a];
+    Node& nodeC = nodes_[c];
+    std::uint32_t b = nodeA.child1 == c ? nodeA.child2 : nodeA.child1;
+    std::uint32_t high = nodeC.child1;
+    std::uint32_t low = nodeC.child2;
+    if (nodes_[high].height < nodes_[low].height) {
+        std::swap(high, low);
+    }
+
+    nodeC.parent = nodeA.parent;
+    nodeA.parent = c;
+    if (nodeC.parent != kNullNode) {
+        Node& parent = nodes_[nodeC.parent];
+        if (parent.child1 == a) {
+            parent.child1 = c;
+        }
+        else {
+            parent.child2 = c;
+        }
+    }
+    else {
+        root_ = c;
+    }
+
+    nodeC.child1 = a;
+    nodeC.child2 = high;
+    if (nodeA.child1 == c) {
+        nodeA.child1 = low;
+    }
+    else {
+        nodeA.child2 = low;
+    }
+    nodes_[low].parent = a;
+
+    nodeA.aabb = nodes_[b].aabb;
+    nodeA.aabb.Include(nodes_[low].aabb);
+    nodeA.height = 1 + std::max(nodes_[b].height, nodes_[low].height);
+    nodeC.aabb = nodeA.aabb;
+    nodeC.aabb.Include(nodes_[high].aabb);
+    nodeC.height = 1 + std::max(nodeA.height, nodes_[high].height);
+    return c;
+}
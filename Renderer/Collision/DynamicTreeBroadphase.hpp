@@ -0,0 +1,67 @@
+#pragma once
+#include "Broadphase.hpp"
+
+// 葉を余白付きのAABBで持つ動的AABB木
+// 余白からはみ出したときだけ葉を付け替え、回転で高さを保つ
+class DynamicTreeBroadphase :
+    public Broadphase {
+public:
+    static constexpr float kMargin = 0.1f;
+    // 移動量の何倍を進行方向に広げるか
+    static constexpr float kDisplacementMultiplier = 2.0f;
+
+    DynamicTreeBroadphase();
+
+    void Insert(std::uint32_t id, const AABB& aabb) override;
+    void Remove(std::uint32_t id) override;
+    void Move(std::uint32_t id, const AABB& aabb) override;
+    void Clear() override;
+
+    void ComputePairs(std::vector<std::uint64_t>& pairs) override;
+    void Query(const AABB& bounds, std::vector<std::uint32_t>& ids) const override;
+    void Raycast(const Vector3& origin, const Vector3& direction, float maxDistance, std::vector<std::uint32_t>& ids) const override;
+
+    BroadphaseType GetType() const override { return BroadphaseType::kDynamicTree; }
+    std::uint32_t GetCount() const override { return count_; }
+    size_t GetMemoryUsage() const override;
+
+    std::int32_t GetHeight() const { return root_ == kNullNode ? 0 : nodes_[root_].height; }
+
+private:
+    static constexpr std::uint32_t kNullNode = 0xFFFFFFFF;
+    static constexpr std::uint32_t kStackSize = 256;
+
+    struct Node {
+        AABB aabb;                  // 余白付き
+        std::uint32_t parent;       // 空きノードでは次の空きノード
+        std::uint32_t child1;
+        std::uint32_t child2;
+        std::uint32_t id;           // 葉のみ
+        std::int32_t height;        // 葉は0、空きノードは-1
+
+        bool IsLeaf() const { return child1 == kNullNode; }
+    };
+    struct Proxy {
+        AABB aabb;                  // 余白なし
+        std::uint32_t node;
+    };
+
+    std::uint32_t AllocateNode();
+    void FreeNode(std::uint32_t node);
+    void InsertLeaf(std::uint32_t leaf);
+    void RemoveLeaf(std::uint32_t leaf);
+    // 親方向へAABBと高さを直しながら回転する
+    void Refit(std::uint32_t node);
+    // 左右の高さの差が2以上なら高い方の子を持ち上げる
+    std::uint32_t Balance(std::uint32_t a);
+    std::uint32_t Rotate(std::uint32_t a, std::uint32_t c);
+
+    std::vector<Node> nodes_;
+    std::uint32_t root_;
+    std::uint32_t freeList_;
+    // IDで引く
+    std::vector<Proxy> proxies_;
+    std::uint32_t count_;
+    // ComputePairsで使う（ノードの組）
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> pairStack_;
+};
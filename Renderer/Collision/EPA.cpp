@@ -0,0 +1,136 @@
+#include "EPA.hpp"
+
+namespace EPA {
+
+    Vector3 Barycentric(const Vector3& p, const Vector3& a, const Vector3& b, const Vector3& c) {
+        Vector3 v0 = b - a;
+        Vector3 v1 = c - a;
+        Vector3 v2 = p - a;
+        float d00 = Vector3::Dot(v0, v0);
+        float d01 = Vector3::Dot(v0, v1);
+        float d11 = Vector3::Dot(v1, v1);
+        float d20 = Vector3::Dot(v2, v0);
+        float d21 = Vector3::Dot(v2, v1);
+        float denom = d00 * d11 - d01 * d01;
+        if (denom <= 0.0f) {
+            return { 1.0f, 0.0f, 0.0f };
+        }
+        float v = (d11 * d20 - d01 * d21) / denom;
+        float w = (d00 * d21 - d01 * d20) / denom;
+        return { 1.0f - v - w, v, w };
+    }
+
+    bool Polytope::Initialize(const SupportPoint (&tetrahedron)[4]) {
+        vertexCount = 0;
+        faceCount = 0;
+        for (const auto& point : tetrahedron) {
+            vertices[vertexCount++] = point;
+        }
+        // 外向きになるように向きをそろえる
+        if (Vector3::Dot(Vector3::Cross(vertices[1].w - vertices[0].w, vertices[2].w - vertices[0].w), vertices[3].w - vertices[0].w) > 0.0f) {
+            std::swap(vertices[1], vertices[2]);
+        }
+        return
+            AddFace(0, 1, 2) &&
+            AddFace(0, 3, 1) &&
+            AddFace(0, 2, 3) &&
+            AddFace(1, 3, 2);
+    }
+
+    std::uint32_t Polytope::FindClosestFace() const {
+        std::uint32_t closest = 0;
+        float closestDistance = Math::positiveInfinity;
+        for (std::uint32_t i = 0; i < faceCount; ++i) {
+            if (!faces[i].isObsolete && faces[i].distance < closestDistance) {
+                closestDistance = faces[i].distance;
+                closest = i;
+            }
+        }
+        return closest;
+    }
+
+    bool Polytope::Expand(const SupportPoint& point) {
+        if (vertexCount >= kMaxVertices) {
+            return false;
+        }
+
+        // 見える面の境界辺を集める。逆向きの辺が既にあれば内部の辺なので消す
+        std::uint32_t edges[kMaxEdges][2];
+        std::uint32_t edgeCount = 0;
+        for (std::uint32_t i = 0; i < faceCount; ++i) {
+            Face& face = faces[i];
+            if (face.isObsolete || Vector3::Dot(face.normal, point.w - vertices[face.index[0]].w) <= 0.0f) {
+                continue;
+            }
+            face.isObsolete = true;
+            for (std::uint32_t j = 0; j < 3; ++j) {
+                std::uint32_t from = face.index[j];
+                std::uint32_t to = face.index[(j + 1) % 3];
+                bool isShared = false;
+                for (std::uint32_t k = 0; k < edgeCount; ++k) {
+                    if (edges[k][0] == to && edges[k][1] == from) {
+                        edges[k][0] = edges[edgeCount - 1][0];
+                        edges[k][1] = edges[edgeCount - 1][1];
+                        --edgeCount;
+                        isShared = true;
+                        break;
+                    }
+                }
+                if (!isShared) {
+                    if (edgeCount >= kMaxEdges) {
+                        return false;
+                    }
+                    edges[edgeCount][0] = from;
+                    edges[edgeCount][1] = to;
+                    ++edgeCount;
+                }
+            }
+        }
+        if (edgeCount == 0) {
+            return false;
+        }
+
+        // 無効になった面を詰める
+        std::uint32_t alive = 0;
+        for (std::uint32_t i = 0; i < faceCount; ++i) {
+            if (!faces[i].isObsolete) {
+                faces[alive++] = faces[i];
+            }
+        }
+        faceCount = alive;
+
+        std::uint32_t newIndex = vertexCount;
+        vertices[vertexCount++] = point;
+        for (std::uint32_t i = 0; i < edgeCount; ++i) {
+            if (!AddFace(edges[i][0], edges[i][1], newIndex)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool Polytope::AddFace(std::uint32_t a, std::uint32_t b, std::uint32_t c) {
+        if (faceCount >= kMaxFaces) {
+            return false;
+        }
+        Face& face = faces[faceCount];
+        face.index[0] = a;
+        face.index[1] = b;
+        face.index[2] = c;
+        face.isObsolete = false;
+        Vector3 normal = Vector3::Cross(vertices[b].w - vertices[a].w, vertices[c].w - vertices[a].w);
+        float length = normal.Length();
+        if (length <= 1.0e-12f) {
+            // 縮退した面は選ばれないようにする
+            face.normal = Vector3::zero;
+            face.distance = Math::positiveInfinity;
+        }
+        else {
+            face.normal = normal / length;
+            face.distance = Vector3::Dot(face.normal, vertices[a].w);
+        }
+        ++faceCount;
+        return true;
+    }
+
+}
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <cstdint>
+
+#include "GJK.hpp"
+
+namespace EPA {
+    constexpr std::uint32_t kMaxIterations = 64;
+    constexpr std::uint32_t kMaxVertices = 4 + kMaxIterations;
+    constexpr std::uint32_t kMaxFaces = 256;
+    constexpr std::uint32_t kMaxEdges = 128;
+    constexpr float kTolerance = 1.0e-4f;
+
+    struct Result {
+        Vector3 normal;     // AからBへ向かう法線
+        Vector3 pointA;     // A上の接触点
+        Vector3 pointB;     // B上の接触点
+        float depth = 0.0f;
+    };
+
+    // 三角形abc上の点pの重心座標
+    Vector3 Barycentric(const Vector3& p, const Vector3& a, const Vector3& b, const Vector3& c);
+
+    class Polytope {
+    public:
+        struct Face {
+            std::uint32_t index[3];
+            Vector3 normal;
+            float distance;
+            bool isObsolete;
+        };
+
+        // 四面体から多面体を作る
+        bool Initialize(const SupportPoint (&tetrahedron)[4]);
+        // 原点に最も近い面
+        std::uint32_t FindClosestFace() const;
+        // 新しい頂点から見える面を取り除き、穴を埋める
+        bool Expand(const SupportPoint& point);
+
+        SupportPoint vertices[kMaxVertices];
+        Face faces[kMaxFaces];
+        std::uint32_t vertexCount = 0;
+        std::uint32_t faceCount = 0;
+
+    private:
+        bool AddFace(std::uint32_t a, std::uint32_t b, std::uint32_t c);
+    };
+
+    // GJKの単体を四面体まで膨らませる
+    template<class Support>
+    bool BuildTetrahedron(const Support& support, const Simplex& simplex, SupportPoint (&tetrahedron)[4]) {
+        constexpr float kEpsilon = 1.0e-8f;
+        std::uint32_t size = simplex.size;
+        for (std::uint32_t i = 0; i < size; ++i) {
+            tetrahedron[i] = simplex.points[i];
+        }
+
+        if (size == 1) {
+            static const Vector3 kAxes[] = { Vector3::unitX, -Vector3::unitX, Vector3::unitY, -Vector3::unitY, Vector3::unitZ, -Vector3::unitZ };
+            for (const auto& axis : kAxes) {
+                SupportPoint point = support(axis);
+                if ((point.w - tetrahedron[0].w).LengthSquare() > kEpsilon) {
+                    tetrahedron[size++] = point;
+                    break;
+                }
+            }
+        }
+        if (size == 2) {
+            Vector3 direction = tetrahedron[1].w - tetrahedron[0].w;
+            Vector3 axis = std::abs(direction.x) < std::abs(direction.y) ?
+                (std::abs(direction.x) < std::abs(direction.z) ? Vector3::unitX : Vector3::unitZ) :
+                (std::abs(direction.y) < std::abs(direction.z) ? Vector3::unitY : Vector3::unitZ);
+            Vector3 perpendicular1 = Vector3::Cross(direction, axis);
+            Vector3 perpendicular2 = Vector3::Cross(direction, perpendicular1);
+            const Vector3 candidates[] = { perpendicular1, -perpendicular1, perpendicular2, -perpendicular2 };
+            for (const auto& candidate : candidates) {
+                SupportPoint point = support(candidate);
+                if (Vector3::Cross(point.w - tetrahedron[0].w, direction).LengthSquare() > kEpsilon) {
+                    tetrahedron[size++] = point;
+                    break;
+                }
+            }
+        }
+        if (size == 3) {
+            Vector3 normal = Vector3::Cross(tetrahedron[1].w - tetrahedron[0].w, tetrahedron[2].w - tetrahedron[0].w);
+            SupportPoint point = support(normal);
+            if (std::abs(Vector3::Dot(point.w - tetrahedron[0].w, normal)) <= kEpsilon) {
+                point = support(-normal);
+            }
+            if (std::abs(Vector3::Dot(point.w - tetrahedron[0].w, normal)) > kEpsilon) {
+                tetrahedron[size++] = point;
+            }
+        }
+        return size == 4;
+    }
+
+    // 交差しているGJKの単体から貫通深度と接触点を求める
+    template<class SupportA, class SupportB>
+    bool Penetration(const SupportA& supportA, const SupportB& supportB, const Simplex& simplex, Result& result) {
+        auto support = [&](const Vector3& direction) {
+            SupportPoint point;
+            point.a = supportA(direction);
+            point.b = supportB(-direction);
+            point.w = point.a - point.b;
+            return point;
+        };
+
+        SupportPoint tetrahedron[4];
+        if (!BuildTetrahedron(support, simplex, tetrahedron)) {
+            return false;
+        }
+        Polytope polytope;
+        if (!polytope.Initialize(tetrahedron)) {
+            return false;
+        }
+
+        // 拡張に失敗しても直前の面で結果を出せるようにコピーしておく
+        Polytope::Face face = polytope.faces[polytope.FindClosestFace()];
+        for (std::uint32_t iteration = 0; iteration < kMaxIterations; ++iteration) {
+            SupportPoint point = support(face.normal);
+            if (Vector3::Dot(point.w, face.normal) - face.distance <= kTolerance) {
+                break;
+            }
+            if (!polytope.Expand(point)) {
+                break;
+            }
+            face = polytope.faces[polytope.FindClosestFace()];
+        }
+        if (face.distance == Math::positiveInfinity) {
+            return false;
+        }
+
+        const SupportPoint& a = polytope.vertices[face.index[0]];
+        const SupportPoint& b = polytope.vertices[face.index[1]];
+        const SupportPoint& c = polytope.vertices[face.index[2]];
+        Vector3 bary = Barycentric(face.normal * face.distance, a.w, b.w, c.w);
+        result.normal = face.normal;
+        result.depth = face.distance;
+        result.pointA = bary.x * a.a + bary.y * b.a + bary.z * c.a;
+        result.pointB = bary.x * a.b + bary.y * b.b + bary.z * c.b;
+        return true;
+    }
+}
@@ -0,0 +1,40 @@
+#include "EpochReclamation.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <thread>
+
+EpochReclamation::EpochReclamation() :
+    epoch_(1) {
+    for (auto& slot : slots_) {
+        slot.epoch.store(kIdleEpoch);
+    }
+}
+
+bool EpochReclamation::TryPin(Guard& guard) const {
+    // スレッドごとに散らした位置から空いている枠を探す
+    std::uint32_t first = static_cast<std::uint32_t>(std::hash<std::thread::id>{}(std::this_thread::get_id()) % kMaxReaders);
+    for (std::uint32_t i = 0; i < kMaxReaders; ++i) {
+        Slot& slot = slots_[(first + i) % kMaxReaders];
+        std::uint64_t expected = kIdleEpoch;
+        // 書き手が枠を見る前にここで書いたエポックが見えるよう、読み込みも書き込みも逐次一貫にする
+        if (slot.epoch.load(std::memory_order_relaxed) == kIdleEpoch && slot.epoch.compare_exchange_strong(expected, epoch_.load())) {
+            guard = Guard(&slot.epoch);
+            return true;
+        }
+    }
+    // 書き手を待たせないよう、読み手を回して空くのを待つことはしない
+    return false;
+}
+
+std::uint64_t EpochReclamation::Advance() {
+    return epoch_.fetch_add(1) + 1;
+}
+
+std::uint64_t EpochReclamation::GetOldestPinnedEpoch() const {
+    std::uint64_t oldest = kIdleEpoch;
+    for (const auto& slot : slots_) {
+        oldest = std::min(oldest, slot.epoch.load());
+    }
+    return oldest;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// エポックによる遅延解放
+// 読み手は使う前にPinで今のエポックを枠に書き、書き手は差し替えた古いものをそのときのエポックと共に取っておく
+// 全ての使用中の枠がそのエポックを越えたら、もう誰も古いものを見ていないので解放してよい
+// 読み手はロックを取らず、枠への書き込み1回と読み込み1回で済む
+class EpochReclamation {
+public:
+    // 同時に読めるスレッドの数
+    static constexpr std::uint32_t kMaxReaders = 64;
+    static constexpr std::uint64_t kIdleEpoch = ~0ull;
+
+    // 生きている間、Pinした時点で公開されていたものは解放されない
+    class Guard {
+    public:
+        Guard() : slot_(nullptr) {}
+        explicit Guard(std::atomic<std::uint64_t>* slot) : slot_(slot) {}
+        ~Guard() { Release(); }
+        Guard(Guard&& other) noexcept : slot_(other.slot_) { other.slot_ = nullptr; }
+        Guard& operator=(Guard&& other) noexcept {
+            if (this != &other) {
+                Release();
+                slot_ = other.slot_;
+                other.slot_ = nullptr;
+            }
+            return *this;
+        }
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+
+        void Release() {
+            if (slot_) {
+                slot_->store(kIdleEpoch, std::memory_order_release);
+                slot_ = nullptr;
+            }
+        }
+
+    private:
+        std::atomic<std::uint64_t>* slot_;
+    };
+
+    EpochReclamation();
+
+    // 読み手。どのスレッドからでも呼べる。枠が全て使用中なら待たずにfalseを返す
+    bool TryPin(Guard& guard) const;
+    // 書き手。差し替えた直後に呼び、古いものを解放してよくなるエポックを返す
+    std::uint64_t Advance();
+    // 書き手。使用中の枠の最も古いエポック。誰も読んでいなければkIdleEpoch
+    std::uint64_t GetOldestPinnedEpoch() const;
+
+    std::uint64_t GetEpoch() const { return epoch_.load(); }
+
+private:
+    // 偽共有を避けるため枠ごとにキャッシュライン1本に揃える
+    struct alignas(64) Slot {
+        std::atomic<std::uint64_t> epoch;
+    };
+
+    alignas(64) std::atomic<std::uint64_t> epoch_;
+    mutable Slot slots_[kMaxReaders];
+};
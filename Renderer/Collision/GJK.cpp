@@ -0,0 +1,195 @@
+#include "GJK.hpp"
+
+bool Simplex::Contains(const Vector3& w) const {
+    for (std::uint32_t i = 0; i < size; ++i) {
+        if (points[i].w == w) { return true; }
+    }
+    return false;
+}
+
+bool Simplex::Solve(Vector3& closest) {
+    switch (size) {
+    case 1:
+        lambdas[0] = 1.0f;
+        closest = points[0].w;
+        return true;
+    case 2:
+        SolveSegment(closest);
+        return true;
+    case 3:
+        SolveTriangle(closest);
+        return true;
+    case 4:
+        return SolveTetrahedron(closest);
+    }
+    return false;
+}
+
+void Simplex::ComputeWitnessPoints(Vector3& pointA, Vector3& pointB) const {
+    pointA = Vector3::zero;
+    pointB = Vector3::zero;
+    for (std::uint32_t i = 0; i < size; ++i) {
+        pointA += lambdas[i] * points[i].a;
+        pointB += lambdas[i] * points[i].b;
+    }
+}
+
+void Simplex::SolveSegment(Vector3& closest) {
+    const Vector3& a = points[0].w;
+    const Vector3& b = points[1].w;
+    Vector3 ab = b - a;
+    float t = Vector3::Dot(-a, ab);
+    if (t <= 0.0f) {
+        size = 1;
+        lambdas[0] = 1.0f;
+        closest = a;
+        return;
+    }
+    float denom = ab.LengthSquare();
+    if (t >= denom) {
+        points[0] = points[1];
+        size = 1;
+        lambdas[0] = 1.0f;
+        closest = b;
+        return;
+    }
+    t /= denom;
+    lambdas[0] = 1.0f - t;
+    lambdas[1] = t;
+    closest = a + t * ab;
+}
+
+void Simplex::SolveTriangle(Vector3& closest) {
+    // Real-Time Collision Detection 5.1.5 の原点版
+    const Vector3& a = points[0].w;
+    const Vector3& b = points[1].w;
+    const Vector3& c = points[2].w;
+    Vector3 ab = b - a;
+    Vector3 ac = c - a;
+
+    float d1 = Vector3::Dot(ab, -a);
+    float d2 = Vector3::Dot(ac, -a);
+    if (d1 <= 0.0f && d2 <= 0.0f) {
+        size = 1;
+        lambdas[0] = 1.0f;
+        closest = a;
+        return;
+    }
+
+    float d3 = Vector3::Dot(ab, -b);
+    float d4 = Vector3::Dot(ac, -b);
+    if (d3 >= 0.0f && d4 <= d3) {
+        points[0] = points[1];
+        size = 1;
+        lambdas[0] = 1.0f;
+        closest = b;
+        return;
+    }
+
+    float vc = d1 * d4 - d3 * d2;
+    if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) {
+        float t = d1 / (d1 - d3);
+        size = 2;
+        lambdas[0] = 1.0f - t;
+        lambdas[1] = t;
+        closest = a + t * ab;
+        return;
+    }
+
+    float d5 = Vector3::Dot(ab, -c);
+    float d6 = Vector3::Dot(ac, -c);
+    if (d6 >= 0.0f && d5 <= d6) {
+        points[0] = points[2];
+        size = 1;
+        lambdas[0] = 1.0f;
+        closest = c;
+        return;
+    }
+
+    float vb = d5 * d2 - d1 * d6;
+    if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) {
+        float t = d2 / (d2 - d6);
+        points[1] = points[2];
+        size = 2;
+        lambdas[0] = 1.0f - t;
+        lambdas[1] = t;
+        closest = a + t * ac;
+        return;
+    }
+
+    float va = d3 * d6 - d5 * d4;
+    if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f) {
+        float t = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+        points[0] = points[1];
+        points[1] = points[2];
+        size = 2;
+        lambdas[0] = 1.0f - t;
+        lambdas[1] = t;
+        closest = points[0].w + t * (points[1].w - points[0].w);
+        return;
+    }
+
+    float denom = 1.0f / (va + vb + vc);
+    float v = vb * denom;
+    float w = vc * denom;
+    lambdas[0] = 1.0f - v - w;
+    lambdas[1] = v;
+    lambdas[2] = w;
+    // 細長い三角形では重心座標から組み立てると桁落ちするので、平面への射影で求める
+    Vector3 normal = Vector3::Cross(ab, ac);
+    float normalSquare = normal.LengthSquare();
+    closest = normalSquare > 0.0f ? normal * (Vector3::Dot(a, normal) / normalSquare) : a + ab * v + ac * w;
+}
+
+bool Simplex::SolveTetrahedron(Vector3& closest) {
+    // 各面について、原点が対頂点と反対側にあるものだけ調べる
+    static const std::uint32_t kFaces[4][4] = {
+        { 0, 1, 2, 3 },
+        { 0, 2, 3, 1 },
+        { 0, 3, 1, 2 },
+        { 1, 3, 2, 0 },
+    };
+
+    Simplex best;
+    float bestSquare = Math::positiveInfinity;
+    bool isOutside = false;
+    float insideLambdas[4] = {};
+    for (const auto& face : kFaces) {
+        const Vector3& a = points[face[0]].w;
+        const Vector3& b = points[face[1]].w;
+        const Vector3& c = points[face[2]].w;
+        const Vector3& d = points[face[3]].w;
+        Vector3 normal = Vector3::Cross(b - a, c - a);
+        float signOrigin = Vector3::Dot(-a, normal);
+        float signOpposite = Vector3::Dot(d - a, normal);
+        if (signOrigin * signOpposite > 0.0f) {
+            insideLambdas[face[3]] = signOrigin / signOpposite;
+            continue;
+        }
+        isOutside = true;
+
+        Simplex triangle;
+        triangle.Push(points[face[0]]);
+        triangle.Push(points[face[1]]);
+        triangle.Push(points[face[2]]);
+        Vector3 point;
+        triangle.SolveTriangle(point);
+        float pointSquare = point.LengthSquare();
+        if (pointSquare < bestSquare) {
+            bestSquare = pointSquare;
+            best = triangle;
+            closest = point;
+        }
+    }
+
+    if (!isOutside) {
+        // 内部の場合は原点の重心座標を残す
+        for (std::uint32_t i = 0; i < 4; ++i) {
+            lambdas[i] = insideLambdas[i];
+        }
+        closest = Vector3::zero;
+        return false;
+    }
+    *this = best;
+    return true;
+}
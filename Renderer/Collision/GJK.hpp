@@ -0,0 +1,235 @@
+#pragma once
+
+#include <cstdint>
+
+#include "../Math/MathUtils.hpp"
+
+// ミンコフスキー差上のサポート点
+struct SupportPoint {
+    Vector3 a;
+    Vector3 b;
+    Vector3 w; // a - b
+};
+
+class Simplex {
+public:
+    void Clear() { size = 0; }
+    void Push(const SupportPoint& point) { points[size++] = point; }
+    bool Contains(const Vector3& w) const;
+
+    // 原点に最も近い点を求め、寄与しない頂点を取り除く
+    // 原点が四面体の内部にある場合はfalse
+    bool Solve(Vector3& closest);
+    void ComputeWitnessPoints(Vector3& pointA, Vector3& pointB) const;
+
+    SupportPoint points[4];
+    float lambdas[4];
+    std::uint32_t size = 0;
+
+private:
+    void SolveSegment(Vector3& closest);
+    void SolveTriangle(Vector3& closest);
+    bool SolveTetrahedron(Vector3& closest);
+};
+
+namespace GJK {
+    constexpr std::uint32_t kMaxIterations = 64;
+    constexpr float kRelativeTolerance = 1.0e-6f;
+    constexpr float kAbsoluteTolerance = 1.0e-12f;
+
+    struct Result {
+        Vector3 pointA;
+        Vector3 pointB;
+        // ミンコフスキー差上で原点に最も近い点。pointA - pointBと同じだが、細長い単体でも誤差が小さい
+        Vector3 closest;
+        float distance = 0.0f;
+        std::uint32_t iterations = 0;
+        bool isIntersecting = false;
+    };
+
+    // サポート関数 Vector3(const Vector3& direction) の組から距離を求める
+    // 距離がmaxDistanceを超えることが確定した時点で打ち切りfalseを返す
+    template<class SupportA, class SupportB>
+    bool Distance(const SupportA& supportA, const SupportB& supportB, Result& result, Simplex& simplex, float maxDistance = Math::positiveInfinity, const Vector3& initialDirection = Vector3::unitX) {
+        auto support = [&](const Vector3& direction) {
+            SupportPoint point;
+            point.a = supportA(direction);
+            point.b = supportB(-direction);
+            point.w = point.a - point.b;
+            return point;
+        };
+
+        result = Result{};
+        simplex.Clear();
+        simplex.Push(support(initialDirection));
+        simplex.lambdas[0] = 1.0f;
+        Vector3 v = simplex.points[0].w;
+        float vv = v.LengthSquare();
+        const float maxDistanceSquare = maxDistance < Math::positiveInfinity ? maxDistance * maxDistance : Math::positiveInfinity;
+
+        while (result.iterations < kMaxIterations) {
+            ++result.iterations;
+            if (vv <= kAbsoluteTolerance) {
+                result.isIntersecting = true;
+                break;
+            }
+
+            SupportPoint point = support(-v);
+            float vw = Vector3::Dot(v, point.w);
+            // 分離軸vに沿った距離の下限 vw/|v| がmaxDistanceを超えた
+            if (vw > 0.0f && vw * vw > maxDistanceSquare * vv) {
+                simplex.ComputeWitnessPoints(result.pointA, result.pointB);
+                result.closest = v;
+                result.distance = vw / std::sqrt(vv);
+                return false;
+            }
+            // 収束
+            if (vv - vw <= kRelativeTolerance * vv || simplex.Contains(point.w)) {
+                break;
+            }
+
+            simplex.Push(point);
+            Vector3 closest;
+            if (!simplex.Solve(closest)) {
+                result.isIntersecting = true;
+                break;
+            }
+            float closestSquare = closest.LengthSquare();
+            // 進展がない場合は数値誤差で振動しているため終了
+            if (closestSquare >= vv) {
+                break;
+            }
+            v = closest;
+            vv = closestSquare;
+        }
+
+        simplex.ComputeWitnessPoints(result.pointA, result.pointB);
+        result.closest = v;
+        result.distance = result.isIntersecting ? 0.0f : std::sqrt(vv);
+        return result.distance <= maxDistance;
+    }
+
+    template<class SupportA, class SupportB>
+    bool Distance(const SupportA& supportA, const SupportB& supportB, Result& result, float maxDistance = Math::positiveInfinity, const Vector3& initialDirection = Vector3::unitX) {
+        Simplex simplex;
+        return Distance(supportA, supportB, result, simplex, maxDistance, initialDirection);
+    }
+
+    // 交差の有無だけを判定する
+    // 分離軸が見つかるか原点を囲んだ時点で終わり、距離や最近点は求めない
+    template<class SupportA, class SupportB>
+    bool Intersect(const SupportA& supportA, const SupportB& supportB, const Vector3& initialDirection = Vector3::unitX) {
+        Simplex simplex;
+        SupportPoint point;
+        point.a = supportA(initialDirection);
+        point.b = supportB(-initialDirection);
+        point.w = point.a - point.b;
+        simplex.Push(point);
+        Vector3 v = point.w;
+        float vv = v.LengthSquare();
+
+        for (std::uint32_t i = 0; i < kMaxIterations; ++i) {
+            // 境界上も交差とする
+            if (vv <= kAbsoluteTolerance) {
+                return true;
+            }
+            point.a = supportA(-v);
+            point.b = supportB(v);
+            point.w = point.a - point.b;
+            // -v方向の最遠点が原点に届かなければvが分離軸
+            if (Vector3::Dot(v, point.w) > 0.0f) {
+                return false;
+            }
+            // 新しい点が得られない。Distanceと同じく収束したとみなす
+            if (simplex.Contains(point.w)) {
+                return false;
+            }
+            simplex.Push(point);
+            Vector3 closest;
+            if (!simplex.Solve(closest)) {
+                return true;
+            }
+            float closestSquare = closest.LengthSquare();
+            // 進展がない。原点は|v|だけ離れている
+            if (closestSquare >= vv) {
+                return false;
+            }
+            v = closest;
+            vv = closestSquare;
+        }
+        return false;
+    }
+
+    // 保守的前進によるレイキャスト。directionは正規化済み
+    // normalは当たった点での外向き法線
+    template<class Support>
+    bool Raycast(const Support& support, const Vector3& origin, const Vector3& direction, float maxDistance, float& distance, Vector3& normal) {
+        constexpr float kHitTolerance = 1.0e-4f;
+        float t = 0.0f;
+        normal = -direction;
+        Vector3 initialDirection = direction;
+        for (std::uint32_t i = 0; i < kMaxIterations; ++i) {
+            Vector3 point = origin + direction * t;
+            auto pointSupport = [&point](const Vector3&) { return point; };
+            Result result;
+            Distance(support, pointSupport, result, Math::positiveInfinity, initialDirection);
+            if (result.isIntersecting || result.distance <= kHitTolerance) {
+                distance = t;
+                return true;
+            }
+            Vector3 separation = (point - result.pointA) / result.distance;
+            float approach = -Vector3::Dot(direction, separation);
+            // 離れていく方向
+            if (approach <= 0.0f) {
+                return false;
+            }
+            normal = separation;
+            t += result.distance / approach;
+            if (t > maxDistance) {
+                return false;
+            }
+            initialDirection = -separation;
+        }
+        return false;
+    }
+
+    // 保守的前進による形状のキャスト。Aをdirection（正規化済み）に動かし、最初にBと接する距離を求める
+    // normalはB上の接触点pointでの外向き法線。始めから接しているか重なっている場合は距離0でnormalは-direction
+    template<class SupportA, class SupportB>
+    bool ShapeCast(const SupportA& supportA, const SupportB& supportB, const Vector3& direction, float maxDistance, float& distance, Vector3& point, Vector3& normal) {
+        // 近すぎると最近点の差が誤差ばかりで向きを誤るので、レイより手前で止める
+        constexpr float kHitTolerance = 1.0e-3f;
+        constexpr float kNormalTolerance = 1.0e-4f;
+        float t = 0.0f;
+        normal = -direction;
+        Vector3 initialDirection = -direction;
+        for (std::uint32_t i = 0; i < kMaxIterations; ++i) {
+            Vector3 offset = direction * t;
+            auto movedSupportA = [&](const Vector3& d) { return supportA(d) + offset; };
+            Result result;
+            Distance(movedSupportA, supportB, result, Math::positiveInfinity, initialDirection);
+            if (result.isIntersecting || result.distance <= kHitTolerance) {
+                // 向きが信用できなければ前の反復の法線を使う
+                if (!result.isIntersecting && result.distance > kNormalTolerance) {
+                    normal = result.closest / result.distance;
+                }
+                distance = t;
+                point = result.pointB;
+                return true;
+            }
+            Vector3 separation = result.closest / result.distance;
+            float approach = -Vector3::Dot(direction, separation);
+            // 離れていく方向
+            if (approach <= 0.0f) {
+                return false;
+            }
+            normal = separation;
+            t += result.distance / approach;
+            if (t > maxDistance) {
+                return false;
+            }
+            initialDirection = separation;
+        }
+        return false;
+    }
+}
@@ -0,0 +1,419 @@
+#include "LinearBVHBroadphase.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cassert>
+
+namespace {
+    // 下位10ビットを3ビットおきに広げる
+    std::uint64_t ExpandBits10(std::uint64_t v) {
+        v &= 0x3FF;
+        v = (v * 0x00010001u) & 0xFF0000FFu;
+        v = (v * 0x00000101u) & 0x0F00F00Fu;
+        v = (v * 0x00000011u) & 0xC30C30C3u;
+        v = (v * 0x00000005u) & 0x49249249u;
+        return v;
+    }
+
+    // 下位21ビットを3ビットおきに広げる
+    std::uint64_t ExpandBits21(std::uint64_t v) {
+        v &= 0x1FFFFF;
+        v = (v | v << 32) & 0x1F00000000FFFFull;
+        v = (v | v << 16) & 0x1F0000FF0000FFull;
+        v = (v | v << 8) & 0x100F00F00F00F00Full;
+        v = (v | v << 4) & 0x10C30C30C30C30C3ull;
+        v = (v | v << 2) & 0x1249249249249249ull;
+        return v;
+    }
+}
+
+LinearBVHBroadphase::LinearBVHBroadphase(MortonBits mortonBits, ThreadPool& threadPool) :
+    threadPool_(threadPool),
+    mortonBits_(mortonBits),
+    isDirty_(false) {
+}
+
+void LinearBVHBroadphase::Insert(std::uint32_t id, const AABB& aabb) {
+    if (id >= idToIndex_.size()) {
+        idToIndex_.resize(id + 1, kInvalidIndex);
+    }
+    assert(idToIndex_[id] == kInvalidIndex);
+    idToIndex_[id] = static_cast<std::uint32_t>(entries_.size());
+    entries_.push_back({ aabb, id });
+    isDirty_ = true;
+}
+
+void LinearBVHBroadphase::Remove(std::uint32_t id) {
+    assert(id < idToIndex_.size() && idToIndex_[id] != kInvalidIndex);
+    std::uint32_t index = idToIndex_[id];
+    entries_[index] = entries_.back();
+    idToIndex_[entries_[index].id] = index;
+    entries_.pop_back();
+    idToIndex_[id] = kInvalidIndex;
+    isDirty_ = true;
+}
+
+void LinearBVHBroadphase::Move(std::uint32_t id, const AABB& aabb) {
+    assert(id < idToIndex_.size() && idToIndex_[id] != kInvalidIndex);
+    entries_[idToIndex_[id]].aabb = aabb;
+    isDirty_ = true;
+}
+
+void LinearBVHBroadphase::Clear() {
+    entries_.clear();
+    idToIndex_.clear();
+    leafBounds_.clear();
+    leafIDs_.clear();
+    leafParents_.clear();
+    nodes_.clear();
+    isDirty_ = false;
+}
+
+void LinearBVHBroadphase::ComputePairs(std::vector<std::uint64_t>& pairs) {
+    Rebuild();
+    std::uint32_t count = static_cast<std::uint32_t>(leafBounds_.size());
+    if (count < 2) {
+        return;
+    }
+    // 葉ごとに木を辿り、自分より後ろの葉とだけ組を作る
+    std::uint32_t taskCount = (count + kTaskSize - 1) / kTaskSize;
+    taskPairs_.resize(std::max(static_cast<std::uint32_t>(taskPairs_.size()), taskCount));
+    threadPool_.ParallelFor(taskCount, [&](std::uint32_t task) {
+        std::vector<std::uint64_t>& taskPairs = taskPairs_[task];
+        taskPairs.clear();
+        std::uint32_t end = std::min((task + 1) * kTaskSize, count);
+        std::uint32_t stack[kStackSize];
+        for (std::uint32_t leaf = task * kTaskSize; leaf < end; ++leaf) {
+            const AABB& bounds = leafBounds_[leaf];
+            std::uint32_t stackSize = 0;
+            stack[stackSize++] = 0;
+            while (stackSize > 0) {
+                const Node& node = nodes_[stack[--stackSize]];
+                for (std::uint32_t child : { node.left, node.right }) {
+                    if (child & kLeafFlag) {
+                        std::uint32_t other = child & ~kLeafFlag;
+                        if (other > leaf && leafBounds_[other].Intersects(bounds)) {
+                            taskPairs.emplace_back(MakePairKey(leafIDs_[leaf], leafIDs_[other]));
+                        }
+                    }
+                    else if (nodes_[child].last > leaf && nodes_[child].aabb.Intersects(bounds)) {
+                        assert(stackSize < kStackSize);
+                        stack[stackSize++] = child;
+                    }
+                }
+            }
+        }
+        });
+    size_t total = pairs.size();
+    for (std::uint32_t task = 0; task < taskCount; ++task) {
+        total += taskPairs_[task].size();
+    }
+    pairs.reserve(total);
+    for (std::uint32_t task = 0; task < taskCount; ++task) {
+        pairs.insert(pairs.end(), taskPairs_[task].begin(), taskPairs_[task].end());
+    }
+}
+
+void LinearBVHBroadphase::Query(const AABB& bounds, std::vector<std::uint32_t>& ids) const {
+    // 移動後に作り直していなければ木が古いので全て調べる
+    if (isDirty_) {
+        for (const auto& entry : entries_) {
+            if (entry.aabb.Intersects(bounds)) {
+                ids.emplace_back(entry.id);
+            }
+        }
+        return;
+    }
+    Traverse(
+        [&](const AABB& aabb) { return aabb.Intersects(bounds); },
+        [&](std::uint32_t leaf) { ids.emplace_back(leafIDs_[leaf]); });
+}
+
+void LinearBVHBroadphase::Raycast(const Vector3& origin, const Vector3& direction, float maxDistance, std::vector<std::uint32_t>& ids) const {
+    auto overlap = [&](const AABB& aabb) {
+        float tMin = 0.0f, tMax = maxDistance;
+        return aabb.IntersectsRay(origin, direction, tMin, tMax);
+    };
+    if (isDirty_) {
+        for (const auto& entry : entries_) {
+            if (overlap(entry.aabb)) {
+                ids.emplace_back(entry.id);
+            }
+        }
+        return;
+    }
+    Traverse(overlap, [&](std::uint32_t leaf) { ids.emplace_back(leafIDs_[leaf]); });
+}
+
+size_t LinearBVHBroadphase::GetMemoryUsage() const {
+    size_t taskPairs = GetCapacityBytes(taskPairs_);
+    for (const auto& pairs : taskPairs_) {
+        taskPairs += GetCapacityBytes(pairs);
+    }
+    return
+        GetCapacityBytes(entries_) +
+        GetCapacityBytes(idToIndex_) +
+        GetCapacityBytes(codes_) +
+        GetCapacityBytes(order_) +
+        GetCapacityBytes(sortCodes_) +
+        GetCapacityBytes(sortOrder_) +
+        GetCapacityBytes(histograms_) +
+        GetCapacityBytes(taskBounds_) +
+        GetCapacityBytes(leafBounds_) +
+        GetCapacityBytes(leafIDs_) +
+        GetCapacityBytes(leafParents_) +
+        GetCapacityBytes(nodes_) +
+        GetCapacityBytes(visitCounts_) +
+        taskPairs;
+}
+
+void LinearBVHBroadphase::Rebuild() {
+    if (!isDirty_) {
+        return;
+    }
+    isDirty_ = false;
+    std::uint32_t count = static_cast<std::uint32_t>(entries_.size());
+    // 配列は毎回作り直さず使い回す
+    codes_.resize(count);
+    order_.resize(count);
+    sortCodes_.resize(count);
+    sortOrder_.resize(count);
+    leafBounds_.resize(count);
+    leafIDs_.resize(count);
+    leafParents_.resize(count);
+    nodes_.resize(count > 0 ? count - 1 : 0);
+    visitCounts_.resize(nodes_.size());
+    if (count == 0) {
+        return;
+    }
+    std::uint32_t taskCount = (count + kTaskSize - 1) / kTaskSize;
+
+    ComputeMortonCodes(taskCount);
+    SortMortonCodes(taskCount);
+
+    if (count == 1) {
+        leafBounds_[0] = entries_[0].aabb;
+        leafIDs_[0] = entries_[0].id;
+        leafParents_[0] = kInvalidIndex;
+        return;
+    }
+    nodes_[0].parent = kInvalidIndex;
+    threadPool_.ParallelFor(taskCount, [&](std::uint32_t task) {
+        std::uint32_t end = std::min((task + 1) * kTaskSize, count);
+        for (std::uint32_t i = task * kTaskSize; i < end; ++i) {
+            const Entry& entry = entries_[order_[i]];
+            leafBounds_[i] = entry.aabb;
+            leafIDs_[i] = entry.id;
+            if (i + 1 < count) {
+                visitCounts_[i] = 0;
+                BuildNode(i);
+            }
+        }
+        });
+    threadPool_.ParallelFor(taskCount, [&](std::uint32_t task) {
+        std::uint32_t end = std::min((task + 1) * kTaskSize, count);
+        for (std::uint32_t i = task * kTaskSize; i < end; ++i) {
+            ComputeBounds(i);
+        }
+        });
+}
+
+void LinearBVHBroadphase::ComputeMortonCodes(std::uint32_t taskCount) {
+    std::uint32_t count = static_cast<std::uint32_t>(entries_.size());
+    // 中心の範囲
+    taskBounds_.resize(taskCount);
+    threadPool_.ParallelFor(taskCount, [&](std::uint32_t task) {
+        AABB bounds;
+        std::uint32_t end = std::min((task + 1) * kTaskSize, count);
+        for (std::uint32_t i = task * kTaskSize; i < end; ++i) {
+            bounds.Include(entries_[i].aabb.Center());
+        }
+        taskBounds_[task] = bounds;
+        });
+    AABB centerBounds;
+    for (std::uint32_t task = 0; task < taskCount; ++task) {
+        centerBounds.Include(taskBounds_[task]);
+    }
+
+    bool is63Bit = mortonBits_ == MortonBits::k63;
+    float maxCell = is63Bit ? static_cast<float>((1 << 21) - 1) : static_cast<float>((1 << 10) - 1);
+    Vector3 scale;
+    for (size_t axis = 0; axis < 3; ++axis) {
+        float extent = centerBounds.Extent(axis);
+        scale[axis] = extent > 0.0f ? maxCell / extent : 0.0f;
+    }
+    threadPool_.ParallelFor(taskCount, [&](std::uint32_t task) {
+        std::uint32_t end = std::min((task + 1) * kTaskSize, count);
+        for (std::uint32_t i = task * kTaskSize; i < end; ++i) {
+            Vector3 cell = Vector3::Scale(entries_[i].aabb.Center() - centerBounds.min, scale);
+            std::uint64_t x = static_cast<std::uint64_t>(std::clamp(cell.x, 0.0f, maxCell));
+            std::uint64_t y = static_cast<std::uint64_t>(std::clamp(cell.y, 0.0f, maxCell));
+            std::uint64_t z = static_cast<std::uint64_t>(std::clamp(cell.z, 0.0f, maxCell));
+            codes_[i] = is63Bit ?
+                (ExpandBits21(x) << 2) | (ExpandBits21(y) << 1) | ExpandBits21(z) :
+                (ExpandBits10(x) << 2) | (ExpandBits10(y) << 1) | ExpandBits10(z);
+            order_[i] = i;
+        }
+        });
+}
+
+void LinearBVHBroadphase::SortMortonCodes(std::uint32_t taskCount) {
+    std::uint32_t count = static_cast<std::uint32_t>(entries_.size());
+    std::uint32_t bitCount = mortonBits_ == MortonBits::k63 ? 63 : 30;
+    histograms_.resize(static_cast<size_t>(taskCount) * kRadixSize);
+    for (std::uint32_t shift = 0; shift < bitCount; shift += kRadixBits) {
+        threadPool_.ParallelFor(taskCount, [&](std::uint32_t task) {
+            std::uint32_t* histogram = histograms_.data() + static_cast<size_t>(task) * kRadixSize;
+            std::fill(histogram, histogram + kRadixSize, 0);
+            std::uint32_t end = std::min((task + 1) * kTaskSize, count);
+            for (std::uint32_t i = task * kTaskSize; i < end; ++i) {
+                ++histogram[(codes_[i] >> shift) & (kRadixSize - 1)];
+            }
+            });
+        // 桁ごと、その中でタスク順に書き込み先を決める（安定）
+        std::uint32_t offset = 0;
+        bool isUniform = false;
+        for (std::uint32_t digit = 0; digit < kRadixSize; ++digit) {
+            std::uint32_t digitStart = offset;
+            for (std::uint32_t task = 0; task < taskCount; ++task) {
+                std::uint32_t& bucket = histograms_[static_cast<size_t>(task) * kRadixSize + digit];
+                std::uint32_t bucketCount = bucket;
+                bucket = offset;
+                offset += bucketCount;
+            }
+            if (offset - digitStart == count) {
+                isUniform = true;
+            }
+        }
+        // 全て同じ桁なら並びは変わらない
+        if (isUniform) {
+            continue;
+        }
+        threadPool_.ParallelFor(taskCount, [&](std::uint32_t task) {
+            std::uint32_t* histogram = histograms_.data() + static_cast<size_t>(task) * kRadixSize;
+            std::uint32_t end = std::min((task + 1) * kTaskSize, count);
+            for (std::uint32_t i = task * kTaskSize; i < end; ++i) {
+                std::uint32_t destination = histogram[(codes_[i] >> shift) & (kRadixSize - 1)]++;
+                sortCodes_[destination] = codes_[i];
+                sortOrder_[destination] = order_[i];
+            }
+            });
+        codes_.swap(sortCodes_);
+        order_.swap(sortOrder_);
+    }
+}
+
+void LinearBVHBroadphase::BuildNode(std::uint32_t index) {
+    std::int64_t i = index;
+    // 範囲の向き
+    std::int64_t d = Delta(i, i + 1) - Delta(i, i - 1) > 0 ? 1 : -1;
+    // 範囲の長さの上限を倍々で探し、二分探索で詰める
+    std::int32_t deltaMin = Delta(i, i - d);
+    std::int64_t lengthMax = 2;
+    while (Delta(i, i + lengthMax * d) > deltaMin) {
+        lengthMax *= 2;
+    }
+    std::int64_t length = 0;
+    for (std::int64_t t = lengthMax / 2; t > 0; t /= 2) {
+        if (Delta(i, i + (length + t) * d) > deltaMin) {
+            length += t;
+        }
+    }
+    std::int64_t j = i + length * d;
+    // 接頭辞が変わる位置で分ける
+    std::int32_t deltaNode = Delta(i, j);
+    std::int64_t split = 0;
+    std::int64_t t = length;
+    do {
+        t = (t + 1) / 2;
+        if (Delta(i, i + (split + t) * d) > deltaNode) {
+            split += t;
+        }
+    } while (t > 1);
+    std::uint32_t gamma = static_cast<std::uint32_t>(i + split * d + std::min<std::int64_t>(d, 0));
+    std::uint32_t first = static_cast<std::uint32_t>(std::min(i, j));
+    std::uint32_t last = static_cast<std::uint32_t>(std::max(i, j));
+
+    Node& node = nodes_[index];
+    node.last = last;
+    if (first == gamma) {
+        node.left = gamma | kLeafFlag;
+        leafParents_[gamma] = index;
+    }
+    else {
+        node.left = gamma;
+        nodes_[gamma].parent = index;
+    }
+    if (last == gamma + 1) {
+        node.right = (gamma + 1) | kLeafFlag;
+        leafParents_[gamma + 1] = index;
+    }
+    else {
+        node.right = gamma + 1;
+        nodes_[gamma + 1].parent = index;
+    }
+}
+
+void LinearBVHBroadphase::ComputeBounds(std::uint32_t leaf) {
+    std::uint32_t index = leafParents_[leaf];
+    while (index != kInvalidIndex) {
+        // 先に着いた方は兄弟の範囲がまだ無いので戻る
+        std::atomic_ref<std::uint32_t> visitCount(visitCounts_[index]);
+        if (visitCount.fetch_add(1, std::memory_order_acq_rel) == 0) {
+            return;
+        }
+        Node& node = nodes_[index];
+        node.aabb = GetBounds(node.left);
+        node.aabb.Include(GetBounds(node.right));
+        index = node.parent;
+    }
+}
+
+std::int32_t LinearBVHBroadphase::Delta(std::int64_t i, std::int64_t j) const {
+    if (j < 0 || j >= static_cast<std::int64_t>(codes_.size())) {
+        return -1;
+    }
+    std::uint64_t x = codes_[i] ^ codes_[j];
+    if (x == 0) {
+        return 64 + std::countl_zero(static_cast<std::uint32_t>(i ^ j));
+    }
+    return std::countl_zero(x);
+}
+
+const AABB& LinearBVHBroadphase::GetBounds(std::uint32_t child) const {
+    return (child & kLeafFlag) ? leafBounds_[child & ~kLeafFlag] : nodes_[child].aabb;
+}
+
+template<class Overlap, class Func>
+void LinearBVHBroadphase::Traverse(Overlap&& overlap, Func&& func) const {
+    if (leafBounds_.empty()) {
+        return;
+    }
+    if (nodes_.empty()) {
+        if (overlap(leafBounds_[0])) {
+            func(0);
+        }
+        return;
+    }
+    std::uint32_t stack[kStackSize];
+    std::uint32_t stackSize = 0;
+    stack[stackSize++] = 0;
+    while (stackSize > 0) {
+        const Node& node = nodes_[stack[--stackSize]];
+        if (!overlap(node.aabb)) {
+            continue;
+        }
+        for (std::uint32_t child : { node.left, node.right }) {
+            if (child & kLeafFlag) {
+                if (overlap(leafBounds_[child & ~kLeafFlag])) {
+                    func(child & ~kLeafFlag);
+                }
+            }
+            else {
+                assert(stackSize < kStackSize);
+                stack[stackSize++] = child;
+            }
+        }
+    }
+}
@@ -0,0 +1,94 @@
+#pragma once
+#include "Broadphase.hpp"
+
+#include "../ThreadPool.hpp"
+
+// 線形BVH。AABBの中心のMorton符号で要素を並べ、Karrasの方法で階層を並列に作る
+// 更新はせず、移動があったフレームに全て作り直す。ほとんどが動く場面で木の更新より安い
+class LinearBVHBroadphase :
+    public Broadphase {
+public:
+    enum class MortonBits {
+        k30,    // 1軸10ビット。並べ替えが速い
+        k63     // 1軸21ビット。広い場面で中心が同じ符号に潰れにくい
+    };
+
+    // 1タスクで扱う要素数
+    static constexpr std::uint32_t kTaskSize = 4096;
+
+    explicit LinearBVHBroadphase(MortonBits mortonBits = MortonBits::k30, ThreadPool& threadPool = ThreadPool::GetShared());
+
+    void Insert(std::uint32_t id, const AABB& aabb) override;
+    void Remove(std::uint32_t id) override;
+    void Move(std::uint32_t id, const AABB& aabb) override;
+    void Clear() override;
+
+    void ComputePairs(std::vector<std::uint64_t>& pairs) override;
+    void Query(const AABB& bounds, std::vector<std::uint32_t>& ids) const override;
+    void Raycast(const Vector3& origin, const Vector3& direction, float maxDistance, std::vector<std::uint32_t>& ids) const override;
+
+    BroadphaseType GetType() const override { return BroadphaseType::kLinearBVH; }
+    std::uint32_t GetCount() const override { return static_cast<std::uint32_t>(entries_.size()); }
+    size_t GetMemoryUsage() const override;
+
+    // 移動がなければ何もしない。ComputePairsが呼ぶ
+    void Rebuild();
+
+private:
+    static constexpr std::uint32_t kInvalidIndex = 0xFFFFFFFF;
+    // 子の番号にこれが立っていれば葉
+    static constexpr std::uint32_t kLeafFlag = 0x80000000;
+    // 深さは符号のビット数と要素番号のビット数で抑えられる
+    static constexpr std::uint32_t kStackSize = 128;
+    static constexpr std::uint32_t kRadixBits = 8;
+    static constexpr std::uint32_t kRadixSize = 1 << kRadixBits;
+
+    struct Entry {
+        AABB aabb;
+        std::uint32_t id;
+    };
+    // 内部ノード。根は0番
+    struct Node {
+        AABB aabb;
+        std::uint32_t left;
+        std::uint32_t right;
+        std::uint32_t parent;
+        std::uint32_t last;     // 子孫の葉の最後の番号
+    };
+
+    void ComputeMortonCodes(std::uint32_t taskCount);
+    // 符号と要素番号の組を下位の桁から並べ替える。桁ごとにタスク別の度数を数えて散らす
+    void SortMortonCodes(std::uint32_t taskCount);
+    void BuildNode(std::uint32_t index);
+    // 葉から根へ。2番目に着いた方が親の範囲を求めて上がる
+    void ComputeBounds(std::uint32_t leaf);
+    // 符号の共通接頭辞の長さ。範囲外は-1、同じ符号なら要素番号で続ける
+    std::int32_t Delta(std::int64_t i, std::int64_t j) const;
+    const AABB& GetBounds(std::uint32_t child) const;
+
+    template<class Overlap, class Func>
+    void Traverse(Overlap&& overlap, Func&& func) const;
+
+    ThreadPool& threadPool_;
+    MortonBits mortonBits_;
+
+    std::vector<Entry> entries_;
+    std::vector<std::uint32_t> idToIndex_;
+
+    std::vector<std::uint64_t> codes_;
+    std::vector<std::uint32_t> order_;
+    std::vector<std::uint64_t> sortCodes_;
+    std::vector<std::uint32_t> sortOrder_;
+    std::vector<std::uint32_t> histograms_;
+    std::vector<AABB> taskBounds_;
+
+    // Morton順の葉
+    std::vector<AABB> leafBounds_;
+    std::vector<std::uint32_t> leafIDs_;
+    std::vector<std::uint32_t> leafParents_;
+    std::vector<Node> nodes_;
+    // ComputeBoundsで親に着いた数
+    std::vector<std::uint32_t> visitCounts_;
+    std::vector<std::vector<std::uint64_t>> taskPairs_;
+    bool isDirty_;
+};
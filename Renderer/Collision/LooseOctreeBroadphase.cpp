@@ -0,0 +1,289 @@
+#include "LooseOctreeBroadphase.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cmath>
+
+LooseOctreeBroadphase::LooseOctreeBroadphase(const AABB& worldBounds, float looseness, std::uint32_t maxDepth) :
+    worldMin_(worldBounds.min),
+    rootSize_(std::max({ worldBounds.Extent(0), worldBounds.Extent(1), worldBounds.Extent(2) })),
+    looseness_(looseness),
+    maxDepth_(std::min(maxDepth, kMaxDepthLimit)),
+    depthCounts_{},
+    isDirty_(false) {
+    assert(looseness > 1.0f);
+}
+
+void LooseOctreeBroadphase::Insert(std::uint32_t id, const AABB& aabb) {
+    if (id >= idToIndex_.size()) {
+        idToIndex_.resize(id + 1, kInvalidIndex);
+    }
+    assert(idToIndex_[id] == kInvalidIndex);
+    idToIndex_[id] = static_cast<std::uint32_t>(entries_.size());
+    entries_.push_back({ aabb, id });
+    isDirty_ = true;
+}
+
+void LooseOctreeBroadphase::Remove(std::uint32_t id) {
+    assert(id < idToIndex_.size() && idToIndex_[id] != kInvalidIndex);
+    std::uint32_t index = idToIndex_[id];
+    entries_[index] = entries_.back();
+    idToIndex_[entries_[index].id] = index;
+    entries_.pop_back();
+    idToIndex_[id] = kInvalidIndex;
+    isDirty_ = true;
+}
+
+void LooseOctreeBroadphase::Move(std::uint32_t id, const AABB& aabb) {
+    assert(id < idToIndex_.size() && idToIndex_[id] != kInvalidIndex);
+    entries_[idToIndex_[id]].aabb = aabb;
+    isDirty_ = true;
+}
+
+void LooseOctreeBroadphase::Clear() {
+    entries_.clear();
+    idToIndex_.clear();
+    placements_.clear();
+    nodes_.clear();
+    table_.clear();
+    std::fill(std::begin(depthCounts_), std::end(depthCounts_), 0);
+    isDirty_ = false;
+}
+
+void LooseOctreeBroadphase::ComputePairs(std::vector<std::uint64_t>& pairs) {
+    Rebuild();
+    auto testNodes = [&](const Node& nodeA, const Node& nodeB) {
+        for (std::uint32_t i = 0; i < nodeA.count; ++i) {
+            const Entry& entryA = entries_[placements_[nodeA.begin + i].entry];
+            for (std::uint32_t j = 0; j < nodeB.count; ++j) {
+                const Entry& entryB = entries_[placements_[nodeB.begin + j].entry];
+                if (entryA.aabb.Intersects(entryB.aabb)) {
+                    pairs.emplace_back(MakePairKey(entryA.id, entryB.id));
+                }
+            }
+        }
+    };
+    // 同じ深さでルーズ範囲が重なり得るセルの差
+    std::int32_t reach = static_cast<std::int32_t>(std::ceil(looseness_ - 1.0f));
+
+    // ノード単位で近傍を引く。浅いノードとは深い側からだけ調べる
+    for (const auto& node : nodes_) {
+        std::uint32_t depth;
+        std::int32_t cell[3];
+        DecodeNodeKey(node.key, depth, cell);
+        std::int32_t cellCount = 1 << depth;
+
+        // ノード内
+        for (std::uint32_t i = 0; i < node.count; ++i) {
+            const Entry& entryA = entries_[placements_[node.begin + i].entry];
+            for (std::uint32_t j = i + 1; j < node.count; ++j) {
+                const Entry& entryB = entries_[placements_[node.begin + j].entry];
+                if (entryA.aabb.Intersects(entryB.aabb)) {
+                    pairs.emplace_back(MakePairKey(entryA.id, entryB.id));
+                }
+            }
+        }
+        // 同じ深さはキーが大きい側の近傍とだけ調べる
+        for (std::int32_t z = std::max(cell[2] - reach, 0); z <= std::min(cell[2] + reach, cellCount - 1); ++z) {
+            for (std::int32_t y = std::max(cell[1] - reach, 0); y <= std::min(cell[1] + reach, cellCount - 1); ++y) {
+                for (std::int32_t x = std::max(cell[0] - reach, 0); x <= std::min(cell[0] + reach, cellCount - 1); ++x) {
+                    std::uint64_t key = MakeNodeKey(depth, x, y, z);
+                    if (key <= node.key) {
+                        continue;
+                    }
+                    std::uint32_t other = FindNode(key);
+                    if (other != kInvalidIndex) {
+                        testNodes(node, nodes_[other]);
+                    }
+                }
+            }
+        }
+        // 浅い深さ。このノードのルーズ範囲と重なるセル
+        if (depth == 0) {
+            continue;
+        }
+        float cellSize = rootSize_ / static_cast<float>(cellCount);
+        float margin = (looseness_ - 1.0f) * cellSize * 0.5f;
+        AABB looseBounds;
+        for (size_t axis = 0; axis < 3; ++axis) {
+            looseBounds.min[axis] = worldMin_[axis] + static_cast<float>(cell[axis]) * cellSize - margin;
+            looseBounds.max[axis] = looseBounds.min[axis] + cellSize + margin * 2.0f;
+        }
+        ForEachNode(looseBounds, depth - 1, [&](const Node& other) { testNodes(node, other); });
+    }
+}
+
+void LooseOctreeBroadphase::Query(const AABB& bounds, std::vector<std::uint32_t>& ids) const {
+    // 移動後に作り直していなければ配置が古いので全て調べる
+    if (isDirty_) {
+        for (const auto& entry : entries_) {
+            if (entry.aabb.Intersects(bounds)) {
+                ids.emplace_back(entry.id);
+            }
+        }
+        return;
+    }
+    ForEachNode(bounds, maxDepth_, [&](const Node& node) {
+        for (std::uint32_t i = 0; i < node.count; ++i) {
+            const Entry& entry = entries_[placements_[node.begin + i].entry];
+            if (entry.aabb.Intersects(bounds)) {
+                ids.emplace_back(entry.id);
+            }
+        }
+        });
+}
+
+void LooseOctreeBroadphase::Raycast(const Vector3& origin, const Vector3& direction, float maxDistance, std::vector<std::uint32_t>& ids) const {
+    auto test = [&](const Entry& entry) {
+        float tMin = 0.0f, tMax = maxDistance;
+        if (entry.aabb.IntersectsRay(origin, direction, tMin, tMax)) {
+            ids.emplace_back(entry.id);
+        }
+    };
+    if (isDirty_ || !std::isfinite(maxDistance)) {
+        for (const auto& entry : entries_) {
+            test(entry);
+        }
+        return;
+    }
+    // 線分を包むAABBで候補を絞る
+    AABB bounds(origin);
+    bounds.Include(origin + direction * maxDistance);
+    ForEachNode(bounds, maxDepth_, [&](const Node& node) {
+        for (std::uint32_t i = 0; i < node.count; ++i) {
+            test(entries_[placements_[node.begin + i].entry]);
+        }
+        });
+}
+
+size_t LooseOctreeBroadphase::GetMemoryUsage() const {
+    return
+        GetCapacityBytes(entries_) +
+        GetCapacityBytes(idToIndex_) +
+        GetCapacityBytes(placements_) +
+        GetCapacityBytes(nodes_) +
+        GetCapacityBytes(table_);
+}
+
+std::uint32_t LooseOctreeBroadphase::ComputeDepth(const AABB& aabb) const {
+    // 大きさが(looseness - 1)倍のセルに収まる最も深い深さ
+    Vector3 extent = aabb.Extent();
+    float size = std::max({ extent.x, extent.y, extent.z });
+    if (size <= 0.0f) {
+        return maxDepth_;
+    }
+    float ratio = (looseness_ - 1.0f) * rootSize_ / size;
+    if (ratio < 2.0f) {
+        return 0;
+    }
+    return std::min(static_cast<std::uint32_t>(std::ilogb(ratio)), maxDepth_);
+}
+
+std::int32_t LooseOctreeBroadphase::ToCell(float x, float min, float cellSize, std::int32_t cellCount) const {
+    float cell = std::floor((x - min) / cellSize);
+    return static_cast<std::int32_t>(std::clamp(cell, 0.0f, static_cast<float>(cellCount - 1)));
+}
+
+std::uint64_t LooseOctreeBroadphase::MakeNodeKey(std::uint32_t depth, std::int32_t x, std::int32_t y, std::int32_t z) {
+    return
+        (static_cast<std::uint64_t>(depth) << 48) |
+        (static_cast<std::uint64_t>(x) << 32) |
+        (static_cast<std::uint64_t>(y) << 16) |
+        static_cast<std::uint64_t>(z);
+}
+
+void LooseOctreeBroadphase::Rebuild() {
+    if (!isDirty_) {
+        return;
+    }
+    // 配列は作り直さず中身だけ入れ替える
+    placements_.clear();
+    nodes_.clear();
+    std::fill(std::begin(depthCounts_), std::end(depthCounts_), 0);
+    for (std::uint32_t i = 0; i < entries_.size(); ++i) {
+        const AABB& aabb = entries_[i].aabb;
+        std::uint32_t depth = ComputeDepth(aabb);
+        std::int32_t cellCount = 1 << depth;
+        float cellSize = rootSize_ / static_cast<float>(cellCount);
+        Vector3 center = aabb.Center();
+        std::uint64_t key = MakeNodeKey(depth,
+            ToCell(center.x, worldMin_.x, cellSize, cellCount),
+            ToCell(center.y, worldMin_.y, cellSize, cellCount),
+            ToCell(center.z, worldMin_.z, cellSize, cellCount));
+        placements_.push_back({ key, i });
+        ++depthCounts_[depth];
+    }
+    std::sort(placements_.begin(), placements_.end(),
+        [](const Placement& lhs, const Placement& rhs) { return lhs.key < rhs.key; });
+
+    for (std::uint32_t i = 0; i < placements_.size(); ++i) {
+        if (nodes_.empty() || nodes_.back().key != placements_[i].key) {
+            nodes_.push_back({ placements_[i].key, i, 0 });
+        }
+        ++nodes_.back().count;
+    }
+
+    // ノード数の2倍以上の2の累乗
+    size_t tableSize = std::bit_ceil(std::max<size_t>(nodes_.size() * 2, 16));
+    table_.assign(tableSize, kInvalidIndex);
+    size_t mask = tableSize - 1;
+    for (std::uint32_t i = 0; i < nodes_.size(); ++i) {
+        size_t slot = static_cast<size_t>((nodes_[i].key * 0x9E3779B97F4A7C15ull) >> 32) & mask;
+        while (table_[slot] != kInvalidIndex) {
+            slot = (slot + 1) & mask;
+        }
+        table_[slot] = i;
+    }
+    isDirty_ = false;
+}
+
+std::uint32_t LooseOctreeBroadphase::FindNode(std::uint64_t key) const {
+    size_t mask = table_.size() - 1;
+    size_t slot = static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> 32) & mask;
+    while (table_[slot] != kInvalidIndex) {
+        if (nodes_[table_[slot]].key == key) {
+            return table_[slot];
+        }
+        slot = (slot + 1) & mask;
+    }
+    return kInvalidIndex;
+}
+
+void LooseOctreeBroadphase::DecodeNodeKey(std::uint64_t key, std::uint32_t& depth, std::int32_t (&cell)[3]) {
+    depth = static_cast<std::uint32_t>(key >> 48);
+    cell[0] = static_cast<std::int32_t>((key >> 32) & 0xFFFF);
+    cell[1] = static_cast<std::int32_t>((key >> 16) & 0xFFFF);
+    cell[2] = static_cast<std::int32_t>(key & 0xFFFF);
+}
+
+template<class Func>
+void LooseOctreeBroadphase::ForEachNode(const AABB& bounds, std::uint32_t maxDepth, Func&& func) const {
+    if (nodes_.empty()) {
+        return;
+    }
+    for (std::uint32_t depth = 0; depth <= maxDepth; ++depth) {
+        if (depthCounts_[depth] == 0) {
+            continue;
+        }
+        std::int32_t cellCount = 1 << depth;
+        float cellSize = rootSize_ / static_cast<float>(cellCount);
+        // ルーズ範囲はセルの両側に(looseness - 1) / 2ずつ広い
+        float margin = (looseness_ - 1.0f) * cellSize * 0.5f;
+        std::int32_t min[3], max[3];
+        for (size_t axis = 0; axis < 3; ++axis) {
+            min[axis] = ToCell(bounds.min[axis] - margin, worldMin_[axis], cellSize, cellCount);
+            max[axis] = ToCell(bounds.max[axis] + margin, worldMin_[axis], cellSize, cellCount);
+        }
+        for (std::int32_t z = min[2]; z <= max[2]; ++z) {
+            for (std::int32_t y = min[1]; y <= max[1]; ++y) {
+                for (std::int32_t x = min[0]; x <= max[0]; ++x) {
+                    std::uint32_t node = FindNode(MakeNodeKey(depth, x, y, z));
+                    if (node != kInvalidIndex) {
+                        func(nodes_[node]);
+                    }
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include "Broadphase.hpp"
+
+// ルーズ八分木。ノードの範囲をlooseness倍に広げ、要素は大きさで決まる深さの
+// 中心を含むセルに置く（O(1)）。重なり得るのは同じ深さの隣接セルか浅い深さのセルだけ
+// 配置は移動があったフレームに作り直し、ノードの要素は連続した配列に並べる
+class LooseOctreeBroadphase :
+    public Broadphase {
+public:
+    static constexpr std::uint32_t kMaxDepthLimit = 16;
+
+    // loosenessは1より大きい値。2なら要素の大きさがセルの大きさまで入る
+    explicit LooseOctreeBroadphase(const AABB& worldBounds = AABB(Vector3(-1024.0f), Vector3(1024.0f)), float looseness = 2.0f, std::uint32_t maxDepth = 8);
+
+    void Insert(std::uint32_t id, const AABB& aabb) override;
+    void Remove(std::uint32_t id) override;
+    void Move(std::uint32_t id, const AABB& aabb) override;
+    void Clear() override;
+
+    void ComputePairs(std::vector<std::uint64_t>& pairs) override;
+    void Query(const AABB& bounds, std::vector<std::uint32_t>& ids) const override;
+    void Raycast(const Vector3& origin, const Vector3& direction, float maxDistance, std::vector<std::uint32_t>& ids) const override;
+
+    BroadphaseType GetType() const override { return BroadphaseType::kLooseOctree; }
+    std::uint32_t GetCount() const override { return static_cast<std::uint32_t>(entries_.size()); }
+    size_t GetMemoryUsage() const override;
+
+    std::uint32_t GetNodeCount() const { return static_cast<std::uint32_t>(nodes_.size()); }
+
+private:
+    static constexpr std::uint32_t kInvalidIndex = 0xFFFFFFFF;
+
+    struct Entry {
+        AABB aabb;
+        std::uint32_t id;
+    };
+    // ノードのキー順に並べた要素
+    struct Placement {
+        std::uint64_t key;
+        std::uint32_t entry;
+    };
+    struct Node {
+        std::uint64_t key;
+        std::uint32_t begin;    // placements_の範囲
+        std::uint32_t count;
+    };
+
+    std::uint32_t ComputeDepth(const AABB& aabb) const;
+    std::int32_t ToCell(float x, float min, float cellSize, std::int32_t cellCount) const;
+    static std::uint64_t MakeNodeKey(std::uint32_t depth, std::int32_t x, std::int32_t y, std::int32_t z);
+    static void DecodeNodeKey(std::uint64_t key, std::uint32_t& depth, std::int32_t (&cell)[3]);
+    void Rebuild();
+    std::uint32_t FindNode(std::uint64_t key) const;
+    // maxDepthまでの各深さで、ルーズ範囲がboundsと重なるノードについてfunc(node)を呼ぶ
+    template<class Func>
+    void ForEachNode(const AABB& bounds, std::uint32_t maxDepth, Func&& func) const;
+
+    Vector3 worldMin_;
+    float rootSize_;
+    float looseness_;
+    std::uint32_t maxDepth_;
+
+    std::vector<Entry> entries_;
+    std::vector<std::uint32_t> idToIndex_;
+    std::vector<Placement> placements_;
+    std::vector<Node> nodes_;
+    // キーからnodes_の番号を引く開番地法のハッシュ表
+    std::vector<std::uint32_t> table_;
+    std::uint32_t depthCounts_[kMaxDepthLimit + 1];
+    bool isDirty_;
+};
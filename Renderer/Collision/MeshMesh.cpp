@@ -0,0 +1,159 @@
+#include "MeshMesh.hpp"
+
+#include <algorithm>
+
+#include "../Math/SIMD.hpp"
+#include "../MeshCollider.hpp"
+#include "../Transform.hpp"
+
+using namespace SIMD;
+
+namespace {
+    // 平面からの距離をこれ以下なら平面上とみなす（法線の長さと辺の長さに対する比）
+    constexpr float kPlaneTolerance = 1.0e-5f;
+
+    // 頂点の平面からの距離。平面に近いものは0に寄せる
+    template<class F>
+    void PlaneDistances(const Vector3T<F> (&plane)[3], const Vector3T<F> (&vertices)[3], F (&distances)[3]) {
+        Vector3T<F> normal = Cross(plane[1] - plane[0], plane[2] - plane[0]);
+        F length = Sqrt(Dot(normal, normal));
+        F tolerance = F(kPlaneTolerance) * length * Sqrt(length);
+        for (size_t i = 0; i < 3; ++i) {
+            F distance = Dot(normal, vertices[i] - plane[0]);
+            distances[i] = Select(Abs(distance) <= tolerance, F(0.0f), distance);
+        }
+    }
+
+    // 三角形が相手の平面を横切る区間を交線方向の射影で求める
+    template<class F>
+    void PlaneInterval(const F (&projections)[3], const F (&distances)[3], F& min, F& max) {
+        min = F(Math::positiveInfinity);
+        max = F(-Math::positiveInfinity);
+        for (size_t i = 0; i < 3; ++i) {
+            // 平面上の頂点
+            auto isOnPlane = distances[i] == F(0.0f);
+            min = Select(isOnPlane, Min(min, projections[i]), min);
+            max = Select(isOnPlane, Max(max, projections[i]), max);
+            // 平面を横切る辺
+            size_t j = (i + 1) % 3;
+            auto isCrossing = distances[i] * distances[j] < F(0.0f);
+            F t = distances[i] / (distances[i] - distances[j]);
+            F crossing = projections[i] + (projections[j] - projections[i]) * t;
+            min = Select(isCrossing, Min(min, crossing), min);
+            max = Select(isCrossing, Max(max, crossing), max);
+        }
+    }
+
+    // Mollerの三角形同士の交差判定。分岐せずに全ての場合を計算して選ぶ
+    template<class F>
+    auto IntersectTriangles(const Vector3T<F> (&a)[3], const Vector3T<F> (&b)[3]) {
+        F distancesA[3], distancesB[3];
+        PlaneDistances(b, a, distancesA);
+        PlaneDistances(a, b, distancesB);
+        F zero(0.0f);
+        // 全ての頂点が相手の平面の片側にあれば離れている
+        auto isSeparated = Or(
+            Or(And(And(distancesA[0] > zero, distancesA[1] > zero), distancesA[2] > zero),
+                And(And(distancesA[0] < zero, distancesA[1] < zero), distancesA[2] < zero)),
+            Or(And(And(distancesB[0] > zero, distancesB[1] > zero), distancesB[2] > zero),
+                And(And(distancesB[0] < zero, distancesB[1] < zero), distancesB[2] < zero)));
+        // 同一平面なら交差として残す
+        auto isCoplanar = And(And(distancesA[0] == zero, distancesA[1] == zero), distancesA[2] == zero);
+
+        Vector3T<F> direction = Cross(Cross(a[1] - a[0], a[2] - a[0]), Cross(b[1] - b[0], b[2] - b[0]));
+        F projectionsA[3] = { Dot(direction, a[0]), Dot(direction, a[1]), Dot(direction, a[2]) };
+        F projectionsB[3] = { Dot(direction, b[0]), Dot(direction, b[1]), Dot(direction, b[2]) };
+        F minA, maxA, minB, maxB;
+        PlaneInterval(projectionsA, distancesA, minA, maxA);
+        PlaneInterval(projectionsB, distancesB, minB, maxB);
+        auto isOverlapping = Max(minA, minB) <= Min(maxA, maxB);
+        return And(Not(isSeparated), Or(isCoplanar, isOverlapping));
+    }
+
+    Vector3T<Float4> LoadVector(const float (&values)[3][Float4::kWidth]) {
+        return { Load<Float4>(values[0]), Load<Float4>(values[1]), Load<Float4>(values[2]) };
+    }
+}
+
+namespace MeshMesh {
+
+    void FindIntersectingTriangles(const MeshCollider& meshA, const MeshCollider& meshB, Scratch& scratch) {
+        auto& trianglePairs = scratch.trianglePairs;
+        trianglePairs.clear();
+        const BVH& bvhA = meshA.GetBVH();
+        const BVH& bvhB = meshB.GetBVH();
+        if (bvhA.IsEmpty() || bvhB.IsEmpty()) {
+            return;
+        }
+        // AのローカルからBを見る
+        Matrix4x4 bToA = meshB.GetTransform().GetWorldMatrix() * meshA.GetTransform().GetWorldMatrix().Inverse();
+
+        // 木を同時に辿る。葉でない側のうち大きい方を下る
+        const auto& nodesA = bvhA.GetNodes();
+        const auto& nodesB = bvhB.GetNodes();
+        const auto& indicesA = bvhA.GetIndices();
+        const auto& indicesB = bvhB.GetIndices();
+        auto& stack = scratch.nodePairs;
+        stack.clear();
+        stack.emplace_back(0, 0);
+        while (!stack.empty()) {
+            auto [indexA, indexB] = stack.back();
+            stack.pop_back();
+            const BVH::Node& nodeA = nodesA[indexA];
+            const BVH::Node& nodeB = nodesB[indexB];
+            AABB boundsB = nodeB.aabb.Transformed(bToA);
+            if (!nodeA.aabb.Intersects(boundsB)) {
+                continue;
+            }
+            if (nodeA.IsLeaf() && nodeB.IsLeaf()) {
+                for (std::uint32_t i = 0; i < nodeA.count; ++i) {
+                    for (std::uint32_t j = 0; j < nodeB.count; ++j) {
+                        trianglePairs.emplace_back(indicesA[nodeA.firstIndex + i], indicesB[nodeB.firstIndex + j]);
+                    }
+                }
+                continue;
+            }
+            if (nodeB.IsLeaf() || (!nodeA.IsLeaf() && nodeA.aabb.SurfaceArea() >= boundsB.SurfaceArea())) {
+                stack.emplace_back(nodeA.rightChild, indexB);
+                stack.emplace_back(indexA + 1, indexB);
+            }
+            else {
+                stack.emplace_back(indexA, nodeB.rightChild);
+                stack.emplace_back(indexA, indexB + 1);
+            }
+        }
+
+        // 4組ずつSoAに詰めて判定し、交差した組だけ前へ詰める
+        const auto& trianglesA = meshA.GetTriangles();
+        const auto& trianglesB = meshB.GetTriangles();
+        constexpr size_t kWidth = Float4::kWidth;
+        size_t pairCount = trianglePairs.size();
+        size_t hitCount = 0;
+        for (size_t first = 0; first < pairCount; first += kWidth) {
+            float lanesA[3][3][kWidth], lanesB[3][3][kWidth];
+            for (size_t lane = 0; lane < kWidth; ++lane) {
+                // 端数は最後の組で埋める
+                const TrianglePair& pair = trianglePairs[std::min(first + lane, pairCount - 1)];
+                const Triangle& triangleA = trianglesA[pair.first];
+                const Triangle& triangleB = trianglesB[pair.second];
+                for (size_t v = 0; v < 3; ++v) {
+                    Vector3 vertexB = triangleB.vertices[v] * bToA;
+                    for (size_t axis = 0; axis < 3; ++axis) {
+                        lanesA[v][axis][lane] = triangleA.vertices[v][axis];
+                        lanesB[v][axis][lane] = vertexB[axis];
+                    }
+                }
+            }
+            Vector3T<Float4> a[3] = { LoadVector(lanesA[0]), LoadVector(lanesA[1]), LoadVector(lanesA[2]) };
+            Vector3T<Float4> b[3] = { LoadVector(lanesB[0]), LoadVector(lanesB[1]), LoadVector(lanesB[2]) };
+            int mask = MoveMask(IntersectTriangles(a, b));
+            for (size_t lane = 0; lane < kWidth && first + lane < pairCount; ++lane) {
+                if (mask & (1 << lane)) {
+                    trianglePairs[hitCount++] = trianglePairs[first + lane];
+                }
+            }
+        }
+        trianglePairs.resize(hitCount);
+    }
+
+}
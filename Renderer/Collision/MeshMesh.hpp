@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+class MeshCollider;
+
+// 三角形メッシュ同士
+// Bの木のノードをAのローカル空間へ移しながら2つの木を同時に辿り、
+// 葉で出た三角形の組を4組ずつSIMDで交差判定する（Moller）
+namespace MeshMesh {
+
+    // 三角形の番号の組（A, B）
+    using TrianglePair = std::pair<std::uint32_t, std::uint32_t>;
+
+    struct Scratch {
+        std::vector<std::pair<std::uint32_t, std::uint32_t>> nodePairs;
+        std::vector<TrianglePair> trianglePairs;
+    };
+
+    // 交差する三角形の組をscratch.trianglePairsに書く
+    // 同一平面上の組は交差として残すので、呼び出し側でGJKなどにより確かめる
+    void FindIntersectingTriangles(const MeshCollider& meshA, const MeshCollider& meshB, Scratch& scratch);
+
+}
@@ -0,0 +1,290 @@
+#include "Narrowphase.hpp"
+
+#include "../Collider.hpp"
+#include "../DistanceFieldCollider.hpp"
+#include "../HeightfieldCollider.hpp"
+#include "../CompoundCollider.hpp"
+#include "../MeshCollider.hpp"
+#include "../Transform.hpp"
+
+namespace {
+    // 距離場で測るサポート点の数の上限
+    constexpr std::uint32_t kMaxProbeCount = 4;
+    // 向きがこれ以上変わらなければ測り終える（内積）
+    constexpr float kProbeTolerance = 0.9999f;
+
+    Vector3 GetInitialDirection(const AABB& aabbA, const AABB& aabbB) {
+        Vector3 direction = aabbB.Center() - aabbA.Center();
+        if (direction.LengthSquare() <= GJK::kAbsoluteTolerance) {
+            direction = Vector3::unitY;
+        }
+        return direction;
+    }
+
+    Triangle TransformTriangle(const Triangle& triangle, const Matrix4x4& matrix) {
+        return { { triangle.vertices[0] * matrix, triangle.vertices[1] * matrix, triangle.vertices[2] * matrix } };
+    }
+
+    // 交差する三角形の組をfuncに渡す。funcがtrueを返したら終える
+    template<class Func>
+    void ForEachMeshTrianglePair(const MeshCollider& meshA, const MeshCollider& meshB, Narrowphase::Scratch& scratch, Func&& func) {
+        MeshMesh::FindIntersectingTriangles(meshA, meshB, scratch.meshMesh);
+        const Matrix4x4& worldA = meshA.GetTransform().GetWorldMatrix();
+        const Matrix4x4& worldB = meshB.GetTransform().GetWorldMatrix();
+        for (const auto& [indexA, indexB] : scratch.meshMesh.trianglePairs) {
+            Triangle triangleA = TransformTriangle(meshA.GetTriangles()[indexA], worldA);
+            Triangle triangleB = TransformTriangle(meshB.GetTriangles()[indexB], worldB);
+            if (func(triangleA, triangleB)) {
+                return;
+            }
+        }
+    }
+
+    // 距離場と凸な部品。勾配に逆らう向きのサポート点を測り、その点の勾配で向きを直す
+    // contactの法線は距離場から部品へ向かい、pointBが部品の最も深い点
+    template<class Support>
+    bool ProbeDistanceField(const SignedDistanceField& field, const Matrix4x4& toLocal, const Support& support, const Vector3& center, Contact& contact) {
+        SignedDistanceField::Sample centerSample = field.Evaluate(center, toLocal);
+        Vector3 direction = -centerSample.gradient;
+        SignedDistanceField::Sample deepest = { Math::positiveInfinity, Vector3::unitY };
+        Vector3 deepestPoint;
+        for (std::uint32_t probe = 0; probe < kMaxProbeCount; ++probe) {
+            Vector3 point = support(direction);
+            SignedDistanceField::Sample sample = field.Evaluate(point, toLocal);
+            if (sample.distance < deepest.distance) {
+                deepest = sample;
+                deepestPoint = point;
+            }
+            if (Vector3::Dot(-sample.gradient, direction) >= kProbeTolerance) {
+                break;
+            }
+            direction = -sample.gradient;
+        }
+
+        // 中心まで入り込んだか、測った点が中心と逆の面に近いときは深くめり込んでいる
+        // 中心の勾配の向きに、中心から最も深い点までの長さと中心の距離の差だけ押し出す
+        if (centerSample.distance < 0.0f || Vector3::Dot(deepest.gradient, centerSample.gradient) < 0.0f) {
+            Vector3 point = support(-centerSample.gradient);
+            float depth = Vector3::Dot(center - point, centerSample.gradient) - centerSample.distance;
+            if (depth < 0.0f) {
+                return false;
+            }
+            contact.normal = centerSample.gradient;
+            contact.pointA = point + centerSample.gradient * depth;
+            contact.pointB = point;
+            contact.depth = depth;
+            return true;
+        }
+        if (deepest.distance > 0.0f) {
+            return false;
+        }
+        contact.normal = deepest.gradient;
+        contact.pointA = deepestPoint - deepest.gradient * deepest.distance;
+        contact.pointB = deepestPoint;
+        contact.depth = -deepest.distance;
+        return true;
+    }
+
+    // 相手を凸な部品に分け、最も深い接触を返す。法線は距離場から相手へ向かう
+    bool CollideDistanceField(const DistanceFieldCollider& fieldCollider, const Collider& other, Narrowphase::Scratch& scratch, Contact& contact) {
+        const SignedDistanceField& field = fieldCollider.GetField();
+        if (field.IsEmpty()) {
+            return false;
+        }
+        scratch.triangles.clear();
+        scratch.partsB.clear();
+        Narrowphase::CollectParts(other, fieldCollider.GetAABB(), scratch, scratch.partsB);
+        Matrix4x4 toLocal = fieldCollider.GetTransform().GetWorldMatrix().Inverse();
+        bool isHit = false;
+        contact.depth = -Math::positiveInfinity;
+        for (const auto& part : scratch.partsB) {
+            auto support = [&](const Vector3& direction) { return Narrowphase::FindPartFurthestPoint(part, scratch.triangles, direction); };
+            Contact partContact;
+            if (ProbeDistanceField(field, toLocal, support, part.aabb.Center(), partContact) && partContact.depth > contact.depth) {
+                contact = partContact;
+                isHit = true;
+            }
+        }
+        return isHit;
+    }
+
+    // 距離場はAでもBでもよい。Bなら向きを入れ替える。距離場同士は判定しない
+    bool CollideWithDistanceField(const Collider& colliderA, const Collider& colliderB, Narrowphase::Scratch& scratch, Contact& contact) {
+        if (colliderA.GetType() == Collider::Type::kDistanceField) {
+            return colliderB.GetType() != Collider::Type::kDistanceField &&
+                CollideDistanceField(static_cast<const DistanceFieldCollider&>(colliderA), colliderB, scratch, contact);
+        }
+        if (!CollideDistanceField(static_cast<const DistanceFieldCollider&>(colliderB), colliderA, scratch, contact)) {
+            return false;
+        }
+        contact.normal = -contact.normal;
+        std::swap(contact.pointA, contact.pointB);
+        return true;
+    }
+
+    bool IsDistanceFieldPair(const Collider& colliderA, const Collider& colliderB) {
+        return colliderA.GetType() == Collider::Type::kDistanceField || colliderB.GetType() == Collider::Type::kDistanceField;
+    }
+}
+
+namespace Narrowphase {
+
+    bool Collide(const Collider& colliderA, const Collider& colliderB, Scratch& scratch, Contact& contact) {
+        if (colliderA.IsConvex() && colliderB.IsConvex()) {
+            auto supportA = [&colliderA](const Vector3& direction) { return colliderA.FindFurthestPoint(direction); };
+            auto supportB = [&colliderB](const Vector3& direction) { return colliderB.FindFurthestPoint(direction); };
+            return CollideConvex(supportA, supportB, GetInitialDirection(colliderA.GetAABB(), colliderB.GetAABB()), contact);
+        }
+        if (IsDistanceFieldPair(colliderA, colliderB)) {
+            return CollideWithDistanceField(colliderA, colliderB, scratch, contact);
+        }
+        // 地形同士は判定しない
+        if (colliderA.GetType() == Collider::Type::kHeightfield && colliderB.GetType() == Collider::Type::kHeightfield) {
+            return false;
+        }
+        // メッシュ同士は交差した三角形の組だけ解く
+        if (colliderA.GetType() == Collider::Type::kMesh && colliderB.GetType() == Collider::Type::kMesh) {
+            bool isHit = false;
+            contact.depth = -Math::positiveInfinity;
+            ForEachMeshTrianglePair(static_cast<const MeshCollider&>(colliderA), static_cast<const MeshCollider&>(colliderB), scratch,
+                [&](const Triangle& triangleA, const Triangle& triangleB) {
+                    auto supportA = [&](const Vector3& direction) { return triangleA.FindFurthestPoint(direction); };
+                    auto supportB = [&](const Vector3& direction) { return triangleB.FindFurthestPoint(direction); };
+                    Contact triangleContact;
+                    if (CollideConvex(supportA, supportB, triangleB.Normal(), triangleContact) && triangleContact.depth > contact.depth) {
+                        contact = triangleContact;
+                        isHit = true;
+                    }
+                    return false;
+                });
+            return isHit;
+        }
+
+        scratch.triangles.clear();
+        scratch.partsA.clear();
+        scratch.partsB.clear();
+        CollectParts(colliderA, colliderB.GetAABB(), scratch, scratch.partsA);
+        if (scratch.partsA.empty()) {
+            return false;
+        }
+        CollectParts(colliderB, colliderA.GetAABB(), scratch, scratch.partsB);
+
+        const auto& triangles = scratch.triangles;
+        bool isHit = false;
+        contact.depth = -Math::positiveInfinity;
+        for (const auto& partA : scratch.partsA) {
+            auto supportA = [&](const Vector3& direction) { return FindPartFurthestPoint(partA, triangles, direction); };
+            for (const auto& partB : scratch.partsB) {
+                if (!partA.aabb.Intersects(partB.aabb)) {
+                    continue;
+                }
+                auto supportB = [&](const Vector3& direction) { return FindPartFurthestPoint(partB, triangles, direction); };
+                Contact partContact;
+                if (CollideConvex(supportA, supportB, GetInitialDirection(partA.aabb, partB.aabb), partContact) && partContact.depth > contact.depth) {
+                    contact = partContact;
+                    isHit = true;
+                }
+            }
+        }
+        return isHit;
+    }
+
+    bool Overlap(const Collider& colliderA, const Collider& colliderB, Scratch& scratch) {
+        if (colliderA.IsConvex() && colliderB.IsConvex()) {
+            auto supportA = [&colliderA](const Vector3& direction) { return colliderA.FindFurthestPoint(direction); };
+            auto supportB = [&colliderB](const Vector3& direction) { return colliderB.FindFurthestPoint(direction); };
+            return GJK::Intersect(supportA, supportB, GetInitialDirection(colliderA.GetAABB(), colliderB.GetAABB()));
+        }
+        // 距離場は1点を測れば終わるので、接触を求めて捨てる
+        if (IsDistanceFieldPair(colliderA, colliderB)) {
+            Contact contact;
+            return CollideWithDistanceField(colliderA, colliderB, scratch, contact);
+        }
+        if (colliderA.GetType() == Collider::Type::kHeightfield && colliderB.GetType() == Collider::Type::kHeightfield) {
+            return false;
+        }
+        if (colliderA.GetType() == Collider::Type::kMesh && colliderB.GetType() == Collider::Type::kMesh) {
+            bool isHit = false;
+            ForEachMeshTrianglePair(static_cast<const MeshCollider&>(colliderA), static_cast<const MeshCollider&>(colliderB), scratch,
+                [&](const Triangle& triangleA, const Triangle& triangleB) {
+                    auto supportA = [&](const Vector3& direction) { return triangleA.FindFurthestPoint(direction); };
+                    auto supportB = [&](const Vector3& direction) { return triangleB.FindFurthestPoint(direction); };
+                    isHit = GJK::Intersect(supportA, supportB, triangleB.Normal());
+                    return isHit;
+                });
+            return isHit;
+        }
+
+        scratch.triangles.clear();
+        scratch.partsA.clear();
+        scratch.partsB.clear();
+        CollectParts(colliderA, colliderB.GetAABB(), scratch, scratch.partsA);
+        if (scratch.partsA.empty()) {
+            return false;
+        }
+        CollectParts(colliderB, colliderA.GetAABB(), scratch, scratch.partsB);
+
+        // 最初に重なった部品の組で終える
+        const auto& triangles = scratch.triangles;
+        for (const auto& partA : scratch.partsA) {
+            auto supportA = [&](const Vector3& direction) { return FindPartFurthestPoint(partA, triangles, direction); };
+            for (const auto& partB : scratch.partsB) {
+                if (!partA.aabb.Intersects(partB.aabb)) {
+                    continue;
+                }
+                auto supportB = [&](const Vector3& direction) { return FindPartFurthestPoint(partB, triangles, direction); };
+                if (GJK::Intersect(supportA, supportB, GetInitialDirection(partA.aabb, partB.aabb))) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    void CollectParts(const Collider& collider, const AABB& bounds, Scratch& scratch, std::vector<ConvexPart>& parts) {
+        switch (collider.GetType()) {
+        case Collider::Type::kHeightfield:
+        case Collider::Type::kMesh:
+        {
+            size_t first = scratch.triangles.size();
+            if (collider.GetType() == Collider::Type::kHeightfield) {
+                static_cast<const HeightfieldCollider&>(collider).CollectTriangles(bounds, scratch.triangles);
+            }
+            else {
+                static_cast<const MeshCollider&>(collider).CollectTriangles(bounds, scratch.triangles);
+            }
+            for (size_t i = first; i < scratch.triangles.size(); ++i) {
+                const Triangle& triangle = scratch.triangles[i];
+                parts.push_back({ &collider, static_cast<std::uint32_t>(i), AABB(triangle.vertices[0], triangle.vertices[1], triangle.vertices[2]) });
+            }
+            break;
+        }
+        case Collider::Type::kCompound:
+        {
+            const auto& compound = static_cast<const CompoundCollider&>(collider);
+            scratch.indices.clear();
+            compound.QueryChildren(bounds, scratch.indices);
+            for (auto index : scratch.indices) {
+                parts.push_back({ &collider, index, compound.GetChildAABB(index) });
+            }
+            break;
+        }
+        default:
+            parts.push_back({ &collider, 0, collider.GetAABB() });
+            break;
+        }
+    }
+
+    Vector3 FindPartFurthestPoint(const ConvexPart& part, const std::vector<Triangle>& triangles, const Vector3& direction) {
+        switch (part.collider->GetType()) {
+        case Collider::Type::kHeightfield:
+        case Collider::Type::kMesh:
+            return triangles[part.index].FindFurthestPoint(direction);
+        case Collider::Type::kCompound:
+            return static_cast<const CompoundCollider*>(part.collider)->FindChildFurthestPoint(part.index, direction);
+        default:
+            return part.collider->FindFurthestPoint(direction);
+        }
+    }
+
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "../Math/MathUtils.hpp"
+#include "../AABB.hpp"
+#include "GJK.hpp"
+#include "EPA.hpp"
+#include "Triangle.hpp"
+#include "MeshMesh.hpp"
+
+class Collider;
+
+struct Contact {
+    Vector3 normal;     // AからBへ向かう法線
+    Vector3 pointA;
+    Vector3 pointB;
+    float depth;
+};
+
+namespace Narrowphase {
+
+    // 非凸なコライダーを分解した凸な部品
+    struct ConvexPart {
+        const Collider* collider;
+        std::uint32_t index;    // コンパウンドの子、または三角形の番号
+        AABB aabb;
+    };
+
+    // 判定の作業領域。毎フレーム確保しないように使い回す
+    struct Scratch {
+        std::vector<Triangle> triangles;
+        std::vector<ConvexPart> partsA;
+        std::vector<ConvexPart> partsB;
+        std::vector<std::uint32_t> indices;
+        MeshMesh::Scratch meshMesh;
+    };
+
+    // 凸形状同士。GJKで交差を判定しEPAで接触を求める
+    template<class SupportA, class SupportB>
+    bool CollideConvex(const SupportA& supportA, const SupportB& supportB, const Vector3& initialDirection, Contact& contact) {
+        Simplex simplex;
+        GJK::Result gjk;
+        if (!GJK::Distance(supportA, supportB, gjk, simplex, 0.0f, initialDirection)) {
+            return false;
+        }
+        EPA::Result epa;
+        if (EPA::Penetration(supportA, supportB, simplex, epa)) {
+            contact.normal = epa.normal;
+            contact.pointA = epa.pointA;
+            contact.pointB = epa.pointB;
+            contact.depth = epa.depth;
+        }
+        else {
+            // 接しているだけの場合
+            contact.normal = initialDirection.Normalized();
+            contact.pointA = gjk.pointA;
+            contact.pointB = gjk.pointB;
+            contact.depth = 0.0f;
+        }
+        return true;
+    }
+
+    // 形状の組み合わせで振り分ける。非凸は部品に分けて最も深い接触を返す
+    bool Collide(const Collider& colliderA, const Collider& colliderB, Scratch& scratch, Contact& contact);
+    // トリガー用。重なりが分かった時点で終わり、接触は求めない
+    bool Overlap(const Collider& colliderA, const Collider& colliderB, Scratch& scratch);
+
+    // boundsと交差するcolliderの凸な部品を集める
+    // 距離場は境界箱1つになり中身の詰まった箱として当たるので、呼び出し側で距離場のまま扱う
+    void CollectParts(const Collider& collider, const AABB& bounds, Scratch& scratch, std::vector<ConvexPart>& parts);
+    Vector3 FindPartFurthestPoint(const ConvexPart& part, const std::vector<Triangle>& triangles, const Vector3& direction);
+
+}
@@ -0,0 +1,307 @@
+#include "OccupancyGrid.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cmath>
+
+#include "../Collider.hpp"
+#include "../DistanceFieldCollider.hpp"
+#include "../Transform.hpp"
+#include "CollisionWorld.hpp"
+#include "GJK.hpp"
+#include "Support.hpp"
+
+namespace {
+    // [first, first + count)のビット
+    std::uint64_t BitRange(std::int32_t first, std::int32_t count) {
+        std::uint64_t bits = count >= 64 ? ~0ull : (1ull << count) - 1;
+        return bits << first;
+    }
+}
+
+OccupancyGrid::OccupancyGrid(float cellSize) :
+    cellSize_(cellSize),
+    invCellSize_(1.0f / cellSize),
+    count_(0),
+    shift_(0) {
+    Rebuild(kMinCapacity);
+}
+
+void OccupancyGrid::Build(const CollisionWorld& world, const AABB& bounds) {
+    Clear();
+    CellRange range = ToCellRange(bounds);
+    colliders_.clear();
+    world.Query(ToBounds(range), colliders_);
+    for (const Collider* collider : colliders_) {
+        if (!collider->IsTrigger()) {
+            Rasterize(*collider, range);
+        }
+    }
+}
+
+void OccupancyGrid::Update(const CollisionWorld& world, const AABB& region) {
+    CellRange range = ToCellRange(region);
+    ForEachBrick(range, [&](std::int32_t x, std::int32_t y, std::int32_t z) {
+        std::uint64_t key = MakeBrickKey(x, y, z);
+        std::uint64_t mask = FindMask(key);
+        if (mask == 0) {
+            return;
+        }
+        mask &= ~MakeRangeMask(range, x, y, z);
+        if (mask != 0) {
+            SetMask(key, mask);
+        }
+        else {
+            Erase(key);
+        }
+        });
+    colliders_.clear();
+    world.Query(ToBounds(range), colliders_);
+    for (const Collider* collider : colliders_) {
+        if (!collider->IsTrigger()) {
+            Rasterize(*collider, range);
+        }
+    }
+}
+
+void OccupancyGrid::Clear() {
+    if (count_ == 0) {
+        return;
+    }
+    std::fill(bricks_.begin(), bricks_.end(), Brick{ kEmptyKey, 0 });
+    count_ = 0;
+}
+
+bool OccupancyGrid::IsOccupied(const Vector3& point) const {
+    std::int32_t x = static_cast<std::int32_t>(std::floor(point.x * invCellSize_));
+    std::int32_t y = static_cast<std::int32_t>(std::floor(point.y * invCellSize_));
+    std::int32_t z = static_cast<std::int32_t>(std::floor(point.z * invCellSize_));
+    std::uint64_t mask = FindMask(MakeBrickKey(x >> 2, y >> 2, z >> 2));
+    return (mask >> ((x & 3) + ((y & 3) << 2) + ((z & 3) << 4))) & 1;
+}
+
+bool OccupancyGrid::IsOccupied(const AABB& bounds) const {
+    CellRange range = ToCellRange(bounds);
+    for (std::int32_t z = range.min[2] >> 2; z <= range.max[2] >> 2; ++z) {
+        for (std::int32_t y = range.min[1] >> 2; y <= range.max[1] >> 2; ++y) {
+            for (std::int32_t x = range.min[0] >> 2; x <= range.max[0] >> 2; ++x) {
+                if (FindMask(MakeBrickKey(x, y, z)) & MakeRangeMask(range, x, y, z)) {
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+size_t OccupancyGrid::GetMemoryUsage() const {
+    return bricks_.capacity() * sizeof(Brick);
+}
+
+OccupancyGrid::CellRange OccupancyGrid::ToCellRange(const AABB& bounds) const {
+    CellRange range;
+    for (size_t i = 0; i < 3; ++i) {
+        range.min[i] = static_cast<std::int32_t>(std::floor(bounds.min[i] * invCellSize_));
+        range.max[i] = static_cast<std::int32_t>(std::floor(bounds.max[i] * invCellSize_));
+    }
+    return range;
+}
+
+AABB OccupancyGrid::ToBounds(const CellRange& range) const {
+    AABB bounds;
+    for (size_t i = 0; i < 3; ++i) {
+        bounds.min[i] = static_cast<float>(range.min[i]) * cellSize_;
+        bounds.max[i] = static_cast<float>(range.max[i] + 1) * cellSize_;
+    }
+    return bounds;
+}
+
+std::uint64_t OccupancyGrid::MakeBrickKey(std::int32_t x, std::int32_t y, std::int32_t z) {
+    // 各軸21bitに詰める
+    const std::uint64_t kMask = (1ull << 21) - 1;
+    const std::int32_t kBias = 1 << 20;
+    return
+        (static_cast<std::uint64_t>(x + kBias) & kMask) |
+        ((static_cast<std::uint64_t>(y + kBias) & kMask) << 21) |
+        ((static_cast<std::uint64_t>(z + kBias) & kMask) << 42);
+}
+
+std::uint64_t OccupancyGrid::MakeRangeMask(const CellRange& range, std::int32_t x, std::int32_t y, std::int32_t z) {
+    const std::int32_t brick[3] = { x, y, z };
+    std::int32_t first[3], count[3];
+    for (size_t i = 0; i < 3; ++i) {
+        std::int32_t origin = brick[i] * static_cast<std::int32_t>(kBrickSize);
+        first[i] = std::max(range.min[i] - origin, 0);
+        count[i] = std::min(range.max[i] - origin, static_cast<std::int32_t>(kBrickSize) - 1) - first[i] + 1;
+        if (count[i] <= 0) {
+            return 0;
+        }
+    }
+    // 軸ごとの帯を全ての段に複製して重ねる
+    std::uint64_t xMask = BitRange(first[0], count[0]) * 0x1111111111111111ull;
+    std::uint64_t yMask = BitRange(first[1] * 4, count[1] * 4) * 0x0001000100010001ull;
+    std::uint64_t zMask = BitRange(first[2] * 16, count[2] * 16);
+    return xMask & yMask & zMask;
+}
+
+void OccupancyGrid::Rasterize(const Collider& collider, const CellRange& region) {
+    CellRange range = ToCellRange(collider.GetAABB());
+    for (size_t i = 0; i < 3; ++i) {
+        range.min[i] = std::max(range.min[i], region.min[i]);
+        range.max[i] = std::min(range.max[i], region.max[i]);
+        if (range.min[i] > range.max[i]) {
+            return;
+        }
+    }
+    // 距離場は凸な部品に分けると中身の詰まった箱になるので、場のまま測る
+    const SignedDistanceField* field = nullptr;
+    Matrix4x4 toLocal;
+    if (collider.GetType() == Collider::Type::kDistanceField) {
+        field = &static_cast<const DistanceFieldCollider&>(collider).GetField();
+        if (field->IsEmpty()) {
+            return;
+        }
+        toLocal = collider.GetTransform().GetWorldMatrix().Inverse();
+    }
+    ForEachBrick(range, [&](std::int32_t x, std::int32_t y, std::int32_t z) {
+        const std::int32_t brick[3] = { x, y, z };
+        CellRange brickRange;
+        for (size_t i = 0; i < 3; ++i) {
+            std::int32_t origin = brick[i] * static_cast<std::int32_t>(kBrickSize);
+            brickRange.min[i] = std::max(range.min[i], origin);
+            brickRange.max[i] = std::min(range.max[i], origin + static_cast<std::int32_t>(kBrickSize) - 1);
+        }
+        std::uint64_t mask = field ? RasterizeField(*field, toLocal, brickRange) : RasterizeParts(collider, brickRange);
+        if (mask != 0) {
+            std::uint64_t key = MakeBrickKey(x, y, z);
+            SetMask(key, FindMask(key) | mask);
+        }
+        });
+}
+
+std::uint64_t OccupancyGrid::RasterizeParts(const Collider& collider, const CellRange& brickRange) {
+    // ブリックに掛かる凸な部品を先に集め、セルごとにGJKで箱と当てる
+    parts_.clear();
+    scratch_.triangles.clear();
+    Narrowphase::CollectParts(collider, ToBounds(brickRange), scratch_, parts_);
+    if (parts_.empty()) {
+        return 0;
+    }
+    Vector3 halfCell = Vector3::one * (cellSize_ * 0.5f);
+    std::uint64_t mask = 0;
+    for (std::int32_t cz = brickRange.min[2]; cz <= brickRange.max[2]; ++cz) {
+        for (std::int32_t cy = brickRange.min[1]; cy <= brickRange.max[1]; ++cy) {
+            for (std::int32_t cx = brickRange.min[0]; cx <= brickRange.max[0]; ++cx) {
+                Vector3 center = Vector3(static_cast<float>(cx) + 0.5f, static_cast<float>(cy) + 0.5f, static_cast<float>(cz) + 0.5f) * cellSize_;
+                AABB cellBounds(center - halfCell, center + halfCell);
+                auto supportCell = [&](const Vector3& direction) { return center + Support::Box(direction, halfCell); };
+                for (const auto& part : parts_) {
+                    if (!part.aabb.Intersects(cellBounds)) {
+                        continue;
+                    }
+                    auto supportPart = [&](const Vector3& direction) { return Narrowphase::FindPartFurthestPoint(part, scratch_.triangles, direction); };
+                    Vector3 direction = part.aabb.Center() - center;
+                    if (direction.LengthSquare() <= GJK::kAbsoluteTolerance) {
+                        direction = Vector3::unitY;
+                    }
+                    if (GJK::Intersect(supportPart, supportCell, direction)) {
+                        mask |= 1ull << ((cx & 3) + ((cy & 3) << 2) + ((cz & 3) << 4));
+                        break;
+                    }
+                }
+            }
+        }
+    }
+    return mask;
+}
+
+std::uint64_t OccupancyGrid::RasterizeField(const SignedDistanceField& field, const Matrix4x4& toLocal, const CellRange& brickRange) const {
+    // 中心からこの距離以内に面があればセルに掛かりうる
+    const float halfDiagonal = cellSize_ * 0.5f * std::sqrt(3.0f);
+    std::uint64_t mask = 0;
+    for (std::int32_t cz = brickRange.min[2]; cz <= brickRange.max[2]; ++cz) {
+        for (std::int32_t cy = brickRange.min[1]; cy <= brickRange.max[1]; ++cy) {
+            for (std::int32_t cx = brickRange.min[0]; cx <= brickRange.max[0]; ++cx) {
+                Vector3 center = Vector3(static_cast<float>(cx) + 0.5f, static_cast<float>(cy) + 0.5f, static_cast<float>(cz) + 0.5f) * cellSize_;
+                if (field.Evaluate(center, toLocal).distance <= halfDiagonal) {
+                    mask |= 1ull << ((cx & 3) + ((cy & 3) << 2) + ((cz & 3) << 4));
+                }
+            }
+        }
+    }
+    return mask;
+}
+
+size_t OccupancyGrid::Hash(std::uint64_t key) const {
+    // フィボナッチハッシュ。上位ビットを使う
+    return static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> shift_);
+}
+
+std::uint64_t OccupancyGrid::FindMask(std::uint64_t key) const {
+    size_t mask = bricks_.size() - 1;
+    for (size_t i = Hash(key); bricks_[i].key != kEmptyKey; i = (i + 1) & mask) {
+        if (bricks_[i].key == key) {
+            return bricks_[i].mask;
+        }
+    }
+    return 0;
+}
+
+void OccupancyGrid::SetMask(std::uint64_t key, std::uint64_t mask) {
+    assert(key != kEmptyKey);
+    // 埋まりを半分以下に保つ
+    if ((static_cast<size_t>(count_) + 1) * 2 > bricks_.size()) {
+        Rebuild(bricks_.size() * 2);
+    }
+    size_t slotMask = bricks_.size() - 1;
+    for (size_t i = Hash(key);; i = (i + 1) & slotMask) {
+        if (bricks_[i].key == key) {
+            bricks_[i].mask = mask;
+            return;
+        }
+        if (bricks_[i].key == kEmptyKey) {
+            bricks_[i] = { key, mask };
+            ++count_;
+            return;
+        }
+    }
+}
+
+void OccupancyGrid::Erase(std::uint64_t key) {
+    size_t mask = bricks_.size() - 1;
+    size_t hole = Hash(key);
+    for (; bricks_[hole].key != key; hole = (hole + 1) & mask) {
+        if (bricks_[hole].key == kEmptyKey) {
+            return;
+        }
+    }
+    // 後続の要素のうち、本来の位置から穴を越えて来たものを穴へ詰める
+    for (size_t i = (hole + 1) & mask; bricks_[i].key != kEmptyKey; i = (i + 1) & mask) {
+        size_t home = Hash(bricks_[i].key);
+        if (((i - home) & mask) >= ((i - hole) & mask)) {
+            bricks_[hole] = bricks_[i];
+            hole = i;
+        }
+    }
+    bricks_[hole] = { kEmptyKey, 0 };
+    --count_;
+}
+
+void OccupancyGrid::Rebuild(size_t capacity) {
+    assert(std::has_single_bit(capacity));
+    std::vector<Brick> oldBricks(capacity, Brick{ kEmptyKey, 0 });
+    oldBricks.swap(bricks_);
+    shift_ = 64 - static_cast<std::uint32_t>(std::countr_zero(capacity));
+    size_t mask = capacity - 1;
+    for (const auto& brick : oldBricks) {
+        if (brick.key == kEmptyKey) {
+            continue;
+        }
+        size_t i = Hash(brick.key);
+        while (bricks_[i].key != kEmptyKey) {
+            i = (i + 1) & mask;
+        }
+        bricks_[i] = brick;
+    }
+}
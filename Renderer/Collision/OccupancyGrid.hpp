@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "../Math/MathUtils.hpp"
+#include "../AABB.hpp"
+#include "Narrowphase.hpp"
+
+class Collider;
+class CollisionWorld;
+class SignedDistanceField;
+
+// コライダーを焼き込んだ疎なボクセル占有格子
+// 4x4x4セルのブリックを64bitのマスク1つで持ち、ブリックは開番地法のハッシュ表で引く
+// スポーン位置の確認や遮蔽物探しなど、形の細部が要らない問い合わせ用。トリガーは焼かない
+// 中身は埋めないので、閉じたメッシュの内側は空きになる。距離場は内側も埋まる
+class OccupancyGrid {
+public:
+    // ブリックの1辺のセル数
+    static constexpr std::uint32_t kBrickSize = 4;
+
+    explicit OccupancyGrid(float cellSize = 0.5f);
+
+    // boundsに掛かるセルを焼き直す。worldはStep後の状態を使う
+    void Build(const CollisionWorld& world, const AABB& bounds);
+    // regionに掛かるセルを消し、重なるコライダーを焼き直す
+    // コライダーを動かしたら移動前と移動後のAABBでそれぞれ呼ぶ
+    void Update(const CollisionWorld& world, const AABB& region);
+    // 容量は残す
+    void Clear();
+
+    // ハッシュ表を1回引いてビットを1つ見る
+    bool IsOccupied(const Vector3& point) const;
+    // boundsに掛かるセルのどれかが埋まっていればtrue。ブリックごとに範囲のマスクと論理積を取る
+    bool IsOccupied(const AABB& bounds) const;
+
+    float GetCellSize() const { return cellSize_; }
+    std::uint32_t GetBrickCount() const { return count_; }
+    size_t GetMemoryUsage() const;
+
+private:
+    static constexpr std::uint64_t kEmptyKey = ~0ull;
+    static constexpr std::uint32_t kMinCapacity = 64;
+
+    struct Brick {
+        std::uint64_t key;
+        std::uint64_t mask;     // x + 4y + 16z番目のビットがセル
+    };
+    // セルの番号の閉区間
+    struct CellRange {
+        std::int32_t min[3];
+        std::int32_t max[3];
+    };
+
+    CellRange ToCellRange(const AABB& bounds) const;
+    AABB ToBounds(const CellRange& range) const;
+    static std::uint64_t MakeBrickKey(std::int32_t x, std::int32_t y, std::int32_t z);
+    // rangeのうちブリック(x, y, z)に入るセルのマスク
+    static std::uint64_t MakeRangeMask(const CellRange& range, std::int32_t x, std::int32_t y, std::int32_t z);
+
+    // rangeに掛かるブリックについてfunc(x, y, z)を呼ぶ
+    template<class Func>
+    static void ForEachBrick(const CellRange& range, Func&& func) {
+        for (std::int32_t z = range.min[2] >> 2; z <= range.max[2] >> 2; ++z) {
+            for (std::int32_t y = range.min[1] >> 2; y <= range.max[1] >> 2; ++y) {
+                for (std::int32_t x = range.min[0] >> 2; x <= range.max[0] >> 2; ++x) {
+                    func(x, y, z);
+                }
+            }
+        }
+    }
+
+    void Rasterize(const Collider& collider, const CellRange& range);
+    // 1つのブリックに収まるbrickRangeのうち、埋まるセルのマスクを返す
+    std::uint64_t RasterizeParts(const Collider& collider, const CellRange& brickRange);
+    // 距離場はセルの中心の距離が対角線の半分以下なら埋める
+    std::uint64_t RasterizeField(const SignedDistanceField& field, const Matrix4x4& toLocal, const CellRange& brickRange) const;
+
+    size_t Hash(std::uint64_t key) const;
+    // 無ければ0
+    std::uint64_t FindMask(std::uint64_t key) const;
+    void SetMask(std::uint64_t key, std::uint64_t mask);
+    void Erase(std::uint64_t key);
+    void Rebuild(size_t capacity);
+
+    float cellSize_;
+    float invCellSize_;
+    std::vector<Brick> bricks_;
+    std::uint32_t count_;
+    // 2の累乗の容量に合わせたハッシュの右シフト量
+    std::uint32_t shift_;
+
+    std::vector<Collider*> colliders_;
+    std::vector<Narrowphase::ConvexPart> parts_;
+    Narrowphase::Scratch scratch_;
+};
@@ -0,0 +1,145 @@
+#include "PairSet.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+
+PairSet::PairSet() :
+    count_(0),
+    shift_(0) {
+    Rebuild(kMinCapacity);
+}
+
+bool PairSet::Insert(std::uint64_t key) {
+    assert(key != kEmpty);
+    // 埋まりを半分以下に保つ
+    if ((static_cast<size_t>(count_) + 1) * 2 > slots_.size()) {
+        Rebuild(slots_.size() * 2);
+    }
+    size_t mask = slots_.size() - 1;
+    for (size_t i = Hash(key);; i = (i + 1) & mask) {
+        if (slots_[i] == key) {
+            return false;
+        }
+        if (slots_[i] == kEmpty) {
+            slots_[i] = key;
+            ++count_;
+            return true;
+        }
+    }
+}
+
+bool PairSet::Remove(std::uint64_t key) {
+    size_t mask = slots_.size() - 1;
+    size_t hole = Hash(key);
+    for (; slots_[hole] != key; hole = (hole + 1) & mask) {
+        if (slots_[hole] == kEmpty) {
+            return false;
+        }
+    }
+    // 後続の要素のうち、本来の位置から穴を越えて来たものを穴へ詰める
+    for (size_t i = (hole + 1) & mask; slots_[i] != kEmpty; i = (i + 1) & mask) {
+        size_t home = Hash(slots_[i]);
+        if (((i - home) & mask) >= ((i - hole) & mask)) {
+            slots_[hole] = slots_[i];
+            hole = i;
+        }
+    }
+    slots_[hole] = kEmpty;
+    --count_;
+    return true;
+}
+
+bool PairSet::Contains(std::uint64_t key) const {
+    size_t mask = slots_.size() - 1;
+    for (size_t i = Hash(key); slots_[i] != kEmpty; i = (i + 1) & mask) {
+        if (slots_[i] == key) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void PairSet::Clear() {
+    if (count_ == 0) {
+        return;
+    }
+    std::fill(slots_.begin(), slots_.end(), kEmpty);
+    count_ = 0;
+}
+
+void PairSet::Reserve(std::uint32_t count) {
+    size_t capacity = std::bit_ceil(static_cast<size_t>(count) * 2);
+    if (capacity > slots_.size()) {
+        Rebuild(capacity);
+    }
+}
+
+void PairSet::GetSortedKeys(std::vector<std::uint64_t>& keys) {
+    keys.clear();
+    keys.reserve(count_);
+    for (auto key : slots_) {
+        if (key != kEmpty) {
+            keys.emplace_back(key);
+        }
+    }
+    if (keys.empty()) {
+        return;
+    }
+
+    // 全ての桁のヒストグラムを一度に数える
+    std::array<std::uint32_t, kRadixSize * kPassCount> histograms{};
+    for (auto key : keys) {
+        for (std::uint32_t pass = 0; pass < kPassCount; ++pass) {
+            ++histograms[pass * kRadixSize + ((key >> (pass * kRadixBits)) & (kRadixSize - 1))];
+        }
+    }
+
+    sortBuffer_.resize(keys.size());
+    for (std::uint32_t pass = 0; pass < kPassCount; ++pass) {
+        std::uint32_t* histogram = histograms.data() + pass * kRadixSize;
+        std::uint32_t shift = pass * kRadixBits;
+        // 全て同じ桁なら並びは変わらない（IDが小さい間は上位の桁が全て0）
+        if (histogram[(keys.front() >> shift) & (kRadixSize - 1)] == keys.size()) {
+            continue;
+        }
+        std::uint32_t offset = 0;
+        for (std::uint32_t digit = 0; digit < kRadixSize; ++digit) {
+            std::uint32_t count = histogram[digit];
+            histogram[digit] = offset;
+            offset += count;
+        }
+        for (auto key : keys) {
+            sortBuffer_[histogram[(key >> shift) & (kRadixSize - 1)]++] = key;
+        }
+        keys.swap(sortBuffer_);
+    }
+}
+
+size_t PairSet::GetMemoryUsage() const {
+    return slots_.capacity() * sizeof(std::uint64_t) + sortBuffer_.capacity() * sizeof(std::uint64_t);
+}
+
+size_t PairSet::Hash(std::uint64_t key) const {
+    // フィボナッチハッシュ。上位ビットを使う
+    return static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> shift_);
+}
+
+void PairSet::Rebuild(size_t capacity) {
+    assert(std::has_single_bit(capacity));
+    std::vector<std::uint64_t> oldSlots(capacity, kEmpty);
+    oldSlots.swap(slots_);
+    shift_ = 64 - static_cast<std::uint32_t>(std::countr_zero(capacity));
+    size_t mask = capacity - 1;
+    for (auto key : oldSlots) {
+        if (key == kEmpty) {
+            continue;
+        }
+        size_t i = Hash(key);
+        while (slots_[i] != kEmpty) {
+            i = (i + 1) & mask;
+        }
+        slots_[i] = key;
+    }
+}
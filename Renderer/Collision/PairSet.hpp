@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// ペアのキー（Broadphase::MakePairKey）の集合
+// 開番地法で線形探索する。削除は後続の要素を詰め直すので墓標を残さず、
+// 埋まりが半分を超えたら倍の大きさで作り直す
+class PairSet {
+public:
+    PairSet();
+
+    // 新しく入ればtrue
+    bool Insert(std::uint64_t key);
+    // 入っていればtrue
+    bool Remove(std::uint64_t key);
+    bool Contains(std::uint64_t key) const;
+    // 容量は残す
+    void Clear();
+    void Reserve(std::uint32_t count);
+
+    // キー順（LSD基数ソート）でkeysを上書きする
+    void GetSortedKeys(std::vector<std::uint64_t>& keys);
+
+    std::uint32_t GetCount() const { return count_; }
+    size_t GetMemoryUsage() const;
+
+private:
+    // MakePairKeyは同じID同士の組を作らないので現れない
+    static constexpr std::uint64_t kEmpty = ~0ull;
+    static constexpr std::uint32_t kMinCapacity = 64;
+    static constexpr std::uint32_t kRadixBits = 8;
+    static constexpr std::uint32_t kRadixSize = 1 << kRadixBits;
+    static constexpr std::uint32_t kPassCount = 64 / kRadixBits;
+
+    size_t Hash(std::uint64_t key) const;
+    void Rebuild(size_t capacity);
+
+    std::vector<std::uint64_t> slots_;
+    std::uint32_t count_;
+    // 2の累乗の容量に合わせたハッシュの右シフト量
+    std::uint32_t shift_;
+
+    std::vector<std::uint64_t> sortBuffer_;
+};
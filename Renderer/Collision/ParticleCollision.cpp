@@ -0,0 +1,273 @@
+#include "ParticleCollision.hpp"
+
+#include "../Math/SIMD.hpp"
+#include "../BoxCollider.hpp"
+#include "../CapsuleCollider.hpp"
+#include "../Collider.hpp"
+#include "../DistanceFieldCollider.hpp"
+#include "../SphereCollider.hpp"
+#include "../Transform.hpp"
+#include "CollisionWorld.hpp"
+
+using namespace SIMD;
+using ParticleCollision::Obstacle;
+
+namespace {
+    constexpr float kEpsilon = 1.0e-6f;
+    // 箱の軸の直交の許容量（相対）
+    constexpr float kAxisTolerance = 1.0e-4f;
+
+    template<class F>
+    Vector3T<F> LoadVector(float* const (&values)[3], size_t i) {
+        return { Load<F>(values[0] + i), Load<F>(values[1] + i), Load<F>(values[2] + i) };
+    }
+
+    template<class F>
+    void StoreVector(float* const (&values)[3], const Vector3T<F>& v, size_t i) {
+        Store(values[0] + i, v.x);
+        Store(values[1] + i, v.y);
+        Store(values[2] + i, v.z);
+    }
+
+    template<class F>
+    Vector3T<F> Broadcast(const Vector3& v) {
+        return { F(v.x), F(v.y), F(v.z) };
+    }
+
+    template<class F>
+    void BoundsKernel(const ParticleCollision::Streams& streams, size_t i, Vector3T<F>& boundsMin, Vector3T<F>& boundsMax) {
+        Vector3T<F> position = LoadVector<F>(streams.positions, i);
+        boundsMin = { Min(boundsMin.x, position.x), Min(boundsMin.y, position.y), Min(boundsMin.z, position.z) };
+        boundsMax = { Max(boundsMax.x, position.x), Max(boundsMax.y, position.y), Max(boundsMax.z, position.z) };
+    }
+
+    // めり込んだ分を押し出し、面に向かう速度を跳ね返す
+    template<class F, class Mask>
+    void Respond(const ParticleCollision::Streams& streams, size_t i, const Vector3T<F>& position, const Vector3T<F>& normal, F depth, Mask isHit, const ParticleCollision::Response& response) {
+        StoreVector(streams.positions, position + normal * depth, i);
+
+        Vector3T<F> velocity = LoadVector<F>(streams.velocities, i);
+        F normalSpeed = Dot(velocity, normal);
+        Vector3T<F> normalVelocity = normal * normalSpeed;
+        Vector3T<F> tangentVelocity = velocity - normalVelocity;
+        Vector3T<F> bounced = tangentVelocity * F(1.0f - response.friction) - normalVelocity * F(response.restitution);
+        StoreVector(streams.velocities, Select(And(isHit, normalSpeed < F(0.0f)), bounced, velocity), i);
+    }
+
+    // 球と箱
+    template<class F>
+    void CollideBoxKernel(const ParticleCollision::Streams& streams, size_t i, const Obstacle& obstacle, const ParticleCollision::Response& response) {
+        Vector3T<F> position = LoadVector<F>(streams.positions, i);
+        Vector3T<F> axisX = Broadcast<F>(obstacle.axes[0]);
+        Vector3T<F> axisY = Broadcast<F>(obstacle.axes[1]);
+        Vector3T<F> axisZ = Broadcast<F>(obstacle.axes[2]);
+        Vector3T<F> halfSize = Broadcast<F>(obstacle.halfSize);
+        // 箱のローカル空間
+        Vector3T<F> d = position - Broadcast<F>(obstacle.center);
+        Vector3T<F> local{ Dot(d, axisX), Dot(d, axisY), Dot(d, axisZ) };
+        Vector3T<F> closest{ Clamp(local.x, -halfSize.x, halfSize.x), Clamp(local.y, -halfSize.y, halfSize.y), Clamp(local.z, -halfSize.z, halfSize.z) };
+        Vector3T<F> delta = local - closest;
+        F distanceSquare = Dot(delta, delta);
+        F radius(response.radius);
+        auto isHit = distanceSquare < radius * radius;
+        if (!Any(isHit)) {
+            return;
+        }
+        F distance = Sqrt(distanceSquare);
+        auto isOutside = distance > F(kEpsilon);
+
+        // 中心が箱の外。最近点から離す
+        Vector3T<F> outsideNormal = delta * (F(1.0f) / Max(distance, F(kEpsilon)));
+        F outsideDepth = radius - distance;
+
+        // 中心が箱の中。最も近い面から出す
+        Vector3T<F> gap = halfSize - Vector3T<F>{ Abs(local.x), Abs(local.y), Abs(local.z) };
+        auto isX = And(gap.x <= gap.y, gap.x <= gap.z);
+        auto isY = And(Not(isX), gap.y <= gap.z);
+        auto isZ = And(Not(isX), Not(isY));
+        Vector3T<F> insideNormal{
+            Select(isX, Select(local.x >= F(0.0f), F(1.0f), F(-1.0f)), F(0.0f)),
+            Select(isY, Select(local.y >= F(0.0f), F(1.0f), F(-1.0f)), F(0.0f)),
+            Select(isZ, Select(local.z >= F(0.0f), F(1.0f), F(-1.0f)), F(0.0f)) };
+        F insideDepth = radius + Select(isX, gap.x, Select(isY, gap.y, gap.z));
+
+        Vector3T<F> localNormal = Select(isOutside, outsideNormal, insideNormal);
+        F depth = Select(isHit, Select(isOutside, outsideDepth, insideDepth), F(0.0f));
+        Vector3T<F> normal = axisX * localNormal.x + axisY * localNormal.y + axisZ * localNormal.z;
+        Respond(streams, i, position, normal, depth, isHit, response);
+    }
+
+    // 球とカプセル。線分の最近点から離す
+    template<class F>
+    void CollideCapsuleKernel(const ParticleCollision::Streams& streams, size_t i, const Obstacle& obstacle, const ParticleCollision::Response& response) {
+        Vector3T<F> position = LoadVector<F>(streams.positions, i);
+        Vector3 segment = obstacle.segment[1] - obstacle.segment[0];
+        float segmentLengthSquare = segment.LengthSquare();
+        float inverseLengthSquare = segmentLengthSquare > kEpsilon ? 1.0f / segmentLengthSquare : 0.0f;
+        Vector3T<F> start = Broadcast<F>(obstacle.segment[0]);
+        Vector3T<F> direction = Broadcast<F>(segment);
+        F t = Clamp(Dot(position - start, direction) * F(inverseLengthSquare), F(0.0f), F(1.0f));
+        Vector3T<F> delta = position - (start + direction * t);
+        F distanceSquare = Dot(delta, delta);
+        F radius(response.radius + obstacle.radius);
+        auto isHit = distanceSquare < radius * radius;
+        if (!Any(isHit)) {
+            return;
+        }
+        F distance = Sqrt(distanceSquare);
+        // 中心が線分の上にあるときは上に出す
+        auto isOutside = distance > F(kEpsilon);
+        Vector3T<F> outsideNormal = delta * (F(1.0f) / Max(distance, F(kEpsilon)));
+        Vector3T<F> normal = Select(isOutside, outsideNormal, Vector3T<F>{ F(0.0f), F(1.0f), F(0.0f) });
+        F depth = Select(isHit, radius - distance, F(0.0f));
+        Respond(streams, i, position, normal, depth, isHit, response);
+    }
+
+    // 球と距離場。粒子ごとに引くブリックが違うので1個ずつ補間する
+    void CollideDistanceFieldKernel(const ParticleCollision::Streams& streams, size_t i, const Obstacle& obstacle, const ParticleCollision::Response& response) {
+        Vector3T<float> position = LoadVector<float>(streams.positions, i);
+        SignedDistanceField::Sample sample = obstacle.field->Evaluate(Vector3(position.x, position.y, position.z), obstacle.toLocal);
+        float depth = response.radius - sample.distance;
+        if (depth <= 0.0f) {
+            return;
+        }
+        Vector3T<float> normal{ sample.gradient.x, sample.gradient.y, sample.gradient.z };
+        Respond(streams, i, position, normal, depth, true, response);
+    }
+
+    // 8個ずつ、残りを1個ずつ
+    template<class Kernel8, class Kernel1>
+    void Run(size_t begin, size_t end, Kernel8&& kernel8, Kernel1&& kernel1) {
+        size_t i = begin;
+#if defined(__AVX__)
+        for (; i + Float8::kWidth <= end; i += Float8::kWidth) {
+            kernel8(i);
+        }
+#else
+        (void)kernel8;
+#endif
+        for (; i < end; ++i) {
+            kernel1(i);
+        }
+    }
+}
+
+namespace ParticleCollision {
+
+    Obstacle MakeObstacle(const Collider& collider) {
+        Obstacle obstacle{};
+        const Matrix4x4& world = collider.GetTransform().GetWorldMatrix();
+        Vector3 axes[3] = { world.GetXAxis(), world.GetYAxis(), world.GetZAxis() };
+        Vector3 scale(axes[0].Length(), axes[1].Length(), axes[2].Length());
+        float maxScale = std::max({ scale.x, scale.y, scale.z });
+        switch (collider.GetType()) {
+        case Collider::Type::kBox: {
+            // 軸が直交していれば向きのある箱
+            const auto& box = static_cast<const BoxCollider&>(collider);
+            float tolerance = kAxisTolerance * maxScale * maxScale;
+            if (std::min({ scale.x, scale.y, scale.z }) > kEpsilon &&
+                std::abs(Vector3::Dot(axes[0], axes[1])) <= tolerance &&
+                std::abs(Vector3::Dot(axes[1], axes[2])) <= tolerance &&
+                std::abs(Vector3::Dot(axes[2], axes[0])) <= tolerance) {
+                obstacle.shape = Obstacle::Shape::kBox;
+                obstacle.center = box.GetCenter() * world;
+                for (size_t i = 0; i < 3; ++i) {
+                    obstacle.axes[i] = axes[i] / scale[i];
+                }
+                obstacle.halfSize = Vector3::Scale(box.GetSize() * 0.5f, scale);
+                return obstacle;
+            }
+            break;
+        }
+        case Collider::Type::kSphere: {
+            const auto& sphere = static_cast<const SphereCollider&>(collider);
+            obstacle.shape = Obstacle::Shape::kCapsule;
+            obstacle.segment[0] = obstacle.segment[1] = sphere.GetCenter() * world;
+            obstacle.radius = sphere.GetRadius() * maxScale;
+            return obstacle;
+        }
+        case Collider::Type::kCapsule: {
+            const auto& capsule = static_cast<const CapsuleCollider&>(collider);
+            Vector3 halfSegment(0.0f, capsule.GetHalfSegment(), 0.0f);
+            obstacle.shape = Obstacle::Shape::kCapsule;
+            obstacle.segment[0] = (capsule.GetCenter() - halfSegment) * world;
+            obstacle.segment[1] = (capsule.GetCenter() + halfSegment) * world;
+            obstacle.radius = capsule.GetRadius() * maxScale;
+            return obstacle;
+        }
+        case Collider::Type::kDistanceField: {
+            const auto& field = static_cast<const DistanceFieldCollider&>(collider).GetField();
+            if (field.IsEmpty()) {
+                break;
+            }
+            obstacle.shape = Obstacle::Shape::kDistanceField;
+            obstacle.field = &field;
+            obstacle.toLocal = world.Inverse();
+            return obstacle;
+        }
+        default:
+            break;
+        }
+        const AABB& aabb = collider.GetAABB();
+        obstacle.shape = Obstacle::Shape::kBox;
+        obstacle.center = aabb.Center();
+        obstacle.axes[0] = Vector3::unitX;
+        obstacle.axes[1] = Vector3::unitY;
+        obstacle.axes[2] = Vector3::unitZ;
+        obstacle.halfSize = (aabb.max - aabb.min) * 0.5f;
+        return obstacle;
+    }
+
+    void Collide(const Obstacle& obstacle, const Streams& streams, std::uint32_t begin, std::uint32_t end, const Response& response) {
+        if (obstacle.shape == Obstacle::Shape::kDistanceField) {
+            for (std::uint32_t i = begin; i < end; ++i) {
+                CollideDistanceFieldKernel(streams, i, obstacle, response);
+            }
+            return;
+        }
+        if (obstacle.shape == Obstacle::Shape::kCapsule) {
+#if defined(__AVX__)
+            auto kernel8 = [&](size_t i) { CollideCapsuleKernel<Float8>(streams, i, obstacle, response); };
+#else
+            auto kernel8 = [](size_t) {};
+#endif
+            Run(begin, end, kernel8, [&](size_t i) { CollideCapsuleKernel<float>(streams, i, obstacle, response); });
+            return;
+        }
+#if defined(__AVX__)
+        auto kernel8 = [&](size_t i) { CollideBoxKernel<Float8>(streams, i, obstacle, response); };
+#else
+        auto kernel8 = [](size_t) {};
+#endif
+        Run(begin, end, kernel8, [&](size_t i) { CollideBoxKernel<float>(streams, i, obstacle, response); });
+    }
+
+    AABB ComputeBounds(const Streams& streams, std::uint32_t begin, std::uint32_t end, float radius) {
+        Vector3 boundsMin(Math::positiveInfinity, Math::positiveInfinity, Math::positiveInfinity);
+        Vector3 boundsMax = -boundsMin;
+        Vector3T<float> min1{ boundsMin.x, boundsMin.y, boundsMin.z }, max1{ boundsMax.x, boundsMax.y, boundsMax.z };
+#if defined(__AVX__)
+        Vector3T<Float8> min8 = Broadcast<Float8>(boundsMin), max8 = Broadcast<Float8>(boundsMax);
+        Run(begin, end, [&](size_t i) { BoundsKernel<Float8>(streams, i, min8, max8); }, [&](size_t i) { BoundsKernel<float>(streams, i, min1, max1); });
+        min1 = { std::min(min1.x, ReduceMin(min8.x)), std::min(min1.y, ReduceMin(min8.y)), std::min(min1.z, ReduceMin(min8.z)) };
+        max1 = { std::max(max1.x, ReduceMax(max8.x)), std::max(max1.y, ReduceMax(max8.y)), std::max(max1.z, ReduceMax(max8.z)) };
+#else
+        Run(begin, end, [](size_t) {}, [&](size_t i) { BoundsKernel<float>(streams, i, min1, max1); });
+#endif
+        return AABB(
+            Vector3(min1.x - radius, min1.y - radius, min1.z - radius),
+            Vector3(max1.x + radius, max1.y + radius, max1.z + radius));
+    }
+
+    void CollideStatic(const CollisionWorld& collisionWorld, const AABB& bounds, const Streams& streams, std::uint32_t begin, std::uint32_t end, const Response& response) {
+        // 範囲に掛かるコライダーごとに、粒子をまとめて判定する
+        collisionWorld.GetStaticTree().Query(bounds, [&](std::uint32_t id) {
+            const Collider* collider = collisionWorld.GetCollider(id);
+            if (!collider || collider->IsTrigger()) {
+                return;
+            }
+            Collide(MakeObstacle(*collider), streams, begin, end, response);
+            });
+    }
+
+}
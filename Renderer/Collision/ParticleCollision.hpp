@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+
+#include "../Math/MathUtils.hpp"
+#include "../AABB.hpp"
+
+class CollisionWorld;
+class Collider;
+class SignedDistanceField;
+
+// 成分ごとの配列で持つ球の粒子と、コライダーとの衝突
+// 箱コライダーは向きのある箱、球とカプセルと距離場はそのまま、それ以外はAABBとみなす
+namespace ParticleCollision {
+
+    struct Streams {
+        float* positions[3];
+        float* velocities[3];
+    };
+
+    // 当たったときの応答
+    struct Response {
+        float radius;
+        // 面に垂直な速度の跳ね返る割合
+        float restitution;
+        // 面に沿う速度の当たるたびに失う割合
+        float friction;
+    };
+
+    // 粒子が当たる形
+    struct Obstacle {
+        enum class Shape {
+            kBox,
+            kCapsule,
+            kDistanceField
+        };
+        Shape shape;
+        // 箱。AABBは軸が単位行列
+        Vector3 center;
+        Vector3 axes[3];
+        Vector3 halfSize;
+        // カプセル。球は両端が同じ
+        Vector3 segment[2];
+        float radius;
+        // 距離場。toLocalはワールド行列の逆行列
+        const SignedDistanceField* field;
+        Matrix4x4 toLocal;
+    };
+
+    // コライダーのワールド空間の形を取り出す。拡縮が一様でない球とカプセルは半径を大きい方に合わせる
+    Obstacle MakeObstacle(const Collider& collider);
+    // [begin, end)の粒子をobstacleから押し出し、面に向かう速度を跳ね返す
+    void Collide(const Obstacle& obstacle, const Streams& streams, std::uint32_t begin, std::uint32_t end, const Response& response);
+    // [begin, end)の中心を囲むAABBを半径だけ広げる
+    AABB ComputeBounds(const Streams& streams, std::uint32_t begin, std::uint32_t end, float radius);
+    // [begin, end)の粒子を、boundsに掛かる静的な木のコライダーに当てる
+    // 同じ粒子を並行に扱わなければ、どのスレッドからでも呼べる。Stepとは並行に呼ばない
+    void CollideStatic(const CollisionWorld& collisionWorld, const AABB& bounds, const Streams& streams, std::uint32_t begin, std::uint32_t end, const Response& response);
+
+}
@@ -0,0 +1,361 @@
+#include "PrimitiveBatch.hpp"
+
+#include "../Math/SIMD.hpp"
+#include "../Collider.hpp"
+#include "../SphereCollider.hpp"
+#include "../CapsuleCollider.hpp"
+#include "../BoxCollider.hpp"
+#include "../Transform.hpp"
+
+using namespace SIMD;
+
+namespace {
+    constexpr float kEpsilon = 1.0e-6f;
+    // スケールの一様さと軸の直交の許容量（相対）
+    constexpr float kScaleTolerance = 1.0e-4f;
+
+    enum class Shape {
+        kSphere,
+        kCapsule,
+        kBox,
+        kOther
+    };
+
+    // ワールド空間の基本形状
+    struct Primitive {
+        Shape shape;
+        Vector3 p;          // 球とカプセルの始点、箱の中心
+        Vector3 q;          // カプセルの終点
+        float radius;
+        Vector3 axes[3];    // 箱の単位軸
+        Vector3 halfSize;   // 箱
+    };
+
+    // 閉じた式で扱える形なら取り出す。球とカプセルは一様スケール、箱は軸が直交している場合のみ
+    bool ExtractPrimitive(const Collider& collider, Primitive& primitive) {
+        if (collider.GetType() != Collider::Type::kSphere &&
+            collider.GetType() != Collider::Type::kCapsule &&
+            collider.GetType() != Collider::Type::kBox) {
+            return false;
+        }
+        const Matrix4x4& world = collider.GetTransform().GetWorldMatrix();
+        Vector3 axes[3] = { world.GetXAxis(), world.GetYAxis(), world.GetZAxis() };
+        Vector3 scale(axes[0].Length(), axes[1].Length(), axes[2].Length());
+        float maxScale = std::max({ scale.x, scale.y, scale.z });
+        if (maxScale <= kEpsilon) {
+            return false;
+        }
+        float tolerance = kScaleTolerance * maxScale * maxScale;
+        if (std::abs(Dot(axes[0], axes[1])) > tolerance || std::abs(Dot(axes[1], axes[2])) > tolerance || std::abs(Dot(axes[2], axes[0])) > tolerance) {
+            return false;
+        }
+        bool isUniform = maxScale - std::min({ scale.x, scale.y, scale.z }) <= kScaleTolerance * maxScale;
+
+        switch (collider.GetType()) {
+        case Collider::Type::kSphere:
+        {
+            if (!isUniform) { return false; }
+            const auto& sphere = static_cast<const SphereCollider&>(collider);
+            primitive.shape = Shape::kSphere;
+            primitive.p = sphere.GetCenter() * world;
+            primitive.q = primitive.p;
+            primitive.radius = sphere.GetRadius() * maxScale;
+            return true;
+        }
+        case Collider::Type::kCapsule:
+        {
+            if (!isUniform) { return false; }
+            const auto& capsule = static_cast<const CapsuleCollider&>(collider);
+            Vector3 halfSegment(0.0f, capsule.GetHalfSegment(), 0.0f);
+            primitive.shape = Shape::kCapsule;
+            primitive.p = (capsule.GetCenter() + halfSegment) * world;
+            primitive.q = (capsule.GetCenter() - halfSegment) * world;
+            primitive.radius = capsule.GetRadius() * maxScale;
+            return true;
+        }
+        default:
+        {
+            const auto& box = static_cast<const BoxCollider&>(collider);
+            primitive.shape = Shape::kBox;
+            primitive.p = box.GetCenter() * world;
+            for (size_t i = 0; i < 3; ++i) {
+                primitive.axes[i] = axes[i] / scale[i];
+            }
+            primitive.halfSize = Vector3::Scale(box.GetSize() * 0.5f, scale);
+            primitive.radius = 0.0f;
+            return true;
+        }
+        }
+    }
+
+    template<class F, std::uint32_t N>
+    Vector3T<F> LoadVector(const std::vector<float> (&values)[N], std::uint32_t first, size_t i) {
+        return { Load<F>(values[first].data() + i), Load<F>(values[first + 1].data() + i), Load<F>(values[first + 2].data() + i) };
+    }
+
+    template<class F>
+    void StoreVector(std::vector<float>* values, const Vector3T<F>& v, size_t i) {
+        Store(values[0].data() + i, v.x);
+        Store(values[1].data() + i, v.y);
+        Store(values[2].data() + i, v.z);
+    }
+
+    // 状態は0が外れ、1が当たり、2が解き直し
+    template<class F, class Mask>
+    F MakeState(const Mask& isHit, const Mask& isFallback) {
+        return Select(isHit, Select(isFallback, F(2.0f), F(1.0f)), F(0.0f));
+    }
+
+    template<class F>
+    void StoreResult(std::vector<float> (&out)[11], size_t i, const Vector3T<F>& normal, const Vector3T<F>& pointA, const Vector3T<F>& pointB, const F& depth, const F& state) {
+        StoreVector(out + 0, normal, i);
+        StoreVector(out + 3, pointA, i);
+        StoreVector(out + 6, pointB, i);
+        Store(out[9].data() + i, depth);
+        Store(out[10].data() + i, state);
+    }
+
+    template<class F>
+    void SphereSphereKernel(const std::vector<float> (&in)[8], std::vector<float> (&out)[11], size_t i) {
+        Vector3T<F> centerA = LoadVector<F>(in, 0, i);
+        F radiusA = Load<F>(in[3].data() + i);
+        Vector3T<F> centerB = LoadVector<F>(in, 4, i);
+        F radiusB = Load<F>(in[7].data() + i);
+
+        Vector3T<F> d = centerB - centerA;
+        F distanceSquare = Dot(d, d);
+        F radiusSum = radiusA + radiusB;
+        auto isHit = distanceSquare <= radiusSum * radiusSum;
+        F distance = Sqrt(distanceSquare);
+        // 中心が重なったら上向きにする
+        auto isDegenerate = distance <= F(kEpsilon);
+        Vector3T<F> normal = Select(isDegenerate,
+            Vector3T<F>{ F(0.0f), F(1.0f), F(0.0f) },
+            d * (F(1.0f) / Max(distance, F(kEpsilon))));
+        StoreResult(out, i, normal, centerA + normal * radiusA, centerB - normal * radiusB, radiusSum - distance, Select(isHit, F(1.0f), F(0.0f)));
+    }
+
+    template<class F>
+    void SphereBoxKernel(const std::vector<float> (&in)[7], std::vector<float> (&out)[11], size_t i) {
+        // 箱のローカル空間。球がA、箱がB
+        Vector3T<F> center = LoadVector<F>(in, 0, i);
+        F radius = Load<F>(in[3].data() + i);
+        Vector3T<F> halfSize = LoadVector<F>(in, 4, i);
+
+        Vector3T<F> closest{ Clamp(center.x, -halfSize.x, halfSize.x), Clamp(center.y, -halfSize.y, halfSize.y), Clamp(center.z, -halfSize.z, halfSize.z) };
+        Vector3T<F> d = closest - center;
+        F distanceSquare = Dot(d, d);
+        auto isHit = distanceSquare <= radius * radius;
+        F distance = Sqrt(distanceSquare);
+        auto isOutside = distance > F(kEpsilon);
+
+        // 中心が箱の外。最近点へ向かう
+        Vector3T<F> outsideNormal = d * (F(1.0f) / Max(distance, F(kEpsilon)));
+        F outsideDepth = radius - distance;
+
+        // 中心が箱の中。最も近い面から押し出す
+        Vector3T<F> gap = halfSize - Vector3T<F>{ Abs(center.x), Abs(center.y), Abs(center.z) };
+        auto isX = And(gap.x <= gap.y, gap.x <= gap.z);
+        auto isY = And(Not(isX), gap.y <= gap.z);
+        auto isZ = And(Not(isX), Not(isY));
+        Vector3T<F> sign{
+            Select(center.x >= F(0.0f), F(1.0f), F(-1.0f)),
+            Select(center.y >= F(0.0f), F(1.0f), F(-1.0f)),
+            Select(center.z >= F(0.0f), F(1.0f), F(-1.0f)) };
+        Vector3T<F> insideNormal{
+            Select(isX, -sign.x, F(0.0f)),
+            Select(isY, -sign.y, F(0.0f)),
+            Select(isZ, -sign.z, F(0.0f)) };
+        F insideDepth = radius + Select(isX, gap.x, Select(isY, gap.y, gap.z));
+        Vector3T<F> insidePoint{
+            Select(isX, sign.x * halfSize.x, center.x),
+            Select(isY, sign.y * halfSize.y, center.y),
+            Select(isZ, sign.z * halfSize.z, center.z) };
+
+        Vector3T<F> normal = Select(isOutside, outsideNormal, insideNormal);
+        Vector3T<F> pointB = Select(isOutside, closest, insidePoint);
+        F depth = Select(isOutside, outsideDepth, insideDepth);
+        StoreResult(out, i, normal, center + normal * radius, pointB, depth, Select(isHit, F(1.0f), F(0.0f)));
+    }
+
+    template<class F>
+    void SegmentSegmentKernel(const std::vector<float> (&in)[14], std::vector<float> (&out)[11], size_t i) {
+        Vector3T<F> p1 = LoadVector<F>(in, 0, i);
+        Vector3T<F> q1 = LoadVector<F>(in, 3, i);
+        F radiusA = Load<F>(in[6].data() + i);
+        Vector3T<F> p2 = LoadVector<F>(in, 7, i);
+        Vector3T<F> q2 = LoadVector<F>(in, 10, i);
+        F radiusB = Load<F>(in[13].data() + i);
+
+        // 線分同士の最近点のパラメータ（Ericson）。分岐は全て計算してから選ぶ
+        Vector3T<F> d1 = q1 - p1, d2 = q2 - p2, r = p1 - p2;
+        F a = Dot(d1, d1), e = Dot(d2, d2), f = Dot(d2, r);
+        F c = Dot(d1, r), b = Dot(d1, d2);
+        F safeA = Max(a, F(kEpsilon)), safeE = Max(e, F(kEpsilon));
+        F zero(0.0f), one(1.0f);
+
+        F denominator = a * e - b * b;
+        F s = Select(denominator > F(kEpsilon) * a * e, Clamp((b * f - c * e) / Max(denominator, F(kEpsilon * kEpsilon)), zero, one), zero);
+        F t = (b * s + f) / safeE;
+        auto isBelow = t < zero;
+        auto isAbove = t > one;
+        s = Select(isBelow, Clamp(-c / safeA, zero, one), Select(isAbove, Clamp((b - c) / safeA, zero, one), s));
+        t = Clamp(t, zero, one);
+        // 片方が点
+        auto isPointB = e <= F(kEpsilon);
+        s = Select(isPointB, Clamp(-c / safeA, zero, one), s);
+        t = Select(isPointB, zero, t);
+        auto isPointA = a <= F(kEpsilon);
+        s = Select(isPointA, zero, s);
+        t = Select(isPointA, Select(isPointB, zero, Clamp(f / safeE, zero, one)), t);
+
+        Vector3T<F> closestA = p1 + d1 * s;
+        Vector3T<F> closestB = p2 + d2 * t;
+        Vector3T<F> d = closestB - closestA;
+        F distanceSquare = Dot(d, d);
+        F radiusSum = radiusA + radiusB;
+        auto isHit = distanceSquare <= radiusSum * radiusSum;
+        F distance = Sqrt(distanceSquare);
+        // 芯の線分が交わっていると法線が決まらない
+        auto isDegenerate = distance <= F(kEpsilon);
+        Vector3T<F> normal = d * (F(1.0f) / Max(distance, F(kEpsilon)));
+        StoreResult(out, i, normal, closestA + normal * radiusA, closestB - normal * radiusB, radiusSum - distance, MakeState<F>(isHit, isDegenerate));
+    }
+
+    // 8組ずつ、残りを1組ずつ
+    template<std::uint32_t N, class Kernel8, class Kernel1>
+    void Run(size_t count, const std::vector<float> (&in)[N], std::vector<float> (&out)[11], Kernel8&& kernel8, Kernel1&& kernel1) {
+        size_t i = 0;
+#if defined(__AVX__)
+        for (; i + Float8::kWidth <= count; i += Float8::kWidth) {
+            kernel8(in, out, i);
+        }
+#else
+        (void)kernel8;
+#endif
+        for (; i < count; ++i) {
+            kernel1(in, out, i);
+        }
+    }
+
+    void Push(std::vector<float>* values, const Vector3& v) {
+        values[0].emplace_back(v.x);
+        values[1].emplace_back(v.y);
+        values[2].emplace_back(v.z);
+    }
+}
+
+void PrimitiveBatch::Clear() {
+    sphereSphere_.Clear();
+    sphereBox_.Clear();
+    boxFrames_.clear();
+    segments_.Clear();
+}
+
+bool PrimitiveBatch::Add(const Collider& colliderA, const Collider& colliderB, std::uint32_t index) {
+    Primitive a, b;
+    if (!ExtractPrimitive(colliderA, a) || !ExtractPrimitive(colliderB, b)) {
+        return false;
+    }
+    if (a.shape == Shape::kSphere && b.shape == Shape::kSphere) {
+        Push(sphereSphere_.values + 0, a.p);
+        sphereSphere_.values[3].emplace_back(a.radius);
+        Push(sphereSphere_.values + 4, b.p);
+        sphereSphere_.values[7].emplace_back(b.radius);
+        sphereSphere_.indices.emplace_back(index);
+        return true;
+    }
+    if ((a.shape == Shape::kSphere && b.shape == Shape::kBox) || (a.shape == Shape::kBox && b.shape == Shape::kSphere)) {
+        bool isSphereB = b.shape == Shape::kSphere;
+        const Primitive& sphere = isSphereB ? b : a;
+        const Primitive& box = isSphereB ? a : b;
+        Vector3 offset = sphere.p - box.p;
+        Push(sphereBox_.values + 0, Vector3(Dot(offset, box.axes[0]), Dot(offset, box.axes[1]), Dot(offset, box.axes[2])));
+        sphereBox_.values[3].emplace_back(sphere.radius);
+        Push(sphereBox_.values + 4, box.halfSize);
+        sphereBox_.indices.emplace_back(index);
+        boxFrames_.push_back({ box.p, { box.axes[0], box.axes[1], box.axes[2] }, isSphereB });
+        return true;
+    }
+    if (a.shape != Shape::kBox && b.shape != Shape::kBox) {
+        Push(segments_.values + 0, a.p);
+        Push(segments_.values + 3, a.q);
+        segments_.values[6].emplace_back(a.radius);
+        Push(segments_.values + 7, b.p);
+        Push(segments_.values + 10, b.q);
+        segments_.values[13].emplace_back(b.radius);
+        segments_.indices.emplace_back(index);
+        return true;
+    }
+    return false;
+}
+
+void PrimitiveBatch::Execute(std::vector<Result>& results, std::vector<Contact>& contacts) {
+    auto& out = output_.values;
+    auto readResults = [&](const std::vector<std::uint32_t>& indices, auto&& toWorld) {
+        for (size_t i = 0; i < indices.size(); ++i) {
+            std::uint32_t index = indices[i];
+            float state = out[10][i];
+            if (state == 0.0f) {
+                results[index] = Result::kMiss;
+                continue;
+            }
+            if (state == 2.0f) {
+                results[index] = Result::kFallback;
+                continue;
+            }
+            Contact& contact = contacts[index];
+            contact.normal = { out[0][i], out[1][i], out[2][i] };
+            contact.pointA = { out[3][i], out[4][i], out[5][i] };
+            contact.pointB = { out[6][i], out[7][i], out[8][i] };
+            contact.depth = out[9][i];
+            toWorld(i, contact);
+            results[index] = Result::kHit;
+        }
+    };
+    auto identity = [](size_t, Contact&) {};
+
+    size_t count = sphereSphere_.indices.size();
+    if (count > 0) {
+        output_.Resize(count);
+#if defined(__AVX__)
+        Run(count, sphereSphere_.values, out, SphereSphereKernel<Float8>, SphereSphereKernel<float>);
+#else
+        Run(count, sphereSphere_.values, out, SphereSphereKernel<float>, SphereSphereKernel<float>);
+#endif
+        readResults(sphereSphere_.indices, identity);
+    }
+
+    count = segments_.indices.size();
+    if (count > 0) {
+        output_.Resize(count);
+#if defined(__AVX__)
+        Run(count, segments_.values, out, SegmentSegmentKernel<Float8>, SegmentSegmentKernel<float>);
+#else
+        Run(count, segments_.values, out, SegmentSegmentKernel<float>, SegmentSegmentKernel<float>);
+#endif
+        readResults(segments_.indices, identity);
+    }
+
+    count = sphereBox_.indices.size();
+    if (count > 0) {
+        output_.Resize(count);
+#if defined(__AVX__)
+        Run(count, sphereBox_.values, out, SphereBoxKernel<Float8>, SphereBoxKernel<float>);
+#else
+        Run(count, sphereBox_.values, out, SphereBoxKernel<float>, SphereBoxKernel<float>);
+#endif
+        // 箱のローカル空間からワールドへ。球がBなら向きを入れ替える
+        readResults(sphereBox_.indices, [&](size_t i, Contact& contact) {
+            const BoxFrame& frame = boxFrames_[i];
+            auto toWorldDirection = [&](const Vector3& v) { return frame.axes[0] * v.x + frame.axes[1] * v.y + frame.axes[2] * v.z; };
+            contact.normal = toWorldDirection(contact.normal);
+            contact.pointA = frame.center + toWorldDirection(contact.pointA);
+            contact.pointB = frame.center + toWorldDirection(contact.pointB);
+            if (frame.isSphereB) {
+                contact.normal = -contact.normal;
+                std::swap(contact.pointA, contact.pointB);
+            }
+            });
+    }
+}
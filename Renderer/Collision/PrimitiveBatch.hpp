@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "../Math/MathUtils.hpp"
+#include "Narrowphase.hpp"
+
+class Collider;
+
+// 球・カプセル・箱の組を種類ごとに集め、閉じた式でまとめて判定する
+// AVXが使えれば8組ずつ、残りは1組ずつ同じ式で解く
+// 扱えない組（箱同士、非一様スケールなど）はGJKとEPAに回す
+class PrimitiveBatch {
+public:
+    enum class Result : std::uint8_t {
+        kNotBatched,
+        kMiss,
+        kHit,
+        kFallback   // 線分が交わるなど法線が決まらない。GJKとEPAで解き直す
+    };
+
+    void Clear();
+    // 扱える組なら積んでtrue。indexは結果を書く位置
+    bool Add(const Collider& colliderA, const Collider& colliderB, std::uint32_t index);
+    // 積んだ組を判定し、results[index]とcontacts[index]に書く
+    void Execute(std::vector<Result>& results, std::vector<Contact>& contacts);
+
+    std::uint32_t GetSphereSphereCount() const { return static_cast<std::uint32_t>(sphereSphere_.indices.size()); }
+    std::uint32_t GetSphereBoxCount() const { return static_cast<std::uint32_t>(sphereBox_.indices.size()); }
+    std::uint32_t GetSegmentCount() const { return static_cast<std::uint32_t>(segments_.indices.size()); }
+
+private:
+    // 要素ごとに分けた配列（SoA）
+    template<std::uint32_t N>
+    struct Stream {
+        std::vector<float> values[N];
+        std::vector<std::uint32_t> indices;
+
+        void Clear() {
+            for (auto& v : values) { v.clear(); }
+            indices.clear();
+        }
+    };
+    // 箱のローカル空間からワールドへ戻すための姿勢
+    struct BoxFrame {
+        Vector3 center;
+        Vector3 axes[3];
+        bool isSphereB;     // 球がBなら法線と点を入れ替える
+    };
+    // 判定結果（法線、A上の点、B上の点、深さ、状態）
+    struct Output {
+        std::vector<float> values[11];
+
+        void Resize(size_t count) {
+            for (auto& v : values) { v.resize(count); }
+        }
+    };
+
+    // 中心a, 半径a, 中心b, 半径b
+    Stream<8> sphereSphere_;
+    // 箱のローカル空間での球の中心、半径、箱の半分の大きさ
+    Stream<7> sphereBox_;
+    std::vector<BoxFrame> boxFrames_;
+    // 線分a(始点, 終点), 半径a, 線分b(始点, 終点), 半径b。球は長さ0の線分
+    Stream<14> segments_;
+    Output output_;
+};
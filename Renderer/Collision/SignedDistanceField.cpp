@@ -0,0 +1,583 @@
+#include "SignedDistanceField.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cmath>
+#include <fstream>
+#include <map>
+#include <unordered_map>
+
+#include "../Math/SIMD.hpp"
+#include "../ThreadPool.hpp"
+#include "BVH.hpp"
+#include "Triangle.hpp"
+
+using namespace SIMD;
+
+namespace {
+    constexpr float kEpsilon = 1.0e-6f;
+    constexpr std::uint32_t kFileMagic = 0x31464453;    // "SDF1"
+    constexpr std::uint32_t kFileVersion = 1;
+    // 頂点をまとめる距離（メッシュの大きさに対する割合）
+    constexpr float kWeldTolerance = 1.0e-5f;
+
+    // 最も近い部分。擬似法線の番号を兼ねる
+    enum Feature : std::uint32_t {
+        kFace,
+        kVertex0,
+        kVertex1,
+        kVertex2,
+        kEdge01,
+        kEdge12,
+        kEdge20,
+        kFeatureCount
+    };
+
+    // 丸めは最近接偶数。範囲外は無限大
+    std::uint16_t ToHalf(float value) {
+        std::uint32_t bits = std::bit_cast<std::uint32_t>(value);
+        std::uint32_t sign = (bits >> 16) & 0x8000;
+        bits &= 0x7FFFFFFF;
+        std::uint16_t half;
+        if (bits >= 0x47800000) {
+            half = bits > 0x7F800000 ? 0x7E00 : 0x7C00;
+        }
+        else if (bits < 0x38800000) {
+            // 非正規化数。足し算で仮数を右に寄せて丸める
+            constexpr std::uint32_t kDenormMagic = ((127 - 15) + (23 - 10) + 1) << 23;
+            float shifted = std::bit_cast<float>(bits) + std::bit_cast<float>(kDenormMagic);
+            half = static_cast<std::uint16_t>(std::bit_cast<std::uint32_t>(shifted) - kDenormMagic);
+        }
+        else {
+            std::uint32_t isOdd = (bits >> 13) & 1;
+            bits += (static_cast<std::uint32_t>(15 - 127) << 23) + 0xFFF + isOdd;
+            half = static_cast<std::uint16_t>(bits >> 13);
+        }
+        return static_cast<std::uint16_t>(half | sign);
+    }
+
+    float FromHalf(std::uint16_t half) {
+        constexpr std::uint32_t kShiftedExponent = 0x7C00 << 13;
+        std::uint32_t bits = (half & 0x7FFFu) << 13;
+        std::uint32_t exponent = bits & kShiftedExponent;
+        bits += (127 - 15) << 23;
+        if (exponent == kShiftedExponent) {
+            bits += (128 - 16) << 23;
+        }
+        else if (exponent == 0) {
+            // 非正規化数
+            bits += 1 << 23;
+            bits = std::bit_cast<std::uint32_t>(std::bit_cast<float>(bits) - std::bit_cast<float>(113u << 23));
+        }
+        return std::bit_cast<float>(bits | ((half & 0x8000u) << 16));
+    }
+
+    // fp16を4つ読む。F16Cがあれば1命令
+    Float4 LoadHalf4(const std::uint16_t* values) {
+#if defined(__F16C__) || (defined(_MSC_VER) && defined(__AVX2__))
+        return _mm_cvtph_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(values)));
+#else
+        return _mm_setr_ps(FromHalf(values[0]), FromHalf(values[1]), FromHalf(values[2]), FromHalf(values[3]));
+#endif
+    }
+
+    Float4 Lerp(const Float4& a, const Float4& b, float t) {
+        return a + (b - a) * Float4(t);
+    }
+
+    float DistanceSquare(const AABB& aabb, const Vector3& p) {
+        float distanceSquare = 0.0f;
+        for (size_t i = 0; i < 3; ++i) {
+            float d = std::max({ aabb.min[i] - p[i], 0.0f, p[i] - aabb.max[i] });
+            distanceSquare += d * d;
+        }
+        return distanceSquare;
+    }
+
+    // Ericsonの領域判定。featureに最も近い部分を返す
+    Vector3 ClosestPointOnTriangle(const Vector3& p, const Vector3& a, const Vector3& b, const Vector3& c, std::uint32_t& feature) {
+        Vector3 ab = b - a;
+        Vector3 ac = c - a;
+        Vector3 ap = p - a;
+        float d1 = Vector3::Dot(ab, ap);
+        float d2 = Vector3::Dot(ac, ap);
+        if (d1 <= 0.0f && d2 <= 0.0f) {
+            feature = kVertex0;
+            return a;
+        }
+        Vector3 bp = p - b;
+        float d3 = Vector3::Dot(ab, bp);
+        float d4 = Vector3::Dot(ac, bp);
+        if (d3 >= 0.0f && d4 <= d3) {
+            feature = kVertex1;
+            return b;
+        }
+        float vc = d1 * d4 - d3 * d2;
+        if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) {
+            feature = kEdge01;
+            return a + ab * (d1 / (d1 - d3));
+        }
+        Vector3 cp = p - c;
+        float d5 = Vector3::Dot(ab, cp);
+        float d6 = Vector3::Dot(ac, cp);
+        if (d6 >= 0.0f && d5 <= d6) {
+            feature = kVertex2;
+            return c;
+        }
+        float vb = d5 * d2 - d1 * d6;
+        if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) {
+            feature = kEdge20;
+            return a + ac * (d2 / (d2 - d6));
+        }
+        float va = d3 * d6 - d5 * d4;
+        if (va <= 0.0f && d4 - d3 >= 0.0f && d5 - d6 >= 0.0f) {
+            feature = kEdge12;
+            return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+        }
+        float inverse = 1.0f / (va + vb + vc);
+        feature = kFace;
+        return a + ab * (vb * inverse) + ac * (vc * inverse);
+    }
+
+    // 焼くときだけ使う、擬似法線付きの三角形の集まり
+    class BakeMesh {
+    public:
+        BakeMesh(const std::vector<Vector3>& vertices, const std::vector<std::uint32_t>& indices);
+
+        // pに最も近い点を探す。木を近い子から辿り、今の最短より遠い節は飛ばす
+        SignedDistanceField::Sample FindNearest(const Vector3& p) const;
+
+        bool IsEmpty() const { return triangles_.empty(); }
+        const AABB& GetBounds() const { return bvh_.GetBounds(); }
+
+    private:
+        struct Nearest {
+            Vector3 point;
+            float distanceSquare = Math::positiveInfinity;
+            std::uint32_t triangle = 0;
+            std::uint32_t feature = kFace;
+        };
+
+        void Test(const Vector3& p, std::uint32_t index, Nearest& nearest) const;
+        SignedDistanceField::Sample MakeSample(const Vector3& p, const Nearest& nearest) const;
+
+        std::vector<Triangle> triangles_;
+        // 三角形ごとにkFeatureCount個
+        std::vector<Vector3> pseudoNormals_;
+        BVH bvh_;
+    };
+
+    BakeMesh::BakeMesh(const std::vector<Vector3>& vertices, const std::vector<std::uint32_t>& indices) {
+        // 近い頂点をまとめる。生成したメッシュの継ぎ目や極は誤差でずれていることがある
+        AABB vertexBounds;
+        for (const Vector3& vertex : vertices) {
+            vertexBounds.Include(vertex);
+        }
+        Vector3 extent = vertexBounds.Extent();
+        float tolerance = std::max({ extent.x, extent.y, extent.z, kEpsilon }) * kWeldTolerance;
+        std::map<std::array<std::int64_t, 3>, std::uint32_t> weldMap;
+        std::vector<std::uint32_t> welded(vertices.size());
+        std::vector<Vector3> positions;
+        for (size_t i = 0; i < vertices.size(); ++i) {
+            std::array<std::int64_t, 3> key = {
+                std::llround(vertices[i].x / tolerance),
+                std::llround(vertices[i].y / tolerance),
+                std::llround(vertices[i].z / tolerance) };
+            auto [iter, isInserted] = weldMap.try_emplace(key, static_cast<std::uint32_t>(positions.size()));
+            if (isInserted) {
+                positions.push_back(vertices[i]);
+            }
+            welded[i] = iter->second;
+        }
+
+        // 面積のある三角形だけ残す
+        std::vector<std::array<std::uint32_t, 3>> faces;
+        std::vector<Vector3> faceNormals;
+        for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+            std::array<std::uint32_t, 3> face = { welded[indices[i]], welded[indices[i + 1]], welded[indices[i + 2]] };
+            if (face[0] == face[1] || face[1] == face[2] || face[2] == face[0]) {
+                continue;
+            }
+            Vector3 cross = Vector3::Cross(positions[face[1]] - positions[face[0]], positions[face[2]] - positions[face[0]]);
+            float length = cross.Length();
+            if (length <= kEpsilon * kEpsilon) {
+                continue;
+            }
+            faces.push_back(face);
+            faceNormals.push_back(cross / length);
+        }
+        if (faces.empty()) {
+            return;
+        }
+
+        // 頂点は角度で、辺は隣り合う面で重み付けした法線の和
+        std::vector<Vector3> vertexNormals(positions.size(), Vector3::zero);
+        std::unordered_map<std::uint64_t, Vector3> edgeNormals;
+        auto edgeKey = [](std::uint32_t a, std::uint32_t b) {
+            return a < b ? (static_cast<std::uint64_t>(a) << 32) | b : (static_cast<std::uint64_t>(b) << 32) | a;
+            };
+        for (size_t i = 0; i < faces.size(); ++i) {
+            for (std::uint32_t corner = 0; corner < 3; ++corner) {
+                std::uint32_t vertex = faces[i][corner];
+                std::uint32_t next = faces[i][(corner + 1) % 3];
+                std::uint32_t previous = faces[i][(corner + 2) % 3];
+                Vector3 toNext = (positions[next] - positions[vertex]).Normalized();
+                Vector3 toPrevious = (positions[previous] - positions[vertex]).Normalized();
+                float angle = std::acos(std::clamp(Vector3::Dot(toNext, toPrevious), -1.0f, 1.0f));
+                vertexNormals[vertex] += faceNormals[i] * angle;
+                edgeNormals[edgeKey(vertex, next)] += faceNormals[i];
+            }
+        }
+
+        triangles_.resize(faces.size());
+        pseudoNormals_.resize(faces.size() * kFeatureCount);
+        std::vector<AABB> bounds(faces.size());
+        for (size_t i = 0; i < faces.size(); ++i) {
+            const auto& face = faces[i];
+            Triangle& triangle = triangles_[i];
+            for (std::uint32_t corner = 0; corner < 3; ++corner) {
+                triangle.vertices[corner] = positions[face[corner]];
+            }
+            Vector3* normals = pseudoNormals_.data() + i * kFeatureCount;
+            normals[kFace] = faceNormals[i];
+            normals[kVertex0] = vertexNormals[face[0]];
+            normals[kVertex1] = vertexNormals[face[1]];
+            normals[kVertex2] = vertexNormals[face[2]];
+            normals[kEdge01] = edgeNormals[edgeKey(face[0], face[1])];
+            normals[kEdge12] = edgeNormals[edgeKey(face[1], face[2])];
+            normals[kEdge20] = edgeNormals[edgeKey(face[2], face[0])];
+            bounds[i] = AABB(triangle.vertices[0], triangle.vertices[1], triangle.vertices[2]);
+        }
+        bvh_.Build(bounds, BVH::SplitMethod::kSAH);
+    }
+
+    SignedDistanceField::Sample BakeMesh::FindNearest(const Vector3& p) const {
+        const auto& nodes = bvh_.GetNodes();
+        const auto& indices = bvh_.GetIndices();
+        Nearest nearest;
+        // 木の深さはBVHが抑えている
+        std::uint32_t stack[BVH::kStackSize];
+        std::uint32_t stackSize = 0;
+        stack[stackSize++] = 0;
+        while (stackSize > 0) {
+            const BVH::Node& node = nodes[stack[--stackSize]];
+            if (DistanceSquare(node.aabb, p) >= nearest.distanceSquare) {
+                continue;
+            }
+            if (node.IsLeaf()) {
+                for (std::uint32_t i = 0; i < node.count; ++i) {
+                    Test(p, indices[node.firstIndex + i], nearest);
+                }
+                continue;
+            }
+            // 近い方を後に積んで先に辿る
+            std::uint32_t left = static_cast<std::uint32_t>(&node - nodes.data()) + 1;
+            std::uint32_t right = node.rightChild;
+            if (DistanceSquare(nodes[left].aabb, p) < DistanceSquare(nodes[right].aabb, p)) {
+                std::swap(left, right);
+            }
+            assert(stackSize + 2 <= BVH::kStackSize);
+            stack[stackSize++] = left;
+            stack[stackSize++] = right;
+        }
+        return MakeSample(p, nearest);
+    }
+
+    void BakeMesh::Test(const Vector3& p, std::uint32_t index, Nearest& nearest) const {
+        const Triangle& triangle = triangles_[index];
+        std::uint32_t feature;
+        Vector3 point = ClosestPointOnTriangle(p, triangle.vertices[0], triangle.vertices[1], triangle.vertices[2], feature);
+        float distanceSquare = (p - point).LengthSquare();
+        if (distanceSquare < nearest.distanceSquare) {
+            nearest.point = point;
+            nearest.distanceSquare = distanceSquare;
+            nearest.triangle = index;
+            nearest.feature = feature;
+        }
+    }
+
+    SignedDistanceField::Sample BakeMesh::MakeSample(const Vector3& p, const Nearest& nearest) const {
+        const Vector3& pseudoNormal = pseudoNormals_[nearest.triangle * kFeatureCount + nearest.feature];
+        Vector3 delta = p - nearest.point;
+        float sign = Vector3::Dot(delta, pseudoNormal) >= 0.0f ? 1.0f : -1.0f;
+        float distance = std::sqrt(nearest.distanceSquare);
+        // 面の内側なら内外によらず面法線が勾配。面の上の格子点は丸め誤差だけのdeltaになるので向きに使わない
+        Vector3 gradient;
+        if (nearest.feature == kFace) {
+            gradient = pseudoNormal;
+        }
+        else {
+            gradient = distance > kEpsilon ? delta * (sign / distance) : pseudoNormal.Normalized();
+        }
+        return { distance * sign, gradient };
+    }
+
+    template<class T>
+    void Write(std::ofstream& file, const T& value) {
+        file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template<class T>
+    void WriteArray(std::ofstream& file, const std::vector<T>& values) {
+        Write(file, static_cast<std::uint64_t>(values.size()));
+        file.write(reinterpret_cast<const char*>(values.data()), static_cast<std::streamsize>(values.size() * sizeof(T)));
+    }
+
+    template<class T>
+    bool Read(std::ifstream& file, T& value) {
+        file.read(reinterpret_cast<char*>(&value), sizeof(T));
+        return static_cast<bool>(file);
+    }
+
+    // 要素数がexpectedでなければ読まない
+    template<class T>
+    bool ReadArray(std::ifstream& file, std::vector<T>& values, std::uint64_t expected) {
+        std::uint64_t size;
+        if (!Read(file, size) || size != expected) {
+            return false;
+        }
+        values.resize(static_cast<size_t>(size));
+        file.read(reinterpret_cast<char*>(values.data()), static_cast<std::streamsize>(values.size() * sizeof(T)));
+        return static_cast<bool>(file);
+    }
+
+    // FNV-1a
+    void HashBytes(std::uint64_t& hash, const void* data, size_t size) {
+        const auto* bytes = static_cast<const std::uint8_t*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash = (hash ^ bytes[i]) * 0x100000001B3ull;
+        }
+    }
+}
+
+void SignedDistanceField::Bake(const std::vector<Vector3>& vertices, const std::vector<std::uint32_t>& indices, const Settings& settings) {
+    Clear();
+    settings_ = settings;
+    BakeMesh mesh(vertices, indices);
+    if (mesh.IsEmpty() || settings.cellSize <= 0.0f) {
+        return;
+    }
+    meshBounds_ = mesh.GetBounds();
+
+    // 帯が収まるようにブリック単位で格子を取り、メッシュの中心に合わせる
+    float cellSize = settings.cellSize;
+    float brickLength = cellSize * static_cast<float>(kBrickSize);
+    Vector3 extent = meshBounds_.Extent();
+    Vector3 gridExtent;
+    for (size_t i = 0; i < 3; ++i) {
+        float length = extent[i] + (settings.bandWidth + cellSize) * 2.0f;
+        brickCounts_[i] = std::max(static_cast<std::uint32_t>(std::ceil(length / brickLength)), 1u);
+        gridExtent[i] = static_cast<float>(brickCounts_[i]) * brickLength;
+    }
+    origin_ = meshBounds_.Center() - gridExtent * 0.5f;
+    invCellSize_ = 1.0f / cellSize;
+
+    ThreadPool& threadPool = ThreadPool::GetShared();
+    auto pack = [](const Sample& sample) {
+        return PackedSample{ { ToHalf(sample.distance), ToHalf(sample.gradient.x), ToHalf(sample.gradient.y), ToHalf(sample.gradient.z) } };
+        };
+
+    // 粗い格子。帯の外の補間にだけ使う
+    coarse_.resize(static_cast<size_t>(brickCounts_[0] + 1) * (brickCounts_[1] + 1) * (brickCounts_[2] + 1));
+    threadPool.ParallelFor(brickCounts_[2] + 1, [&](std::uint32_t z) {
+        for (std::uint32_t y = 0; y <= brickCounts_[1]; ++y) {
+            for (std::uint32_t x = 0; x <= brickCounts_[0]; ++x) {
+                Vector3 point = origin_ + Vector3(static_cast<float>(x), static_cast<float>(y), static_cast<float>(z)) * brickLength;
+                coarse_[GetCoarseIndex(x, y, z)] = pack(mesh.FindNearest(point));
+            }
+        }
+        });
+
+    // 中心の距離から、どこかの格子点が帯に入るブリックを選ぶ
+    std::uint32_t tableSize = brickCounts_[0] * brickCounts_[1] * brickCounts_[2];
+    float halfDiagonal = brickLength * 0.5f * std::sqrt(3.0f);
+    std::vector<float> centerDistances(tableSize);
+    auto getBrickCenter = [&](std::uint32_t index) {
+        std::uint32_t x = index % brickCounts_[0];
+        std::uint32_t y = index / brickCounts_[0] % brickCounts_[1];
+        std::uint32_t z = index / (brickCounts_[0] * brickCounts_[1]);
+        return origin_ + Vector3(static_cast<float>(x) + 0.5f, static_cast<float>(y) + 0.5f, static_cast<float>(z) + 0.5f) * brickLength;
+        };
+    threadPool.ParallelFor(tableSize, [&](std::uint32_t index) {
+        centerDistances[index] = std::abs(mesh.FindNearest(getBrickCenter(index)).distance);
+        });
+    brickTable_.assign(tableSize, kEmptyBrick);
+    std::uint32_t brickCount = 0;
+    for (std::uint32_t index = 0; index < tableSize; ++index) {
+        if (centerDistances[index] - halfDiagonal <= settings.bandWidth) {
+            brickTable_[index] = brickCount++;
+        }
+    }
+
+    bricks_.resize(static_cast<size_t>(brickCount) * kBrickSampleCount);
+    threadPool.ParallelFor(tableSize, [&](std::uint32_t index) {
+        if (brickTable_[index] == kEmptyBrick) {
+            return;
+        }
+        Vector3 corner = getBrickCenter(index) - Vector3(brickLength, brickLength, brickLength) * 0.5f;
+        PackedSample* samples = bricks_.data() + static_cast<size_t>(brickTable_[index]) * kBrickSampleCount;
+        for (std::uint32_t z = 0; z < kBrickSampleSize; ++z) {
+            for (std::uint32_t y = 0; y < kBrickSampleSize; ++y) {
+                for (std::uint32_t x = 0; x < kBrickSampleSize; ++x) {
+                    Vector3 point = corner + Vector3(static_cast<float>(x), static_cast<float>(y), static_cast<float>(z)) * cellSize;
+                    *samples++ = pack(mesh.FindNearest(point));
+                }
+            }
+        }
+        });
+}
+
+void SignedDistanceField::Clear() {
+    meshBounds_ = AABB();
+    origin_ = Vector3::zero;
+    invCellSize_ = 0.0f;
+    std::fill(std::begin(brickCounts_), std::end(brickCounts_), 0u);
+    brickTable_.clear();
+    coarse_.clear();
+    bricks_.clear();
+}
+
+bool SignedDistanceField::Save(const std::filesystem::path& path, std::uint64_t sourceHash) const {
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    Write(file, kFileMagic);
+    Write(file, kFileVersion);
+    Write(file, sourceHash);
+    Write(file, settings_);
+    Write(file, meshBounds_.min);
+    Write(file, meshBounds_.max);
+    Write(file, origin_);
+    Write(file, brickCounts_);
+    WriteArray(file, brickTable_);
+    WriteArray(file, coarse_);
+    WriteArray(file, bricks_);
+    return static_cast<bool>(file);
+}
+
+bool SignedDistanceField::Load(const std::filesystem::path& path, std::uint64_t sourceHash) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    std::uint32_t magic = 0, version = 0;
+    std::uint64_t hash = 0;
+    if (!Read(file, magic) || magic != kFileMagic || !Read(file, version) || version != kFileVersion || !Read(file, hash) || hash != sourceHash) {
+        return false;
+    }
+    SignedDistanceField field;
+    if (!Read(file, field.settings_) || !Read(file, field.meshBounds_.min) || !Read(file, field.meshBounds_.max) || !Read(file, field.origin_) || !Read(file, field.brickCounts_)) {
+        return false;
+    }
+    if (field.settings_.cellSize <= 0.0f) {
+        return false;
+    }
+    std::uint64_t tableSize = static_cast<std::uint64_t>(field.brickCounts_[0]) * field.brickCounts_[1] * field.brickCounts_[2];
+    std::uint64_t coarseSize = static_cast<std::uint64_t>(field.brickCounts_[0] + 1) * (field.brickCounts_[1] + 1) * (field.brickCounts_[2] + 1);
+    if (!ReadArray(file, field.brickTable_, tableSize) || !ReadArray(file, field.coarse_, coarseSize)) {
+        return false;
+    }
+    // 表の指すブリックが全部あること
+    std::uint64_t brickCount = 0;
+    for (std::uint32_t index : field.brickTable_) {
+        if (index != kEmptyBrick) {
+            if (index != brickCount) {
+                return false;
+            }
+            ++brickCount;
+        }
+    }
+    if (!ReadArray(file, field.bricks_, brickCount * kBrickSampleCount)) {
+        return false;
+    }
+    field.invCellSize_ = 1.0f / field.settings_.cellSize;
+    *this = std::move(field);
+    return true;
+}
+
+std::uint64_t SignedDistanceField::ComputeSourceHash(const std::vector<Vector3>& vertices, const std::vector<std::uint32_t>& indices, const Settings& settings) {
+    std::uint64_t hash = 0xCBF29CE484222325ull;
+    HashBytes(hash, &kFileVersion, sizeof(kFileVersion));
+    for (const Vector3& vertex : vertices) {
+        HashBytes(hash, &vertex.x, sizeof(float) * 3);
+    }
+    HashBytes(hash, indices.data(), indices.size() * sizeof(std::uint32_t));
+    HashBytes(hash, &settings.cellSize, sizeof(settings.cellSize));
+    HashBytes(hash, &settings.bandWidth, sizeof(settings.bandWidth));
+    return hash;
+}
+
+SignedDistanceField::Sample SignedDistanceField::Evaluate(const Vector3& point) const {
+    if (IsEmpty()) {
+        return { Math::positiveInfinity, Vector3::unitY };
+    }
+    // 格子の外は格子の表面に寄せ、はみ出した距離を後で足す
+    Vector3 cell = (point - origin_) * invCellSize_;
+    Vector3 clamped;
+    std::uint32_t brick[3];
+    std::uint32_t local[3];
+    float fraction[3];
+    float brickFraction[3];
+    for (size_t i = 0; i < 3; ++i) {
+        clamped[i] = std::clamp(cell[i], 0.0f, static_cast<float>(brickCounts_[i] * kBrickSize));
+        brick[i] = std::min(static_cast<std::uint32_t>(clamped[i]) / kBrickSize, brickCounts_[i] - 1);
+        float inBrick = clamped[i] - static_cast<float>(brick[i] * kBrickSize);
+        local[i] = std::min(static_cast<std::uint32_t>(inBrick), kBrickSize - 1);
+        fraction[i] = inBrick - static_cast<float>(local[i]);
+        brickFraction[i] = inBrick / static_cast<float>(kBrickSize);
+    }
+    float outside = (cell - clamped).Length() * settings_.cellSize;
+
+    const PackedSample* base;
+    size_t strideY, strideZ;
+    const float* t;
+    std::uint32_t index = brickTable_[GetBrickIndex(brick[0], brick[1], brick[2])];
+    if (index != kEmptyBrick) {
+        base = bricks_.data() + static_cast<size_t>(index) * kBrickSampleCount + local[0] + kBrickSampleSize * (local[1] + kBrickSampleSize * local[2]);
+        strideY = kBrickSampleSize;
+        strideZ = kBrickSampleSize * kBrickSampleSize;
+        t = fraction;
+    }
+    else {
+        base = coarse_.data() + GetCoarseIndex(brick[0], brick[1], brick[2]);
+        strideY = brickCounts_[0] + 1;
+        strideZ = strideY * (brickCounts_[1] + 1);
+        t = brickFraction;
+    }
+
+    // 距離と勾配の4成分をまとめて三線形補間する
+    auto load = [](const PackedSample* sample) { return LoadHalf4(sample->values); };
+    Float4 y0 = Lerp(Lerp(load(base), load(base + 1), t[0]), Lerp(load(base + strideY), load(base + strideY + 1), t[0]), t[1]);
+    base += strideZ;
+    Float4 y1 = Lerp(Lerp(load(base), load(base + 1), t[0]), Lerp(load(base + strideY), load(base + strideY + 1), t[0]), t[1]);
+    float values[4];
+    Store(values, Lerp(y0, y1, t[2]));
+
+    Vector3 gradient(values[1], values[2], values[3]);
+    float length = gradient.Length();
+    return { values[0] + outside, length > kEpsilon ? gradient / length : Vector3::unitY };
+}
+
+SignedDistanceField::Sample SignedDistanceField::Evaluate(const Vector3& point, const Matrix4x4& toLocal) const {
+    Sample sample = Evaluate(point * toLocal);
+    // 勾配は逆行列の転置で戻し、その長さで距離を割る
+    Vector3 gradient(
+        Vector3::Dot(toLocal.GetXAxis(), sample.gradient),
+        Vector3::Dot(toLocal.GetYAxis(), sample.gradient),
+        Vector3::Dot(toLocal.GetZAxis(), sample.gradient));
+    float length = gradient.Length();
+    if (length <= kEpsilon) {
+        return sample;
+    }
+    return { sample.distance / length, gradient / length };
+}
+
+size_t SignedDistanceField::GetMemoryUsage() const {
+    return
+        brickTable_.capacity() * sizeof(std::uint32_t) +
+        coarse_.capacity() * sizeof(PackedSample) +
+        bricks_.capacity() * sizeof(PackedSample);
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+#include "../Math/MathUtils.hpp"
+#include "../AABB.hpp"
+
+// メッシュを焼き込んだ符号付き距離場。ローカル空間の格子点に距離と勾配をfp16で持つ
+// 面から帯幅以内に掛かる8x8x8セルのブリックだけ細かい格子点を持ち、ほかはブリックの角の粗い格子で補間する
+// ブリックは密な表を1回引けば見つかるので、1点の問い合わせは三線形補間1回で終わる
+// 符号は最も近い面、辺、頂点の角度重み付き擬似法線で決める。閉じていないメッシュは表の向く側を外とする
+class SignedDistanceField {
+public:
+    // ブリックの1辺のセル数。格子点は隣と共有せず、1辺にkBrickSize+1個持つ
+    static constexpr std::uint32_t kBrickSize = 8;
+
+    struct Settings {
+        // 細かい格子の間隔（ローカル空間）
+        float cellSize = 0.1f;
+        // 面からこの距離までは細かい格子で持つ
+        float bandWidth = 0.3f;
+    };
+
+    // 距離は外が正。勾配は距離が増える向きの単位ベクトル
+    struct Sample {
+        float distance;
+        Vector3 gradient;
+    };
+
+    // indicesは3つずつで1枚。位置が同じ頂点はつながっているものとして扱う
+    void Bake(const std::vector<Vector3>& vertices, const std::vector<std::uint32_t>& indices, const Settings& settings);
+    void Clear();
+    // 焼いた結果を書き出す。sourceHashは元のメッシュと設定の指紋で、Loadで照合する
+    bool Save(const std::filesystem::path& path, std::uint64_t sourceHash) const;
+    // ファイルが無いか、形式かsourceHashが合わなければfalseで、中身は変えない
+    bool Load(const std::filesystem::path& path, std::uint64_t sourceHash);
+    static std::uint64_t ComputeSourceHash(const std::vector<Vector3>& vertices, const std::vector<std::uint32_t>& indices, const Settings& settings);
+
+    // ローカル空間の点。格子の外では格子の表面までの距離を足す
+    Sample Evaluate(const Vector3& point) const;
+    // ワールド空間の点。toLocalはワールド行列の逆行列で、拡縮は勾配の長さで距離に戻す
+    Sample Evaluate(const Vector3& point, const Matrix4x4& toLocal) const;
+
+    bool IsEmpty() const { return brickTable_.empty(); }
+    // 元のメッシュのローカル空間の境界
+    const AABB& GetMeshBounds() const { return meshBounds_; }
+    const Settings& GetSettings() const { return settings_; }
+    std::uint32_t GetBrickCount() const { return static_cast<std::uint32_t>(bricks_.size() / kBrickSampleCount); }
+    std::uint32_t GetBrickTableSize() const { return static_cast<std::uint32_t>(brickTable_.size()); }
+    size_t GetMemoryUsage() const;
+
+private:
+    static constexpr std::uint32_t kBrickSampleSize = kBrickSize + 1;
+    static constexpr std::uint32_t kBrickSampleCount = kBrickSampleSize * kBrickSampleSize * kBrickSampleSize;
+    static constexpr std::uint32_t kEmptyBrick = 0xFFFFFFFF;
+
+    // fp16で距離、勾配x, y, z
+    struct PackedSample {
+        std::uint16_t values[4];
+    };
+
+    std::uint32_t GetBrickIndex(std::uint32_t x, std::uint32_t y, std::uint32_t z) const { return x + brickCounts_[0] * (y + brickCounts_[1] * z); }
+    std::uint32_t GetCoarseIndex(std::uint32_t x, std::uint32_t y, std::uint32_t z) const { return x + (brickCounts_[0] + 1) * (y + (brickCounts_[1] + 1) * z); }
+
+    Settings settings_;
+    AABB meshBounds_;
+    // 格子の最小の角
+    Vector3 origin_;
+    float invCellSize_ = 0.0f;
+    std::uint32_t brickCounts_[3] = {};
+    // ブリックごとにbricks_の中の番号。帯に掛からなければkEmptyBrick
+    std::vector<std::uint32_t> brickTable_;
+    // ブリックの角の格子点
+    std::vector<PackedSample> coarse_;
+    // 帯に掛かるブリックの格子点をkBrickSampleCount個ずつ。x優先
+    std::vector<PackedSample> bricks_;
+};
@@ -0,0 +1,66 @@
+#include "StaticTree.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+void StaticTree::Insert(std::uint32_t id, const AABB& aabb) {
+    if (id >= idToIndex_.size()) {
+        idToIndex_.resize(id + 1, kInvalidIndex);
+    }
+    assert(idToIndex_[id] == kInvalidIndex);
+    idToIndex_[id] = static_cast<std::uint32_t>(entries_.size());
+    entries_.push_back({ aabb, id, false });
+}
+
+void StaticTree::Remove(std::uint32_t id) {
+    assert(id < idToIndex_.size() && idToIndex_[id] != kInvalidIndex);
+    std::uint32_t index = idToIndex_[id];
+    idToIndex_[id] = kInvalidIndex;
+    if (index < builtCount_) {
+        // 木の中は印だけ付ける
+        entries_[index].isRemoved = true;
+        ++removedCount_;
+        return;
+    }
+    // 保留中なら末尾と入れ替えて消す
+    entries_[index] = entries_.back();
+    if (index < entries_.size() - 1) {
+        idToIndex_[entries_[index].id] = index;
+    }
+    entries_.pop_back();
+}
+
+void StaticTree::Clear() {
+    entries_.clear();
+    idToIndex_.clear();
+    bvh_.Clear();
+    builtCount_ = 0;
+    removedCount_ = 0;
+}
+
+bool StaticTree::NeedsRebuild() const {
+    std::uint32_t threshold = std::max(kMinRebuildCount, GetCount() / 8);
+    return GetPendingCount() > threshold || removedCount_ > threshold;
+}
+
+void StaticTree::Rebuild() {
+    auto end = std::remove_if(entries_.begin(), entries_.end(), [](const Entry& entry) { return entry.isRemoved; });
+    entries_.erase(end, entries_.end());
+    bounds_.clear();
+    for (std::uint32_t i = 0; i < entries_.size(); ++i) {
+        idToIndex_[entries_[i].id] = i;
+        bounds_.emplace_back(entries_[i].aabb);
+    }
+    bvh_.Build(bounds_, BVH::SplitMethod::kSAH);
+    builtCount_ = static_cast<std::uint32_t>(entries_.size());
+    removedCount_ = 0;
+}
+
+size_t StaticTree::GetMemoryUsage() const {
+    return
+        entries_.capacity() * sizeof(Entry) +
+        idToIndex_.capacity() * sizeof(std::uint32_t) +
+        bounds_.capacity() * sizeof(AABB) +
+        bvh_.GetNodes().capacity() * sizeof(BVH::Node) +
+        bvh_.GetIndices().capacity() * sizeof(std::uint32_t);
+}
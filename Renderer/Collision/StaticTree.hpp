@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "../AABB.hpp"
+#include "BVH.hpp"
+
+// 動かないコライダー用の広域判定
+// SAHで一括構築し、構築後は更新しない。追加は保留リストに積み、削除は印を付けるだけ
+// 保留や削除が溜まったら作り直す
+class StaticTree {
+public:
+    // 保留や削除がこれと全体の1/8の大きい方を超えたら作り直す
+    static constexpr std::uint32_t kMinRebuildCount = 32;
+
+    void Insert(std::uint32_t id, const AABB& aabb);
+    void Remove(std::uint32_t id);
+    void Clear();
+
+    bool NeedsRebuild() const;
+    void Rebuild();
+
+    // boundsと重なる要素のIDについてfuncを呼ぶ
+    template<class Func>
+    void Query(const AABB& bounds, Func&& func) const {
+        bvh_.Query(bounds, [&](std::uint32_t index) {
+            const Entry& entry = entries_[index];
+            if (!entry.isRemoved && entry.aabb.Intersects(bounds)) {
+                func(entry.id);
+            }
+            });
+        for (std::uint32_t i = builtCount_; i < entries_.size(); ++i) {
+            if (entries_[i].aabb.Intersects(bounds)) {
+                func(entries_[i].id);
+            }
+        }
+    }
+    // 線分[origin, origin + direction * maxDistance]とAABBが交差する要素のIDについてfuncを呼ぶ
+    template<class Func>
+    void Raycast(const Vector3& origin, const Vector3& direction, float maxDistance, Func&& func) const {
+        auto test = [&](const Entry& entry) {
+            float tMin = 0.0f, tMax = maxDistance;
+            if (!entry.isRemoved && entry.aabb.IntersectsRay(origin, direction, tMin, tMax)) {
+                func(entry.id);
+            }
+        };
+        bvh_.Raycast(origin, direction, maxDistance, [&](std::uint32_t index) { test(entries_[index]); });
+        for (std::uint32_t i = builtCount_; i < entries_.size(); ++i) {
+            test(entries_[i]);
+        }
+    }
+
+    std::uint32_t GetCount() const { return static_cast<std::uint32_t>(entries_.size()) - removedCount_; }
+    std::uint32_t GetPendingCount() const { return static_cast<std::uint32_t>(entries_.size()) - builtCount_; }
+    size_t GetMemoryUsage() const;
+
+private:
+    static constexpr std::uint32_t kInvalidIndex = 0xFFFFFFFF;
+
+    struct Entry {
+        AABB aabb;
+        std::uint32_t id;
+        bool isRemoved;
+    };
+
+    // [0, builtCount_)が木に入っていて、残りが保留
+    std::vector<Entry> entries_;
+    std::vector<std::uint32_t> idToIndex_;
+    std::vector<AABB> bounds_;
+    BVH bvh_;
+    std::uint32_t builtCount_ = 0;
+    std::uint32_t removedCount_ = 0;
+};
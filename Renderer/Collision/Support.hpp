@@ -0,0 +1,27 @@
+#pragma once
+
+#include "../Math/MathUtils.hpp"
+
+// 原点中心の基本形状のサポート写像
+namespace Support {
+
+    inline Vector3 Sphere(const Vector3& direction, float radius) {
+        float length = direction.Length();
+        return length > 0.0f ? direction * (radius / length) : Vector3::zero;
+    }
+
+    inline Vector3 Box(const Vector3& direction, const Vector3& halfSize) {
+        return {
+            direction.x >= 0.0f ? halfSize.x : -halfSize.x,
+            direction.y >= 0.0f ? halfSize.y : -halfSize.y,
+            direction.z >= 0.0f ? halfSize.z : -halfSize.z };
+    }
+
+    // Y軸方向のカプセル
+    inline Vector3 Capsule(const Vector3& direction, float radius, float halfSegment) {
+        Vector3 point = Sphere(direction, radius);
+        point.y += direction.y >= 0.0f ? halfSegment : -halfSegment;
+        return point;
+    }
+
+}
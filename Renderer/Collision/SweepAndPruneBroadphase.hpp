@@ -0,0 +1,45 @@
+#pragma once
+#include "Broadphase.hpp"
+
+// X軸でソートして掃引する
+// 前フレームの並びを残して挿入ソートで時間的な連続性を活かす
+class SweepAndPruneBroadphase :
+    public Broadphase {
+public:
+    SweepAndPruneBroadphase() : isSorted_(true), isOrdered_(true), maxWidthX_(0.0f) {}
+
+    void Insert(std::uint32_t id, const AABB& aabb) override;
+    void Remove(std::uint32_t id) override;
+    void Move(std::uint32_t id, const AABB& aabb) override;
+    void Clear() override;
+
+    void ComputePairs(std::vector<std::uint64_t>& pairs) override;
+    void Query(const AABB& bounds, std::vector<std::uint32_t>& ids) const override;
+    void Raycast(const Vector3& origin, const Vector3& direction, float maxDistance, std::vector<std::uint32_t>& ids) const override;
+
+    BroadphaseType GetType() const override { return BroadphaseType::kSweepAndPrune; }
+    std::uint32_t GetCount() const override { return static_cast<std::uint32_t>(entries_.size()); }
+    size_t GetMemoryUsage() const override;
+
+private:
+    static constexpr std::uint32_t kInvalidIndex = 0xFFFFFFFF;
+
+    struct Entry {
+        AABB aabb;
+        std::uint32_t id;
+    };
+
+    void Sort();
+    // min.xが[minX - maxWidthX_, maxX]に入る要素の範囲。並びが崩れていれば全体
+    void FindRange(float minX, float maxX, size_t& first, size_t& last) const;
+
+    std::vector<Entry> entries_;
+    // IDからentries_の番号
+    std::vector<std::uint32_t> idToIndex_;
+    // 挿入と削除で並びが崩れたら全体をソートし直す
+    bool isSorted_;
+    // entries_が今のmin.xの順に並んでいる。Sortで立ち、挿入、削除、移動で落ちる
+    bool isOrdered_;
+    // Sortしたときの最も大きいXの幅。問い合わせの範囲をこれだけ手前に広げる
+    float maxWidthX_;
+};
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "../Math/MathUtils.hpp"
+
+struct Triangle {
+    Vector3 FindFurthestPoint(const Vector3& direction) const {
+        float d0 = Vector3::Dot(vertices[0], direction);
+        float d1 = Vector3::Dot(vertices[1], direction);
+        float d2 = Vector3::Dot(vertices[2], direction);
+        if (d0 >= d1 && d0 >= d2) { return vertices[0]; }
+        return d1 >= d2 ? vertices[1] : vertices[2];
+    }
+    Vector3 Normal() const {
+        return Vector3::Cross(vertices[1] - vertices[0], vertices[2] - vertices[0]).Normalized();
+    }
+
+    Vector3 vertices[3];
+};
+
+// Moller-Trumbore。両面で判定する
+inline bool RaycastTriangle(const Vector3& origin, const Vector3& direction, const Vector3& v0, const Vector3& v1, const Vector3& v2, float& t) {
+    constexpr float kEpsilon = 1.0e-8f;
+    Vector3 edge1 = v1 - v0;
+    Vector3 edge2 = v2 - v0;
+    Vector3 p = Vector3::Cross(direction, edge2);
+    float det = Vector3::Dot(edge1, p);
+    if (std::abs(det) < kEpsilon) {
+        return false;
+    }
+    float invDet = 1.0f / det;
+    Vector3 s = origin - v0;
+    float u = Vector3::Dot(s, p) * invDet;
+    if (u < 0.0f || u > 1.0f) {
+        return false;
+    }
+    Vector3 q = Vector3::Cross(s, edge1);
+    float v = Vector3::Dot(direction, q) * invDet;
+    if (v < 0.0f || u + v > 1.0f) {
+        return false;
+    }
+    t = Vector3::Dot(edge2, q) * invDet;
+    return t >= 0.0f;
+}
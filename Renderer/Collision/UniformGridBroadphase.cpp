@@ -0,0 +1,263 @@
+#include "UniformGridBroadphase.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+UniformGridBroadphase::UniformGridBroadphase(float cellSize) :
+    cellSize_(cellSize),
+    invCellSize_(1.0f / cellSize),
+    isCellListValid_(true) {
+    assert(cellSize > 0.0f);
+}
+
+void UniformGridBroadphase::Insert(std::uint32_t id, const AABB& aabb) {
+    if (id >= idToIndex_.size()) {
+        idToIndex_.resize(id + 1, kInvalidIndex);
+    }
+    assert(idToIndex_[id] == kInvalidIndex);
+    idToIndex_[id] = static_cast<std::uint32_t>(entries_.size());
+    entries_.push_back({ aabb, id });
+    isCellListValid_ = false;
+}
+
+void UniformGridBroadphase::Remove(std::uint32_t id) {
+    assert(id < idToIndex_.size() && idToIndex_[id] != kInvalidIndex);
+    std::uint32_t index = idToIndex_[id];
+    entries_[index] = entries_.back();
+    idToIndex_[entries_[index].id] = index;
+    entries_.pop_back();
+    idToIndex_[id] = kInvalidIndex;
+    isCellListValid_ = false;
+}
+
+void UniformGridBroadphase::Move(std::uint32_t id, const AABB& aabb) {
+    assert(id < idToIndex_.size() && idToIndex_[id] != kInvalidIndex);
+    entries_[idToIndex_[id]].aabb = aabb;
+    isCellListValid_ = false;
+}
+
+void UniformGridBroadphase::Clear() {
+    entries_.clear();
+    idToIndex_.clear();
+    cellEntries_.clear();
+    largeEntries_.clear();
+    isCellListValid_ = true;
+}
+
+void UniformGridBroadphase::ComputePairs(std::vector<std::uint64_t>& pairs) {
+    cellEntries_.clear();
+    largeEntries_.clear();
+    cellBounds_ = AABB();
+    for (std::uint32_t i = 0; i < entries_.size(); ++i) {
+        const AABB& aabb = entries_[i].aabb;
+        std::int32_t minX = ToCell(aabb.min.x), maxX = ToCell(aabb.max.x);
+        std::int32_t minY = ToCell(aabb.min.y), maxY = ToCell(aabb.max.y);
+        std::int32_t minZ = ToCell(aabb.min.z), maxZ = ToCell(aabb.max.z);
+        std::uint64_t cellCount =
+            static_cast<std::uint64_t>(maxX - minX + 1) *
+            static_cast<std::uint64_t>(maxY - minY + 1) *
+            static_cast<std::uint64_t>(maxZ - minZ + 1);
+        if (cellCount > kMaxCellsPerEntry) {
+            largeEntries_.emplace_back(i);
+            continue;
+        }
+        cellBounds_.min = Vector3::Min(cellBounds_.min, aabb.min);
+        cellBounds_.max = Vector3::Max(cellBounds_.max, aabb.max);
+        for (std::int32_t z = minZ; z <= maxZ; ++z) {
+            for (std::int32_t y = minY; y <= maxY; ++y) {
+                for (std::int32_t x = minX; x <= maxX; ++x) {
+                    cellEntries_.push_back({ MakeCellKey(x, y, z), i });
+                }
+            }
+        }
+    }
+    std::sort(cellEntries_.begin(), cellEntries_.end(),
+        [](const CellEntry& lhs, const CellEntry& rhs) { return lhs.cell < rhs.cell; });
+    isCellListValid_ = true;
+
+    // 同じセルの連続区間ごとに総当たり
+    for (size_t begin = 0; begin < cellEntries_.size();) {
+        std::uint64_t cell = cellEntries_[begin].cell;
+        size_t end = begin + 1;
+        while (end < cellEntries_.size() && cellEntries_[end].cell == cell) { ++end; }
+        for (size_t i = begin; i < end; ++i) {
+            const Entry& entryA = entries_[cellEntries_[i].index];
+            for (size_t j = i + 1; j < end; ++j) {
+                const Entry& entryB = entries_[cellEntries_[j].index];
+                if (!entryA.aabb.Intersects(entryB.aabb)) {
+                    continue;
+                }
+                // 重なり領域の最小角を含むセルでだけ出す
+                Vector3 corner = Vector3::Max(entryA.aabb.min, entryB.aabb.min);
+                if (MakeCellKey(ToCell(corner.x), ToCell(corner.y), ToCell(corner.z)) == cell) {
+                    pairs.emplace_back(MakePairKey(entryA.id, entryB.id));
+                }
+            }
+        }
+        begin = end;
+    }
+
+    // 大きな要素は全要素と調べる。大きな要素同士は一度だけ（largeEntries_は昇順）
+    for (size_t i = 0; i < largeEntries_.size(); ++i) {
+        std::uint32_t largeIndex = largeEntries_[i];
+        const Entry& large = entries_[largeIndex];
+        for (std::uint32_t j = 0; j < entries_.size(); ++j) {
+            if (j == largeIndex) { continue; }
+            bool isLarge = std::binary_search(largeEntries_.begin(), largeEntries_.end(), j);
+            if (isLarge && j < largeIndex) { continue; }
+            if (large.aabb.Intersects(entries_[j].aabb)) {
+                pairs.emplace_back(MakePairKey(large.id, entries_[j].id));
+            }
+        }
+    }
+}
+
+template<class Function>
+void UniformGridBroadphase::ForEachInCell(std::uint64_t cell, Function&& test) const {
+    auto range = std::equal_range(cellEntries_.begin(), cellEntries_.end(), CellEntry{ cell, 0 },
+        [](const CellEntry& lhs, const CellEntry& rhs) { return lhs.cell < rhs.cell; });
+    for (auto it = range.first; it != range.second; ++it) {
+        test(entries_[it->index]);
+    }
+}
+
+void UniformGridBroadphase::Query(const AABB& bounds, std::vector<std::uint32_t>& ids) const {
+    std::int32_t minX = ToCell(bounds.min.x), maxX = ToCell(bounds.max.x);
+    std::int32_t minY = ToCell(bounds.min.y), maxY = ToCell(bounds.max.y);
+    std::int32_t minZ = ToCell(bounds.min.z), maxZ = ToCell(bounds.max.z);
+    std::uint64_t cellCount =
+        static_cast<std::uint64_t>(maxX - minX + 1) *
+        static_cast<std::uint64_t>(maxY - minY + 1) *
+        static_cast<std::uint64_t>(maxZ - minZ + 1);
+    // セル列が古いか、セルを引くより全要素を見た方が早ければ総当たり
+    if (!isCellListValid_ || cellCount > entries_.size()) {
+        for (const auto& entry : entries_) {
+            if (entry.aabb.Intersects(bounds)) {
+                ids.emplace_back(entry.id);
+            }
+        }
+        return;
+    }
+
+    for (std::int32_t z = minZ; z <= maxZ; ++z) {
+        for (std::int32_t y = minY; y <= maxY; ++y) {
+            for (std::int32_t x = minX; x <= maxX; ++x) {
+                std::uint64_t cell = MakeCellKey(x, y, z);
+                ForEachInCell(cell, [&](const Entry& entry) {
+                    if (!entry.aabb.Intersects(bounds)) {
+                        return;
+                    }
+                    // ComputePairsと同じく重なり領域の最小角を含むセルでだけ出す
+                    Vector3 corner = Vector3::Max(entry.aabb.min, bounds.min);
+                    if (MakeCellKey(ToCell(corner.x), ToCell(corner.y), ToCell(corner.z)) == cell) {
+                        ids.emplace_back(entry.id);
+                    }
+                    });
+            }
+        }
+    }
+    for (std::uint32_t index : largeEntries_) {
+        if (entries_[index].aabb.Intersects(bounds)) {
+            ids.emplace_back(entries_[index].id);
+        }
+    }
+}
+
+void UniformGridBroadphase::Raycast(const Vector3& origin, const Vector3& direction, float maxDistance, std::vector<std::uint32_t>& ids) const {
+    auto raycastAll = [&]() {
+        for (const auto& entry : entries_) {
+            float tMin = 0.0f, tMax = maxDistance;
+            if (entry.aabb.IntersectsRay(origin, direction, tMin, tMax)) {
+                ids.emplace_back(entry.id);
+            }
+        }
+        };
+    if (!isCellListValid_) {
+        raycastAll();
+        return;
+    }
+    // セル列の要素が無い所は辿らない。無限のレイもここで有限になる
+    float tEnter = 0.0f, tExit = maxDistance;
+    bool isCellHit = !cellEntries_.empty() && cellBounds_.IntersectsRay(origin, direction, tEnter, tExit);
+    std::int32_t cell[3] = {};
+    std::uint64_t stepCount = 0;
+    if (isCellHit) {
+        Vector3 start = origin + direction * tEnter;
+        Vector3 end = origin + direction * tExit;
+        std::int32_t endCell[3] = { ToCell(end.x), ToCell(end.y), ToCell(end.z) };
+        stepCount = 1;
+        for (size_t i = 0; i < 3; ++i) {
+            cell[i] = ToCell(start[i]);
+            stepCount += static_cast<std::uint64_t>(std::abs(static_cast<std::int64_t>(endCell[i]) - cell[i]));
+        }
+    }
+    // セルを引くより全要素を見た方が早ければ総当たり
+    if (stepCount > entries_.size()) {
+        raycastAll();
+        return;
+    }
+    for (std::uint32_t index : largeEntries_) {
+        float tMin = 0.0f, tMax = maxDistance;
+        if (entries_[index].aabb.IntersectsRay(origin, direction, tMin, tMax)) {
+            ids.emplace_back(entries_[index].id);
+        }
+    }
+    if (!isCellHit) {
+        return;
+    }
+
+    // 3D DDAで通るセルを順に辿る
+    std::int32_t step[3];
+    float tNext[3], tDelta[3];
+    for (size_t i = 0; i < 3; ++i) {
+        if (std::abs(direction[i]) < 1.0e-8f) {
+            step[i] = 0;
+            tNext[i] = Math::positiveInfinity;
+            tDelta[i] = Math::positiveInfinity;
+            continue;
+        }
+        step[i] = direction[i] > 0.0f ? 1 : -1;
+        float boundary = static_cast<float>(cell[i] + (step[i] > 0 ? 1 : 0)) * cellSize_;
+        tNext[i] = (boundary - origin[i]) / direction[i];
+        tDelta[i] = cellSize_ / std::abs(direction[i]);
+    }
+    // 複数のセルにまたがる要素は何度も出るので、足した分を後でまとめる
+    size_t first = ids.size();
+    for (std::uint64_t i = 0; i < stepCount; ++i) {
+        ForEachInCell(MakeCellKey(cell[0], cell[1], cell[2]), [&](const Entry& entry) {
+            float tMin = 0.0f, tMax = maxDistance;
+            if (entry.aabb.IntersectsRay(origin, direction, tMin, tMax)) {
+                ids.emplace_back(entry.id);
+            }
+            });
+        size_t axis = tNext[0] < tNext[1] ? (tNext[0] < tNext[2] ? 0 : 2) : (tNext[1] < tNext[2] ? 1 : 2);
+        if (tNext[axis] > tExit) {
+            break;
+        }
+        cell[axis] += step[axis];
+        tNext[axis] += tDelta[axis];
+    }
+    std::sort(ids.begin() + first, ids.end());
+    ids.erase(std::unique(ids.begin() + first, ids.end()), ids.end());
+}
+
+size_t UniformGridBroadphase::GetMemoryUsage() const {
+    return GetCapacityBytes(entries_) + GetCapacityBytes(idToIndex_) + GetCapacityBytes(cellEntries_) + GetCapacityBytes(largeEntries_);
+}
+
+std::int32_t UniformGridBroadphase::ToCell(float x) const {
+    // 平面や広い地形の無限大や巨大な座標はint32_tに収まらないので、キーに詰められる範囲に丸めてから変換する
+    float cell = std::clamp(std::floor(x * invCellSize_), static_cast<float>(-kCellBias), static_cast<float>(kCellBias - 1));
+    return static_cast<std::int32_t>(cell);
+}
+
+std::uint64_t UniformGridBroadphase::MakeCellKey(std::int32_t x, std::int32_t y, std::int32_t z) {
+    // 各軸21bitに詰める
+    const std::uint64_t kMask = (1ull << 21) - 1;
+    const std::int32_t kBias = kCellBias;
+    return
+        ((static_cast<std::uint64_t>(x + kBias) & kMask) << 42) |
+        ((static_cast<std::uint64_t>(y + kBias) & kMask) << 21) |
+        (static_cast<std::uint64_t>(z + kBias) & kMask);
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include "Broadphase.hpp"
+
+// 一様格子。毎回(セル, ID)の列を作ってセル順に並べ、同じセルの要素同士を調べる
+// セルをまたぐ要素は重なりの最小角があるセルでだけペアを出す
+class UniformGridBroadphase :
+    public Broadphase {
+public:
+    // これより多くのセルにまたがる要素は格子に入れず全要素と調べる
+    static constexpr std::uint32_t kMaxCellsPerEntry = 64;
+
+    explicit UniformGridBroadphase(float cellSize = 4.0f);
+
+    void Insert(std::uint32_t id, const AABB& aabb) override;
+    void Remove(std::uint32_t id) override;
+    void Move(std::uint32_t id, const AABB& aabb) override;
+    void Clear() override;
+
+    void ComputePairs(std::vector<std::uint64_t>& pairs) override;
+    void Query(const AABB& bounds, std::vector<std::uint32_t>& ids) const override;
+    void Raycast(const Vector3& origin, const Vector3& direction, float maxDistance, std::vector<std::uint32_t>& ids) const override;
+
+    BroadphaseType GetType() const override { return BroadphaseType::kUniformGrid; }
+    std::uint32_t GetCount() const override { return static_cast<std::uint32_t>(entries_.size()); }
+    size_t GetMemoryUsage() const override;
+
+    float GetCellSize() const { return cellSize_; }
+
+private:
+    static constexpr std::uint32_t kInvalidIndex = 0xFFFFFFFF;
+    // セル座標は各軸[-kCellBias, kCellBias)
+    static constexpr std::int32_t kCellBias = 1 << 20;
+
+    struct Entry {
+        AABB aabb;
+        std::uint32_t id;
+    };
+    struct CellEntry {
+        std::uint64_t cell;
+        std::uint32_t index;    // entries_の番号
+    };
+
+    std::int32_t ToCell(float x) const;
+    static std::uint64_t MakeCellKey(std::int32_t x, std::int32_t y, std::int32_t z);
+    // cellのセル列の要素をtestに渡す
+    template<class Function>
+    void ForEachInCell(std::uint64_t cell, Function&& test) const;
+
+    float cellSize_;
+    float invCellSize_;
+    std::vector<Entry> entries_;
+    std::vector<std::uint32_t> idToIndex_;
+    std::vector<CellEntry> cellEntries_;
+    std::vector<std::uint32_t> largeEntries_;
+    // セル列に入った要素のAABBの和。レイをこの中に切り詰めて辿る
+    AABB cellBounds_;
+    // セル列が今の要素と合っている。ComputePairsで立ち、挿入、削除、移動で落ちる
+    bool isCellListValid_;
+};
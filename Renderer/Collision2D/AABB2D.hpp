@@ -0,0 +1,55 @@
+#pragma once
+
+#include "../Math/MathUtils.hpp"
+
+class AABB2D {
+public:
+    AABB2D() : min(Vector2::positiveInfinity), max(Vector2::negativeInfinity) {}
+    AABB2D(const Vector2& min, const Vector2& max) : min(min), max(max) {}
+
+    void Include(const Vector2& point) {
+        min = Vector2::Min(min, point);
+        max = Vector2::Max(max, point);
+    }
+    void Include(const AABB2D& other) {
+        min = Vector2::Min(min, other.min);
+        max = Vector2::Max(max, other.max);
+    }
+
+    Vector2 Extent() const { return max - min; }
+    Vector2 Center() const { return (max + min) * 0.5f; }
+
+    bool Contains(const Vector2& point) const {
+        return
+            min.x <= point.x &&
+            point.x <= max.x &&
+            min.y <= point.y &&
+            point.y <= max.y;
+    }
+    bool Intersects(const AABB2D& other) const {
+        return
+            min.x <= other.max.x &&
+            other.min.x <= max.x &&
+            min.y <= other.max.y &&
+            other.min.y <= max.y;
+    }
+    // スラブ法。[tMin, tMax]に交差区間を返す
+    bool IntersectsRay(const Vector2& origin, const Vector2& direction, float& tMin, float& tMax) const {
+        for (size_t i = 0; i < 2; ++i) {
+            if (std::abs(direction[i]) < 1.0e-8f) {
+                if (origin[i] < min[i] || origin[i] > max[i]) { return false; }
+                continue;
+            }
+            float invDirection = 1.0f / direction[i];
+            float t0 = (min[i] - origin[i]) * invDirection;
+            float t1 = (max[i] - origin[i]) * invDirection;
+            if (t0 > t1) { std::swap(t0, t1); }
+            tMin = std::max(tMin, t0);
+            tMax = std::min(tMax, t1);
+            if (tMin > tMax) { return false; }
+        }
+        return true;
+    }
+
+    Vector2 min, max;
+};
@@ -0,0 +1,100 @@
+#include "CollisionWorld2D.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+#include "../Collision/Broadphase.hpp"
+#include "GJK2D.hpp"
+
+std::uint32_t CollisionWorld2D::AddBody(const Shape2D& shape, const Transform2D& transform, bool isTrigger) {
+    std::uint32_t id;
+    if (!freeIDs_.empty()) {
+        id = freeIDs_.back();
+        freeIDs_.pop_back();
+    }
+    else {
+        id = static_cast<std::uint32_t>(bodies_.size());
+        bodies_.emplace_back();
+    }
+    Body& body = bodies_[id];
+    body.shape = shape;
+    body.transform = transform;
+    body.aabb = shape.ComputeAABB(transform);
+    body.isTrigger = isTrigger;
+    body.isAlive = true;
+    body.isDirty = false;
+    broadphase_.Insert(id, body.aabb);
+    return id;
+}
+
+void CollisionWorld2D::RemoveBody(std::uint32_t id) {
+    assert(id < bodies_.size() && bodies_[id].isAlive);
+    broadphase_.Remove(id);
+    bodies_[id].isAlive = false;
+    freeIDs_.emplace_back(id);
+    auto end = std::remove_if(contacts_.begin(), contacts_.end(),
+        [id](const Contact2D& contact) { return contact.bodyA == id || contact.bodyB == id; });
+    contacts_.erase(end, contacts_.end());
+}
+
+void CollisionWorld2D::SetTransform(std::uint32_t id, const Transform2D& transform) {
+    bodies_[id].transform = transform;
+    bodies_[id].isDirty = true;
+}
+
+void CollisionWorld2D::SetShape(std::uint32_t id, const Shape2D& shape) {
+    bodies_[id].shape = shape;
+    bodies_[id].isDirty = true;
+}
+
+void CollisionWorld2D::Step() {
+    for (std::uint32_t id = 0; id < bodies_.size(); ++id) {
+        Body& body = bodies_[id];
+        if (body.isAlive && body.isDirty) {
+            body.aabb = body.shape.ComputeAABB(body.transform);
+            body.isDirty = false;
+            broadphase_.Move(id, body.aabb);
+        }
+    }
+
+    candidatePairs_.clear();
+    broadphase_.ComputePairs(candidatePairs_);
+    std::sort(candidatePairs_.begin(), candidatePairs_.end());
+
+    contacts_.clear();
+    for (auto key : candidatePairs_) {
+        std::uint32_t idA = Broadphase::PairKeyFirst(key);
+        std::uint32_t idB = Broadphase::PairKeySecond(key);
+        const Body& bodyA = bodies_[idA];
+        const Body& bodyB = bodies_[idB];
+        Proxy2D proxyA = Proxy2D::Make(bodyA.shape, bodyA.transform);
+        Proxy2D proxyB = Proxy2D::Make(bodyB.shape, bodyB.transform);
+        Contact2D contact{ idA, idB, {}, bodyA.isTrigger || bodyB.isTrigger };
+        bool isHit = contact.isTrigger ?
+            GJK2D::Overlap(proxyA, proxyB) :
+            Narrowphase2D::Collide(proxyA, proxyB, contact.manifold);
+        if (isHit) {
+            contacts_.emplace_back(contact);
+        }
+    }
+}
+
+bool CollisionWorld2D::Raycast(const Vector2& origin, const Vector2& direction, float maxDistance, RaycastHit2D& hit) const {
+    std::vector<std::uint32_t> ids;
+    broadphase_.Raycast(origin, direction, maxDistance, ids);
+    bool isHit = false;
+    hit.distance = maxDistance;
+    for (std::uint32_t id : ids) {
+        const Body& body = bodies_[id];
+        float distance;
+        Vector2 normal;
+        if (GJK2D::Raycast(Proxy2D::Make(body.shape, body.transform), origin, direction, hit.distance, distance, normal) && distance <= hit.distance) {
+            hit.point = origin + direction * distance;
+            hit.normal = normal;
+            hit.distance = distance;
+            hit.body = id;
+            isHit = true;
+        }
+    }
+    return isHit;
+}
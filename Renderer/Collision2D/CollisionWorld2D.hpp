@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "../Math/MathUtils.hpp"
+#include "Shape2D.hpp"
+#include "Narrowphase2D.hpp"
+#include "SweepAndPrune2D.hpp"
+
+struct RaycastHit2D {
+    Vector2 point;
+    Vector2 normal;
+    float distance;
+    std::uint32_t body;
+};
+
+struct Contact2D {
+    std::uint32_t bodyA;
+    std::uint32_t bodyB;
+    Manifold2D manifold;    // isTriggerなら求めない
+    bool isTrigger;
+};
+
+// 2Dゲーム用の衝突判定。全てVector2で計算する
+class CollisionWorld2D {
+public:
+    static constexpr std::uint32_t kInvalidID = 0xFFFFFFFF;
+
+    std::uint32_t AddBody(const Shape2D& shape, const Transform2D& transform, bool isTrigger = false);
+    void RemoveBody(std::uint32_t id);
+
+    void SetTransform(std::uint32_t id, const Transform2D& transform);
+    void SetShape(std::uint32_t id, const Shape2D& shape);
+    void SetIsTrigger(std::uint32_t id, bool isTrigger) { bodies_[id].isTrigger = isTrigger; }
+
+    void Step();
+
+    // directionは正規化済み。最も近いヒットを返す
+    bool Raycast(const Vector2& origin, const Vector2& direction, float maxDistance, RaycastHit2D& hit) const;
+    void Query(const AABB2D& bounds, std::vector<std::uint32_t>& ids) const { broadphase_.Query(bounds, ids); }
+
+    const Shape2D& GetShape(std::uint32_t id) const { return bodies_[id].shape; }
+    const Transform2D& GetTransform(std::uint32_t id) const { return bodies_[id].transform; }
+    const AABB2D& GetAABB(std::uint32_t id) const { return bodies_[id].aabb; }
+    const std::vector<Contact2D>& GetContacts() const { return contacts_; }
+
+private:
+    struct Body {
+        Shape2D shape;
+        Transform2D transform;
+        AABB2D aabb;
+        bool isTrigger;
+        bool isAlive;
+        bool isDirty;   // AABBの再計算が必要
+    };
+
+    std::vector<Body> bodies_;
+    std::vector<std::uint32_t> freeIDs_;
+    SweepAndPrune2D broadphase_;
+    std::vector<std::uint64_t> candidatePairs_;
+    std::vector<Contact2D> contacts_;
+};
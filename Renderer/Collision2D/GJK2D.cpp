@@ -0,0 +1,192 @@
+#include "GJK2D.hpp"
+
+namespace {
+    struct SupportPoint2D {
+        Vector2 a;
+        Vector2 b;
+        Vector2 w;  // a - b
+        std::uint32_t indexA;
+        std::uint32_t indexB;
+    };
+
+    // 最大3点。原点に最も近い点を求めて寄与しない点を捨てる
+    struct Simplex2D {
+        SupportPoint2D points[3];
+        float lambdas[3];
+        std::uint32_t size = 0;
+
+        bool Contains(std::uint32_t indexA, std::uint32_t indexB) const {
+            for (std::uint32_t i = 0; i < size; ++i) {
+                if (points[i].indexA == indexA && points[i].indexB == indexB) { return true; }
+            }
+            return false;
+        }
+
+        void Keep(std::uint32_t i0) {
+            points[0] = points[i0];
+            lambdas[0] = 1.0f;
+            size = 1;
+        }
+        void Keep(std::uint32_t i0, std::uint32_t i1, float t) {
+            SupportPoint2D p0 = points[i0], p1 = points[i1];
+            points[0] = p0;
+            points[1] = p1;
+            lambdas[0] = 1.0f - t;
+            lambdas[1] = t;
+            size = 2;
+        }
+
+        void SolveSegment(std::uint32_t i0, std::uint32_t i1) {
+            const Vector2& a = points[i0].w;
+            Vector2 ab = points[i1].w - a;
+            float denominator = ab.LengthSquare();
+            float t = denominator > 0.0f ? -Vector2::Dot(a, ab) / denominator : 0.0f;
+            if (t <= 0.0f) { Keep(i0); }
+            else if (t >= 1.0f) { Keep(i1); }
+            else { Keep(i0, i1, t); }
+        }
+
+        // 原点が三角形の内部ならfalse
+        bool SolveTriangle() {
+            const Vector2& a = points[0].w;
+            const Vector2& b = points[1].w;
+            const Vector2& c = points[2].w;
+            Vector2 ab = b - a, ac = c - a;
+            float d1 = -Vector2::Dot(ab, a);
+            float d2 = -Vector2::Dot(ac, a);
+            if (d1 <= 0.0f && d2 <= 0.0f) { Keep(0); return true; }
+            float d3 = -Vector2::Dot(ab, b);
+            float d4 = -Vector2::Dot(ac, b);
+            if (d3 >= 0.0f && d4 <= d3) { Keep(1); return true; }
+            float d5 = -Vector2::Dot(ab, c);
+            float d6 = -Vector2::Dot(ac, c);
+            if (d6 >= 0.0f && d5 <= d6) { Keep(2); return true; }
+            float vc = d1 * d4 - d3 * d2;
+            if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) { Keep(0, 1, d1 / (d1 - d3)); return true; }
+            float vb = d5 * d2 - d1 * d6;
+            if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) { Keep(0, 2, d2 / (d2 - d6)); return true; }
+            float va = d3 * d6 - d5 * d4;
+            if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f) { Keep(1, 2, (d4 - d3) / ((d4 - d3) + (d5 - d6))); return true; }
+            float sum = va + vb + vc;
+            // 潰れた三角形の上に原点がある
+            if (sum <= 0.0f) {
+                lambdas[0] = lambdas[1] = lambdas[2] = 1.0f / 3.0f;
+                return false;
+            }
+            float denominator = 1.0f / sum;
+            lambdas[1] = vb * denominator;
+            lambdas[2] = vc * denominator;
+            lambdas[0] = 1.0f - lambdas[1] - lambdas[2];
+            return false;
+        }
+
+        Vector2 Closest() const {
+            Vector2 closest = Vector2::zero;
+            for (std::uint32_t i = 0; i < size; ++i) { closest += points[i].w * lambdas[i]; }
+            return closest;
+        }
+        void ComputeWitnessPoints(Vector2& pointA, Vector2& pointB) const {
+            pointA = Vector2::zero;
+            pointB = Vector2::zero;
+            for (std::uint32_t i = 0; i < size; ++i) {
+                pointA += points[i].a * lambdas[i];
+                pointB += points[i].b * lambdas[i];
+            }
+        }
+    };
+
+    SupportPoint2D Support(const Proxy2D& proxyA, const Proxy2D& proxyB, const Vector2& direction) {
+        SupportPoint2D point;
+        point.indexA = proxyA.FindSupportIndex(direction);
+        point.indexB = proxyB.FindSupportIndex(-direction);
+        point.a = proxyA.vertices[point.indexA];
+        point.b = proxyB.vertices[point.indexB];
+        point.w = point.a - point.b;
+        return point;
+    }
+}
+
+namespace GJK2D {
+
+    bool Distance(const Proxy2D& proxyA, const Proxy2D& proxyB, Result& result, float maxDistance) {
+        result = Result{};
+        Simplex2D simplex;
+        simplex.points[0] = Support(proxyA, proxyB, proxyB.vertices[0] - proxyA.vertices[0]);
+        simplex.lambdas[0] = 1.0f;
+        simplex.size = 1;
+        Vector2 v = simplex.points[0].w;
+        float vv = v.LengthSquare();
+        const float maxDistanceSquare = maxDistance < Math::positiveInfinity ? maxDistance * maxDistance : Math::positiveInfinity;
+
+        while (result.iterations < kMaxIterations) {
+            ++result.iterations;
+            if (vv <= kAbsoluteTolerance) {
+                result.isOverlapping = true;
+                break;
+            }
+            SupportPoint2D point = Support(proxyA, proxyB, -v);
+            float vw = Vector2::Dot(v, point.w);
+            if (vw > 0.0f && vw * vw > maxDistanceSquare * vv) {
+                simplex.ComputeWitnessPoints(result.pointA, result.pointB);
+                result.distance = vw / std::sqrt(vv);
+                return false;
+            }
+            if (vv - vw <= kRelativeTolerance * vv || simplex.Contains(point.indexA, point.indexB)) {
+                break;
+            }
+
+            simplex.points[simplex.size++] = point;
+            if (simplex.size == 2) {
+                simplex.SolveSegment(0, 1);
+            }
+            else if (!simplex.SolveTriangle()) {
+                result.isOverlapping = true;
+                break;
+            }
+            Vector2 closest = simplex.Closest();
+            float closestSquare = closest.LengthSquare();
+            if (closestSquare >= vv) {
+                break;
+            }
+            v = closest;
+            vv = closestSquare;
+        }
+
+        simplex.ComputeWitnessPoints(result.pointA, result.pointB);
+        result.distance = result.isOverlapping ? 0.0f : std::sqrt(vv);
+        return result.distance <= maxDistance;
+    }
+
+    bool Overlap(const Proxy2D& proxyA, const Proxy2D& proxyB) {
+        Result result;
+        return Distance(proxyA, proxyB, result, proxyA.radius + proxyB.radius);
+    }
+
+    bool Raycast(const Proxy2D& proxy, const Vector2& origin, const Vector2& direction, float maxDistance, float& distance, Vector2& normal) {
+        constexpr float kHitTolerance = 1.0e-4f;
+        float t = 0.0f;
+        normal = -direction;
+        for (std::uint32_t i = 0; i < kMaxIterations; ++i) {
+            Proxy2D point = Proxy2D::MakePoint(origin + direction * t);
+            Result result;
+            Distance(proxy, point, result);
+            float gap = result.distance - proxy.radius;
+            if (result.isOverlapping || gap <= kHitTolerance) {
+                distance = t;
+                return true;
+            }
+            Vector2 separation = (result.pointB - result.pointA) / result.distance;
+            float approach = -Vector2::Dot(direction, separation);
+            if (approach <= 0.0f) {
+                return false;
+            }
+            normal = separation;
+            t += gap / approach;
+            if (t > maxDistance) {
+                return false;
+            }
+        }
+        return false;
+    }
+
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+
+#include "../Math/MathUtils.hpp"
+#include "Shape2D.hpp"
+
+// 2DのGJK。半径を除いた芯同士の距離を求める
+namespace GJK2D {
+    constexpr std::uint32_t kMaxIterations = 32;
+    constexpr float kRelativeTolerance = 1.0e-6f;
+    constexpr float kAbsoluteTolerance = 1.0e-12f;
+
+    struct Result {
+        Vector2 pointA;     // 芯の上の最近点
+        Vector2 pointB;
+        float distance = 0.0f;
+        std::uint32_t iterations = 0;
+        bool isOverlapping = false;
+    };
+
+    // 芯同士の距離がmaxDistanceを超えることが確定した時点で打ち切りfalseを返す
+    bool Distance(const Proxy2D& proxyA, const Proxy2D& proxyB, Result& result, float maxDistance = Math::positiveInfinity);
+    // 半径を含めて重なっているか
+    bool Overlap(const Proxy2D& proxyA, const Proxy2D& proxyB);
+    // 保守的前進によるレイキャスト。directionは正規化済み
+    bool Raycast(const Proxy2D& proxy, const Vector2& origin, const Vector2& direction, float maxDistance, float& distance, Vector2& normal);
+}
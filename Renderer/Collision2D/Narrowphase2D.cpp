@@ -0,0 +1,147 @@
+#include "Narrowphase2D.hpp"
+
+#include "GJK2D.hpp"
+
+namespace {
+    // 芯の距離がこれより大きければ離れているとみなす
+    constexpr float kLinearSlop = 1.0e-4f;
+
+    // referenceの辺の法線方向で、incidentが最も深く入り込んだ量の最大
+    float FindMaxSeparation(const Proxy2D& reference, const Proxy2D& incident, std::uint32_t& edge) {
+        float maxSeparation = -Math::positiveInfinity;
+        edge = 0;
+        for (std::uint32_t i = 0; i < reference.count; ++i) {
+            const Vector2& normal = reference.normals[i];
+            float separation = Math::positiveInfinity;
+            for (std::uint32_t j = 0; j < incident.count; ++j) {
+                separation = std::min(separation, Vector2::Dot(normal, incident.vertices[j] - reference.vertices[i]));
+            }
+            if (separation > maxSeparation) {
+                maxSeparation = separation;
+                edge = i;
+            }
+        }
+        return maxSeparation;
+    }
+
+    void ClipContacts(const Proxy2D& reference, std::uint32_t edge, const Proxy2D& incident, bool flip, Manifold2D& manifold) {
+        const Vector2& v1 = reference.vertices[edge];
+        const Vector2& v2 = reference.vertices[(edge + 1) % reference.count];
+        const Vector2& normal = reference.normals[edge];
+
+        // 接触辺は参照辺の法線と最も逆向きの辺
+        Vector2 candidates[2];
+        std::uint32_t candidateCount = 1;
+        if (incident.count == 1) {
+            candidates[0] = incident.vertices[0];
+        }
+        else {
+            std::uint32_t incidentEdge = 0;
+            float minDot = Math::positiveInfinity;
+            for (std::uint32_t i = 0; i < incident.count; ++i) {
+                float dot = Vector2::Dot(normal, incident.normals[i]);
+                if (dot < minDot) {
+                    minDot = dot;
+                    incidentEdge = i;
+                }
+            }
+            candidates[0] = incident.vertices[incidentEdge];
+            candidates[1] = incident.vertices[(incidentEdge + 1) % incident.count];
+            candidateCount = 2;
+
+            // 参照辺の両端の側面でクリップ
+            Vector2 tangent = (v2 - v1).Normalized();
+            float bounds[2] = { 0.0f, Vector2::Dot(tangent, v2 - v1) };
+            for (std::uint32_t side = 0; side < 2; ++side) {
+                // 内側が正になる符号付き距離
+                float sign = side == 0 ? 1.0f : -1.0f;
+                float d0 = sign * (Vector2::Dot(tangent, candidates[0] - v1) - bounds[side]);
+                float d1 = sign * (Vector2::Dot(tangent, candidates[1] - v1) - bounds[side]);
+                if (d0 < 0.0f && d1 < 0.0f) {
+                    candidateCount = 0;
+                    break;
+                }
+                if (d0 < 0.0f) {
+                    candidates[0] = candidates[0] + (candidates[1] - candidates[0]) * (d0 / (d0 - d1));
+                }
+                else if (d1 < 0.0f) {
+                    candidates[1] = candidates[0] + (candidates[1] - candidates[0]) * (d0 / (d0 - d1));
+                }
+            }
+        }
+
+        float totalRadius = reference.radius + incident.radius;
+        manifold.normal = flip ? -normal : normal;
+        manifold.count = 0;
+        for (std::uint32_t i = 0; i < candidateCount; ++i) {
+            const Vector2& point = candidates[i];
+            float separation = Vector2::Dot(normal, point - v1);
+            if (separation > totalRadius) {
+                continue;
+            }
+            Vector2 referenceSurface = point + normal * (reference.radius - separation);
+            Vector2 incidentSurface = point - normal * incident.radius;
+            manifold.points[manifold.count] = (referenceSurface + incidentSurface) * 0.5f;
+            manifold.depths[manifold.count] = totalRadius - separation;
+            ++manifold.count;
+        }
+    }
+}
+
+namespace Narrowphase2D {
+
+    bool Collide(const Shape2D& shapeA, const Transform2D& transformA, const Shape2D& shapeB, const Transform2D& transformB, Manifold2D& manifold) {
+        return Collide(Proxy2D::Make(shapeA, transformA), Proxy2D::Make(shapeB, transformB), manifold);
+    }
+
+    bool Collide(const Proxy2D& proxyA, const Proxy2D& proxyB, Manifold2D& manifold) {
+        float totalRadius = proxyA.radius + proxyB.radius;
+        GJK2D::Result gjk;
+        if (!GJK2D::Distance(proxyA, proxyB, gjk, totalRadius)) {
+            return false;
+        }
+
+        // 芯が離れている。丸みのある形状同士
+        if (gjk.distance > kLinearSlop) {
+            manifold.normal = (gjk.pointB - gjk.pointA) / gjk.distance;
+            Vector2 surfaceA = gjk.pointA + manifold.normal * proxyA.radius;
+            Vector2 surfaceB = gjk.pointB - manifold.normal * proxyB.radius;
+            manifold.points[0] = (surfaceA + surfaceB) * 0.5f;
+            manifold.depths[0] = totalRadius - gjk.distance;
+            manifold.count = 1;
+            return true;
+        }
+
+        // 芯が重なっている。辺を持つ側でSAT
+        if (proxyA.count < 2 && proxyB.count < 2) {
+            // 円の中心同士が一致
+            manifold.normal = Vector2::unitY;
+            manifold.points[0] = proxyA.vertices[0];
+            manifold.depths[0] = totalRadius;
+            manifold.count = 1;
+            return true;
+        }
+        std::uint32_t edgeA = 0, edgeB = 0;
+        float separationA = proxyA.count >= 2 ? FindMaxSeparation(proxyA, proxyB, edgeA) : -Math::positiveInfinity;
+        float separationB = proxyB.count >= 2 ? FindMaxSeparation(proxyB, proxyA, edgeB) : -Math::positiveInfinity;
+        // 同程度ならAを参照にして結果を安定させる
+        if (separationB > separationA + 0.1f * kLinearSlop) {
+            ClipContacts(proxyB, edgeB, proxyA, true, manifold);
+        }
+        else {
+            ClipContacts(proxyA, edgeA, proxyB, false, manifold);
+        }
+        // クリップで全て落ちた場合
+        if (manifold.count == 0) {
+            manifold.points[0] = (gjk.pointA + gjk.pointB) * 0.5f;
+            manifold.depths[0] = totalRadius;
+            manifold.count = 1;
+        }
+        return true;
+    }
+
+    bool Overlap(const Shape2D& shapeA, const Transform2D& transformA, const Shape2D& shapeB, const Transform2D& transformB) {
+        return GJK2D::Overlap(Proxy2D::Make(shapeA, transformA), Proxy2D::Make(shapeB, transformB));
+    }
+
+}
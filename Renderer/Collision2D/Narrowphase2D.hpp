@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+
+#include "../Math/MathUtils.hpp"
+#include "Shape2D.hpp"
+
+// 接触点は最大2つ
+struct Manifold2D {
+    Vector2 normal;     // AからBへ向かう法線
+    Vector2 points[2];  // 両表面の中点
+    float depths[2];
+    std::uint32_t count;
+};
+
+namespace Narrowphase2D {
+    // 芯が離れていればGJKの最近点から1点、芯が重なっていればSATで参照辺を決めて接触辺をクリップする
+    bool Collide(const Shape2D& shapeA, const Transform2D& transformA, const Shape2D& shapeB, const Transform2D& transformB, Manifold2D& manifold);
+    bool Collide(const Proxy2D& proxyA, const Proxy2D& proxyB, Manifold2D& manifold);
+    // トリガー用。重なりの有無だけ
+    bool Overlap(const Shape2D& shapeA, const Transform2D& transformA, const Shape2D& shapeB, const Transform2D& transformB);
+}
@@ -0,0 +1,91 @@
+#include "Shape2D.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+Shape2D Shape2D::MakeCircle(float radius, const Vector2& center) {
+    Shape2D shape;
+    shape.type_ = Type::kCircle;
+    shape.vertices_[0] = center;
+    shape.count_ = 1;
+    shape.radius_ = radius;
+    return shape;
+}
+
+Shape2D Shape2D::MakeBox(const Vector2& halfSize) {
+    Shape2D shape;
+    shape.type_ = Type::kBox;
+    shape.vertices_[0] = { -halfSize.x, -halfSize.y };
+    shape.vertices_[1] = { halfSize.x, -halfSize.y };
+    shape.vertices_[2] = { halfSize.x, halfSize.y };
+    shape.vertices_[3] = { -halfSize.x, halfSize.y };
+    shape.count_ = 4;
+    shape.ComputeNormals();
+    return shape;
+}
+
+Shape2D Shape2D::MakeCapsule(float radius, float halfSegment) {
+    Shape2D shape;
+    shape.type_ = Type::kCapsule;
+    shape.vertices_[0] = { 0.0f, -halfSegment };
+    shape.vertices_[1] = { 0.0f, halfSegment };
+    shape.count_ = 2;
+    shape.radius_ = radius;
+    shape.ComputeNormals();
+    return shape;
+}
+
+Shape2D Shape2D::MakePolygon(const Vector2* vertices, std::uint32_t count, float radius) {
+    assert(count >= 3 && count <= kMaxVertices);
+    Shape2D shape;
+    shape.type_ = Type::kPolygon;
+    std::copy(vertices, vertices + count, shape.vertices_);
+    shape.count_ = count;
+    shape.radius_ = radius;
+    float area = 0.0f;
+    for (std::uint32_t i = 0; i < count; ++i) {
+        area += Vector2::Cross(vertices[i], vertices[(i + 1) % count]);
+    }
+    if (area < 0.0f) {
+        std::reverse(shape.vertices_, shape.vertices_ + count);
+    }
+    shape.ComputeNormals();
+    return shape;
+}
+
+AABB2D Shape2D::ComputeAABB(const Transform2D& transform) const {
+    AABB2D aabb;
+    for (std::uint32_t i = 0; i < count_; ++i) {
+        aabb.Include(transform.Apply(vertices_[i]));
+    }
+    aabb.min -= Vector2(radius_);
+    aabb.max += Vector2(radius_);
+    return aabb;
+}
+
+void Shape2D::ComputeNormals() {
+    // 反時計回りなので辺を右に90度回すと外向き
+    for (std::uint32_t i = 0; i < count_; ++i) {
+        Vector2 edge = vertices_[(i + 1) % count_] - vertices_[i];
+        normals_[i] = Vector2(edge.y, -edge.x).Normalized();
+    }
+}
+
+Proxy2D Proxy2D::Make(const Shape2D& shape, const Transform2D& transform) {
+    Proxy2D proxy;
+    proxy.count = shape.GetVertexCount();
+    proxy.radius = shape.GetRadius();
+    for (std::uint32_t i = 0; i < proxy.count; ++i) {
+        proxy.vertices[i] = transform.Apply(shape.GetVertex(i));
+        proxy.normals[i] = transform.Rotate(shape.GetNormal(i));
+    }
+    return proxy;
+}
+
+Proxy2D Proxy2D::MakePoint(const Vector2& point) {
+    Proxy2D proxy;
+    proxy.vertices[0] = point;
+    proxy.count = 1;
+    proxy.radius = 0.0f;
+    return proxy;
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdint>
+
+#include "../Math/MathUtils.hpp"
+#include "AABB2D.hpp"
+
+// 位置と回転（cos, sin）
+struct Transform2D {
+    Vector2 position;
+    Vector2 rotation = Vector2::unitX;
+
+    static Transform2D Make(const Vector2& position, float angle) {
+        return { position, { std::cos(angle), std::sin(angle) } };
+    }
+
+    Vector2 Rotate(const Vector2& v) const { return { rotation.x * v.x - rotation.y * v.y, rotation.y * v.x + rotation.x * v.y }; }
+    Vector2 InverseRotate(const Vector2& v) const { return { rotation.x * v.x + rotation.y * v.y, -rotation.y * v.x + rotation.x * v.y }; }
+    Vector2 Apply(const Vector2& point) const { return Rotate(point) + position; }
+    Vector2 InverseApply(const Vector2& point) const { return InverseRotate(point - position); }
+};
+
+// 凸多角形を半径で膨らませた形状で全てを表す
+// 円は頂点1つ、カプセルは線分、箱は4頂点
+class Shape2D {
+public:
+    static constexpr std::uint32_t kMaxVertices = 8;
+
+    enum class Type {
+        kCircle,
+        kBox,
+        kCapsule,
+        kPolygon
+    };
+
+    static Shape2D MakeCircle(float radius, const Vector2& center = Vector2::zero);
+    static Shape2D MakeBox(const Vector2& halfSize);
+    // ローカルY軸に沿ったカプセル
+    static Shape2D MakeCapsule(float radius, float halfSegment);
+    // 凸多角形。時計回りなら並べ替える
+    static Shape2D MakePolygon(const Vector2* vertices, std::uint32_t count, float radius = 0.0f);
+
+    AABB2D ComputeAABB(const Transform2D& transform) const;
+
+    Type GetType() const { return type_; }
+    std::uint32_t GetVertexCount() const { return count_; }
+    const Vector2& GetVertex(std::uint32_t index) const { return vertices_[index]; }
+    // 辺 i -> i+1 の外向き法線
+    const Vector2& GetNormal(std::uint32_t index) const { return normals_[index]; }
+    float GetRadius() const { return radius_; }
+
+private:
+    void ComputeNormals();
+
+    Vector2 vertices_[kMaxVertices];
+    Vector2 normals_[kMaxVertices];
+    std::uint32_t count_ = 0;
+    float radius_ = 0.0f;
+    Type type_ = Type::kCircle;
+};
+
+// 判定用にワールド座標へ変換した形状
+struct Proxy2D {
+    Vector2 vertices[Shape2D::kMaxVertices];
+    Vector2 normals[Shape2D::kMaxVertices];
+    std::uint32_t count;
+    float radius;
+
+    static Proxy2D Make(const Shape2D& shape, const Transform2D& transform);
+    static Proxy2D MakePoint(const Vector2& point);
+
+    std::uint32_t FindSupportIndex(const Vector2& direction) const {
+        std::uint32_t best = 0;
+        float maxDot = Vector2::Dot(vertices[0], direction);
+        for (std::uint32_t i = 1; i < count; ++i) {
+            float dot = Vector2::Dot(vertices[i], direction);
+            if (dot > maxDot) {
+                maxDot = dot;
+                best = i;
+            }
+        }
+        return best;
+    }
+};
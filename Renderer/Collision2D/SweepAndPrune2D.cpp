@@ -0,0 +1,121 @@
+#include "SweepAndPrune2D.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+#include "../Collision/Broadphase.hpp"
+
+void SweepAndPrune2D::Insert(std::uint32_t id, const AABB2D& aabb) {
+    if (id >= idToIndex_.size()) {
+        idToIndex_.resize(id + 1, kInvalidIndex);
+    }
+    assert(idToIndex_[id] == kInvalidIndex);
+    idToIndex_[id] = static_cast<std::uint32_t>(entries_.size());
+    entries_.push_back({ aabb, id });
+    isSorted_ = false;
+    isOrdered_ = false;
+}
+
+void SweepAndPrune2D::Remove(std::uint32_t id) {
+    assert(id < idToIndex_.size() && idToIndex_[id] != kInvalidIndex);
+    std::uint32_t index = idToIndex_[id];
+    entries_[index] = entries_.back();
+    idToIndex_[entries_[index].id] = index;
+    entries_.pop_back();
+    idToIndex_[id] = kInvalidIndex;
+    isSorted_ = false;
+    isOrdered_ = false;
+}
+
+void SweepAndPrune2D::Move(std::uint32_t id, const AABB2D& aabb) {
+    assert(id < idToIndex_.size() && idToIndex_[id] != kInvalidIndex);
+    entries_[idToIndex_[id]].aabb = aabb;
+    isOrdered_ = false;
+}
+
+void SweepAndPrune2D::Clear() {
+    entries_.clear();
+    idToIndex_.clear();
+    isSorted_ = true;
+    isOrdered_ = true;
+    maxWidthX_ = 0.0f;
+}
+
+void SweepAndPrune2D::ComputePairs(std::vector<std::uint64_t>& pairs) {
+    Sort();
+    for (size_t i = 0; i < entries_.size(); ++i) {
+        const Entry& entryA = entries_[i];
+        for (size_t j = i + 1; j < entries_.size() && entries_[j].aabb.min.x <= entryA.aabb.max.x; ++j) {
+            const Entry& entryB = entries_[j];
+            if (entryA.aabb.Intersects(entryB.aabb)) {
+                pairs.emplace_back(Broadphase::MakePairKey(entryA.id, entryB.id));
+            }
+        }
+    }
+}
+
+void SweepAndPrune2D::Query(const AABB2D& bounds, std::vector<std::uint32_t>& ids) const {
+    size_t first, last;
+    FindRange(bounds.min.x, bounds.max.x, first, last);
+    for (size_t i = first; i < last; ++i) {
+        const Entry& entry = entries_[i];
+        if (entry.aabb.Intersects(bounds)) {
+            ids.emplace_back(entry.id);
+        }
+    }
+}
+
+void SweepAndPrune2D::Raycast(const Vector2& origin, const Vector2& direction, float maxDistance, std::vector<std::uint32_t>& ids) const {
+    // 線分のXの範囲で絞る。Xに進まなければ始点だけ
+    float endX = direction.x != 0.0f ? origin.x + direction.x * maxDistance : origin.x;
+    size_t first, last;
+    FindRange(std::min(origin.x, endX), std::max(origin.x, endX), first, last);
+    for (size_t i = first; i < last; ++i) {
+        const Entry& entry = entries_[i];
+        float tMin = 0.0f, tMax = maxDistance;
+        if (entry.aabb.IntersectsRay(origin, direction, tMin, tMax)) {
+            ids.emplace_back(entry.id);
+        }
+    }
+}
+
+void SweepAndPrune2D::Sort() {
+    auto less = [](const Entry& lhs, const Entry& rhs) { return lhs.aabb.min.x < rhs.aabb.min.x; };
+    if (!isSorted_) {
+        std::sort(entries_.begin(), entries_.end(), less);
+        isSorted_ = true;
+    }
+    else {
+        // 移動だけなら前フレームからほぼ整列している
+        for (size_t i = 1; i < entries_.size(); ++i) {
+            Entry entry = entries_[i];
+            size_t j = i;
+            for (; j > 0 && less(entry, entries_[j - 1]); --j) {
+                entries_[j] = entries_[j - 1];
+            }
+            entries_[j] = entry;
+        }
+    }
+    maxWidthX_ = 0.0f;
+    for (std::uint32_t i = 0; i < entries_.size(); ++i) {
+        idToIndex_[entries_[i].id] = i;
+        maxWidthX_ = std::max(maxWidthX_, entries_[i].aabb.max.x - entries_[i].aabb.min.x);
+    }
+    isOrdered_ = true;
+}
+
+void SweepAndPrune2D::FindRange(float minX, float maxX, size_t& first, size_t& last) const {
+    first = 0;
+    last = entries_.size();
+    // 挿入、削除、移動の後は次のComputePairsまで並びに頼れない
+    if (!isOrdered_) {
+        return;
+    }
+    // 幅の最も大きい要素がminXに届く位置より手前は重ならない
+    auto lower = std::lower_bound(entries_.begin(), entries_.end(), minX - maxWidthX_,
+        [](const Entry& entry, float x) { return entry.aabb.min.x < x; });
+    auto upper = std::upper_bound(lower, entries_.end(), maxX,
+        [](float x, const Entry& entry) { return x < entry.aabb.min.x; });
+    first = static_cast<size_t>(lower - entries_.begin());
+    last = static_cast<size_t>(upper - entries_.begin());
+}
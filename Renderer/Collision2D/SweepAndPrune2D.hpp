@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "AABB2D.hpp"
+
+// 2Dの広域判定。X軸でソートして掃引する
+// 移動だけのフレームは前回の並びから挿入ソートする
+class SweepAndPrune2D {
+public:
+    void Insert(std::uint32_t id, const AABB2D& aabb);
+    void Remove(std::uint32_t id);
+    void Move(std::uint32_t id, const AABB2D& aabb);
+    void Clear();
+
+    // AABBが重なる全てのペアのキーをpairsに追加する（順不同、重複なし）
+    void ComputePairs(std::vector<std::uint64_t>& pairs);
+    void Query(const AABB2D& bounds, std::vector<std::uint32_t>& ids) const;
+    void Raycast(const Vector2& origin, const Vector2& direction, float maxDistance, std::vector<std::uint32_t>& ids) const;
+
+    std::uint32_t GetCount() const { return static_cast<std::uint32_t>(entries_.size()); }
+
+private:
+    static constexpr std::uint32_t kInvalidIndex = 0xFFFFFFFF;
+
+    struct Entry {
+        AABB2D aabb;
+        std::uint32_t id;
+    };
+
+    void Sort();
+    // min.xが[minX - maxWidthX_, maxX]に入る要素の範囲。並びが崩れていれば全体
+    void FindRange(float minX, float maxX, size_t& first, size_t& last) const;
+
+    std::vector<Entry> entries_;
+    std::vector<std::uint32_t> idToIndex_;
+    bool isSorted_ = true;
+    // entries_が今のmin.xの順に並んでいる。Sortで立ち、挿入、削除、移動で落ちる
+    bool isOrdered_ = true;
+    // Sortしたときの最も大きいXの幅。問い合わせの範囲をこれだけ手前に広げる
+    float maxWidthX_ = 0.0f;
+};
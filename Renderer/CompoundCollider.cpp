@@ -0,0 +1,203 @@
+#include "CompoundCollider.hpp"
+
+#include "Externals/ImGui/imgui.h"
+
+#include "Transform.hpp"
+#include "Collision/GJK.hpp"
+#include "Collision/Support.hpp"
+
+std::uint32_t CompoundCollider::AddSphere(const Vector3& translate, float radius) {
+    return AddChild({ Type::kSphere, translate, Quaternion::identity, Vector3::zero, radius, 0.0f, 0 });
+}
+
+std::uint32_t CompoundCollider::AddBox(const Vector3& translate, const Quaternion& rotate, const Vector3& size) {
+    return AddChild({ Type::kBox, translate, rotate, size, 0.0f, 0.0f, 0 });
+}
+
+std::uint32_t CompoundCollider::AddCapsule(const Vector3& translate, const Quaternion& rotate, float radius, float height) {
+    return AddChild({ Type::kCapsule, translate, rotate, Vector3::zero, radius, height, 0 });
+}
+
+std::uint32_t CompoundCollider::AddConvexHull(const Vector3& translate, const Quaternion& rotate, const ConvexHull& hull) {
+    auto& hulls = GetMutableShape().hulls;
+    hulls.emplace_back(hull);
+    return AddChild({ Type::kConvexHull, translate, rotate, Vector3::zero, 0.0f, 0.0f, static_cast<std::uint32_t>(hulls.size() - 1) });
+}
+
+void CompoundCollider::AddConvexDecomposition(const std::vector<Vector3>& vertices, const std::vector<std::uint32_t>& indices, const ConvexDecomposition::Settings& settings) {
+    std::vector<ConvexHull> hulls;
+    ConvexDecomposition::Decompose(vertices, indices, settings, hulls);
+    for (const auto& hull : hulls) {
+        AddConvexHull(Vector3::zero, Quaternion::identity, hull);
+    }
+}
+
+void CompoundCollider::ClearChildren() {
+    shape_ = std::make_shared<Shape>();
+    isDirty_ = false;
+    MarkShapeChanged();
+}
+
+Vector3 CompoundCollider::FindFurthestPoint(const Vector3& direction) const {
+    Vector3 localDirection = ToLocalDirection(direction);
+    Vector3 furthest = Vector3::zero;
+    float maxDot = -Math::positiveInfinity;
+    for (const auto& child : shape_->children) {
+        Vector3 point = shape_->FindChildLocalFurthestPoint(child, localDirection);
+        float dot = Vector3::Dot(point, localDirection);
+        if (dot > maxDot) {
+            maxDot = dot;
+            furthest = point;
+        }
+    }
+    return ToWorldPoint(furthest);
+}
+
+void CompoundCollider::UpdateAABB() {
+    if (isDirty_) {
+        RebuildBVH();
+    }
+    if (shape_->bvh.IsEmpty()) {
+        aabb_ = AABB(GetTransform().GetWorldPosition());
+        return;
+    }
+    // 子ごとではなくローカル木の根を変換する
+    aabb_ = shape_->bvh.GetBounds().Transformed(GetTransform().GetWorldMatrix());
+}
+
+bool CompoundCollider::Raycast(const Vector3& origin, const Vector3& direction, float maxDistance, RaycastHit& hit) const {
+    if (!shape_->Raycast(GetTransform().GetWorldMatrix(), origin, direction, maxDistance, hit)) {
+        return false;
+    }
+    hit.collider = const_cast<CompoundCollider*>(this);
+    return true;
+}
+
+void CompoundCollider::ShowUI() {
+    if (ImGui::TreeNodeEx("CompoundCollider", ImGuiTreeNodeFlags_DefaultOpen | ImGuiTreeNodeFlags_SpanAvailWidth)) {
+        ImGui::Unindent();
+        Collider::ShowUI();
+        ImGui::Text("Children %u", static_cast<std::uint32_t>(shape_->children.size()));
+        ImGui::TreePop();
+    }
+}
+
+Vector3 CompoundCollider::FindChildFurthestPoint(std::uint32_t index, const Vector3& direction) const {
+    return ToWorldPoint(shape_->FindChildLocalFurthestPoint(shape_->children[index], ToLocalDirection(direction)));
+}
+
+void CompoundCollider::QueryChildren(const AABB& bounds, std::vector<std::uint32_t>& indices) const {
+    if (shape_->bvh.IsEmpty()) {
+        return;
+    }
+    AABB localBounds = bounds.Transformed(GetTransform().GetWorldMatrix().Inverse());
+    shape_->bvh.Query(localBounds, [&indices](std::uint32_t index) { indices.emplace_back(index); });
+}
+
+AABB CompoundCollider::GetChildAABB(std::uint32_t index) const {
+    Vector3 min, max;
+    for (size_t i = 0; i < 3; ++i) {
+        Vector3 axis = Vector3::zero;
+        axis[i] = 1.0f;
+        max[i] = FindChildFurthestPoint(index, axis)[i];
+        min[i] = FindChildFurthestPoint(index, -axis)[i];
+    }
+    return AABB(min, max);
+}
+
+std::uint32_t CompoundCollider::AddChild(const Child& child) {
+    auto& children = GetMutableShape().children;
+    children.emplace_back(child);
+    isDirty_ = true;
+    return static_cast<std::uint32_t>(children.size() - 1);
+}
+
+CompoundCollider::Shape& CompoundCollider::GetMutableShape() {
+    // 複製が要るのは写しを公開したStepと同じスレッドで、写しが手放すのは数を減らすだけなので、1を見たら他に持ち主はいない
+    if (shape_.use_count() > 1) {
+        shape_ = std::make_shared<Shape>(*shape_);
+    }
+    MarkShapeChanged();
+    return *shape_;
+}
+
+Vector3 CompoundCollider::Shape::FindChildLocalFurthestPoint(const Child& child, const Vector3& localDirection) const {
+    Vector3 direction = child.rotate.Conjugate() * localDirection;
+    Vector3 point;
+    switch (child.type) {
+    case Type::kSphere:
+        point = Support::Sphere(direction, child.radius);
+        break;
+    case Type::kBox:
+        point = Support::Box(direction, child.size * 0.5f);
+        break;
+    case Type::kConvexHull:
+        point = hulls[child.hull].FindFurthestPoint(direction);
+        break;
+    case Type::kCapsule:
+    default:
+        point = Support::Capsule(direction, child.radius, std::max(child.height * 0.5f - child.radius, 0.0f));
+        break;
+    }
+    return child.rotate * point + child.translate;
+}
+
+AABB CompoundCollider::Shape::GetChildLocalAABB(const Child& child) const {
+    Vector3 min, max;
+    for (size_t i = 0; i < 3; ++i) {
+        Vector3 axis = Vector3::zero;
+        axis[i] = 1.0f;
+        max[i] = FindChildLocalFurthestPoint(child, axis)[i];
+        min[i] = FindChildLocalFurthestPoint(child, -axis)[i];
+    }
+    return AABB(min, max);
+}
+
+void CompoundCollider::RebuildBVH() {
+    Shape& shape = GetMutableShape();
+    std::vector<AABB> bounds;
+    bounds.reserve(shape.children.size());
+    for (const auto& child : shape.children) {
+        bounds.emplace_back(shape.GetChildLocalAABB(child));
+    }
+    shape.bvh.Build(bounds);
+    isDirty_ = false;
+}
+
+bool CompoundCollider::Shape::Raycast(const Matrix4x4& worldMatrix, const Vector3& origin, const Vector3& direction, float maxDistance, RaycastHit& hit) const {
+    auto toWorldPoint = [&worldMatrix](const Vector3& point) { return point * worldMatrix; };
+    auto toLocalDirection = [&worldMatrix](const Vector3& d) {
+        return Vector3{ Vector3::Dot(worldMatrix.GetXAxis(), d), Vector3::Dot(worldMatrix.GetYAxis(), d), Vector3::Dot(worldMatrix.GetZAxis(), d) };
+        };
+    bool isHit = false;
+    hit.distance = maxDistance;
+    auto raycastChild = [&](std::uint32_t index) {
+        const Child& child = children[index];
+        auto support = [&](const Vector3& d) { return toWorldPoint(FindChildLocalFurthestPoint(child, toLocalDirection(d))); };
+        float distance;
+        Vector3 normal;
+        if (GJK::Raycast(support, origin, direction, hit.distance, distance, normal)) {
+            hit.point = origin + direction * distance;
+            hit.normal = normal;
+            hit.distance = distance;
+            isHit = true;
+        }
+        };
+    // 子を足してまだUpdateAABBしていなければ木が古いので全ての子を調べる
+    if (bvh.GetIndices().size() != children.size()) {
+        for (std::uint32_t i = 0; i < children.size(); ++i) {
+            float tMin = 0.0f, tMax = hit.distance;
+            if (GetChildLocalAABB(children[i]).Transformed(worldMatrix).IntersectsRay(origin, direction, tMin, tMax)) {
+                raycastChild(i);
+            }
+        }
+        return isHit;
+    }
+    if (bvh.IsEmpty()) {
+        return false;
+    }
+    // QueryChildrenと同じくローカル空間で木を辿る。線形変換なのでtはワールドと共通
+    Matrix4x4 inverseWorld = worldMatrix.Inverse();
+    bvh.Raycast(origin * inverseWorld, inverseWorld.ApplyRotation(direction), maxDistance, raycastChild);
+    return isHit;
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include "Collider.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "Collision/BVH.hpp"
+#include "Collision/ConvexDecomposition.hpp"
+#include "Collision/ConvexHull.hpp"
+
+// 複数の凸形状をまとめて広域判定に1つのAABBとして出す
+// 子同士は判定しない
+class CompoundCollider :
+    public Collider {
+public:
+    struct Child {
+        Type type;          // kSphere, kBox, kCapsule, kConvexHullのいずれか
+        Vector3 translate;  // コンパウンドのローカル空間
+        Quaternion rotate;
+        Vector3 size;       // kBox
+        float radius;       // kSphere, kCapsule
+        float height;       // kCapsule 半球を含めた全長
+        std::uint32_t hull; // kConvexHull hullsの番号
+    };
+
+    // 子と木。写しが持っている間に変えるときは複製してから変える
+    struct Shape {
+        std::vector<Child> children;
+        std::vector<ConvexHull> hulls;
+        BVH bvh;
+
+        Vector3 FindChildLocalFurthestPoint(const Child& child, const Vector3& localDirection) const;
+        AABB GetChildLocalAABB(const Child& child) const;
+        // worldMatrixに置いたときのレイキャスト。hit.colliderは設定しない
+        bool Raycast(const Matrix4x4& worldMatrix, const Vector3& origin, const Vector3& direction, float maxDistance, RaycastHit& hit) const;
+    };
+
+    CompoundCollider(GameObject* const gameObject) :
+        Collider(gameObject, Type::kCompound),
+        shape_(std::make_shared<Shape>()),
+        isDirty_(false) {
+    }
+
+    std::uint32_t AddSphere(const Vector3& translate, float radius);
+    std::uint32_t AddBox(const Vector3& translate, const Quaternion& rotate, const Vector3& size);
+    std::uint32_t AddCapsule(const Vector3& translate, const Quaternion& rotate, float radius, float height);
+    std::uint32_t AddConvexHull(const Vector3& translate, const Quaternion& rotate, const ConvexHull& hull);
+    // 凹メッシュを凸分解して凸包の子として加える。メッシュはコンパウンドのローカル空間
+    void AddConvexDecomposition(const std::vector<Vector3>& vertices, const std::vector<std::uint32_t>& indices, const ConvexDecomposition::Settings& settings = {});
+    void ClearChildren();
+
+    // 全ての子の凸包のサポート点
+    Vector3 FindFurthestPoint(const Vector3& direction) const override;
+    void UpdateAABB() override;
+    bool Raycast(const Vector3& origin, const Vector3& direction, float maxDistance, RaycastHit& hit) const override;
+    void ShowUI() override;
+
+    Vector3 FindChildFurthestPoint(std::uint32_t index, const Vector3& direction) const;
+    // ワールド空間のboundsと交差する子の番号を追加する
+    void QueryChildren(const AABB& bounds, std::vector<std::uint32_t>& indices) const;
+    AABB GetChildAABB(std::uint32_t index) const;
+
+    const std::vector<Child>& GetChildren() const { return shape_->children; }
+    // 木が古いかもしれないので、UpdateAABBの後に取る
+    std::shared_ptr<const Shape> GetShape() const { return shape_; }
+
+private:
+    std::uint32_t AddChild(const Child& child);
+    // 写しと共有していれば複製して返す。形の版も進める
+    Shape& GetMutableShape();
+    void RebuildBVH();
+
+    std::shared_ptr<Shape> shape_;
+    bool isDirty_;
+};
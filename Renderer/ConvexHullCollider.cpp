@@ -0,0 +1,21 @@
+#include "ConvexHullCollider.hpp"
+
+#include "Externals/ImGui/imgui.h"
+
+#include "Transform.hpp"
+
+Vector3 ConvexHullCollider::FindFurthestPoint(const Vector3& direction) const {
+    if (hull_.IsEmpty()) {
+        return GetTransform().GetWorldPosition();
+    }
+    return ToWorldPoint(hull_.FindFurthestPoint(ToLocalDirection(direction)));
+}
+
+void ConvexHullCollider::ShowUI() {
+    if (ImGui::TreeNodeEx("ConvexHullCollider", ImGuiTreeNodeFlags_DefaultOpen | ImGuiTreeNodeFlags_SpanAvailWidth)) {
+        ImGui::Unindent();
+        Collider::ShowUI();
+        ImGui::Text("Vertices %u", static_cast<std::uint32_t>(hull_.GetVertices().size()));
+        ImGui::TreePop();
+    }
+}
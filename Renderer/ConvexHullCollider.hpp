@@ -0,0 +1,28 @@
+#pragma once
+#include "Collider.hpp"
+
+#include <vector>
+
+#include "Collision/ConvexHull.hpp"
+
+// 点群の凸包。凹形状は凸分解してCompoundColliderの子にする
+class ConvexHullCollider :
+    public Collider {
+public:
+    ConvexHullCollider(GameObject* const gameObject) :
+        Collider(gameObject, Type::kConvexHull) {
+    }
+
+    // ローカル空間の点群から凸包を作る
+    void SetPoints(const std::vector<Vector3>& points, std::uint32_t maxVertices = ConvexHull::kDefaultMaxVertices) { hull_.Build(points, maxVertices); MarkShapeChanged(); }
+    void SetHull(const ConvexHull& hull) { hull_ = hull; MarkShapeChanged(); }
+
+    Vector3 FindFurthestPoint(const Vector3& direction) const override;
+    const std::vector<Vector3>* GetLocalVertices() const override { return &hull_.GetVertices(); }
+    void ShowUI() override;
+
+    const ConvexHull& GetHull() const { return hull_; }
+
+private:
+    ConvexHull hull_;
+};
@@ -0,0 +1,117 @@
+#include "DistanceFieldCollider.hpp"
+
+#include <algorithm>
+
+#include "Externals/ImGui/imgui.h"
+
+#include "Transform.hpp"
+
+namespace {
+    // 面に着いたとみなす距離
+    constexpr float kHitTolerance = 1.0e-3f;
+    constexpr std::uint32_t kMaxRaycastSteps = 128;
+}
+
+void DistanceFieldCollider::SetMesh(const std::vector<Vector3>& vertices, const std::vector<std::uint32_t>& indices, const SignedDistanceField::Settings& settings, const std::filesystem::path& cachePath) {
+    std::uint64_t sourceHash = SignedDistanceField::ComputeSourceHash(vertices, indices, settings);
+    auto field = std::make_shared<SignedDistanceField>();
+    isLoadedFromCache_ = !cachePath.empty() && field->Load(cachePath, sourceHash);
+    if (!isLoadedFromCache_) {
+        field->Bake(vertices, indices, settings);
+        if (!cachePath.empty() && !field->IsEmpty()) {
+            // 書けなくても次に焼き直すだけ
+            field->Save(cachePath, sourceHash);
+        }
+    }
+    field_ = std::move(field);
+    MarkShapeChanged();
+}
+
+Vector3 DistanceFieldCollider::FindFurthestPoint(const Vector3& direction) const {
+    if (field_->IsEmpty()) {
+        return GetTransform().GetWorldPosition();
+    }
+    Vector3 localDirection = ToLocalDirection(direction);
+    const AABB& bounds = field_->GetMeshBounds();
+    return ToWorldPoint({
+        localDirection.x >= 0.0f ? bounds.max.x : bounds.min.x,
+        localDirection.y >= 0.0f ? bounds.max.y : bounds.min.y,
+        localDirection.z >= 0.0f ? bounds.max.z : bounds.min.z });
+}
+
+void DistanceFieldCollider::UpdateAABB() {
+    if (field_->IsEmpty()) {
+        aabb_ = AABB(GetTransform().GetWorldPosition());
+        return;
+    }
+    aabb_ = field_->GetMeshBounds().Transformed(GetTransform().GetWorldMatrix());
+}
+
+bool DistanceFieldCollider::Raycast(const Vector3& origin, const Vector3& direction, float maxDistance, RaycastHit& hit) const {
+    if (!RaycastField(*field_, GetTransform().GetWorldMatrix(), origin, direction, maxDistance, hit)) {
+        return false;
+    }
+    hit.collider = const_cast<DistanceFieldCollider*>(this);
+    return true;
+}
+
+void DistanceFieldCollider::ShowUI() {
+    if (ImGui::TreeNodeEx("DistanceFieldCollider", ImGuiTreeNodeFlags_DefaultOpen | ImGuiTreeNodeFlags_SpanAvailWidth)) {
+        ImGui::Unindent();
+        Collider::ShowUI();
+        const auto& settings = field_->GetSettings();
+        ImGui::Text("Cell %.3f Band %.3f", settings.cellSize, settings.bandWidth);
+        ImGui::Text("Bricks %u / %u %.1fKB%s", field_->GetBrickCount(), field_->GetBrickTableSize(),
+            static_cast<float>(field_->GetMemoryUsage()) / 1024.0f, isLoadedFromCache_ ? " (cached)" : "");
+        ImGui::TreePop();
+    }
+}
+
+SignedDistanceField::Sample DistanceFieldCollider::Evaluate(const Vector3& point) const {
+    return field_->Evaluate(point, GetTransform().GetWorldMatrix().Inverse());
+}
+
+bool DistanceFieldCollider::CollideSphere(const Vector3& center, float radius, Contact& contact) const {
+    SignedDistanceField::Sample sample = Evaluate(center);
+    if (sample.distance >= radius) {
+        return false;
+    }
+    contact.normal = sample.gradient;
+    contact.pointA = center - sample.gradient * sample.distance;
+    contact.pointB = center - sample.gradient * radius;
+    contact.depth = radius - sample.distance;
+    return true;
+}
+
+bool DistanceFieldCollider::RaycastField(const SignedDistanceField& field, const Matrix4x4& worldMatrix, const Vector3& origin, const Vector3& direction, float maxDistance, RaycastHit& hit) {
+    if (field.IsEmpty()) {
+        return false;
+    }
+    float t = 0.0f, tExit = maxDistance;
+    if (!field.GetMeshBounds().Transformed(worldMatrix).IntersectsRay(origin, direction, t, tExit)) {
+        return false;
+    }
+    Matrix4x4 toLocal = worldMatrix.Inverse();
+    SignedDistanceField::Sample sample = field.Evaluate(origin + direction * t, toLocal);
+    if (t == 0.0f && sample.distance < 0.0f) {
+        hit.point = origin;
+        hit.normal = sample.gradient;
+        hit.distance = 0.0f;
+        return true;
+    }
+    // 距離の分だけなら面を越えない
+    for (std::uint32_t step = 0; step < kMaxRaycastSteps; ++step) {
+        if (sample.distance <= kHitTolerance) {
+            hit.point = origin + direction * t;
+            hit.normal = sample.gradient;
+            hit.distance = t;
+            return true;
+        }
+        t += sample.distance;
+        if (t > tExit) {
+            return false;
+        }
+        sample = field.Evaluate(origin + direction * t, toLocal);
+    }
+    return false;
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include "Collider.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+#include "Collision/Narrowphase.hpp"
+#include "Collision/SignedDistanceField.hpp"
+
+// 細かい静的なメッシュを符号付き距離場に焼いたコライダー
+// 深くめり込んでも1回の補間で距離と押し出す向きが分かる。相手はサポート点を距離場で測って当てる
+// 焼くのは重いので、cachePathを渡せば次からはファイルから読む
+class DistanceFieldCollider :
+    public Collider {
+public:
+    DistanceFieldCollider(GameObject* const gameObject) :
+        Collider(gameObject, Type::kDistanceField),
+        field_(std::make_shared<SignedDistanceField>()),
+        isLoadedFromCache_(false) {
+    }
+
+    // indicesは3つずつで1枚。cachePathが空でなければ、同じメッシュと設定で焼いたものをそこから読み、無ければ焼いて書き出す
+    void SetMesh(const std::vector<Vector3>& vertices, const std::vector<std::uint32_t>& indices, const SignedDistanceField::Settings& settings, const std::filesystem::path& cachePath);
+
+    // メッシュの境界箱のサポート点（非凸なのでGJKには直接使わない）
+    Vector3 FindFurthestPoint(const Vector3& direction) const override;
+    void UpdateAABB() override;
+    // 距離場を球で辿る。始点が中にあれば始点で当たる
+    bool Raycast(const Vector3& origin, const Vector3& direction, float maxDistance, RaycastHit& hit) const override;
+    void ShowUI() override;
+    // worldMatrixに置いたfieldのレイキャスト。hit.colliderは設定しない
+    static bool RaycastField(const SignedDistanceField& field, const Matrix4x4& worldMatrix, const Vector3& origin, const Vector3& direction, float maxDistance, RaycastHit& hit);
+
+    // ワールド空間の点の符号付き距離と、距離が増える向き
+    SignedDistanceField::Sample Evaluate(const Vector3& point) const;
+    // ワールド空間の球。当たればcontactの法線は距離場から球へ向かい、pointBが球の最も深い点
+    bool CollideSphere(const Vector3& center, float radius, Contact& contact) const;
+
+    const SignedDistanceField& GetField() const { return *field_; }
+    const std::shared_ptr<const SignedDistanceField>& GetSharedField() const { return field_; }
+    bool IsLoadedFromCache() const { return isLoadedFromCache_; }
+
+private:
+    // 焼き直すときは差し替える。写しが持っている間は変わらない
+    std::shared_ptr<const SignedDistanceField> field_;
+    bool isLoadedFromCache_;
+};
@@ -0,0 +1,469 @@
+#include "FluidSystem.hpp"
+
+#include <algorithm>
+
+#include "Externals/ImGui/imgui.h"
+
+#include "Math/SIMD.hpp"
+#include "GameObject.hpp"
+#include "Renderer.hpp"
+#include "Scene.hpp"
+#include "ThreadPool.hpp"
+#include "Collision/CollisionWorld.hpp"
+#include "Collision/ParticleCollision.hpp"
+
+using namespace SIMD;
+
+namespace {
+    // 1タスクで扱うセルの数
+    constexpr std::uint32_t kCellsPerTask = 64;
+    // 1タスクで扱う粒子の数
+    constexpr std::uint32_t kChunkSize = 4096;
+    constexpr std::uint32_t kMinBucketCount = 64;
+    // 近傍の候補の詰め物。どの粒子からも影響半径の外になる
+    constexpr float kFarAway = 1.0e10f;
+    constexpr float kEpsilon = 1.0e-6f;
+    // 候補を詰める幅
+#if defined(__AVX__)
+    constexpr std::uint32_t kWidth = static_cast<std::uint32_t>(Float8::kWidth);
+#else
+    constexpr std::uint32_t kWidth = 1;
+#endif
+
+    // 下位10ビットを3ビットおきに広げる
+    std::uint32_t ExpandBits10(std::uint32_t v) {
+        v &= 0x3FF;
+        v = (v * 0x00010001u) & 0xFF0000FFu;
+        v = (v * 0x00000101u) & 0x0F00F00Fu;
+        v = (v * 0x00000011u) & 0xC30C30C3u;
+        v = (v * 0x00000005u) & 0x49249249u;
+        return v;
+    }
+
+    // 影響半径hのカーネルの係数
+    float Poly6Coefficient(float h) { return 315.0f / (64.0f * Math::Pi * std::pow(h, 9.0f)); }
+    float SpikyCoefficient(float h) { return 45.0f / (Math::Pi * std::pow(h, 6.0f)); }
+
+    template<class F>
+    Vector3T<F> LoadVector(const std::vector<float>* values, size_t i) {
+        return { Load<F>(values[0].data() + i), Load<F>(values[1].data() + i), Load<F>(values[2].data() + i) };
+    }
+
+    // 候補の(h^2 - r^2)^3の和
+    template<class F>
+    F DensityKernel(const std::vector<float> (&candidates)[8], size_t j, const Vector3T<F>& position, float h2) {
+        Vector3T<F> d = position - LoadVector<F>(candidates, j);
+        F w = Max(F(h2) - Dot(d, d), F(0.0f));
+        return w * w * w;
+    }
+
+    // 圧力と粘性による加速度の和。係数はまとめて外で掛ける
+    template<class F>
+    Vector3T<F> AccelerationKernel(const std::vector<float> (&candidates)[8], size_t j, const Vector3T<F>& position, const Vector3T<F>& velocity, float pressureTerm, float h, float viscosityScale) {
+        Vector3T<F> d = position - LoadVector<F>(candidates, j);
+        F distanceSquare = Dot(d, d);
+        auto isNeighbor = And(distanceSquare < F(h * h), distanceSquare > F(kEpsilon * kEpsilon));
+        F distance = Sqrt(Max(distanceSquare, F(kEpsilon * kEpsilon)));
+        F hr = Max(F(h) - distance, F(0.0f));
+        F density = Load<F>(candidates[6].data() + j);
+        F pressure = Load<F>(candidates[7].data() + j);
+        F inverseDensity = F(1.0f) / density;
+        // 対称な圧力項。近づいた分だけ離す
+        F pressureScale = (F(pressureTerm) + pressure * inverseDensity * inverseDensity) * hr * hr / distance;
+        // 粘性は相手の速度に寄せる
+        F viscosity = F(viscosityScale) * hr * inverseDensity;
+        Vector3T<F> relativeVelocity = LoadVector<F>(candidates + 3, j) - velocity;
+        Vector3T<F> acceleration = d * pressureScale + relativeVelocity * viscosity;
+        Vector3T<F> zero{ F(0.0f), F(0.0f), F(0.0f) };
+        return Select(isNeighbor, acceleration, zero);
+    }
+
+    template<class F>
+    void IntegrateKernel(const ParticleCollision::Streams& streams, const std::vector<float>* accelerations, size_t i, const Vector3& gravity, float timeStep) {
+        F dt(timeStep);
+        Vector3T<F> acceleration = LoadVector<F>(accelerations, i) + Vector3T<F>{ F(gravity.x), F(gravity.y), F(gravity.z) };
+        Vector3T<F> velocity{ Load<F>(streams.velocities[0] + i), Load<F>(streams.velocities[1] + i), Load<F>(streams.velocities[2] + i) };
+        velocity = velocity + acceleration * dt;
+        for (size_t axis = 0; axis < 3; ++axis) {
+            const F& v = axis == 0 ? velocity.x : axis == 1 ? velocity.y : velocity.z;
+            Store(streams.velocities[axis] + i, v);
+            Store(streams.positions[axis] + i, Load<F>(streams.positions[axis] + i) + v * dt);
+        }
+    }
+
+    // 8個ずつ、残りを1個ずつ
+    template<class Kernel8, class Kernel1>
+    void Run(size_t begin, size_t end, Kernel8&& kernel8, Kernel1&& kernel1) {
+        size_t i = begin;
+#if defined(__AVX__)
+        for (; i + Float8::kWidth <= end; i += Float8::kWidth) {
+            kernel8(i);
+        }
+#else
+        (void)kernel8;
+#endif
+        for (; i < end; ++i) {
+            kernel1(i);
+        }
+    }
+}
+
+void FluidSystem::Update(float deltaTime) {
+    if (timeStep_ <= 0.0f) {
+        return;
+    }
+    accumulator_ += deltaTime;
+    std::uint32_t stepCount = 0;
+    while (accumulator_ >= timeStep_ && stepCount < maxSubstepCount_) {
+        Step(timeStep_);
+        accumulator_ -= timeStep_;
+        ++stepCount;
+    }
+    // 追いつけない分は捨てて、重いフレームが続いても破綻させない
+    if (stepCount == maxSubstepCount_) {
+        accumulator_ = std::min(accumulator_, timeStep_);
+    }
+}
+
+void FluidSystem::Step(float timeStep) {
+    std::uint32_t count = GetCount();
+    if (count == 0) {
+        return;
+    }
+    if (mass_ <= 0.0f) {
+        UpdateMass();
+    }
+    BuildGrid();
+    densities_.resize(count);
+    pressures_.resize(count);
+    for (auto& acceleration : accelerations_) {
+        acceleration.resize(count);
+    }
+
+    ThreadPool& threadPool = ThreadPool::GetShared();
+    std::uint32_t taskCount = static_cast<std::uint32_t>((cells_.size() + kCellsPerTask - 1) / kCellsPerTask);
+    if (scratches_.size() < taskCount) {
+        scratches_.resize(taskCount);
+    }
+    // 加速度は全ての密度が揃ってから
+    threadPool.ParallelFor(taskCount, [&](std::uint32_t task) { ComputeDensity(task); });
+    threadPool.ParallelFor(taskCount, [&](std::uint32_t task) { ComputeAcceleration(task); });
+
+    Scene* scene = gameObject.GetScene();
+    const CollisionWorld* collisionWorld = scene ? &scene->GetCollisionWorld() : nullptr;
+    std::uint32_t chunkCount = (count + kChunkSize - 1) / kChunkSize;
+    threadPool.ParallelFor(chunkCount, [&](std::uint32_t chunk) { Integrate(chunk, timeStep, collisionWorld); });
+}
+
+void FluidSystem::Draw(Renderer& renderer) const {
+    std::uint32_t count = GetCount();
+    if (count == 0) {
+        return;
+    }
+    Renderer::InstanceData* instances = renderer.DrawInstances(renderer.GetBoxMesh(), count);
+    if (!instances) {
+        return;
+    }
+    // 箱のメッシュは1辺1なので粒子の間隔で拡大する
+    std::uint32_t chunkCount = (count + kChunkSize - 1) / kChunkSize;
+    ThreadPool::GetShared().ParallelFor(chunkCount, [&](std::uint32_t chunk) {
+        std::uint32_t begin = chunk * kChunkSize;
+        std::uint32_t end = std::min(begin + kChunkSize, count);
+        for (std::uint32_t i = begin; i < end; ++i) {
+            Renderer::InstanceData& instance = instances[i];
+            instance.mat0 = { spacing_, 0.0f, 0.0f, positions_[0][i] };
+            instance.mat1 = { 0.0f, spacing_, 0.0f, positions_[1][i] };
+            instance.mat2 = { 0.0f, 0.0f, spacing_, positions_[2][i] };
+            instance.color = color_;
+        }
+        });
+}
+
+void FluidSystem::AddParticle(const Vector3& position, const Vector3& velocity) {
+    for (size_t axis = 0; axis < 3; ++axis) {
+        positions_[axis].emplace_back(position[axis]);
+        velocities_[axis].emplace_back(velocity[axis]);
+    }
+}
+
+void FluidSystem::FillBox(const Vector3& center, const Vector3& size) {
+    if (spacing_ <= 0.0f) {
+        return;
+    }
+    std::int32_t counts[3];
+    for (size_t axis = 0; axis < 3; ++axis) {
+        counts[axis] = std::max(static_cast<std::int32_t>(size[axis] / spacing_), 1);
+    }
+    Vector3 origin = center - Vector3(static_cast<float>(counts[0]), static_cast<float>(counts[1]), static_cast<float>(counts[2])) * (spacing_ * 0.5f);
+    for (std::int32_t z = 0; z < counts[2]; ++z) {
+        for (std::int32_t y = 0; y < counts[1]; ++y) {
+            for (std::int32_t x = 0; x < counts[0]; ++x) {
+                Vector3 offset(static_cast<float>(x) + 0.5f, static_cast<float>(y) + 0.5f, static_cast<float>(z) + 0.5f);
+                AddParticle(origin + offset * spacing_, Vector3::zero);
+            }
+        }
+    }
+}
+
+void FluidSystem::Clear() {
+    for (size_t axis = 0; axis < 3; ++axis) {
+        positions_[axis].clear();
+        velocities_[axis].clear();
+    }
+    densities_.clear();
+    pressures_.clear();
+    accumulator_ = 0.0f;
+}
+
+void FluidSystem::ShowUI() {
+    if (ImGui::TreeNodeEx("FluidSystem", ImGuiTreeNodeFlags_DefaultOpen | ImGuiTreeNodeFlags_SpanAvailWidth)) {
+        ImGui::Unindent();
+        if (ImGui::DragFloat("Spacing", &spacing_, 0.001f, 0.001f, Math::positiveInfinity)) {
+            mass_ = 0.0f;
+        }
+        if (ImGui::DragFloat("RestDensity", &restDensity_, 1.0f, 1.0f, Math::positiveInfinity)) {
+            mass_ = 0.0f;
+        }
+        ImGui::DragFloat("Stiffness", &stiffness_, 1.0f, 0.0f, Math::positiveInfinity);
+        ImGui::DragFloat("Viscosity", &viscosity_, 0.01f, 0.0f, Math::positiveInfinity);
+        ImGui::DragFloat3("Gravity", &gravity_.x, 0.1f);
+        ImGui::DragFloat("Restitution", &restitution_, 0.01f, 0.0f, 1.0f);
+        ImGui::DragFloat("Friction", &friction_, 0.01f, 0.0f, 1.0f);
+        ImGui::ColorEdit4("Color", &color_.x);
+        ImGui::Text("Count %u Cells %u", GetCount(), static_cast<std::uint32_t>(cells_.size()));
+        ImGui::TreePop();
+    }
+}
+
+void FluidSystem::BuildGrid() {
+    std::uint32_t count = GetCount();
+    float inverseCellSize = 1.0f / GetSmoothingRadius();
+    // 粒子数の2倍以上の2の冪にして衝突を減らす
+    std::uint32_t bucketCount = kMinBucketCount;
+    while (bucketCount < count * 2) {
+        bucketCount <<= 1;
+    }
+    for (size_t axis = 0; axis < 3; ++axis) {
+        cellCoordinates_[axis].resize(count);
+        sortedCellCoordinates_[axis].resize(count);
+        sortedPositions_[axis].resize(count);
+        sortedVelocities_[axis].resize(count);
+    }
+    particleBuckets_.resize(count);
+    bucketStarts_.assign(static_cast<size_t>(bucketCount) + 1, 0);
+
+    std::uint32_t chunkCount = (count + kChunkSize - 1) / kChunkSize;
+    ThreadPool::GetShared().ParallelFor(chunkCount, [&](std::uint32_t chunk) {
+        std::uint32_t begin = chunk * kChunkSize;
+        std::uint32_t end = std::min(begin + kChunkSize, count);
+        for (std::uint32_t i = begin; i < end; ++i) {
+            std::int32_t cell[3];
+            for (size_t axis = 0; axis < 3; ++axis) {
+                cell[axis] = static_cast<std::int32_t>(std::floor(positions_[axis][i] * inverseCellSize));
+                cellCoordinates_[axis][i] = cell[axis];
+            }
+            particleBuckets_[i] = GetBucket(cell[0], cell[1], cell[2]);
+        }
+        });
+
+    // 数え上げソート。数えて累積し、先頭から詰める
+    for (std::uint32_t i = 0; i < count; ++i) {
+        ++bucketStarts_[particleBuckets_[i] + 1];
+    }
+    for (std::uint32_t bucket = 0; bucket < bucketCount; ++bucket) {
+        bucketStarts_[bucket + 1] += bucketStarts_[bucket];
+    }
+    for (std::uint32_t i = 0; i < count; ++i) {
+        std::uint32_t dst = bucketStarts_[particleBuckets_[i]]++;
+        for (size_t axis = 0; axis < 3; ++axis) {
+            sortedPositions_[axis][dst] = positions_[axis][i];
+            sortedVelocities_[axis][dst] = velocities_[axis][i];
+            sortedCellCoordinates_[axis][dst] = cellCoordinates_[axis][i];
+        }
+    }
+    // 詰め終わると各バケットの先頭は次のバケットの先頭になっているので1つずらす
+    for (std::uint32_t bucket = bucketCount; bucket > 0; --bucket) {
+        bucketStarts_[bucket] = bucketStarts_[bucket - 1];
+    }
+    bucketStarts_[0] = 0;
+    for (size_t axis = 0; axis < 3; ++axis) {
+        positions_[axis].swap(sortedPositions_[axis]);
+        velocities_[axis].swap(sortedVelocities_[axis]);
+        cellCoordinates_[axis].swap(sortedCellCoordinates_[axis]);
+    }
+
+    // バケットの中をセルの座標が変わるところで区切る。衝突したセルが混ざっても近傍は正しく引ける
+    cells_.clear();
+    for (std::uint32_t bucket = 0; bucket < bucketCount; ++bucket) {
+        std::uint32_t end = bucketStarts_[bucket + 1];
+        for (std::uint32_t begin = bucketStarts_[bucket]; begin < end;) {
+            std::uint32_t i = begin + 1;
+            while (i < end &&
+                cellCoordinates_[0][i] == cellCoordinates_[0][begin] &&
+                cellCoordinates_[1][i] == cellCoordinates_[1][begin] &&
+                cellCoordinates_[2][i] == cellCoordinates_[2][begin]) {
+                ++i;
+            }
+            cells_.push_back({ begin, i });
+            begin = i;
+        }
+    }
+}
+
+std::uint32_t FluidSystem::GatherNeighbors(const Cell& cell, Scratch& scratch, std::uint32_t streamCount) const {
+    // 周りの27セルのバケット。衝突で同じバケットを2度数えないよう重複を除く
+    std::uint32_t buckets[27];
+    std::uint32_t bucketCount = 0;
+    for (std::int32_t z = -1; z <= 1; ++z) {
+        for (std::int32_t y = -1; y <= 1; ++y) {
+            for (std::int32_t x = -1; x <= 1; ++x) {
+                buckets[bucketCount++] = GetBucket(
+                    cellCoordinates_[0][cell.begin] + x,
+                    cellCoordinates_[1][cell.begin] + y,
+                    cellCoordinates_[2][cell.begin] + z);
+            }
+        }
+    }
+    std::sort(buckets, buckets + bucketCount);
+    bucketCount = static_cast<std::uint32_t>(std::unique(buckets, buckets + bucketCount) - buckets);
+
+    std::uint32_t candidateCount = 0;
+    for (std::uint32_t b = 0; b < bucketCount; ++b) {
+        candidateCount += bucketStarts_[buckets[b] + 1] - bucketStarts_[buckets[b]];
+    }
+    // 幅の倍数まで詰め物をして端数の処理をなくす
+    std::uint32_t paddedCount = (candidateCount + kWidth - 1) / kWidth * kWidth;
+    for (std::uint32_t stream = 0; stream < streamCount; ++stream) {
+        scratch.values[stream].resize(paddedCount);
+    }
+    const std::vector<float>* sources[8] = {
+        &positions_[0], &positions_[1], &positions_[2],
+        &velocities_[0], &velocities_[1], &velocities_[2],
+        &densities_, &pressures_ };
+    for (std::uint32_t stream = 0; stream < streamCount; ++stream) {
+        float* dst = scratch.values[stream].data();
+        for (std::uint32_t b = 0; b < bucketCount; ++b) {
+            const float* src = sources[stream]->data();
+            dst = std::copy(src + bucketStarts_[buckets[b]], src + bucketStarts_[buckets[b] + 1], dst);
+        }
+        // 位置は遠くへ、密度は割れるように1
+        float padding = stream < 3 ? kFarAway : stream == 6 ? 1.0f : 0.0f;
+        std::fill(dst, scratch.values[stream].data() + paddedCount, padding);
+    }
+    return paddedCount;
+}
+
+void FluidSystem::ComputeDensity(std::uint32_t task) {
+    Scratch& scratch = scratches_[task];
+    float h = GetSmoothingRadius();
+    float h2 = h * h;
+    float densityScale = mass_ * Poly6Coefficient(h);
+    size_t cellEnd = std::min(static_cast<size_t>(task + 1) * kCellsPerTask, cells_.size());
+    for (size_t c = static_cast<size_t>(task) * kCellsPerTask; c < cellEnd; ++c) {
+        const Cell& cell = cells_[c];
+        std::uint32_t candidateCount = GatherNeighbors(cell, scratch, 3);
+        for (std::uint32_t i = cell.begin; i < cell.end; ++i) {
+            Vector3 position = GetPosition(i);
+            float sum = 0.0f;
+#if defined(__AVX__)
+            Vector3T<Float8> position8{ Float8(position.x), Float8(position.y), Float8(position.z) };
+            Float8 sum8(0.0f);
+            Run(0, candidateCount, [&](size_t j) { sum8 = sum8 + DensityKernel<Float8>(scratch.values, j, position8, h2); }, [](size_t) {});
+            sum = ReduceAdd(sum8);
+#else
+            Vector3T<float> position1{ position.x, position.y, position.z };
+            Run(0, candidateCount, [](size_t) {}, [&](size_t j) { sum += DensityKernel<float>(scratch.values, j, position1, h2); });
+#endif
+            densities_[i] = densityScale * sum;
+            // 引っ張る向きの圧力は粒子を固まらせるので捨てる
+            pressures_[i] = std::max(stiffness_ * (densities_[i] - restDensity_), 0.0f);
+        }
+    }
+}
+
+void FluidSystem::ComputeAcceleration(std::uint32_t task) {
+    Scratch& scratch = scratches_[task];
+    float h = GetSmoothingRadius();
+    float gradientScale = mass_ * SpikyCoefficient(h);
+    size_t cellEnd = std::min(static_cast<size_t>(task + 1) * kCellsPerTask, cells_.size());
+    for (size_t c = static_cast<size_t>(task) * kCellsPerTask; c < cellEnd; ++c) {
+        const Cell& cell = cells_[c];
+        std::uint32_t candidateCount = GatherNeighbors(cell, scratch, 8);
+        for (std::uint32_t i = cell.begin; i < cell.end; ++i) {
+            Vector3 position = GetPosition(i);
+            Vector3 velocity = GetVelocity(i);
+            float inverseDensity = 1.0f / densities_[i];
+            float pressureTerm = pressures_[i] * inverseDensity * inverseDensity;
+            // 粘性のラプラシアンは勾配と同じ係数になる
+            float viscosityScale = viscosity_ * inverseDensity;
+            Vector3T<float> sum{ 0.0f, 0.0f, 0.0f };
+#if defined(__AVX__)
+            Vector3T<Float8> position8{ Float8(position.x), Float8(position.y), Float8(position.z) };
+            Vector3T<Float8> velocity8{ Float8(velocity.x), Float8(velocity.y), Float8(velocity.z) };
+            Vector3T<Float8> sum8{ Float8(0.0f), Float8(0.0f), Float8(0.0f) };
+            Run(0, candidateCount, [&](size_t j) {
+                sum8 = sum8 + AccelerationKernel<Float8>(scratch.values, j, position8, velocity8, pressureTerm, h, viscosityScale);
+                }, [](size_t) {});
+            sum = { ReduceAdd(sum8.x), ReduceAdd(sum8.y), ReduceAdd(sum8.z) };
+#else
+            Vector3T<float> position1{ position.x, position.y, position.z };
+            Vector3T<float> velocity1{ velocity.x, velocity.y, velocity.z };
+            Run(0, candidateCount, [](size_t) {}, [&](size_t j) {
+                sum = sum + AccelerationKernel<float>(scratch.values, j, position1, velocity1, pressureTerm, h, viscosityScale);
+                });
+#endif
+            accelerations_[0][i] = sum.x * gradientScale;
+            accelerations_[1][i] = sum.y * gradientScale;
+            accelerations_[2][i] = sum.z * gradientScale;
+        }
+    }
+}
+
+void FluidSystem::Integrate(std::uint32_t chunk, float timeStep, const CollisionWorld* collisionWorld) {
+    std::uint32_t begin = chunk * kChunkSize;
+    std::uint32_t end = std::min(begin + kChunkSize, GetCount());
+    ParticleCollision::Streams streams{
+        { positions_[0].data(), positions_[1].data(), positions_[2].data() },
+        { velocities_[0].data(), velocities_[1].data(), velocities_[2].data() } };
+#if defined(__AVX__)
+    auto kernel8 = [&](size_t i) { IntegrateKernel<Float8>(streams, accelerations_, i, gravity_, timeStep); };
+#else
+    auto kernel8 = [](size_t) {};
+#endif
+    Run(begin, end, kernel8, [&](size_t i) { IntegrateKernel<float>(streams, accelerations_, i, gravity_, timeStep); });
+
+    // バケットがセル座標のMorton順なので、塊の粒子は空間的にまとまりAABBは小さい
+    if (collisionWorld) {
+        float radius = spacing_ * 0.5f;
+        AABB bounds = ParticleCollision::ComputeBounds(streams, begin, end, radius);
+        ParticleCollision::CollideStatic(*collisionWorld, bounds, streams, begin, end, { radius, restitution_, friction_ });
+    }
+}
+
+void FluidSystem::UpdateMass() {
+    // 格子の周りの粒子から受ける密度の和を質量1で求める
+    float h = GetSmoothingRadius();
+    float h2 = h * h;
+    std::int32_t range = static_cast<std::int32_t>(std::ceil(h / spacing_));
+    float sum = 0.0f;
+    for (std::int32_t z = -range; z <= range; ++z) {
+        for (std::int32_t y = -range; y <= range; ++y) {
+            for (std::int32_t x = -range; x <= range; ++x) {
+                float r2 = static_cast<float>(x * x + y * y + z * z) * spacing_ * spacing_;
+                float w = std::max(h2 - r2, 0.0f);
+                sum += w * w * w;
+            }
+        }
+    }
+    mass_ = restDensity_ / (Poly6Coefficient(h) * sum);
+}
+
+std::uint32_t FluidSystem::GetBucket(std::int32_t x, std::int32_t y, std::int32_t z) const {
+    // セル座標の下位ビットのMorton符号。バケット順に並べた粒子が空間的にまとまる
+    // 下位ビットの揃う遠いセルは同じバケットに入るが、セルは座標で区切るので近傍は正しく引ける
+    std::uint32_t code =
+        ExpandBits10(static_cast<std::uint32_t>(x)) |
+        ExpandBits10(static_cast<std::uint32_t>(y)) << 1 |
+        ExpandBits10(static_cast<std::uint32_t>(z)) << 2;
+    return code & static_cast<std::uint32_t>(bucketStarts_.size() - 2);
+}
@@ -0,0 +1,130 @@
+#pragma once
+#include "Component.hpp"
+
+#include <cstdint>
+#include <vector>
+
+#include "Math/MathUtils.hpp"
+
+class Renderer;
+class CollisionWorld;
+
+// SPH（粒子法）の水
+// 近傍探索は毎ステップ数え上げソートで作り直す空間ハッシュ。粒子の並びもバケット順に並べ替える
+// バケットはセル座標のMorton符号なので、並びの近い粒子は空間的にも近い
+// 境界は当たり判定の静的な木にあるコライダー。箱は向きのある箱、球とカプセルはそのまま、それ以外はAABBとみなす
+class FluidSystem :
+    public Component {
+public:
+    FluidSystem(GameObject* const gameObject) :
+        Component(gameObject),
+        gravity_(0.0f, -9.8f, 0.0f),
+        color_(0.2f, 0.5f, 1.0f, 1.0f),
+        spacing_(0.1f),
+        restDensity_(1000.0f),
+        stiffness_(200.0f),
+        viscosity_(5.0f),
+        timeStep_(1.0f / 240.0f),
+        maxSubstepCount_(8),
+        restitution_(0.0f),
+        friction_(0.05f),
+        accumulator_(0.0f),
+        mass_(0.0f) {
+    }
+
+    // timeStep刻みで進める。端数は次に持ち越す
+    void Update(float deltaTime);
+    void Step(float timeStep);
+    // 粒子を箱のインスタンスとして1回で描く
+    void Draw(Renderer& renderer) const;
+    void AddParticle(const Vector3& position, const Vector3& velocity);
+    // ワールド空間の箱をspacing間隔の格子で満たす
+    void FillBox(const Vector3& center, const Vector3& size);
+    void Clear();
+    void ShowUI() override;
+
+    // 静止した粒子の間隔。影響半径はこの2倍
+    void SetSpacing(float spacing) { spacing_ = spacing; mass_ = 0.0f; }
+    void SetRestDensity(float restDensity) { restDensity_ = restDensity; mass_ = 0.0f; }
+    // 密度の超過を圧力に変える係数。大きいほど縮まないが、timeStepを小さくする必要がある
+    void SetStiffness(float stiffness) { stiffness_ = stiffness; }
+    void SetViscosity(float viscosity) { viscosity_ = viscosity; }
+    void SetGravity(const Vector3& gravity) { gravity_ = gravity; }
+    void SetTimeStep(float timeStep) { timeStep_ = timeStep; }
+    // 1回のUpdateで進めるステップの上限。超えた分は捨てる
+    void SetMaxSubstepCount(std::uint32_t maxSubstepCount) { maxSubstepCount_ = maxSubstepCount; }
+    // 境界との当たり。壁と床の角に挟まれた粒子が角に沿って加速し続けないよう、少し摩擦を残す
+    void SetRestitution(float restitution) { restitution_ = restitution; }
+    void SetFriction(float friction) { friction_ = friction; }
+    void SetColor(const Vector4& color) { color_ = color; }
+
+    float GetSpacing() const { return spacing_; }
+    float GetSmoothingRadius() const { return spacing_ * 2.0f; }
+    float GetRestDensity() const { return restDensity_; }
+    float GetStiffness() const { return stiffness_; }
+    float GetViscosity() const { return viscosity_; }
+    const Vector3& GetGravity() const { return gravity_; }
+    float GetTimeStep() const { return timeStep_; }
+    std::uint32_t GetMaxSubstepCount() const { return maxSubstepCount_; }
+    float GetRestitution() const { return restitution_; }
+    float GetFriction() const { return friction_; }
+    const Vector4& GetColor() const { return color_; }
+    std::uint32_t GetCount() const { return static_cast<std::uint32_t>(positions_[0].size()); }
+    // 並びはステップごとに変わる
+    Vector3 GetPosition(std::uint32_t i) const { return { positions_[0][i], positions_[1][i], positions_[2][i] }; }
+    Vector3 GetVelocity(std::uint32_t i) const { return { velocities_[0][i], velocities_[1][i], velocities_[2][i] }; }
+    // 直前のステップの値
+    float GetDensity(std::uint32_t i) const { return densities_[i]; }
+
+private:
+    // 同じセルの粒子の範囲
+    struct Cell {
+        std::uint32_t begin;
+        std::uint32_t end;
+    };
+    // タスクごとの作業領域。近傍の候補を詰め直した成分ごとの配列
+    struct Scratch {
+        std::vector<float> values[8];
+    };
+
+    // 粒子をセル順に並べ替え、セルの範囲を作る
+    void BuildGrid();
+    // セルの近傍の候補をscratchに詰め、候補の数を返す。stream数だけ詰める
+    std::uint32_t GatherNeighbors(const Cell& cell, Scratch& scratch, std::uint32_t streamCount) const;
+    void ComputeDensity(std::uint32_t task);
+    void ComputeAcceleration(std::uint32_t task);
+    void Integrate(std::uint32_t chunk, float timeStep, const CollisionWorld* collisionWorld);
+    // 静止した格子で密度がrestDensityになる質量
+    void UpdateMass();
+    std::uint32_t GetBucket(std::int32_t x, std::int32_t y, std::int32_t z) const;
+
+    std::vector<float> positions_[3];
+    std::vector<float> velocities_[3];
+    std::vector<float> densities_;
+    std::vector<float> pressures_;
+    std::vector<float> accelerations_[3];
+
+    // 空間ハッシュ。セル順に並べ替えた先と、バケットごとの先頭
+    std::vector<float> sortedPositions_[3];
+    std::vector<float> sortedVelocities_[3];
+    std::vector<std::int32_t> cellCoordinates_[3];
+    std::vector<std::int32_t> sortedCellCoordinates_[3];
+    std::vector<std::uint32_t> particleBuckets_;
+    std::vector<std::uint32_t> bucketStarts_;
+    std::vector<Cell> cells_;
+    std::vector<Scratch> scratches_;
+
+    Vector3 gravity_;
+    Vector4 color_;
+    float spacing_;
+    float restDensity_;
+    float stiffness_;
+    float viscosity_;
+    float timeStep_;
+    std::uint32_t maxSubstepCount_;
+    float restitution_;
+    float friction_;
+    float accumulator_;
+    // 0なら次のステップで求め直す
+    float mass_;
+};
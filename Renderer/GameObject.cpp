@@ -2,7 +2,8 @@
 
 #include "Externals/ImGui/imgui.h"
 
-GameObject::GameObject() :
+GameObject::GameObject(Scene* const scene) :
+    scene_(scene),
     parent_(nullptr),
     transform(this),
     isActive_(true) {
@@ -10,6 +10,8 @@
 #include "Behavior.hpp"
 #include "Transform.hpp"
 
+class Scene;
+
 class GameObject : 
     public Object {
 private:
@@ -17,7 +19,7 @@ private:
     using ComponentType = std::conditional<std::is_base_of<Behavior, T>::value, Behavior, Component>::type;
 
 public:
-    GameObject();
+    GameObject(Scene* const scene);
 
     template<class T>
     T* AddComponent() {
@@ -49,6 +51,8 @@ public:
     void SetParent(GameObject* parent);
 
     bool IsActive() const { return isActive_; }
+    Scene* GetScene() { return scene_; }
+    const Scene* GetScene() const { return scene_; }
     const std::string& GetTag() const { return tag_; }
     Transform* GetTransform() { return &transform; }
     const Transform* GetTransform() const { return &transform; }
@@ -76,6 +80,7 @@ private:
     }
 
     std::string tag_;
+    Scene* scene_;
     GameObject* parent_;
     std::vector<GameObject*> children_;
     std::vector<std::unique_ptr<Component>> components_;
@@ -0,0 +1,225 @@
+#include "HeightfieldCollider.hpp"
+
+#include <cassert>
+
+#include "Externals/ImGui/imgui.h"
+
+#include "Transform.hpp"
+
+void HeightfieldCollider::SetHeights(const std::vector<float>& heights, std::uint32_t width, std::uint32_t depth) {
+    assert(width >= 2 && depth >= 2 && heights.size() == static_cast<size_t>(width) * depth);
+    auto shape = std::make_shared<Shape>();
+    auto [minIter, maxIter] = std::minmax_element(heights.begin(), heights.end());
+    shape->minHeight = *minIter;
+    shape->heightScale = (*maxIter - *minIter) / 65535.0f;
+    float invScale = shape->heightScale > 0.0f ? 1.0f / shape->heightScale : 0.0f;
+
+    shape->width = width;
+    shape->depth = depth;
+    shape->cellSize = shape_->cellSize;
+    shape->heights.resize(heights.size());
+    for (size_t i = 0; i < heights.size(); ++i) {
+        shape->heights[i] = static_cast<std::uint16_t>(std::lround((heights[i] - shape->minHeight) * invScale));
+    }
+    shape_ = std::move(shape);
+    MarkShapeChanged();
+}
+
+void HeightfieldCollider::SetCellSize(const Vector2& cellSize) {
+    auto shape = std::make_shared<Shape>(*shape_);
+    shape->cellSize = cellSize;
+    shape_ = std::move(shape);
+    MarkShapeChanged();
+}
+
+Vector3 HeightfieldCollider::FindFurthestPoint(const Vector3& direction) const {
+    Vector3 localDirection = ToLocalDirection(direction);
+    AABB bounds = shape_->GetLocalBounds();
+    return ToWorldPoint({
+        localDirection.x >= 0.0f ? bounds.max.x : bounds.min.x,
+        localDirection.y >= 0.0f ? bounds.max.y : bounds.min.y,
+        localDirection.z >= 0.0f ? bounds.max.z : bounds.min.z });
+}
+
+bool HeightfieldCollider::Raycast(const Vector3& origin, const Vector3& direction, float maxDistance, RaycastHit& hit) const {
+    if (!shape_->Raycast(GetTransform().GetWorldMatrix(), origin, direction, maxDistance, hit)) {
+        return false;
+    }
+    hit.collider = const_cast<HeightfieldCollider*>(this);
+    return true;
+}
+
+void HeightfieldCollider::ShowUI() {
+    if (ImGui::TreeNodeEx("HeightfieldCollider", ImGuiTreeNodeFlags_DefaultOpen | ImGuiTreeNodeFlags_SpanAvailWidth)) {
+        ImGui::Unindent();
+        Collider::ShowUI();
+        ImGui::Text("Size %u x %u", shape_->width, shape_->depth);
+        Vector2 cellSize = shape_->cellSize;
+        if (ImGui::DragFloat2("CellSize", &cellSize.x, 0.1f, 0.01f, Math::positiveInfinity)) {
+            SetCellSize(cellSize);
+        }
+        ImGui::TreePop();
+    }
+}
+
+void HeightfieldCollider::CollectTriangles(const AABB& bounds, std::vector<Triangle>& triangles) const {
+    if (shape_->heights.empty()) {
+        return;
+    }
+    // ワールドの境界をローカルに持ってくる
+    Matrix4x4 inverseWorld = GetTransform().GetWorldMatrix().Inverse();
+    AABB localBounds;
+    for (std::uint32_t i = 0; i < 8; ++i) {
+        Vector3 corner{
+            (i & 1) ? bounds.max.x : bounds.min.x,
+            (i & 2) ? bounds.max.y : bounds.min.y,
+            (i & 4) ? bounds.max.z : bounds.min.z };
+        localBounds.Include(corner * inverseWorld);
+    }
+    if (!shape_->GetLocalBounds().Intersects(localBounds)) {
+        return;
+    }
+
+    Vector3 gridOrigin = shape_->GetLocalVertex(0, 0);
+    auto toCell = [](float value, float origin, float size, std::uint32_t count) {
+        float cell = std::floor((value - origin) / size);
+        return static_cast<std::uint32_t>(std::clamp(cell, 0.0f, static_cast<float>(count - 2)));
+    };
+    std::uint32_t minX = toCell(localBounds.min.x, gridOrigin.x, shape_->cellSize.x, shape_->width);
+    std::uint32_t maxX = toCell(localBounds.max.x, gridOrigin.x, shape_->cellSize.x, shape_->width);
+    std::uint32_t minZ = toCell(localBounds.min.z, gridOrigin.z, shape_->cellSize.y, shape_->depth);
+    std::uint32_t maxZ = toCell(localBounds.max.z, gridOrigin.z, shape_->cellSize.y, shape_->depth);
+
+    for (std::uint32_t z = minZ; z <= maxZ; ++z) {
+        for (std::uint32_t x = minX; x <= maxX; ++x) {
+            float cellMin, cellMax;
+            shape_->GetCellHeightRange(x, z, cellMin, cellMax);
+            if (cellMax < localBounds.min.y || cellMin > localBounds.max.y) {
+                continue;
+            }
+            Triangle cell[2];
+            shape_->GetCellTriangles(x, z, cell);
+            for (auto& triangle : cell) {
+                for (auto& vertex : triangle.vertices) {
+                    vertex = ToWorldPoint(vertex);
+                }
+                triangles.emplace_back(triangle);
+            }
+        }
+    }
+}
+
+Vector3 HeightfieldCollider::Shape::GetLocalVertex(std::uint32_t x, std::uint32_t z) const {
+    return {
+        (static_cast<float>(x) - static_cast<float>(width - 1) * 0.5f) * cellSize.x,
+        GetHeight(x, z),
+        (static_cast<float>(z) - static_cast<float>(depth - 1) * 0.5f) * cellSize.y };
+}
+
+AABB HeightfieldCollider::Shape::GetLocalBounds() const {
+    Vector3 halfSize{
+        static_cast<float>(width - 1) * 0.5f * cellSize.x,
+        0.0f,
+        static_cast<float>(depth - 1) * 0.5f * cellSize.y };
+    return AABB(
+        { -halfSize.x, minHeight, -halfSize.z },
+        { halfSize.x, minHeight + 65535.0f * heightScale, halfSize.z });
+}
+
+void HeightfieldCollider::Shape::GetCellTriangles(std::uint32_t x, std::uint32_t z, Triangle (&triangles)[2]) const {
+    Vector3 v00 = GetLocalVertex(x, z);
+    Vector3 v10 = GetLocalVertex(x + 1, z);
+    Vector3 v01 = GetLocalVertex(x, z + 1);
+    Vector3 v11 = GetLocalVertex(x + 1, z + 1);
+    triangles[0] = { { v00, v01, v10 } };
+    triangles[1] = { { v10, v01, v11 } };
+}
+
+void HeightfieldCollider::Shape::GetCellHeightRange(std::uint32_t x, std::uint32_t z, float& cellMinHeight, float& cellMaxHeight) const {
+    std::uint16_t h00 = heights[z * width + x];
+    std::uint16_t h10 = heights[z * width + x + 1];
+    std::uint16_t h01 = heights[(z + 1) * width + x];
+    std::uint16_t h11 = heights[(z + 1) * width + x + 1];
+    cellMinHeight = minHeight + static_cast<float>(std::min({ h00, h10, h01, h11 })) * heightScale;
+    cellMaxHeight = minHeight + static_cast<float>(std::max({ h00, h10, h01, h11 })) * heightScale;
+}
+
+bool HeightfieldCollider::Shape::Raycast(const Matrix4x4& worldMatrix, const Vector3& origin, const Vector3& direction, float maxDistance, RaycastHit& hit) const {
+    if (heights.empty()) {
+        return false;
+    }
+    // ローカル空間で辿る。線形変換なのでtはワールドと共通
+    Matrix4x4 inverseWorld = worldMatrix.Inverse();
+    Vector3 localOrigin = origin * inverseWorld;
+    Vector3 localDirection = inverseWorld.ApplyRotation(direction);
+
+    float tEnter = 0.0f, tExit = maxDistance;
+    if (!GetLocalBounds().IntersectsRay(localOrigin, localDirection, tEnter, tExit)) {
+        return false;
+    }
+
+    // 2D DDA (Amanatides & Woo)
+    Vector3 start = localOrigin + localDirection * tEnter;
+    Vector3 gridOrigin = GetLocalVertex(0, 0);
+    float cellX = (start.x - gridOrigin.x) / cellSize.x;
+    float cellZ = (start.z - gridOrigin.z) / cellSize.y;
+    std::int32_t x = std::clamp(static_cast<std::int32_t>(std::floor(cellX)), 0, static_cast<std::int32_t>(width) - 2);
+    std::int32_t z = std::clamp(static_cast<std::int32_t>(std::floor(cellZ)), 0, static_cast<std::int32_t>(depth) - 2);
+
+    std::int32_t stepX = localDirection.x >= 0.0f ? 1 : -1;
+    std::int32_t stepZ = localDirection.z >= 0.0f ? 1 : -1;
+    float tDeltaX = localDirection.x != 0.0f ? cellSize.x / std::abs(localDirection.x) : Math::positiveInfinity;
+    float tDeltaZ = localDirection.z != 0.0f ? cellSize.y / std::abs(localDirection.z) : Math::positiveInfinity;
+    float tMaxX = localDirection.x != 0.0f ?
+        tEnter + ((static_cast<float>(x + (stepX > 0 ? 1 : 0)) - cellX) * cellSize.x) / localDirection.x :
+        Math::positiveInfinity;
+    float tMaxZ = localDirection.z != 0.0f ?
+        tEnter + ((static_cast<float>(z + (stepZ > 0 ? 1 : 0)) - cellZ) * cellSize.y) / localDirection.z :
+        Math::positiveInfinity;
+
+    while (true) {
+        Triangle triangles[2];
+        GetCellTriangles(static_cast<std::uint32_t>(x), static_cast<std::uint32_t>(z), triangles);
+        float closest = Math::positiveInfinity;
+        const Triangle* closestTriangle = nullptr;
+        for (const auto& triangle : triangles) {
+            float t;
+            if (RaycastTriangle(localOrigin, localDirection, triangle.vertices[0], triangle.vertices[1], triangle.vertices[2], t) && t < closest) {
+                closest = t;
+                closestTriangle = &triangle;
+            }
+        }
+        // セルは t の順に辿るので最初に見つかったものが最も近い
+        if (closestTriangle && closest <= maxDistance) {
+            Vector3 localNormal = closestTriangle->Normal();
+            // 法線は逆転置で変換する
+            Vector3 normal{
+                Vector3::Dot(inverseWorld.GetXAxis(), localNormal),
+                Vector3::Dot(inverseWorld.GetYAxis(), localNormal),
+                Vector3::Dot(inverseWorld.GetZAxis(), localNormal) };
+            normal = normal.Normalized();
+            if (Vector3::Dot(normal, direction) > 0.0f) {
+                normal = -normal;
+            }
+            hit.point = origin + direction * closest;
+            hit.normal = normal;
+            hit.distance = closest;
+            return true;
+        }
+
+        if (tMaxX < tMaxZ) {
+            if (tMaxX > tExit) { break; }
+            x += stepX;
+            tMaxX += tDeltaX;
+        }
+        else {
+            if (tMaxZ > tExit) { break; }
+            z += stepZ;
+            tMaxZ += tDeltaZ;
+        }
+        if (x < 0 || z < 0 || x >= static_cast<std::int32_t>(width) - 1 || z >= static_cast<std::int32_t>(depth) - 1) {
+            break;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include "Collider.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "Collision/Triangle.hpp"
+
+// XZ平面上の格子に16bitで量子化した高さを持つ地形
+// ローカル原点を格子の中心とする
+class HeightfieldCollider :
+    public Collider {
+public:
+    // 作った後は書き換えず、変えるときは差し替える。写しが持っている間は変わらない
+    struct Shape {
+        std::vector<std::uint16_t> heights;
+        std::uint32_t width = 0;
+        std::uint32_t depth = 0;
+        Vector2 cellSize = Vector2::one;
+        float minHeight = 0.0f;
+        float heightScale = 0.0f;
+
+        float GetHeight(std::uint32_t x, std::uint32_t z) const { return minHeight + static_cast<float>(heights[z * width + x]) * heightScale; }
+        Vector3 GetLocalVertex(std::uint32_t x, std::uint32_t z) const;
+        AABB GetLocalBounds() const;
+        // セル(x, z)の2枚の三角形（ローカル）
+        void GetCellTriangles(std::uint32_t x, std::uint32_t z, Triangle (&triangles)[2]) const;
+        // セルの高さ範囲
+        void GetCellHeightRange(std::uint32_t x, std::uint32_t z, float& cellMinHeight, float& cellMaxHeight) const;
+        // worldMatrixに置いたときのレイキャスト。格子をDDAで辿る。hit.colliderは設定しない
+        bool Raycast(const Matrix4x4& worldMatrix, const Vector3& origin, const Vector3& direction, float maxDistance, RaycastHit& hit) const;
+    };
+
+    HeightfieldCollider(GameObject* const gameObject) :
+        Collider(gameObject, Type::kHeightfield),
+        shape_(std::make_shared<Shape>()) {
+    }
+
+    // heightsはX優先でwidth*depth個
+    void SetHeights(const std::vector<float>& heights, std::uint32_t width, std::uint32_t depth);
+    void SetCellSize(const Vector2& cellSize);
+
+    // 境界箱のサポート点（非凸なのでGJKには直接使わない）
+    Vector3 FindFurthestPoint(const Vector3& direction) const override;
+    // 格子をDDAで辿る
+    bool Raycast(const Vector3& origin, const Vector3& direction, float maxDistance, RaycastHit& hit) const override;
+    void ShowUI() override;
+
+    // ワールド空間のboundsの下にあるセルの三角形をワールド座標で追加する
+    void CollectTriangles(const AABB& bounds, std::vector<Triangle>& triangles) const;
+
+    float GetHeight(std::uint32_t x, std::uint32_t z) const { return shape_->GetHeight(x, z); }
+    std::uint32_t GetWidth() const { return shape_->width; }
+    std::uint32_t GetDepth() const { return shape_->depth; }
+    const Vector2& GetCellSize() const { return shape_->cellSize; }
+    const std::shared_ptr<const Shape>& GetShape() const { return shape_; }
+
+private:
+    std::shared_ptr<const Shape> shape_;
+};
@@ -0,0 +1,67 @@
+#include "Joint.hpp"
+
+#include "Externals/ImGui/imgui.h"
+
+#include "GameObject.hpp"
+#include "Rigidbody.hpp"
+#include "Scene.hpp"
+
+namespace {
+    const char* kTypeNames[] = { "Ball", "Hinge", "Slider", "Fixed" };
+}
+
+Joint::Joint(GameObject* const gameObject) :
+    Component(gameObject),
+    world_(nullptr),
+    index_(0),
+    connectedBody_(nullptr),
+    anchor_(Vector3::zero),
+    axis_(Vector3::unitX),
+    connectedAnchor_(Vector3::zero),
+    connectedAxis_(Vector3::unitX),
+    relativeRotation_(Quaternion::identity),
+    type_(Type::kBall),
+    isConnected_(false) {
+    Scene* scene = gameObject->GetScene();
+    if (scene) {
+        scene->GetPhysicsWorld().Register(this);
+    }
+}
+
+Joint::~Joint() {
+    if (world_) {
+        world_->Unregister(this);
+    }
+}
+
+void Joint::Connect(Rigidbody* connectedBody) {
+    const Transform& transformA = GetTransform();
+    Vector3 anchor = transformA.translate + transformA.rotate * anchor_;
+    Vector3 axis = transformA.rotate * axis_.Normalized();
+    Quaternion rotationB = Quaternion::identity;
+    Vector3 positionB = Vector3::zero;
+    if (connectedBody) {
+        rotationB = connectedBody->GetTransform().rotate;
+        positionB = connectedBody->GetTransform().translate;
+    }
+    Quaternion inverseB = rotationB.Conjugate();
+    connectedBody_ = connectedBody;
+    connectedAnchor_ = inverseB * (anchor - positionB);
+    connectedAxis_ = inverseB * axis;
+    relativeRotation_ = transformA.rotate.Conjugate() * rotationB;
+    isConnected_ = true;
+}
+
+void Joint::ShowUI() {
+    if (ImGui::TreeNodeEx("Joint", ImGuiTreeNodeFlags_DefaultOpen | ImGuiTreeNodeFlags_SpanAvailWidth)) {
+        ImGui::Unindent();
+        int type = static_cast<int>(type_);
+        if (ImGui::Combo("Type", &type, kTypeNames, IM_ARRAYSIZE(kTypeNames))) {
+            type_ = static_cast<Type>(type);
+        }
+        ImGui::DragFloat3("Anchor", &anchor_.x, 0.1f);
+        ImGui::DragFloat3("Axis", &axis_.x, 0.1f);
+        ImGui::TextUnformatted(isConnected_ ? (connectedBody_ ? "Connected" : "Connected to world") : "Not connected");
+        ImGui::TreePop();
+    }
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include "Component.hpp"
+
+#include <cstdint>
+
+#include "Math/MathUtils.hpp"
+
+class PhysicsWorld;
+class Rigidbody;
+
+// 2つの剛体、または剛体とワールドをつなぐ関節
+// 同じGameObjectのRigidbodyをA、つなぐ相手をBとする。Connectするまでは何もしない
+class Joint :
+    public Component {
+public:
+    enum class Type {
+        kBall,      // アンカーを一致させる
+        kHinge,     // 加えて、軸の周りにだけ回る
+        kSlider,    // 向きを固定し、軸に沿ってだけ動く
+        kFixed      // アンカーと向きを固定する
+    };
+
+    Joint(GameObject* const gameObject);
+    ~Joint();
+
+    // 今の姿勢でつなぐ。nullptrならワールドにつなぐ
+    // Bのアンカーと軸、AとBの相対的な向きはこの時点の姿勢から決める
+    void Connect(Rigidbody* connectedBody);
+    void Disconnect() { isConnected_ = false; }
+    void ShowUI() override;
+
+    void SetType(Type type) { type_ = type; }
+    // Aのローカル空間（拡縮は掛けない）。Connectの前に決める
+    void SetAnchor(const Vector3& anchor) { anchor_ = anchor; }
+    void SetAxis(const Vector3& axis) { axis_ = axis; }
+
+    Type GetType() const { return type_; }
+    Rigidbody* GetConnectedBody() const { return connectedBody_; }
+    const Vector3& GetAnchor() const { return anchor_; }
+    const Vector3& GetAxis() const { return axis_; }
+    // Bのローカル空間。ワールドにつないだならワールド空間
+    const Vector3& GetConnectedAnchor() const { return connectedAnchor_; }
+    const Vector3& GetConnectedAxis() const { return connectedAxis_; }
+    // Aから見たBの向き
+    const Quaternion& GetRelativeRotation() const { return relativeRotation_; }
+    bool IsConnected() const { return isConnected_; }
+
+private:
+    PhysicsWorld* world_;
+    std::uint32_t index_;
+    Rigidbody* connectedBody_;
+    Vector3 anchor_;
+    Vector3 axis_;
+    Vector3 connectedAnchor_;
+    Vector3 connectedAxis_;
+    Quaternion relativeRotation_;
+    Type type_;
+    bool isConnected_;
+
+    friend class PhysicsWorld;
+};
@@ -11,7 +11,7 @@ namespace Math {
     constexpr float ToRadian = Pi / 180.0f;
     constexpr float ToDegree = 180.0f / Pi;
     constexpr float positiveInfinity = std::numeric_limits<float>::max();
-    constexpr float negativeInfinity = std::numeric_limits<float>::min();
+    constexpr float negativeInfinity = std::numeric_limits<float>::lowest();
 
     inline constexpr float Lerp(float t, float start, float end) {
         return start + t * (end - start);
@@ -308,7 +308,7 @@ public:
                 lhs.x * rhs.y - lhs.y * rhs.x };
     }
     static inline constexpr Vector3 Scale(const Vector3& lhs, const Vector3& rhs) noexcept {
-        return { lhs.x * rhs.x , lhs.y + rhs.y, lhs.z * rhs.z };
+        return { lhs.x * rhs.x, lhs.y * rhs.y, lhs.z * rhs.z };
     }
     static inline constexpr Vector3 Project(const Vector3& base, const Vector3& direction) noexcept {
         return Dot(base, direction) * direction;
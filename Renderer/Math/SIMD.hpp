@@ -0,0 +1,158 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+#include <emmintrin.h>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#endif
+
+// 1要素と4要素、8要素で同じ式を書くための演算
+// 比較の結果はfloatではbool、Float4とFloat8では全ビットが立ったマスク
+namespace SIMD {
+
+    inline float Min(float lhs, float rhs) { return std::min(lhs, rhs); }
+    inline float Max(float lhs, float rhs) { return std::max(lhs, rhs); }
+    inline float Sqrt(float value) { return std::sqrt(value); }
+    inline float Abs(float value) { return std::abs(value); }
+    inline float Clamp(float value, float min, float max) { return std::clamp(value, min, max); }
+    inline float Select(bool mask, float trueValue, float falseValue) { return mask ? trueValue : falseValue; }
+    inline bool And(bool lhs, bool rhs) { return lhs && rhs; }
+    inline bool Or(bool lhs, bool rhs) { return lhs || rhs; }
+    inline bool Not(bool mask) { return !mask; }
+    template<class F>
+    F Load(const float* p);
+    template<>
+    inline float Load<float>(const float* p) { return *p; }
+    inline void Store(float* p, float value) { *p = value; }
+
+    // SSEの4要素（x64では常に使える）
+    class Float4 {
+    public:
+        static constexpr std::size_t kWidth = 4;
+
+        Float4() = default;
+        Float4(__m128 v) : v(v) {}
+        explicit Float4(float value) : v(_mm_set1_ps(value)) {}
+
+        friend Float4 operator-(const Float4& rhs) { return _mm_xor_ps(rhs.v, _mm_set1_ps(-0.0f)); }
+        friend Float4 operator+(const Float4& lhs, const Float4& rhs) { return _mm_add_ps(lhs.v, rhs.v); }
+        friend Float4 operator-(const Float4& lhs, const Float4& rhs) { return _mm_sub_ps(lhs.v, rhs.v); }
+        friend Float4 operator*(const Float4& lhs, const Float4& rhs) { return _mm_mul_ps(lhs.v, rhs.v); }
+        friend Float4 operator/(const Float4& lhs, const Float4& rhs) { return _mm_div_ps(lhs.v, rhs.v); }
+        friend Float4 operator<(const Float4& lhs, const Float4& rhs) { return _mm_cmplt_ps(lhs.v, rhs.v); }
+        friend Float4 operator<=(const Float4& lhs, const Float4& rhs) { return _mm_cmple_ps(lhs.v, rhs.v); }
+        friend Float4 operator>(const Float4& lhs, const Float4& rhs) { return _mm_cmpgt_ps(lhs.v, rhs.v); }
+        friend Float4 operator>=(const Float4& lhs, const Float4& rhs) { return _mm_cmpge_ps(lhs.v, rhs.v); }
+        friend Float4 operator==(const Float4& lhs, const Float4& rhs) { return _mm_cmpeq_ps(lhs.v, rhs.v); }
+
+        __m128 v;
+    };
+
+    inline Float4 Min(const Float4& lhs, const Float4& rhs) { return _mm_min_ps(lhs.v, rhs.v); }
+    inline Float4 Max(const Float4& lhs, const Float4& rhs) { return _mm_max_ps(lhs.v, rhs.v); }
+    inline Float4 Sqrt(const Float4& value) { return _mm_sqrt_ps(value.v); }
+    inline Float4 Abs(const Float4& value) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), value.v); }
+    inline Float4 Clamp(const Float4& value, const Float4& min, const Float4& max) { return Min(Max(value, min), max); }
+    // SSE2にblendvは無いのでビット演算で選ぶ
+    inline Float4 Select(const Float4& mask, const Float4& trueValue, const Float4& falseValue) { return _mm_or_ps(_mm_and_ps(mask.v, trueValue.v), _mm_andnot_ps(mask.v, falseValue.v)); }
+    inline Float4 And(const Float4& lhs, const Float4& rhs) { return _mm_and_ps(lhs.v, rhs.v); }
+    inline Float4 Or(const Float4& lhs, const Float4& rhs) { return _mm_or_ps(lhs.v, rhs.v); }
+    inline Float4 Not(const Float4& mask) { return _mm_xor_ps(mask.v, _mm_castsi128_ps(_mm_set1_epi32(-1))); }
+    inline int MoveMask(const Float4& mask) { return _mm_movemask_ps(mask.v); }
+    template<>
+    inline Float4 Load<Float4>(const float* p) { return _mm_loadu_ps(p); }
+    inline void Store(float* p, const Float4& value) { _mm_storeu_ps(p, value.v); }
+
+#if defined(__AVX__)
+    // AVXの8要素
+    class Float8 {
+    public:
+        static constexpr std::size_t kWidth = 8;
+
+        Float8() = default;
+        Float8(__m256 v) : v(v) {}
+        explicit Float8(float value) : v(_mm256_set1_ps(value)) {}
+
+        friend Float8 operator-(const Float8& rhs) { return _mm256_xor_ps(rhs.v, _mm256_set1_ps(-0.0f)); }
+        friend Float8 operator+(const Float8& lhs, const Float8& rhs) { return _mm256_add_ps(lhs.v, rhs.v); }
+        friend Float8 operator-(const Float8& lhs, const Float8& rhs) { return _mm256_sub_ps(lhs.v, rhs.v); }
+        friend Float8 operator*(const Float8& lhs, const Float8& rhs) { return _mm256_mul_ps(lhs.v, rhs.v); }
+        friend Float8 operator/(const Float8& lhs, const Float8& rhs) { return _mm256_div_ps(lhs.v, rhs.v); }
+        friend Float8 operator<(const Float8& lhs, const Float8& rhs) { return _mm256_cmp_ps(lhs.v, rhs.v, _CMP_LT_OQ); }
+        friend Float8 operator<=(const Float8& lhs, const Float8& rhs) { return _mm256_cmp_ps(lhs.v, rhs.v, _CMP_LE_OQ); }
+        friend Float8 operator>(const Float8& lhs, const Float8& rhs) { return _mm256_cmp_ps(lhs.v, rhs.v, _CMP_GT_OQ); }
+        friend Float8 operator>=(const Float8& lhs, const Float8& rhs) { return _mm256_cmp_ps(lhs.v, rhs.v, _CMP_GE_OQ); }
+        friend Float8 operator==(const Float8& lhs, const Float8& rhs) { return _mm256_cmp_ps(lhs.v, rhs.v, _CMP_EQ_OQ); }
+
+        __m256 v;
+    };
+
+    inline Float8 Min(const Float8& lhs, const Float8& rhs) { return _mm256_min_ps(lhs.v, rhs.v); }
+    inline Float8 Max(const Float8& lhs, const Float8& rhs) { return _mm256_max_ps(lhs.v, rhs.v); }
+    inline Float8 Sqrt(const Float8& value) { return _mm256_sqrt_ps(value.v); }
+    inline Float8 Abs(const Float8& value) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), value.v); }
+    inline Float8 Clamp(const Float8& value, const Float8& min, const Float8& max) { return Min(Max(value, min), max); }
+    inline Float8 Select(const Float8& mask, const Float8& trueValue, const Float8& falseValue) { return _mm256_blendv_ps(falseValue.v, trueValue.v, mask.v); }
+    inline Float8 And(const Float8& lhs, const Float8& rhs) { return _mm256_and_ps(lhs.v, rhs.v); }
+    inline Float8 Or(const Float8& lhs, const Float8& rhs) { return _mm256_or_ps(lhs.v, rhs.v); }
+    inline Float8 Not(const Float8& mask) { return _mm256_xor_ps(mask.v, _mm256_castsi256_ps(_mm256_set1_epi32(-1))); }
+    // 各要素のマスクの最上位ビット
+    inline int MoveMask(const Float8& mask) { return _mm256_movemask_ps(mask.v); }
+    template<>
+    inline Float8 Load<Float8>(const float* p) { return _mm256_loadu_ps(p); }
+    inline void Store(float* p, const Float8& value) { _mm256_storeu_ps(p, value.v); }
+#endif
+
+    // 全要素をまとめる。1要素ではそのまま
+    inline float ReduceAdd(float value) { return value; }
+    inline float ReduceMin(float value) { return value; }
+    inline float ReduceMax(float value) { return value; }
+    inline bool Any(bool mask) { return mask; }
+    template<class F>
+    float ReduceAdd(const F& value) {
+        float values[F::kWidth];
+        Store(values, value);
+        float sum = 0.0f;
+        for (float element : values) { sum += element; }
+        return sum;
+    }
+    template<class F>
+    float ReduceMin(const F& value) {
+        float values[F::kWidth];
+        Store(values, value);
+        return *std::min_element(values, values + F::kWidth);
+    }
+    template<class F>
+    float ReduceMax(const F& value) {
+        float values[F::kWidth];
+        Store(values, value);
+        return *std::max_element(values, values + F::kWidth);
+    }
+    // どれかの要素のマスクが立っているか
+    template<class F>
+    bool Any(const F& mask) { return MoveMask(mask) != 0; }
+
+    // 要素の型を揃えた3次元ベクトル
+    template<class F>
+    struct Vector3T {
+        F x, y, z;
+
+        friend Vector3T operator+(const Vector3T& lhs, const Vector3T& rhs) { return { lhs.x + rhs.x, lhs.y + rhs.y, lhs.z + rhs.z }; }
+        friend Vector3T operator-(const Vector3T& lhs, const Vector3T& rhs) { return { lhs.x - rhs.x, lhs.y - rhs.y, lhs.z - rhs.z }; }
+        friend Vector3T operator*(const Vector3T& lhs, const F& rhs) { return { lhs.x * rhs, lhs.y * rhs, lhs.z * rhs }; }
+        friend F Dot(const Vector3T& lhs, const Vector3T& rhs) { return lhs.x * rhs.x + lhs.y * rhs.y + lhs.z * rhs.z; }
+        friend Vector3T Cross(const Vector3T& lhs, const Vector3T& rhs) {
+            return { lhs.y * rhs.z - lhs.z * rhs.y, lhs.z * rhs.x - lhs.x * rhs.z, lhs.x * rhs.y - lhs.y * rhs.x };
+        }
+    };
+
+    template<class F>
+    Vector3T<F> Select(const decltype(F() < F())& mask, const Vector3T<F>& trueValue, const Vector3T<F>& falseValue) {
+        return { Select(mask, trueValue.x, falseValue.x), Select(mask, trueValue.y, falseValue.y), Select(mask, trueValue.z, falseValue.z) };
+    }
+
+}
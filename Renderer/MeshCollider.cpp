@@ -0,0 +1,122 @@
+#include "MeshCollider.hpp"
+
+#include <cassert>
+
+#include "Externals/ImGui/imgui.h"
+
+#include "Transform.hpp"
+
+void MeshCollider::SetMesh(const std::vector<Vector3>& vertices, const std::vector<std::uint32_t>& indices) {
+    assert(indices.size() % 3 == 0);
+    auto shape = std::make_shared<Shape>();
+    shape->vertices = vertices;
+    auto& triangles = shape->triangles;
+    triangles.resize(indices.size() / 3);
+    std::vector<AABB> bounds(triangles.size());
+    for (size_t i = 0; i < triangles.size(); ++i) {
+        Triangle& triangle = triangles[i];
+        for (size_t j = 0; j < 3; ++j) {
+            triangle.vertices[j] = vertices[indices[i * 3 + j]];
+        }
+        bounds[i] = AABB(triangle.vertices[0], triangle.vertices[1], triangle.vertices[2]);
+    }
+    // 動かしても形は変わらないので探索の速いSAHで作る
+    shape->bvh.Build(bounds, BVH::SplitMethod::kSAH);
+    shape_ = std::move(shape);
+    MarkShapeChanged();
+}
+
+Vector3 MeshCollider::FindFurthestPoint(const Vector3& direction) const {
+    if (shape_->bvh.IsEmpty()) {
+        return GetTransform().GetWorldPosition();
+    }
+    Vector3 localDirection = ToLocalDirection(direction);
+    const Vector3* furthest = &shape_->vertices[0];
+    float maxDot = Vector3::Dot(*furthest, localDirection);
+    for (const auto& vertex : shape_->vertices) {
+        float dot = Vector3::Dot(vertex, localDirection);
+        if (dot > maxDot) {
+            maxDot = dot;
+            furthest = &vertex;
+        }
+    }
+    return ToWorldPoint(*furthest);
+}
+
+void MeshCollider::UpdateAABB() {
+    if (shape_->bvh.IsEmpty()) {
+        aabb_ = AABB(GetTransform().GetWorldPosition());
+        return;
+    }
+    aabb_ = shape_->bvh.GetBounds().Transformed(GetTransform().GetWorldMatrix());
+}
+
+bool MeshCollider::Raycast(const Vector3& origin, const Vector3& direction, float maxDistance, RaycastHit& hit) const {
+    if (!shape_->Raycast(GetTransform().GetWorldMatrix(), origin, direction, maxDistance, hit)) {
+        return false;
+    }
+    hit.collider = const_cast<MeshCollider*>(this);
+    return true;
+}
+
+void MeshCollider::ShowUI() {
+    if (ImGui::TreeNodeEx("MeshCollider", ImGuiTreeNodeFlags_DefaultOpen | ImGuiTreeNodeFlags_SpanAvailWidth)) {
+        ImGui::Unindent();
+        Collider::ShowUI();
+        ImGui::Text("Triangles %u", static_cast<std::uint32_t>(shape_->triangles.size()));
+        ImGui::TreePop();
+    }
+}
+
+void MeshCollider::CollectTriangles(const AABB& bounds, std::vector<Triangle>& triangles) const {
+    if (shape_->bvh.IsEmpty()) {
+        return;
+    }
+    const Matrix4x4& world = GetTransform().GetWorldMatrix();
+    AABB localBounds = bounds.Transformed(world.Inverse());
+    shape_->bvh.Query(localBounds, [&](std::uint32_t index) {
+        Triangle triangle = shape_->triangles[index];
+        for (auto& vertex : triangle.vertices) {
+            vertex = vertex * world;
+        }
+        triangles.emplace_back(triangle);
+        });
+}
+
+bool MeshCollider::Shape::Raycast(const Matrix4x4& worldMatrix, const Vector3& origin, const Vector3& direction, float maxDistance, RaycastHit& hit) const {
+    if (bvh.IsEmpty()) {
+        return false;
+    }
+    // ローカル空間で辿る。線形変換なのでtはワールドと共通
+    Matrix4x4 inverseWorld = worldMatrix.Inverse();
+    Vector3 localOrigin = origin * inverseWorld;
+    Vector3 localDirection = inverseWorld.ApplyRotation(direction);
+
+    float closest = maxDistance;
+    const Triangle* closestTriangle = nullptr;
+    bvh.Raycast(localOrigin, localDirection, maxDistance, [&](std::uint32_t index) {
+        const Triangle& triangle = triangles[index];
+        float t;
+        if (RaycastTriangle(localOrigin, localDirection, triangle.vertices[0], triangle.vertices[1], triangle.vertices[2], t) && t <= closest) {
+            closest = t;
+            closestTriangle = &triangle;
+        }
+        });
+    if (!closestTriangle) {
+        return false;
+    }
+    Vector3 localNormal = closestTriangle->Normal();
+    // 法線は逆転置で変換する
+    Vector3 normal{
+        Vector3::Dot(inverseWorld.GetXAxis(), localNormal),
+        Vector3::Dot(inverseWorld.GetYAxis(), localNormal),
+        Vector3::Dot(inverseWorld.GetZAxis(), localNormal) };
+    normal = normal.Normalized();
+    if (Vector3::Dot(normal, direction) > 0.0f) {
+        normal = -normal;
+    }
+    hit.point = origin + direction * closest;
+    hit.normal = normal;
+    hit.distance = closest;
+    return true;
+}
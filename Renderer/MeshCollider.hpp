@@ -0,0 +1,51 @@
+#pragma once
+#include "Collider.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "Collision/BVH.hpp"
+#include "Collision/Triangle.hpp"
+
+// 三角形メッシュ。ローカル空間の三角形にSAHで木を作っておく
+// 凹形状同士はMeshMeshで木を同時に辿る
+class MeshCollider :
+    public Collider {
+public:
+    // 作った後は書き換えず、SetMeshで差し替える。写しが持っている間は変わらない
+    struct Shape {
+        // ローカル空間の頂点。境界ボリュームとサポート点に使う
+        std::vector<Vector3> vertices;
+        std::vector<Triangle> triangles;
+        BVH bvh;
+
+        // worldMatrixに置いたときのレイキャスト。hit.colliderは設定しない
+        bool Raycast(const Matrix4x4& worldMatrix, const Vector3& origin, const Vector3& direction, float maxDistance, RaycastHit& hit) const;
+    };
+
+    MeshCollider(GameObject* const gameObject) :
+        Collider(gameObject, Type::kMesh),
+        shape_(std::make_shared<Shape>()) {
+    }
+
+    // indicesは3つずつで1枚
+    void SetMesh(const std::vector<Vector3>& vertices, const std::vector<std::uint32_t>& indices);
+
+    // 頂点のうちdirectionに最も遠いもの。凸包のサポート点になる（非凸なのでGJKには直接使わない）
+    Vector3 FindFurthestPoint(const Vector3& direction) const override;
+    void UpdateAABB() override;
+    const std::vector<Vector3>* GetLocalVertices() const override { return &shape_->vertices; }
+    bool Raycast(const Vector3& origin, const Vector3& direction, float maxDistance, RaycastHit& hit) const override;
+    void ShowUI() override;
+
+    // ワールド空間のboundsと交差する三角形をワールド座標で追加する
+    void CollectTriangles(const AABB& bounds, std::vector<Triangle>& triangles) const;
+
+    const std::vector<Triangle>& GetTriangles() const { return shape_->triangles; }
+    const BVH& GetBVH() const { return shape_->bvh; }
+    const std::shared_ptr<const Shape>& GetShape() const { return shape_; }
+
+private:
+    std::shared_ptr<const Shape> shape_;
+};
@@ -0,0 +1,104 @@
+#include "NavMesh.hpp"
+
+#include <algorithm>
+
+namespace {
+    // 上から見た三角形の符号付き面積の2倍。反時計回りで正
+    float TriangleArea2D(const Vector3& a, const Vector3& b, const Vector3& c) {
+        return (b.x - a.x) * (c.z - a.z) - (b.z - a.z) * (c.x - a.x);
+    }
+
+    // 上から見た線分abでpointに最も近い点の位置
+    float ClosestParameter2D(const Vector3& a, const Vector3& b, const Vector3& point) {
+        float dx = b.x - a.x;
+        float dz = b.z - a.z;
+        float lengthSquare = dx * dx + dz * dz;
+        if (lengthSquare <= 0.0f) {
+            return 0.0f;
+        }
+        return std::clamp(((point.x - a.x) * dx + (point.z - a.z) * dz) / lengthSquare, 0.0f, 1.0f);
+    }
+}
+
+void NavMesh::Clear() {
+    polygons_.clear();
+    vertices_.clear();
+    links_.clear();
+    clusters_.clear();
+    clusterLinks_.clear();
+    bvh_.Clear();
+}
+
+std::uint32_t NavMesh::FindNearestPolygon(const Vector3& point, const Vector3& extents, Vector3& nearest) const {
+    std::uint32_t result = kInvalidIndex;
+    float minDistance = Math::positiveInfinity;
+    bvh_.Query(AABB(point - extents, point + extents), [&](std::uint32_t polygon) {
+        Vector3 closest = ClosestPointOnPolygon(polygon, point);
+        float distance = (closest - point).LengthSquare();
+        if (distance < minDistance) {
+            minDistance = distance;
+            nearest = closest;
+            result = polygon;
+        }
+        });
+    return result;
+}
+
+Vector3 NavMesh::ClosestPointOnPolygon(std::uint32_t polygon, const Vector3& point) const {
+    const Polygon& poly = polygons_[polygon];
+    const Vector3* vertices = vertices_.data() + poly.firstVertex;
+    // 上から見て内側なら、扇に分けた三角形の上で高さを補間する
+    bool isInside = true;
+    for (std::uint32_t i = 0; i < poly.vertexCount; ++i) {
+        if (TriangleArea2D(vertices[i], vertices[(i + 1) % poly.vertexCount], point) < 0.0f) {
+            isInside = false;
+            break;
+        }
+    }
+    if (isInside) {
+        for (std::uint32_t i = 1; i + 1 < poly.vertexCount; ++i) {
+            const Vector3& a = vertices[0];
+            const Vector3& b = vertices[i];
+            const Vector3& c = vertices[i + 1];
+            float area = TriangleArea2D(a, b, c);
+            float u = TriangleArea2D(point, b, c);
+            float v = TriangleArea2D(a, point, c);
+            float w = TriangleArea2D(a, b, point);
+            if (area > 0.0f && u >= 0.0f && v >= 0.0f && w >= 0.0f) {
+                float y = (a.y * u + b.y * v + c.y * w) / area;
+                return Vector3(point.x, y, point.z);
+            }
+        }
+    }
+    // 外側なら縁の最も近い点
+    Vector3 closest = vertices[0];
+    float minDistance = Math::positiveInfinity;
+    for (std::uint32_t i = 0; i < poly.vertexCount; ++i) {
+        const Vector3& a = vertices[i];
+        const Vector3& b = vertices[(i + 1) % poly.vertexCount];
+        Vector3 candidate = Vector3::Lerp(ClosestParameter2D(a, b, point), a, b);
+        float distance = (candidate - point).LengthSquare();
+        if (distance < minDistance) {
+            minDistance = distance;
+            closest = candidate;
+        }
+    }
+    return closest;
+}
+
+void NavMesh::Finalize() {
+    std::vector<AABB> bounds(polygons_.size());
+    for (size_t i = 0; i < polygons_.size(); ++i) {
+        Polygon& polygon = polygons_[i];
+        polygon.bounds = AABB();
+        polygon.center = Vector3::zero;
+        for (std::uint32_t j = 0; j < polygon.vertexCount; ++j) {
+            const Vector3& vertex = vertices_[polygon.firstVertex + j];
+            polygon.bounds.Include(vertex);
+            polygon.center += vertex;
+        }
+        polygon.center /= static_cast<float>(polygon.vertexCount);
+        bounds[i] = polygon.bounds;
+    }
+    bvh_.Build(bounds, BVH::SplitMethod::kSAH);
+}
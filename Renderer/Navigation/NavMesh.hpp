@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "../Math/MathUtils.hpp"
+#include "../AABB.hpp"
+#include "../Collision/BVH.hpp"
+
+class NavMeshBuilder;
+
+// 歩ける面を凸多角形に分けたナビゲーションメッシュ
+// 多角形は隣と出口（ポータル）でつながり、さらに近くの多角形をまとめたクラスタの粗いグラフを持つ
+// 作るのはNavMeshBuilder、経路を探すのはNavMeshQuery
+class NavMesh {
+public:
+    static constexpr std::uint32_t kInvalidIndex = ~0u;
+
+    // 隣の多角形への出口。left, rightはこの多角形から隣を見たときの左右の端
+    struct Link {
+        std::uint32_t polygon;
+        Vector3 left;
+        Vector3 right;
+    };
+    struct Polygon {
+        std::uint32_t firstVertex;
+        std::uint32_t vertexCount;
+        std::uint32_t firstLink;
+        std::uint32_t linkCount;
+        std::uint32_t cluster;
+        Vector3 center;
+        AABB bounds;
+    };
+    struct ClusterLink {
+        std::uint32_t cluster;
+        float cost;         // 中心同士を出口経由で結んだ長さ
+    };
+    struct Cluster {
+        std::uint32_t firstLink;
+        std::uint32_t linkCount;
+        Vector3 center;     // 中心に最も近い多角形の中心
+    };
+
+    void Clear();
+
+    // pointを中心にextentsの範囲で最も近い多角形を探し、多角形上の最も近い点をnearestに書く
+    // 見つからなければkInvalidIndex
+    std::uint32_t FindNearestPolygon(const Vector3& point, const Vector3& extents, Vector3& nearest) const;
+    // 多角形上でpointに最も近い点
+    Vector3 ClosestPointOnPolygon(std::uint32_t polygon, const Vector3& point) const;
+
+    bool IsEmpty() const { return polygons_.empty(); }
+    std::uint32_t GetPolygonCount() const { return static_cast<std::uint32_t>(polygons_.size()); }
+    std::uint32_t GetClusterCount() const { return static_cast<std::uint32_t>(clusters_.size()); }
+    const std::vector<Polygon>& GetPolygons() const { return polygons_; }
+    const std::vector<Vector3>& GetVertices() const { return vertices_; }
+    const std::vector<Link>& GetLinks() const { return links_; }
+    const std::vector<Cluster>& GetClusters() const { return clusters_; }
+    const std::vector<ClusterLink>& GetClusterLinks() const { return clusterLinks_; }
+
+private:
+    friend class NavMeshBuilder;
+
+    // 多角形の頂点と範囲、クラスタをもとに出口以外の情報を作る
+    void Finalize();
+
+    std::vector<Polygon> polygons_;
+    std::vector<Vector3> vertices_;     // 多角形ごとに上から見て反時計回り
+    std::vector<Link> links_;
+    std::vector<Cluster> clusters_;
+    std::vector<ClusterLink> clusterLinks_;
+    BVH bvh_;
+};
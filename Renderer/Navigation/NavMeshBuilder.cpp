@@ -0,0 +1,690 @@
+#include "NavMeshBuilder.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "../Collider.hpp"
+#include "../Collision/CollisionWorld.hpp"
+#include "../Collision/ConvexHull.hpp"
+
+namespace {
+    // 凸な形を近似するときにサポート写像を引く方向の数（軸と対角線を除く）
+    constexpr std::uint32_t kHullDirectionCount = 48;
+    constexpr std::uint32_t kInvalidIndex = ~0u;
+    constexpr std::uint16_t kMaxSpanHeight = 0xFFFF;
+    // 上面の高さの差がこのセル数以下の区間は、歩けるかどうかを足し合わせる
+    constexpr std::int32_t kSpanMergeThreshold = 1;
+    // これより少ない多角形のクラスタは隣に混ぜる
+    constexpr size_t kMinClusterPolygons = 4;
+
+    // 隣のセルの向き。-x, +z, +x, -zの順
+    constexpr std::int32_t kDirectionX[4] = { -1, 0, 1, 0 };
+    constexpr std::int32_t kDirectionZ[4] = { 0, 1, 0, -1 };
+
+    // 柱の中の固体の区間。下から順に連結リストでつなぐ
+    struct Span {
+        std::uint16_t min;
+        std::uint16_t max;
+        std::uint32_t next;
+        bool isWalkable;
+    };
+
+    // 床のセル。区間の上面から上の隙間
+    struct Cell {
+        std::uint16_t y;
+        std::uint16_t height;
+        std::uint32_t neighbors[4];
+        std::uint32_t region;
+        std::uint32_t polygon;
+    };
+
+    struct Column {
+        std::uint32_t firstCell;
+        std::uint32_t cellCount;
+    };
+
+    struct Grid {
+        Vector3 origin;
+        std::int32_t width;
+        std::int32_t depth;
+        float cellSize;
+        float cellHeight;
+        std::vector<std::uint32_t> firstSpans;    // 柱ごとのリストの先頭
+        std::vector<Span> spans;
+        std::vector<Column> columns;
+        std::vector<Cell> cells;
+        std::vector<std::int32_t> cellX;
+        std::vector<std::int32_t> cellZ;
+    };
+
+    // 上から見た三角形の符号付き面積の2倍。反時計回りで正
+    float TriangleArea2D(const Vector3& a, const Vector3& b, const Vector3& c) {
+        return (b.x - a.x) * (c.z - a.z) - (b.z - a.z) * (c.x - a.x);
+    }
+
+    const std::vector<Vector3>& GetHullDirections() {
+        static const std::vector<Vector3> directions = [] {
+            std::vector<Vector3> result;
+            for (std::int32_t axis = 0; axis < 3; ++axis) {
+                Vector3 direction = Vector3::zero;
+                direction[axis] = 1.0f;
+                result.emplace_back(direction);
+                result.emplace_back(-direction);
+            }
+            for (std::int32_t i = 0; i < 8; ++i) {
+                result.emplace_back(Vector3((i & 1) ? 1.0f : -1.0f, (i & 2) ? 1.0f : -1.0f, (i & 4) ? 1.0f : -1.0f).Normalized());
+            }
+            // 球面上のフィボナッチ格子
+            const float kGoldenAngle = Math::Pi * (3.0f - std::sqrt(5.0f));
+            for (std::uint32_t i = 0; i < kHullDirectionCount; ++i) {
+                float y = 1.0f - 2.0f * (static_cast<float>(i) + 0.5f) / static_cast<float>(kHullDirectionCount);
+                float radius = std::sqrt(1.0f - y * y);
+                float angle = kGoldenAngle * static_cast<float>(i);
+                result.emplace_back(std::cos(angle) * radius, y, std::sin(angle) * radius);
+            }
+            return result;
+            }();
+        return directions;
+    }
+
+    // 区間を柱に加え、重なる区間とは1つにまとめる
+    void AddSpan(Grid& grid, std::int32_t x, std::int32_t z, std::uint16_t min, std::uint16_t max, bool isWalkable) {
+        std::uint32_t& first = grid.firstSpans[static_cast<size_t>(z) * grid.width + x];
+        Span span{ min, max, kInvalidIndex, isWalkable };
+        std::uint32_t previous = kInvalidIndex;
+        std::uint32_t current = first;
+        while (current != kInvalidIndex) {
+            const Span& other = grid.spans[current];
+            if (other.min > span.max) {
+                break;
+            }
+            if (other.max < span.min) {
+                previous = current;
+                current = other.next;
+                continue;
+            }
+            // 上面が近ければどちらかが歩ければよい。離れていれば高い方に従う
+            if (std::abs(static_cast<std::int32_t>(other.max) - static_cast<std::int32_t>(span.max)) <= kSpanMergeThreshold) {
+                span.isWalkable = span.isWalkable || other.isWalkable;
+            }
+            else if (other.max > span.max) {
+                span.isWalkable = other.isWalkable;
+            }
+            span.min = std::min(span.min, other.min);
+            span.max = std::max(span.max, other.max);
+            // 取り除いた区間はリストから外すだけで、配列には残す
+            current = other.next;
+        }
+        span.next = current;
+        std::uint32_t index = static_cast<std::uint32_t>(grid.spans.size());
+        grid.spans.emplace_back(span);
+        if (previous != kInvalidIndex) {
+            grid.spans[previous].next = index;
+        }
+        else {
+            first = index;
+        }
+    }
+
+    // 多角形をaxis軸のoffsetの位置で分ける。belowは小さい側、aboveは大きい側
+    void DividePolygon(const Vector3* in, std::uint32_t inCount, Vector3* below, std::uint32_t& belowCount, Vector3* above, std::uint32_t& aboveCount, float offset, std::int32_t axis) {
+        float distances[12];
+        for (std::uint32_t i = 0; i < inCount; ++i) {
+            distances[i] = offset - in[i][axis];
+        }
+        belowCount = 0;
+        aboveCount = 0;
+        for (std::uint32_t i = 0, j = inCount - 1; i < inCount; j = i, ++i) {
+            bool isBelowJ = distances[j] >= 0.0f;
+            bool isBelowI = distances[i] >= 0.0f;
+            if (isBelowJ != isBelowI) {
+                float t = distances[j] / (distances[j] - distances[i]);
+                Vector3 point = Vector3::Lerp(t, in[j], in[i]);
+                below[belowCount++] = point;
+                above[aboveCount++] = point;
+                if (distances[i] > 0.0f) {
+                    below[belowCount++] = in[i];
+                }
+                else if (distances[i] < 0.0f) {
+                    above[aboveCount++] = in[i];
+                }
+                continue;
+            }
+            if (distances[i] >= 0.0f) {
+                below[belowCount++] = in[i];
+                if (distances[i] != 0.0f) {
+                    continue;
+                }
+            }
+            above[aboveCount++] = in[i];
+        }
+    }
+
+    // 三角形をセルの柱で切り、切れ端の高さの範囲を区間にする
+    void RasterizeTriangle(Grid& grid, const Triangle& triangle, bool isWalkable) {
+        AABB bounds(triangle.vertices[0], triangle.vertices[1], triangle.vertices[2]);
+        float invCellSize = 1.0f / grid.cellSize;
+        float invCellHeight = 1.0f / grid.cellHeight;
+        std::int32_t z0 = static_cast<std::int32_t>(std::floor((bounds.min.z - grid.origin.z) * invCellSize));
+        std::int32_t z1 = static_cast<std::int32_t>(std::floor((bounds.max.z - grid.origin.z) * invCellSize));
+        z0 = std::clamp(z0, 0, grid.depth - 1);
+        z1 = std::clamp(z1, 0, grid.depth - 1);
+
+        Vector3 buffers[4][12];
+        Vector3* in = buffers[0];
+        Vector3* rest = buffers[1];
+        Vector3* row = buffers[2];
+        Vector3* column = buffers[3];
+        std::uint32_t inCount = 3, restCount = 0, rowCount = 0, columnCount = 0;
+        std::copy(std::begin(triangle.vertices), std::end(triangle.vertices), in);
+        for (std::int32_t z = z0; z <= z1; ++z) {
+            float rowZ = grid.origin.z + static_cast<float>(z + 1) * grid.cellSize;
+            DividePolygon(in, inCount, row, rowCount, rest, restCount, rowZ, 2);
+            std::swap(in, rest);
+            inCount = restCount;
+            if (rowCount < 3) {
+                continue;
+            }
+            float minX = row[0].x, maxX = row[0].x;
+            for (std::uint32_t i = 1; i < rowCount; ++i) {
+                minX = std::min(minX, row[i].x);
+                maxX = std::max(maxX, row[i].x);
+            }
+            std::int32_t x0 = std::clamp(static_cast<std::int32_t>(std::floor((minX - grid.origin.x) * invCellSize)), 0, grid.width - 1);
+            std::int32_t x1 = std::clamp(static_cast<std::int32_t>(std::floor((maxX - grid.origin.x) * invCellSize)), 0, grid.width - 1);
+            for (std::int32_t x = x0; x <= x1; ++x) {
+                float columnX = grid.origin.x + static_cast<float>(x + 1) * grid.cellSize;
+                DividePolygon(row, rowCount, column, columnCount, rest, restCount, columnX, 0);
+                std::swap(row, rest);
+                rowCount = restCount;
+                if (columnCount < 3) {
+                    continue;
+                }
+                float minY = column[0].y, maxY = column[0].y;
+                for (std::uint32_t i = 1; i < columnCount; ++i) {
+                    minY = std::min(minY, column[i].y);
+                    maxY = std::max(maxY, column[i].y);
+                }
+                minY = (minY - grid.origin.y) * invCellHeight;
+                maxY = (maxY - grid.origin.y) * invCellHeight;
+                if (maxY < 0.0f || minY >= static_cast<float>(kMaxSpanHeight)) {
+                    continue;
+                }
+                std::uint16_t spanMin = static_cast<std::uint16_t>(std::clamp(std::floor(minY), 0.0f, static_cast<float>(kMaxSpanHeight - 1)));
+                std::uint16_t spanMax = static_cast<std::uint16_t>(std::clamp(std::ceil(maxY), static_cast<float>(spanMin + 1), static_cast<float>(kMaxSpanHeight)));
+                AddSpan(grid, x, z, spanMin, spanMax, isWalkable);
+            }
+        }
+    }
+
+    std::int32_t ToCells(float length, float cellLength) {
+        return static_cast<std::int32_t>(std::ceil(length / cellLength - 1.0e-4f));
+    }
+}
+
+NavMeshBuilder::NavMeshBuilder() :
+    NavMeshBuilder(Settings{}) {
+}
+
+NavMeshBuilder::NavMeshBuilder(const Settings& settings) :
+    settings_(settings) {
+}
+
+void NavMeshBuilder::AddTriangles(const std::vector<Vector3>& vertices, const std::vector<std::uint32_t>& indices, const Matrix4x4& world) {
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        triangles_.push_back({ { vertices[indices[i]] * world, vertices[indices[i + 1]] * world, vertices[indices[i + 2]] * world } });
+    }
+}
+
+void NavMeshBuilder::AddTriangles(const std::vector<Vector3>& vertices, const std::vector<std::uint16_t>& indices, const Matrix4x4& world) {
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        triangles_.push_back({ { vertices[indices[i]] * world, vertices[indices[i + 1]] * world, vertices[indices[i + 2]] * world } });
+    }
+}
+
+void NavMeshBuilder::AddStaticColliders(const CollisionWorld& world, const AABB& bounds) {
+    colliders_.clear();
+    world.Query(bounds, colliders_);
+    for (const Collider* collider : colliders_) {
+        if (!collider->IsStatic() || collider->IsTrigger()) {
+            continue;
+        }
+        // 距離場は境界箱の凸包になってしまうので、呼び出し側が元のメッシュを加える
+        if (collider->GetType() == Collider::Type::kDistanceField) {
+            continue;
+        }
+        parts_.clear();
+        scratch_.triangles.clear();
+        Narrowphase::CollectParts(*collider, bounds, scratch_, parts_);
+        for (const auto& part : parts_) {
+            Collider::Type type = part.collider->GetType();
+            if (type == Collider::Type::kMesh || type == Collider::Type::kHeightfield) {
+                triangles_.emplace_back(scratch_.triangles[part.index]);
+            }
+            else {
+                AddConvexPart(part);
+            }
+        }
+    }
+}
+
+void NavMeshBuilder::Clear() {
+    triangles_.clear();
+}
+
+void NavMeshBuilder::AddConvexPart(const Narrowphase::ConvexPart& part) {
+    hullPoints_.clear();
+    for (const auto& direction : GetHullDirections()) {
+        hullPoints_.emplace_back(Narrowphase::FindPartFurthestPoint(part, scratch_.triangles, direction));
+    }
+    ConvexHull hull;
+    hull.Build(hullPoints_, static_cast<std::uint32_t>(hullPoints_.size()));
+    const auto& vertices = hull.GetVertices();
+    const auto& indices = hull.GetIndices();
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        triangles_.push_back({ { vertices[indices[i]], vertices[indices[i + 1]], vertices[indices[i + 2]] } });
+    }
+}
+
+void NavMeshBuilder::Build(NavMesh& navMesh) const {
+    navMesh.Clear();
+    if (triangles_.empty()) {
+        return;
+    }
+
+    AABB bounds;
+    for (const auto& triangle : triangles_) {
+        for (const auto& vertex : triangle.vertices) {
+            bounds.Include(vertex);
+        }
+    }
+    Grid grid;
+    grid.cellSize = settings_.cellSize;
+    grid.cellHeight = settings_.cellHeight;
+    grid.origin = bounds.min;
+    grid.width = std::max(ToCells(bounds.max.x - bounds.min.x, grid.cellSize), 1);
+    grid.depth = std::max(ToCells(bounds.max.z - bounds.min.z, grid.cellSize), 1);
+    const std::int32_t agentHeight = ToCells(settings_.agentHeight, grid.cellHeight);
+    const std::int32_t maxClimb = static_cast<std::int32_t>(std::floor(settings_.agentMaxClimb / grid.cellHeight));
+    const std::int32_t agentRadius = ToCells(settings_.agentRadius, grid.cellSize);
+    const std::int32_t maxPolygonSize = static_cast<std::int32_t>(std::max(settings_.maxPolygonSize, 1u));
+    const std::int32_t clusterSize = static_cast<std::int32_t>(std::max(settings_.clusterSize, 1u));
+
+    // 三角形を柱の区間に焼く。法線の向きは問わない
+    grid.firstSpans.assign(static_cast<size_t>(grid.width) * grid.depth, kInvalidIndex);
+    grid.spans.reserve(triangles_.size() * 4);
+    const float minNormalY = std::cos(settings_.agentMaxSlope * Math::ToRadian);
+    for (const auto& triangle : triangles_) {
+        Vector3 normal = Vector3::Cross(triangle.vertices[1] - triangle.vertices[0], triangle.vertices[2] - triangle.vertices[0]);
+        float length = normal.Length();
+        if (length <= 0.0f) {
+            continue;
+        }
+        RasterizeTriangle(grid, triangle, std::abs(normal.y) >= minNormalY * length);
+    }
+
+    // 低い出っ張りは下の床から登れれば歩けるものとし、頭がつかえる上面は歩けないものとする
+    for (std::uint32_t first : grid.firstSpans) {
+        bool isPreviousWalkable = false;
+        std::int32_t previousMax = 0;
+        for (std::uint32_t i = first; i != kInvalidIndex; i = grid.spans[i].next) {
+            Span& span = grid.spans[i];
+            bool isWalkable = span.isWalkable;
+            if (!span.isWalkable && isPreviousWalkable && static_cast<std::int32_t>(span.max) - previousMax <= maxClimb) {
+                span.isWalkable = true;
+            }
+            isPreviousWalkable = isWalkable;
+            previousMax = span.max;
+        }
+        for (std::uint32_t i = first; i != kInvalidIndex; i = grid.spans[i].next) {
+            Span& span = grid.spans[i];
+            std::int32_t top = span.next != kInvalidIndex ? grid.spans[span.next].min : kMaxSpanHeight;
+            if (top - static_cast<std::int32_t>(span.max) < agentHeight) {
+                span.isWalkable = false;
+            }
+        }
+    }
+
+    // 歩ける上面を床のセルにする
+    grid.columns.resize(grid.firstSpans.size());
+    for (std::int32_t z = 0; z < grid.depth; ++z) {
+        for (std::int32_t x = 0; x < grid.width; ++x) {
+            size_t columnIndex = static_cast<size_t>(z) * grid.width + x;
+            Column& column = grid.columns[columnIndex];
+            column.firstCell = static_cast<std::uint32_t>(grid.cells.size());
+            for (std::uint32_t i = grid.firstSpans[columnIndex]; i != kInvalidIndex; i = grid.spans[i].next) {
+                const Span& span = grid.spans[i];
+                if (!span.isWalkable) {
+                    continue;
+                }
+                std::uint16_t top = span.next != kInvalidIndex ? grid.spans[span.next].min : kMaxSpanHeight;
+                Cell& cell = grid.cells.emplace_back();
+                cell.y = span.max;
+                cell.height = static_cast<std::uint16_t>(top - span.max);
+                std::fill(std::begin(cell.neighbors), std::end(cell.neighbors), kInvalidIndex);
+                cell.region = kInvalidIndex;
+                cell.polygon = kInvalidIndex;
+                grid.cellX.emplace_back(x);
+                grid.cellZ.emplace_back(z);
+            }
+            column.cellCount = static_cast<std::uint32_t>(grid.cells.size()) - column.firstCell;
+        }
+    }
+    std::vector<Cell>& cells = grid.cells;
+    const std::uint32_t cellCount = static_cast<std::uint32_t>(cells.size());
+
+    // 段差を登れて、間を通れるだけの隙間がある隣とつなぐ
+    for (std::uint32_t i = 0; i < cellCount; ++i) {
+        Cell& cell = cells[i];
+        for (std::int32_t direction = 0; direction < 4; ++direction) {
+            std::int32_t x = grid.cellX[i] + kDirectionX[direction];
+            std::int32_t z = grid.cellZ[i] + kDirectionZ[direction];
+            if (x < 0 || z < 0 || x >= grid.width || z >= grid.depth) {
+                continue;
+            }
+            const Column& column = grid.columns[static_cast<size_t>(z) * grid.width + x];
+            for (std::uint32_t j = column.firstCell; j < column.firstCell + column.cellCount; ++j) {
+                const Cell& neighbor = cells[j];
+                std::int32_t bottom = std::max(cell.y, neighbor.y);
+                std::int32_t top = std::min(cell.y + cell.height, neighbor.y + neighbor.height);
+                if (top - bottom >= agentHeight && std::abs(static_cast<std::int32_t>(neighbor.y) - static_cast<std::int32_t>(cell.y)) <= maxClimb) {
+                    cell.neighbors[direction] = j;
+                    break;
+                }
+            }
+        }
+    }
+
+    // 縁からの距離を2パスの面取り距離（縦横2、斜め3）で求め、エージェントの半径より近いセルを削る
+    std::vector<bool> isRemoved(cellCount, false);
+    auto unlinkRemoved = [&]() {
+        for (auto& cell : cells) {
+            for (auto& neighbor : cell.neighbors) {
+                if (neighbor != kInvalidIndex && isRemoved[neighbor]) {
+                    neighbor = kInvalidIndex;
+                }
+            }
+        }
+        };
+    if (agentRadius > 0) {
+        std::vector<std::uint16_t> distances(cellCount);
+        for (std::uint32_t i = 0; i < cellCount; ++i) {
+            bool isBorder = std::any_of(std::begin(cells[i].neighbors), std::end(cells[i].neighbors), [](std::uint32_t neighbor) { return neighbor == kInvalidIndex; });
+            distances[i] = isBorder ? 0 : 0xFFFF;
+        }
+        auto relax = [&](std::uint32_t i, std::int32_t straight, std::int32_t diagonal) {
+            std::uint32_t neighbor = cells[i].neighbors[straight];
+            if (neighbor == kInvalidIndex) {
+                return;
+            }
+            distances[i] = std::min<std::uint16_t>(distances[i], static_cast<std::uint16_t>(std::min(distances[neighbor] + 2, 0xFFFF)));
+            std::uint32_t corner = cells[neighbor].neighbors[diagonal];
+            if (corner != kInvalidIndex) {
+                distances[i] = std::min<std::uint16_t>(distances[i], static_cast<std::uint16_t>(std::min(distances[corner] + 3, 0xFFFF)));
+            }
+            };
+        for (std::uint32_t i = 0; i < cellCount; ++i) {
+            relax(i, 0, 3);
+            relax(i, 3, 2);
+        }
+        for (std::uint32_t i = cellCount; i-- > 0;) {
+            relax(i, 2, 1);
+            relax(i, 1, 0);
+        }
+        for (std::uint32_t i = 0; i < cellCount; ++i) {
+            isRemoved[i] = distances[i] < agentRadius * 2;
+        }
+        unlinkRemoved();
+    }
+
+    // つながったセルを領域に分け、小さな島は捨てる
+    std::uint32_t regionCount = 0;
+    std::vector<std::uint32_t> stack;
+    std::vector<std::uint32_t> members;
+    for (std::uint32_t seed = 0; seed < cellCount; ++seed) {
+        if (isRemoved[seed] || cells[seed].region != kInvalidIndex) {
+            continue;
+        }
+        members.clear();
+        stack.assign(1, seed);
+        cells[seed].region = regionCount;
+        while (!stack.empty()) {
+            std::uint32_t i = stack.back();
+            stack.pop_back();
+            members.emplace_back(i);
+            for (std::uint32_t neighbor : cells[i].neighbors) {
+                if (neighbor != kInvalidIndex && cells[neighbor].region == kInvalidIndex) {
+                    cells[neighbor].region = regionCount;
+                    stack.emplace_back(neighbor);
+                }
+            }
+        }
+        if (members.size() < settings_.minRegionArea) {
+            for (std::uint32_t i : members) {
+                isRemoved[i] = true;
+            }
+            continue;
+        }
+        ++regionCount;
+    }
+    unlinkRemoved();
+
+    // 領域ごとにセルを+x、+zへ広げた長方形にまとめる。高さが離れすぎるセルは入れない
+    struct Rectangle {
+        std::int32_t x;
+        std::int32_t z;
+        std::int32_t width;
+        std::int32_t depth;
+        std::uint32_t firstCell;    // rectangleCellsの中の位置。行ごとに並ぶ
+    };
+    std::vector<Rectangle> rectangles;
+    std::vector<std::uint32_t> rectangleCells;
+    rectangleCells.reserve(cellCount);
+    auto canJoin = [&](std::uint32_t i, const Cell& seed) {
+        return i != kInvalidIndex && !isRemoved[i] && cells[i].polygon == kInvalidIndex && cells[i].region == seed.region &&
+            std::abs(static_cast<std::int32_t>(cells[i].y) - static_cast<std::int32_t>(seed.y)) <= maxClimb;
+        };
+    for (std::uint32_t seed = 0; seed < cellCount; ++seed) {
+        if (isRemoved[seed] || cells[seed].polygon != kInvalidIndex) {
+            continue;
+        }
+        const Cell& seedCell = cells[seed];
+        std::uint32_t polygon = static_cast<std::uint32_t>(rectangles.size());
+        Rectangle rectangle{ grid.cellX[seed], grid.cellZ[seed], 1, 1, static_cast<std::uint32_t>(rectangleCells.size()) };
+        rectangleCells.emplace_back(seed);
+        cells[seed].polygon = polygon;
+        for (std::uint32_t i = seed; rectangle.width < maxPolygonSize;) {
+            std::uint32_t next = cells[i].neighbors[2];
+            if (!canJoin(next, seedCell)) {
+                break;
+            }
+            rectangleCells.emplace_back(next);
+            cells[next].polygon = polygon;
+            i = next;
+            ++rectangle.width;
+        }
+        while (rectangle.depth < maxPolygonSize) {
+            // 前の行の全てのセルの+z側が、横にもつながって並んでいれば1行伸ばす
+            size_t previousRow = rectangleCells.size() - rectangle.width;
+            bool canExtend = true;
+            for (std::int32_t i = 0; i < rectangle.width && canExtend; ++i) {
+                std::uint32_t next = cells[rectangleCells[previousRow + i]].neighbors[1];
+                canExtend = canJoin(next, seedCell) &&
+                    (i == 0 || cells[rectangleCells[rectangleCells.size() - 1]].neighbors[2] == next);
+                if (canExtend) {
+                    rectangleCells.emplace_back(next);
+                }
+            }
+            if (!canExtend) {
+                rectangleCells.resize(previousRow + rectangle.width);
+                break;
+            }
+            for (size_t i = previousRow + rectangle.width; i < rectangleCells.size(); ++i) {
+                cells[rectangleCells[i]].polygon = polygon;
+            }
+            ++rectangle.depth;
+        }
+        rectangles.emplace_back(rectangle);
+    }
+
+    // 長方形の4隅を頂点にする。高さは隅のセルの上面
+    auto cellTop = [&](std::uint32_t i) { return grid.origin.y + static_cast<float>(cells[i].y) * grid.cellHeight; };
+    auto cornerX = [&](std::int32_t x) { return grid.origin.x + static_cast<float>(x) * grid.cellSize; };
+    auto cornerZ = [&](std::int32_t z) { return grid.origin.z + static_cast<float>(z) * grid.cellSize; };
+    navMesh.polygons_.resize(rectangles.size());
+    navMesh.vertices_.reserve(rectangles.size() * 4);
+    for (size_t p = 0; p < rectangles.size(); ++p) {
+        const Rectangle& rectangle = rectangles[p];
+        const std::uint32_t* rectCells = rectangleCells.data() + rectangle.firstCell;
+        std::uint32_t lastRow = static_cast<std::uint32_t>((rectangle.depth - 1) * rectangle.width);
+        NavMesh::Polygon& polygon = navMesh.polygons_[p];
+        polygon.firstVertex = static_cast<std::uint32_t>(navMesh.vertices_.size());
+        polygon.vertexCount = 4;
+        polygon.cluster = kInvalidIndex;
+        float x0 = cornerX(rectangle.x), x1 = cornerX(rectangle.x + rectangle.width);
+        float z0 = cornerZ(rectangle.z), z1 = cornerZ(rectangle.z + rectangle.depth);
+        navMesh.vertices_.emplace_back(x0, cellTop(rectCells[0]), z0);
+        navMesh.vertices_.emplace_back(x1, cellTop(rectCells[rectangle.width - 1]), z0);
+        navMesh.vertices_.emplace_back(x1, cellTop(rectCells[lastRow + rectangle.width - 1]), z1);
+        navMesh.vertices_.emplace_back(x0, cellTop(rectCells[lastRow]), z1);
+    }
+    navMesh.Finalize();
+
+    // 各辺のセルの外側を見て、同じ多角形が続く範囲を出口にする
+    for (size_t p = 0; p < rectangles.size(); ++p) {
+        const Rectangle& rectangle = rectangles[p];
+        const std::uint32_t* rectCells = rectangleCells.data() + rectangle.firstCell;
+        NavMesh::Polygon& polygon = navMesh.polygons_[p];
+        polygon.firstLink = static_cast<std::uint32_t>(navMesh.links_.size());
+        for (std::int32_t direction = 0; direction < 4; ++direction) {
+            bool isAlongX = direction == 1 || direction == 3;
+            std::int32_t edgeLength = isAlongX ? rectangle.width : rectangle.depth;
+            auto edgeCell = [&](std::int32_t i) -> std::uint32_t {
+                switch (direction) {
+                case 0: return rectCells[i * rectangle.width];
+                case 1: return rectCells[(rectangle.depth - 1) * rectangle.width + i];
+                case 2: return rectCells[i * rectangle.width + rectangle.width - 1];
+                default: return rectCells[i];
+                }
+                };
+            auto neighborPolygon = [&](std::int32_t i) {
+                std::uint32_t neighbor = cells[edgeCell(i)].neighbors[direction];
+                return neighbor != kInvalidIndex ? cells[neighbor].polygon : kInvalidIndex;
+                };
+            // 辺の上の点。高さは両側のセルの上面の平均
+            auto edgePoint = [&](std::int32_t i, float along) {
+                std::uint32_t cell = edgeCell(i);
+                float y = (cellTop(cell) + cellTop(cells[cell].neighbors[direction])) * 0.5f;
+                float x = direction == 0 ? cornerX(rectangle.x) : direction == 2 ? cornerX(rectangle.x + rectangle.width) : along;
+                float z = direction == 3 ? cornerZ(rectangle.z) : direction == 1 ? cornerZ(rectangle.z + rectangle.depth) : along;
+                return Vector3(x, y, z);
+                };
+            for (std::int32_t begin = 0; begin < edgeLength;) {
+                std::uint32_t neighbor = neighborPolygon(begin);
+                std::int32_t end = begin + 1;
+                while (end < edgeLength && neighborPolygon(end) == neighbor) {
+                    ++end;
+                }
+                if (neighbor != kInvalidIndex) {
+                    float alongBegin = isAlongX ? cornerX(rectangle.x + begin) : cornerZ(rectangle.z + begin);
+                    float alongEnd = isAlongX ? cornerX(rectangle.x + end) : cornerZ(rectangle.z + end);
+                    Vector3 a = edgePoint(begin, alongBegin);
+                    Vector3 b = edgePoint(end - 1, alongEnd);
+                    // 中心から見て右から左へ反時計回りになる順に置く
+                    if (TriangleArea2D(polygon.center, a, b) > 0.0f) {
+                        navMesh.links_.push_back({ neighbor, b, a });
+                    }
+                    else {
+                        navMesh.links_.push_back({ neighbor, a, b });
+                    }
+                }
+                begin = end;
+            }
+        }
+        polygon.linkCount = static_cast<std::uint32_t>(navMesh.links_.size()) - polygon.firstLink;
+    }
+
+    // 多角形から幅優先でつながりをたどり、起点から1辺clusterSizeセルの範囲に収まるものを1つのクラスタにまとめる
+    const float clusterExtent = static_cast<float>(clusterSize) * grid.cellSize * 0.5f;
+    for (std::uint32_t seed = 0; seed < navMesh.polygons_.size(); ++seed) {
+        if (navMesh.polygons_[seed].cluster != kInvalidIndex) {
+            continue;
+        }
+        std::uint32_t cluster = static_cast<std::uint32_t>(navMesh.clusters_.size());
+        const Vector3 seedCenter = navMesh.polygons_[seed].center;
+        members.assign(1, seed);
+        navMesh.polygons_[seed].cluster = cluster;
+        Vector3 center = Vector3::zero;
+        for (size_t m = 0; m < members.size(); ++m) {
+            const NavMesh::Polygon& polygon = navMesh.polygons_[members[m]];
+            center += polygon.center;
+            for (std::uint32_t i = polygon.firstLink; i < polygon.firstLink + polygon.linkCount; ++i) {
+                NavMesh::Polygon& neighbor = navMesh.polygons_[navMesh.links_[i].polygon];
+                if (neighbor.cluster == kInvalidIndex &&
+                    std::abs(neighbor.center.x - seedCenter.x) <= clusterExtent && std::abs(neighbor.center.z - seedCenter.z) <= clusterExtent) {
+                    neighbor.cluster = cluster;
+                    members.emplace_back(navMesh.links_[i].polygon);
+                }
+            }
+        }
+        // 残り物の小さなクラスタは隣の出来上がったクラスタに混ぜる
+        if (members.size() < kMinClusterPolygons) {
+            std::uint32_t merged = kInvalidIndex;
+            for (std::uint32_t member : members) {
+                const NavMesh::Polygon& polygon = navMesh.polygons_[member];
+                for (std::uint32_t i = polygon.firstLink; i < polygon.firstLink + polygon.linkCount && merged == kInvalidIndex; ++i) {
+                    std::uint32_t neighborCluster = navMesh.polygons_[navMesh.links_[i].polygon].cluster;
+                    if (neighborCluster < cluster) {
+                        merged = neighborCluster;
+                    }
+                }
+            }
+            if (merged != kInvalidIndex) {
+                for (std::uint32_t member : members) {
+                    navMesh.polygons_[member].cluster = merged;
+                }
+                continue;
+            }
+        }
+        center /= static_cast<float>(members.size());
+        std::uint32_t nearest = *std::min_element(members.begin(), members.end(), [&](std::uint32_t lhs, std::uint32_t rhs) {
+            return (navMesh.polygons_[lhs].center - center).LengthSquare() < (navMesh.polygons_[rhs].center - center).LengthSquare();
+            });
+        navMesh.clusters_.push_back({ 0, 0, navMesh.polygons_[nearest].center });
+    }
+
+    // クラスタ間の出口ごとに中心同士を結んだ長さを求め、組ごとに最短のものを残す
+    struct ClusterEdge {
+        std::uint32_t from;
+        std::uint32_t to;
+        float cost;
+    };
+    std::vector<ClusterEdge> clusterEdges;
+    for (const auto& polygon : navMesh.polygons_) {
+        for (std::uint32_t i = polygon.firstLink; i < polygon.firstLink + polygon.linkCount; ++i) {
+            const NavMesh::Link& link = navMesh.links_[i];
+            std::uint32_t to = navMesh.polygons_[link.polygon].cluster;
+            if (to == polygon.cluster) {
+                continue;
+            }
+            Vector3 middle = (link.left + link.right) * 0.5f;
+            float cost = (middle - navMesh.clusters_[polygon.cluster].center).Length() + (navMesh.clusters_[to].center - middle).Length();
+            clusterEdges.push_back({ polygon.cluster, to, cost });
+        }
+    }
+    std::sort(clusterEdges.begin(), clusterEdges.end(), [](const ClusterEdge& lhs, const ClusterEdge& rhs) {
+        return lhs.from != rhs.from ? lhs.from < rhs.from : lhs.to != rhs.to ? lhs.to < rhs.to : lhs.cost < rhs.cost;
+        });
+    for (size_t i = 0; i < clusterEdges.size(); ++i) {
+        const ClusterEdge& edge = clusterEdges[i];
+        if (i > 0 && clusterEdges[i - 1].from == edge.from && clusterEdges[i - 1].to == edge.to) {
+            continue;
+        }
+        NavMesh::Cluster& cluster = navMesh.clusters_[edge.from];
+        if (cluster.linkCount == 0) {
+            cluster.firstLink = static_cast<std::uint32_t>(navMesh.clusterLinks_.size());
+        }
+        ++cluster.linkCount;
+        navMesh.clusterLinks_.push_back({ edge.to, edge.cost });
+    }
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "../Math/MathUtils.hpp"
+#include "../AABB.hpp"
+#include "../Collision/Narrowphase.hpp"
+#include "../Collision/Triangle.hpp"
+#include "NavMesh.hpp"
+
+class CollisionWorld;
+
+// 当たり判定と同じ静的な形からナビメッシュを作る（Recastに倣った手順）
+// 1. 三角形を縦の柱ごとの区間に焼き、上に人が立てる隙間のある上面を床のセルにする
+// 2. 段差がmaxClimb以下の隣とつなぎ、壁や崖からagentRadius以内を削る
+// 3. つながったセルを領域に分け、領域ごとにセルを長方形にまとめて多角形にする
+// 4. 多角形の出口と、近くの多角形をまとめたクラスタを作る
+class NavMeshBuilder {
+public:
+    struct Settings {
+        float cellSize = 0.3f;          // 水平方向のセルの幅
+        float cellHeight = 0.2f;        // 高さ方向のセルの幅
+        float agentHeight = 2.0f;
+        float agentRadius = 0.6f;
+        float agentMaxClimb = 0.9f;     // 登れる段差
+        float agentMaxSlope = 45.0f;    // 歩ける坂の角度（度）
+        std::uint32_t minRegionArea = 8;        // これより少ないセルの島は捨てる
+        std::uint32_t maxPolygonSize = 32;      // 多角形の1辺のセル数
+        std::uint32_t clusterSize = 64;         // クラスタの1辺のセル数
+    };
+
+    NavMeshBuilder();
+    explicit NavMeshBuilder(const Settings& settings);
+
+    // indicesは3つずつで1枚。worldで変換してから加える
+    void AddTriangles(const std::vector<Vector3>& vertices, const std::vector<std::uint32_t>& indices, const Matrix4x4& world = Matrix4x4::identity);
+    // Renderer::RegisterMeshに渡すのと同じ形のメッシュ用
+    void AddTriangles(const std::vector<Vector3>& vertices, const std::vector<std::uint16_t>& indices, const Matrix4x4& world = Matrix4x4::identity);
+    // boundsに掛かる静的でトリガーでないコライダーの形を加える。worldはStep後の状態を使う
+    // 凸な形はサポート写像を多方向に引いて作った凸包で近似する
+    // 距離場は元の三角形を持たず、凸包では中身の詰まった箱になるので加えない。焼いたメッシュをAddTrianglesで渡す
+    void AddStaticColliders(const CollisionWorld& world, const AABB& bounds);
+    void Clear();
+
+    // 加えた三角形からnavMeshを作り直す
+    void Build(NavMesh& navMesh) const;
+
+    const Settings& GetSettings() const { return settings_; }
+    std::uint32_t GetTriangleCount() const { return static_cast<std::uint32_t>(triangles_.size()); }
+
+private:
+    void AddConvexPart(const Narrowphase::ConvexPart& part);
+
+    Settings settings_;
+    std::vector<Triangle> triangles_;
+
+    std::vector<Collider*> colliders_;
+    std::vector<Narrowphase::ConvexPart> parts_;
+    Narrowphase::Scratch scratch_;
+    std::vector<Vector3> hullPoints_;
+};
@@ -0,0 +1,337 @@
+#include "NavMeshQuery.hpp"
+
+#include <algorithm>
+#include <atomic>
+
+#include "../ThreadPool.hpp"
+
+namespace {
+    constexpr std::uint32_t kInvalidIndex = NavMesh::kInvalidIndex;
+
+    // 上から見た三角形の符号付き面積の2倍。反時計回りで正
+    float TriangleArea2D(const Vector3& a, const Vector3& b, const Vector3& c) {
+        return (b.x - a.x) * (c.z - a.z) - (b.z - a.z) * (c.x - a.x);
+    }
+
+    bool IsSamePoint(const Vector3& a, const Vector3& b) {
+        return (a - b).LengthSquare() <= 1.0e-10f;
+    }
+}
+
+NavMeshQuery::NavMeshQuery(const NavMesh& navMesh, std::uint32_t maxIterations) :
+    navMesh_(navMesh),
+    maxIterations_(maxIterations),
+    searchExtents_(2.0f, 4.0f, 2.0f),
+    isHierarchical_(true),
+    polygonNodes_(navMesh.GetPolygonCount(), Node{}),
+    clusterNodes_(navMesh.GetClusterCount(), Node{}),
+    clusterMarks_(navMesh.GetClusterCount(), 0),
+    generation_(0),
+    corridorGeneration_(0) {
+    openList_.reserve(navMesh.GetPolygonCount());
+    corridor_.reserve(navMesh.GetPolygonCount());
+}
+
+NavMeshQuery::Status NavMeshQuery::FindPath(const Vector3& start, const Vector3& goal, std::vector<Vector3>& path) {
+    path.clear();
+    corridor_.clear();
+    Vector3 startPosition, goalPosition;
+    std::uint32_t startPolygon = navMesh_.FindNearestPolygon(start, searchExtents_, startPosition);
+    std::uint32_t goalPolygon = navMesh_.FindNearestPolygon(goal, searchExtents_, goalPosition);
+    if (startPolygon == kInvalidIndex || goalPolygon == kInvalidIndex) {
+        return Status::kNotFound;
+    }
+
+    const auto& polygons = navMesh_.GetPolygons();
+    // クラスタでたどれなければ、つながっていないので絞らずに最も近づけるところを探す
+    bool isRestricted = isHierarchical_ && MarkClusterCorridor(polygons[startPolygon].cluster, polygons[goalPolygon].cluster);
+    std::uint32_t end = kInvalidIndex;
+    bool isReached = SearchPolygons(startPolygon, startPosition, goalPolygon, goalPosition, isRestricted, end);
+
+    for (std::uint32_t polygon = end; polygon != kInvalidIndex; polygon = polygonNodes_[polygon].parent) {
+        corridor_.emplace_back(polygon);
+    }
+    std::reverse(corridor_.begin(), corridor_.end());
+    Vector3 endPosition = isReached ? goalPosition : navMesh_.ClosestPointOnPolygon(end, goalPosition);
+    StringPull(startPosition, endPosition, path);
+    return isReached ? Status::kFound : Status::kPartial;
+}
+
+void NavMeshQuery::BeginSearch() {
+    openList_.clear();
+    if (++generation_ == 0) {
+        // 一周したら古い番号と見分けが付かなくなるので消す
+        for (auto& node : polygonNodes_) { node.generation = 0; }
+        for (auto& node : clusterNodes_) { node.generation = 0; }
+        generation_ = 1;
+    }
+}
+
+bool NavMeshQuery::MarkClusterCorridor(std::uint32_t start, std::uint32_t goal) {
+    if (++corridorGeneration_ == 0) {
+        std::fill(clusterMarks_.begin(), clusterMarks_.end(), 0);
+        corridorGeneration_ = 1;
+    }
+    const auto& clusters = navMesh_.GetClusters();
+    const auto& links = navMesh_.GetClusterLinks();
+    const Vector3& goalCenter = clusters[goal].center;
+
+    BeginSearch();
+    Node& startNode = clusterNodes_[start];
+    startNode.position = clusters[start].center;
+    startNode.link = kInvalidIndex;
+    startNode.cost = 0.0f;
+    startNode.total = (goalCenter - startNode.position).Length();
+    startNode.parent = kInvalidIndex;
+    startNode.heapIndex = kInvalidIndex;
+    startNode.generation = generation_;
+    Push(clusterNodes_, start);
+    for (std::uint32_t iteration = 0; !openList_.empty() && iteration < maxIterations_; ++iteration) {
+        std::uint32_t current = Pop(clusterNodes_);
+        if (current == goal) {
+            // 中心同士の距離は粗いので、経路のクラスタに隣り合うものまで広げておく
+            for (std::uint32_t cluster = goal; cluster != kInvalidIndex; cluster = clusterNodes_[cluster].parent) {
+                clusterMarks_[cluster] = corridorGeneration_;
+                for (std::uint32_t i = clusters[cluster].firstLink; i < clusters[cluster].firstLink + clusters[cluster].linkCount; ++i) {
+                    clusterMarks_[links[i].cluster] = corridorGeneration_;
+                }
+            }
+            return true;
+        }
+        const NavMesh::Cluster& cluster = clusters[current];
+        float currentCost = clusterNodes_[current].cost;
+        for (std::uint32_t i = cluster.firstLink; i < cluster.firstLink + cluster.linkCount; ++i) {
+            const NavMesh::ClusterLink& link = links[i];
+            float cost = currentCost + link.cost;
+            Node& node = clusterNodes_[link.cluster];
+            if (IsVisited(node)) {
+                if (cost >= node.cost) {
+                    continue;
+                }
+            }
+            else {
+                node.position = clusters[link.cluster].center;
+                node.heapIndex = kInvalidIndex;
+                node.generation = generation_;
+            }
+            node.link = i;
+            node.cost = cost;
+            node.total = cost + (goalCenter - node.position).Length();
+            node.parent = current;
+            if (node.heapIndex == kInvalidIndex) {
+                Push(clusterNodes_, link.cluster);
+            }
+            else {
+                SiftUp(clusterNodes_, node.heapIndex);
+            }
+        }
+    }
+    return false;
+}
+
+bool NavMeshQuery::SearchPolygons(std::uint32_t start, const Vector3& startPosition, std::uint32_t goal, const Vector3& goalPosition, bool isRestricted, std::uint32_t& end) {
+    const auto& polygons = navMesh_.GetPolygons();
+    const auto& links = navMesh_.GetLinks();
+
+    BeginSearch();
+    Node& startNode = polygonNodes_[start];
+    startNode.position = startPosition;
+    startNode.link = kInvalidIndex;
+    startNode.cost = 0.0f;
+    startNode.total = (goalPosition - startPosition).Length();
+    startNode.parent = kInvalidIndex;
+    startNode.heapIndex = kInvalidIndex;
+    startNode.generation = generation_;
+    Push(polygonNodes_, start);
+    std::uint32_t best = start;
+    float bestHeuristic = startNode.total;
+    for (std::uint32_t iteration = 0; !openList_.empty() && iteration < maxIterations_; ++iteration) {
+        std::uint32_t current = Pop(polygonNodes_);
+        if (current == goal) {
+            end = goal;
+            return true;
+        }
+        const NavMesh::Polygon& polygon = polygons[current];
+        Vector3 currentPosition = polygonNodes_[current].position;
+        float currentCost = polygonNodes_[current].cost;
+        for (std::uint32_t i = polygon.firstLink; i < polygon.firstLink + polygon.linkCount; ++i) {
+            const NavMesh::Link& link = links[i];
+            if (isRestricted && clusterMarks_[polygons[link.polygon].cluster] != corridorGeneration_) {
+                continue;
+            }
+            // 出口の中点を通るものとして距離を測る
+            Vector3 middle = (link.left + link.right) * 0.5f;
+            float cost = currentCost + (middle - currentPosition).Length();
+            float heuristic = (goalPosition - middle).Length();
+            if (link.polygon == goal) {
+                cost += heuristic;
+                heuristic = 0.0f;
+            }
+            Node& node = polygonNodes_[link.polygon];
+            if (IsVisited(node)) {
+                if (cost >= node.cost) {
+                    continue;
+                }
+            }
+            else {
+                node.heapIndex = kInvalidIndex;
+                node.generation = generation_;
+            }
+            node.position = middle;
+            node.link = i;
+            node.cost = cost;
+            node.total = cost + heuristic;
+            node.parent = current;
+            if (node.heapIndex == kInvalidIndex) {
+                Push(polygonNodes_, link.polygon);
+            }
+            else {
+                SiftUp(polygonNodes_, node.heapIndex);
+            }
+            if (heuristic < bestHeuristic) {
+                bestHeuristic = heuristic;
+                best = link.polygon;
+            }
+        }
+    }
+    end = best;
+    return false;
+}
+
+void NavMeshQuery::StringPull(const Vector3& start, const Vector3& goal, std::vector<Vector3>& path) {
+    const auto& links = navMesh_.GetLinks();
+    portalLefts_.clear();
+    portalRights_.clear();
+    portalLefts_.emplace_back(start);
+    portalRights_.emplace_back(start);
+    for (size_t i = 1; i < corridor_.size(); ++i) {
+        const NavMesh::Link& link = links[polygonNodes_[corridor_[i]].link];
+        portalLefts_.emplace_back(link.left);
+        portalRights_.emplace_back(link.right);
+    }
+    portalLefts_.emplace_back(goal);
+    portalRights_.emplace_back(goal);
+
+    // 頂点から左右の縁へ張った漏斗を出口ごとに狭め、縁が交差したら反対側の縁を曲がり角にする
+    path.emplace_back(start);
+    Vector3 apex = start, left = start, right = start;
+    size_t apexIndex = 0, leftIndex = 0, rightIndex = 0;
+    for (size_t i = 1; i < portalLefts_.size(); ++i) {
+        const Vector3& portalLeft = portalLefts_[i];
+        const Vector3& portalRight = portalRights_[i];
+        if (TriangleArea2D(apex, right, portalRight) >= 0.0f) {
+            if (IsSamePoint(apex, right) || TriangleArea2D(apex, left, portalRight) < 0.0f) {
+                right = portalRight;
+                rightIndex = i;
+            }
+            else {
+                apex = left;
+                apexIndex = leftIndex;
+                if (!IsSamePoint(path.back(), apex)) {
+                    path.emplace_back(apex);
+                }
+                right = left = apex;
+                rightIndex = leftIndex = apexIndex;
+                i = apexIndex;
+                continue;
+            }
+        }
+        if (TriangleArea2D(apex, left, portalLeft) <= 0.0f) {
+            if (IsSamePoint(apex, left) || TriangleArea2D(apex, right, portalLeft) > 0.0f) {
+                left = portalLeft;
+                leftIndex = i;
+            }
+            else {
+                apex = right;
+                apexIndex = rightIndex;
+                if (!IsSamePoint(path.back(), apex)) {
+                    path.emplace_back(apex);
+                }
+                right = left = apex;
+                rightIndex = leftIndex = apexIndex;
+                i = apexIndex;
+                continue;
+            }
+        }
+    }
+    if (!IsSamePoint(path.back(), goal) || path.size() == 1) {
+        path.emplace_back(goal);
+    }
+}
+
+void NavMeshQuery::Push(std::vector<Node>& nodes, std::uint32_t index) {
+    nodes[index].heapIndex = static_cast<std::uint32_t>(openList_.size());
+    openList_.emplace_back(index);
+    SiftUp(nodes, nodes[index].heapIndex);
+}
+
+std::uint32_t NavMeshQuery::Pop(std::vector<Node>& nodes) {
+    std::uint32_t top = openList_.front();
+    nodes[top].heapIndex = kInvalidIndex;
+    std::uint32_t last = openList_.back();
+    openList_.pop_back();
+    if (!openList_.empty()) {
+        openList_.front() = last;
+        nodes[last].heapIndex = 0;
+        SiftDown(nodes, 0);
+    }
+    return top;
+}
+
+void NavMeshQuery::SiftUp(std::vector<Node>& nodes, std::uint32_t position) {
+    std::uint32_t index = openList_[position];
+    float total = nodes[index].total;
+    while (position > 0) {
+        std::uint32_t parent = (position - 1) / 2;
+        if (nodes[openList_[parent]].total <= total) {
+            break;
+        }
+        openList_[position] = openList_[parent];
+        nodes[openList_[position]].heapIndex = position;
+        position = parent;
+    }
+    openList_[position] = index;
+    nodes[index].heapIndex = position;
+}
+
+void NavMeshQuery::SiftDown(std::vector<Node>& nodes, std::uint32_t position) {
+    std::uint32_t index = openList_[position];
+    float total = nodes[index].total;
+    std::uint32_t count = static_cast<std::uint32_t>(openList_.size());
+    while (true) {
+        std::uint32_t child = position * 2 + 1;
+        if (child >= count) {
+            break;
+        }
+        if (child + 1 < count && nodes[openList_[child + 1]].total < nodes[openList_[child]].total) {
+            ++child;
+        }
+        if (nodes[openList_[child]].total >= total) {
+            break;
+        }
+        openList_[position] = openList_[child];
+        nodes[openList_[position]].heapIndex = position;
+        position = child;
+    }
+    openList_[position] = index;
+    nodes[index].heapIndex = position;
+}
+
+NavMeshPathBatch::NavMeshPathBatch(const NavMesh& navMesh, ThreadPool& threadPool, std::uint32_t maxIterations) :
+    threadPool_(threadPool) {
+    for (std::uint32_t i = 0; i < threadPool.GetThreadCount(); ++i) {
+        queries_.emplace_back(std::make_unique<NavMeshQuery>(navMesh, maxIterations));
+    }
+}
+
+void NavMeshPathBatch::FindPaths(const std::vector<Request>& requests, std::vector<Result>& results) {
+    results.resize(requests.size());
+    std::uint32_t requestCount = static_cast<std::uint32_t>(requests.size());
+    std::atomic<std::uint32_t> next = 0;
+    threadPool_.ParallelFor(GetQueryCount(), [&](std::uint32_t task) {
+        NavMeshQuery& query = *queries_[task];
+        for (std::uint32_t i = next.fetch_add(1, std::memory_order_relaxed); i < requestCount; i = next.fetch_add(1, std::memory_order_relaxed)) {
+            results[i].status = query.FindPath(requests[i].start, requests[i].goal, results[i].path);
+        }
+        });
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "../Math/MathUtils.hpp"
+#include "NavMesh.hpp"
+
+class ThreadPool;
+
+// ナビメッシュ上の経路探索
+// まずクラスタの粗いグラフをA*で探し、通るクラスタとその隣の中だけで多角形のA*を回す
+// 探索のノードは多角形の数だけ最初に確保し、世代番号で使い回すので探索ごとに確保も初期化もしない
+// 1回の探索で開くノード数に上限を設け、超えたらゴールに最も近づいたところまでの経路を返す
+// 1つのオブジェクトを複数のスレッドから同時に使わない。並列にはNavMeshPathBatchを使う
+class NavMeshQuery {
+public:
+    static constexpr std::uint32_t kDefaultMaxIterations = 4096;
+
+    enum class Status {
+        kFound,
+        kPartial,       // 届かないか上限に達した。ゴールに最も近づいたところまで
+        kNotFound       // 始点かゴールの近くに多角形が無い
+    };
+
+    explicit NavMeshQuery(const NavMesh& navMesh, std::uint32_t maxIterations = kDefaultMaxIterations);
+
+    // 始点からゴールまでの折れ線をpathに書く。両端を含む
+    Status FindPath(const Vector3& start, const Vector3& goal, std::vector<Vector3>& path);
+
+    // 始点とゴールから多角形を探す範囲
+    void SetSearchExtents(const Vector3& extents) { searchExtents_ = extents; }
+    // falseにするとクラスタで絞らずに探す。最短だが遅い
+    void SetIsHierarchical(bool isHierarchical) { isHierarchical_ = isHierarchical; }
+    // 最後に見つけた経路が通る多角形
+    const std::vector<std::uint32_t>& GetCorridor() const { return corridor_; }
+
+private:
+    struct Node {
+        Vector3 position;       // この多角形に入った出口の中点
+        std::uint32_t link;     // 入るのに使った出口
+        float cost;
+        float total;
+        std::uint32_t parent;
+        std::uint32_t heapIndex;    // kInvalidIndexなら開いていない
+        std::uint32_t generation;
+    };
+
+    void BeginSearch();
+    bool IsVisited(const Node& node) const { return node.generation == generation_; }
+    // startからgoalのクラスタまでの並びに印を付ける。たどれなければfalse
+    bool MarkClusterCorridor(std::uint32_t start, std::uint32_t goal);
+    // 届けばtrue。endに最後の多角形を書く
+    bool SearchPolygons(std::uint32_t start, const Vector3& startPosition, std::uint32_t goal, const Vector3& goalPosition, bool isRestricted, std::uint32_t& end);
+    // 通った多角形の出口を左右の縁として漏斗で引き締める
+    void StringPull(const Vector3& start, const Vector3& goal, std::vector<Vector3>& path);
+
+    void Push(std::vector<Node>& nodes, std::uint32_t index);
+    std::uint32_t Pop(std::vector<Node>& nodes);
+    void SiftUp(std::vector<Node>& nodes, std::uint32_t position);
+    void SiftDown(std::vector<Node>& nodes, std::uint32_t position);
+
+    const NavMesh& navMesh_;
+    std::uint32_t maxIterations_;
+    Vector3 searchExtents_;
+    bool isHierarchical_;
+
+    std::vector<Node> polygonNodes_;
+    std::vector<Node> clusterNodes_;
+    std::vector<std::uint32_t> clusterMarks_;   // 経路に使うクラスタはcorridorGeneration_
+    std::vector<std::uint32_t> openList_;       // 合計の小さい順の二分ヒープ
+    std::uint32_t generation_;
+    std::uint32_t corridorGeneration_;
+
+    std::vector<std::uint32_t> corridor_;
+    std::vector<Vector3> portalLefts_;
+    std::vector<Vector3> portalRights_;
+};
+
+// 多数の経路をスレッドプールで並列に探す
+// スレッドごとにNavMeshQueryを持ち、依頼は空いたスレッドから順に取っていく
+// ParallelForは1つのスレッドからしか呼べないので、プールは呼び出し側が選んで渡す
+// 物理のStepと別のスレッドから呼ぶなら、ThreadPool::GetShared()ではなく専用のプールを作って渡す
+class NavMeshPathBatch {
+public:
+    struct Request {
+        Vector3 start;
+        Vector3 goal;
+    };
+    struct Result {
+        std::vector<Vector3> path;
+        NavMeshQuery::Status status;
+    };
+
+    NavMeshPathBatch(const NavMesh& navMesh, ThreadPool& threadPool, std::uint32_t maxIterations = NavMeshQuery::kDefaultMaxIterations);
+
+    // results[i]にrequests[i]の結果を書く。resultsを使い回せば経路の配列も再確保しない
+    void FindPaths(const std::vector<Request>& requests, std::vector<Result>& results);
+
+    NavMeshQuery& GetQuery(std::uint32_t thread) { return *queries_[thread]; }
+    std::uint32_t GetQueryCount() const { return static_cast<std::uint32_t>(queries_.size()); }
+
+private:
+    ThreadPool& threadPool_;
+    std::vector<std::unique_ptr<NavMeshQuery>> queries_;
+};
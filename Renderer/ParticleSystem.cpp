@@ -0,0 +1,230 @@
+#include "ParticleSystem.hpp"
+
+#include "Externals/ImGui/imgui.h"
+
+#include "Math/SIMD.hpp"
+#include "GameObject.hpp"
+#include "Renderer.hpp"
+#include "Scene.hpp"
+#include "ThreadPool.hpp"
+#include "Collision/CollisionWorld.hpp"
+#include "Collision/ParticleCollision.hpp"
+
+using namespace SIMD;
+
+namespace {
+    // 1タスクで扱う粒子の数。8の倍数
+    constexpr std::uint32_t kChunkSize = 4096;
+    constexpr float kEpsilon = 1.0e-6f;
+
+    template<class F>
+    Vector3T<F> LoadVector(float* const (&values)[3], size_t i) {
+        return { Load<F>(values[0] + i), Load<F>(values[1] + i), Load<F>(values[2] + i) };
+    }
+
+    template<class F>
+    void StoreVector(float* const (&values)[3], const Vector3T<F>& v, size_t i) {
+        Store(values[0] + i, v.x);
+        Store(values[1] + i, v.y);
+        Store(values[2] + i, v.z);
+    }
+
+    // 重力を足して進め、寿命を減らす
+    template<class F>
+    void IntegrateKernel(const ParticleCollision::Streams& streams, float* lives, size_t i, const Vector3& gravityDelta, float deltaTime) {
+        Vector3T<F> position = LoadVector<F>(streams.positions, i);
+        Vector3T<F> velocity = LoadVector<F>(streams.velocities, i);
+        velocity = velocity + Vector3T<F>{ F(gravityDelta.x), F(gravityDelta.y), F(gravityDelta.z) };
+        position = position + velocity * F(deltaTime);
+        StoreVector(streams.velocities, velocity, i);
+        StoreVector(streams.positions, position, i);
+        Store(lives + i, Load<F>(lives + i) - F(deltaTime));
+    }
+
+    // 8個ずつ、残りを1個ずつ
+    template<class Kernel8, class Kernel1>
+    void Run(size_t begin, size_t end, Kernel8&& kernel8, Kernel1&& kernel1) {
+        size_t i = begin;
+#if defined(__AVX__)
+        for (; i + Float8::kWidth <= end; i += Float8::kWidth) {
+            kernel8(i);
+        }
+#else
+        (void)kernel8;
+#endif
+        for (; i < end; ++i) {
+            kernel1(i);
+        }
+    }
+}
+
+void ParticleSystem::Update(float deltaTime) {
+    Resize();
+    if (emissionRate_ > 0.0f) {
+        emissionRemainder_ += emissionRate_ * deltaTime;
+        auto emitCount = static_cast<std::uint32_t>(emissionRemainder_);
+        emissionRemainder_ -= static_cast<float>(emitCount);
+        Emit(emitCount);
+    }
+    if (count_ == 0 || deltaTime <= 0.0f) {
+        return;
+    }
+
+    Scene* scene = gameObject.GetScene();
+    const CollisionWorld* collisionWorld = isColliding_ && scene ? &scene->GetCollisionWorld() : nullptr;
+    std::uint32_t chunkCount = (count_ + kChunkSize - 1) / kChunkSize;
+    ThreadPool::GetShared().ParallelFor(chunkCount, [&](std::uint32_t chunk) {
+        Simulate(chunk, deltaTime, collisionWorld);
+        });
+    RemoveDead();
+}
+
+void ParticleSystem::Draw(Renderer& renderer) const {
+    if (count_ == 0) {
+        return;
+    }
+    Renderer::InstanceData* instances = renderer.DrawInstances(renderer.GetBoxMesh(), count_);
+    if (!instances) {
+        return;
+    }
+    // 箱のメッシュは1辺1なので直径で拡大し、残り寿命で薄くする
+    float diameter = radius_ * 2.0f;
+    float inverseLifetime = lifetime_ > 0.0f ? 1.0f / lifetime_ : 0.0f;
+    std::uint32_t chunkCount = (count_ + kChunkSize - 1) / kChunkSize;
+    ThreadPool::GetShared().ParallelFor(chunkCount, [&](std::uint32_t chunk) {
+        std::uint32_t begin = chunk * kChunkSize;
+        std::uint32_t end = std::min(begin + kChunkSize, count_);
+        for (std::uint32_t i = begin; i < end; ++i) {
+            Renderer::InstanceData& instance = instances[i];
+            instance.mat0 = { diameter, 0.0f, 0.0f, positions_[0][i] };
+            instance.mat1 = { 0.0f, diameter, 0.0f, positions_[1][i] };
+            instance.mat2 = { 0.0f, 0.0f, diameter, positions_[2][i] };
+            instance.color = { color_.x, color_.y, color_.z, color_.w * std::clamp(lives_[i] * inverseLifetime, 0.0f, 1.0f) };
+        }
+        });
+}
+
+void ParticleSystem::Emit(std::uint32_t count) {
+    Resize();
+    count = std::min(count, capacity_ - count_);
+    if (count == 0) {
+        return;
+    }
+    const Matrix4x4& world = GetTransform().GetWorldMatrix();
+    Vector3 origin = world.GetTranslate();
+    // 円錐の軸とそれに直交する2軸
+    Vector3 axis = world.GetYAxis();
+    axis = axis.LengthSquare() > kEpsilon ? axis.Normalized() : Vector3::unitY;
+    Vector3 tangent = Vector3::Cross(std::abs(axis.x) < 0.9f ? Vector3::unitX : Vector3::unitZ, axis).Normalized();
+    Vector3 bitangent = Vector3::Cross(axis, tangent);
+
+    // 円錐の中で立体角が一様になるよう、軸方向の余弦を一様に取る
+    float cosSpread = std::cos(std::clamp(spreadAngle_, 0.0f, 180.0f) * Math::ToRadian);
+    std::uniform_real_distribution<float> cosDistribution(cosSpread, 1.0f);
+    std::uniform_real_distribution<float> angleDistribution(0.0f, Math::TwoPi);
+    for (std::uint32_t n = 0; n < count; ++n) {
+        float cosTheta = cosDistribution(random_);
+        float sinTheta = std::sqrt(std::max(1.0f - cosTheta * cosTheta, 0.0f));
+        float phi = angleDistribution(random_);
+        Vector3 velocity = (axis * cosTheta + tangent * (sinTheta * std::cos(phi)) + bitangent * (sinTheta * std::sin(phi))) * speed_;
+        std::uint32_t i = count_++;
+        positions_[0][i] = origin.x;
+        positions_[1][i] = origin.y;
+        positions_[2][i] = origin.z;
+        velocities_[0][i] = velocity.x;
+        velocities_[1][i] = velocity.y;
+        velocities_[2][i] = velocity.z;
+        lives_[i] = lifetime_;
+    }
+}
+
+void ParticleSystem::ShowUI() {
+    if (ImGui::TreeNodeEx("ParticleSystem", ImGuiTreeNodeFlags_DefaultOpen | ImGuiTreeNodeFlags_SpanAvailWidth)) {
+        ImGui::Unindent();
+        int capacity = static_cast<int>(capacity_);
+        if (ImGui::DragInt("Capacity", &capacity, 1024.0f, 0, static_cast<int>(kMaxCapacity))) {
+            SetCapacity(static_cast<std::uint32_t>(capacity));
+        }
+        ImGui::DragFloat("EmissionRate", &emissionRate_, 10.0f, 0.0f, Math::positiveInfinity);
+        ImGui::DragFloat("Lifetime", &lifetime_, 0.1f, 0.0f, Math::positiveInfinity);
+        ImGui::DragFloat("Speed", &speed_, 0.1f, 0.0f, Math::positiveInfinity);
+        ImGui::DragFloat("SpreadAngle", &spreadAngle_, 1.0f, 0.0f, 180.0f);
+        ImGui::DragFloat("Radius", &radius_, 0.01f, 0.0f, Math::positiveInfinity);
+        ImGui::DragFloat3("Gravity", &gravity_.x, 0.1f);
+        ImGui::DragFloat("Restitution", &restitution_, 0.01f, 0.0f, 1.0f);
+        ImGui::DragFloat("Friction", &friction_, 0.01f, 0.0f, 1.0f);
+        ImGui::ColorEdit4("Color", &color_.x);
+        ImGui::Checkbox("Colliding", &isColliding_);
+        ImGui::Text("Count %u", count_);
+        ImGui::TreePop();
+    }
+}
+
+void ParticleSystem::SetCapacity(std::uint32_t capacity) {
+    capacity_ = std::min(capacity, kMaxCapacity);
+    count_ = std::min(count_, capacity_);
+    Resize();
+}
+
+void ParticleSystem::Simulate(std::uint32_t chunk, float deltaTime, const CollisionWorld* collisionWorld) {
+    std::uint32_t begin = chunk * kChunkSize;
+    std::uint32_t end = std::min(begin + kChunkSize, count_);
+    ParticleCollision::Streams streams{
+        { positions_[0].data(), positions_[1].data(), positions_[2].data() },
+        { velocities_[0].data(), velocities_[1].data(), velocities_[2].data() } };
+    float* lives = lives_.data();
+
+    Vector3 gravityDelta = gravity_ * deltaTime;
+#if defined(__AVX__)
+    auto kernel8 = [&](size_t i) { IntegrateKernel<Float8>(streams, lives, i, gravityDelta, deltaTime); };
+#else
+    auto kernel8 = [](size_t) {};
+#endif
+    Run(begin, end, kernel8, [&](size_t i) { IntegrateKernel<float>(streams, lives, i, gravityDelta, deltaTime); });
+
+    if (collisionWorld) {
+        AABB bounds = ParticleCollision::ComputeBounds(streams, begin, end, radius_);
+        ParticleCollision::CollideStatic(*collisionWorld, bounds, streams, begin, end, { radius_, restitution_, friction_ });
+    }
+
+    std::uint32_t deadCount = 0;
+    for (std::uint32_t i = begin; i < end; ++i) {
+        if (lives_[i] <= 0.0f) {
+            deadIndices_[begin + deadCount++] = i;
+        }
+    }
+    deadCounts_[chunk] = deadCount;
+}
+
+void ParticleSystem::RemoveDead() {
+    // 番号の大きい方から埋めれば、末尾から持ってくる粒子は必ず生きている
+    std::uint32_t chunkCount = (count_ + kChunkSize - 1) / kChunkSize;
+    for (std::uint32_t chunk = chunkCount; chunk-- > 0;) {
+        const std::uint32_t* dead = deadIndices_.data() + chunk * kChunkSize;
+        for (std::uint32_t k = deadCounts_[chunk]; k-- > 0;) {
+            std::uint32_t i = dead[k];
+            std::uint32_t last = --count_;
+            if (i == last) {
+                continue;
+            }
+            for (size_t axis = 0; axis < 3; ++axis) {
+                positions_[axis][i] = positions_[axis][last];
+                velocities_[axis][i] = velocities_[axis][last];
+            }
+            lives_[i] = lives_[last];
+        }
+    }
+}
+
+void ParticleSystem::Resize() {
+    if (lives_.size() == capacity_) {
+        return;
+    }
+    for (size_t axis = 0; axis < 3; ++axis) {
+        positions_[axis].resize(capacity_);
+        velocities_[axis].resize(capacity_);
+    }
+    lives_.resize(capacity_);
+    deadIndices_.resize(capacity_);
+    deadCounts_.resize((capacity_ + kChunkSize - 1) / kChunkSize);
+}
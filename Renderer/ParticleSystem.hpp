@@ -0,0 +1,111 @@
+#pragma once
+#include "Component.hpp"
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "Math/MathUtils.hpp"
+
+class Renderer;
+class CollisionWorld;
+
+// 小さな球を大量に飛ばす
+// 位置、速度、寿命を成分ごとの配列で持ち、8個ずつまとめて進める
+// 当たるのは当たり判定の静的な木にあるコライダーだけ。箱は向きのある箱、球とカプセルはそのまま、それ以外はAABBとみなす
+class ParticleSystem :
+    public Component {
+public:
+    // Renderer::kMaxBulkInstanceCountと同じ
+    static constexpr std::uint32_t kMaxCapacity = 1 << 20;
+
+    ParticleSystem(GameObject* const gameObject) :
+        Component(gameObject),
+        gravity_(0.0f, -9.8f, 0.0f),
+        color_(1.0f, 1.0f, 1.0f, 1.0f),
+        capacity_(65536),
+        count_(0),
+        emissionRate_(1000.0f),
+        emissionRemainder_(0.0f),
+        lifetime_(5.0f),
+        speed_(5.0f),
+        spreadAngle_(30.0f),
+        radius_(0.05f),
+        restitution_(0.3f),
+        friction_(0.1f),
+        isColliding_(true) {
+    }
+
+    // 放出、積分、衝突、寿命の尽きた粒子の削除
+    void Update(float deltaTime);
+    // 生きている粒子を箱のインスタンスとして1回で描く
+    void Draw(Renderer& renderer) const;
+    // TransformのY軸を中心にspreadAngleの円錐へcount個放つ。空きがなければ捨てる
+    void Emit(std::uint32_t count);
+    void Clear() { count_ = 0; }
+    void ShowUI() override;
+
+    // 超える分の粒子は消える
+    void SetCapacity(std::uint32_t capacity);
+    // 毎秒の放出数
+    void SetEmissionRate(float emissionRate) { emissionRate_ = emissionRate; }
+    void SetLifetime(float lifetime) { lifetime_ = lifetime; }
+    void SetSpeed(float speed) { speed_ = speed; }
+    // 度
+    void SetSpreadAngle(float spreadAngle) { spreadAngle_ = spreadAngle; }
+    void SetRadius(float radius) { radius_ = radius; }
+    void SetGravity(const Vector3& gravity) { gravity_ = gravity; }
+    // 面に垂直な速度の跳ね返る割合
+    void SetRestitution(float restitution) { restitution_ = restitution; }
+    // 面に沿う速度の当たるたびに失う割合
+    void SetFriction(float friction) { friction_ = friction; }
+    void SetColor(const Vector4& color) { color_ = color; }
+    void SetIsColliding(bool isColliding) { isColliding_ = isColliding; }
+
+    std::uint32_t GetCapacity() const { return capacity_; }
+    std::uint32_t GetCount() const { return count_; }
+    float GetEmissionRate() const { return emissionRate_; }
+    float GetLifetime() const { return lifetime_; }
+    float GetSpeed() const { return speed_; }
+    float GetSpreadAngle() const { return spreadAngle_; }
+    float GetRadius() const { return radius_; }
+    const Vector3& GetGravity() const { return gravity_; }
+    float GetRestitution() const { return restitution_; }
+    float GetFriction() const { return friction_; }
+    const Vector4& GetColor() const { return color_; }
+    bool IsColliding() const { return isColliding_; }
+    // i < GetCount()
+    Vector3 GetPosition(std::uint32_t i) const { return { positions_[0][i], positions_[1][i], positions_[2][i] }; }
+    Vector3 GetVelocity(std::uint32_t i) const { return { velocities_[0][i], velocities_[1][i], velocities_[2][i] }; }
+    float GetLife(std::uint32_t i) const { return lives_[i]; }
+
+private:
+    // 塊ごとに積分し、塊を囲むAABBで静的な木を引いて当てる
+    void Simulate(std::uint32_t chunk, float deltaTime, const CollisionWorld* collisionWorld);
+    // 寿命の尽きた粒子を末尾の粒子で埋める
+    void RemoveDead();
+    void Resize();
+
+    std::vector<float> positions_[3];
+    std::vector<float> velocities_[3];
+    std::vector<float> lives_;
+    // 塊ごとに、先頭から寿命の尽きた粒子の番号を詰める
+    std::vector<std::uint32_t> deadIndices_;
+    std::vector<std::uint32_t> deadCounts_;
+
+    Vector3 gravity_;
+    Vector4 color_;
+    std::uint32_t capacity_;
+    std::uint32_t count_;
+    float emissionRate_;
+    // 端数を次のフレームに持ち越す
+    float emissionRemainder_;
+    float lifetime_;
+    float speed_;
+    float spreadAngle_;
+    float radius_;
+    float restitution_;
+    float friction_;
+    bool isColliding_;
+    std::mt19937 random_;
+};
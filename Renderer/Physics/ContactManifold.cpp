@@ -0,0 +1,100 @@
+#include "ContactManifold.hpp"
+
+#include <algorithm>
+
+namespace {
+    Vector3 ToWorld(const ContactManifold::Pose& pose, const Vector3& local) {
+        return pose.position + pose.rotation * local;
+    }
+
+    Vector3 ToLocal(const ContactManifold::Pose& pose, const Vector3& point) {
+        return pose.rotation.Conjugate() * (point - pose.position);
+    }
+
+    // 4点が張る面積の目安。対角線の外積の大きい方
+    float EstimateArea(const Vector3& p0, const Vector3& p1, const Vector3& p2, const Vector3& p3) {
+        float area = Vector3::Cross(p0 - p1, p2 - p3).LengthSquare();
+        area = std::max(area, Vector3::Cross(p0 - p2, p1 - p3).LengthSquare());
+        area = std::max(area, Vector3::Cross(p0 - p3, p1 - p2).LengthSquare());
+        return area;
+    }
+}
+
+void ContactManifold::Refresh(const Vector3& normal, const Pose& poseA, const Pose& poseB, float breakingDistance) {
+    normal_ = normal;
+    float breakingDistanceSquare = breakingDistance * breakingDistance;
+    std::uint32_t count = 0;
+    for (std::uint32_t i = 0; i < pointCount_; ++i) {
+        Point& point = points_[i];
+        point.pointA = ToWorld(poseA, point.localA);
+        point.pointB = ToWorld(poseB, point.localB);
+        Vector3 separation = point.pointA - point.pointB;
+        point.depth = Vector3::Dot(separation, normal_);
+        Vector3 drift = separation - normal_ * point.depth;
+        if (point.depth < -breakingDistance || drift.LengthSquare() > breakingDistanceSquare) {
+            continue;
+        }
+        points_[count++] = point;
+    }
+    pointCount_ = count;
+}
+
+void ContactManifold::Add(const Contact& contact, const Pose& poseA, const Pose& poseB, float breakingDistance) {
+    Point point{};
+    point.localA = ToLocal(poseA, contact.pointA);
+    point.localB = ToLocal(poseB, contact.pointB);
+    point.pointA = contact.pointA;
+    point.pointB = contact.pointB;
+    point.depth = contact.depth;
+
+    // 同じ場所の点なら力積を引き継いで置き換える
+    float mergeDistanceSquare = breakingDistance * breakingDistance;
+    for (std::uint32_t i = 0; i < pointCount_; ++i) {
+        if ((points_[i].pointA - point.pointA).LengthSquare() < mergeDistanceSquare) {
+            std::copy_n(points_[i].impulses, ContactSolver::kRowCount, point.impulses);
+            points_[i] = point;
+            return;
+        }
+    }
+    if (pointCount_ < kMaxPointCount) {
+        points_[pointCount_++] = point;
+        return;
+    }
+    std::uint32_t replacement = SelectReplacement(point.pointA, point.depth);
+    if (replacement < kMaxPointCount) {
+        points_[replacement] = point;
+    }
+}
+
+std::uint32_t ContactManifold::SelectReplacement(const Vector3& point, float depth) const {
+    // 一番深い点は捨てない
+    std::uint32_t deepest = kMaxPointCount;
+    float maxDepth = depth;
+    for (std::uint32_t i = 0; i < kMaxPointCount; ++i) {
+        if (points_[i].depth > maxDepth) {
+            maxDepth = points_[i].depth;
+            deepest = i;
+        }
+    }
+    // i番目を新しい点に替えたときの面積が最大になるものを選ぶ。今の4点より狭くなるなら替えない
+    Vector3 positions[kMaxPointCount];
+    for (std::uint32_t i = 0; i < kMaxPointCount; ++i) {
+        positions[i] = points_[i].pointA;
+    }
+    float maxArea = deepest == kMaxPointCount ? 0.0f : EstimateArea(positions[0], positions[1], positions[2], positions[3]);
+    std::uint32_t replacement = kMaxPointCount;
+    for (std::uint32_t i = 0; i < kMaxPointCount; ++i) {
+        if (i == deepest) {
+            continue;
+        }
+        Vector3 replaced = positions[i];
+        positions[i] = point;
+        float area = EstimateArea(positions[0], positions[1], positions[2], positions[3]);
+        positions[i] = replaced;
+        if (area > maxArea) {
+            maxArea = area;
+            replacement = i;
+        }
+    }
+    return replacement;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+
+#include "../Math/MathUtils.hpp"
+#include "../Collision/Narrowphase.hpp"
+#include "ContactSolver.hpp"
+
+// 1つのペアの接触点を数ステップ分覚えておく
+// 狭域判定はペアごとに1点しか返さないので、点を剛体のローカル空間で持ち越して面で支える
+class ContactManifold {
+public:
+    static constexpr std::uint32_t kMaxPointCount = 4;
+
+    // 剛体の姿勢。動かない相手は原点と単位回転
+    struct Pose {
+        Vector3 position;
+        Quaternion rotation;
+    };
+
+    struct Point {
+        Vector3 localA;
+        Vector3 localB;
+        // ワールド空間。Refreshで求め直す
+        Vector3 pointA;
+        Vector3 pointB;
+        float depth;
+        // 前のステップの力積。法線と摩擦2軸
+        float impulses[ContactSolver::kRowCount];
+    };
+
+    ContactManifold() : normal_(Vector3::unitY), pointCount_(0), points_{} {}
+
+    // 今の姿勢で点を求め直し、離れた点と接平面でずれた点を捨てる
+    void Refresh(const Vector3& normal, const Pose& poseA, const Pose& poseB, float breakingDistance);
+    // 狭域判定の点を加える。近い点があれば置き換え、あふれたら一番深い点を残して広く張る4点を選ぶ
+    void Add(const Contact& contact, const Pose& poseA, const Pose& poseB, float breakingDistance);
+
+    const Vector3& GetNormal() const { return normal_; }
+    std::uint32_t GetPointCount() const { return pointCount_; }
+    Point& GetPoint(std::uint32_t index) { return points_[index]; }
+    const Point& GetPoint(std::uint32_t index) const { return points_[index]; }
+
+private:
+    // 入れ替える点。どれも捨てられなければkMaxPointCount
+    std::uint32_t SelectReplacement(const Vector3& point, float depth) const;
+
+    Vector3 normal_;
+    std::uint32_t pointCount_;
+    Point points_[kMaxPointCount];
+};
@@ -0,0 +1,108 @@
+#include "ContactSolver.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    constexpr float kEpsilon = 1.0e-6f;
+}
+
+void ContactSolver::Clear() {
+    bodiesA_.clear();
+    bodiesB_.clear();
+    frictions_.clear();
+    biases_.clear();
+    linears_.clear();
+    angularsA_.clear();
+    angularsB_.clear();
+    angularResponsesA_.clear();
+    angularResponsesB_.clear();
+    effectiveMasses_.clear();
+    impulses_.clear();
+}
+
+void ContactSolver::Add(std::uint32_t bodyA, std::uint32_t bodyB, const Vector3& normal, const Vector3& rA, const Vector3& rB, float depth, float friction, float restitution, const float* impulses, const SolverBodies& bodies, float deltaTime, const Settings& settings) {
+    bodiesA_.push_back(bodyA);
+    bodiesB_.push_back(bodyB);
+    frictions_.push_back(friction);
+
+    // 法線と、それに直交する2軸
+    Vector3 tangent = Vector3::Cross(std::abs(normal.x) < 0.9f ? Vector3::unitX : Vector3::unitY, normal).Normalized();
+    Vector3 directions[kRowCount] = { normal, tangent, Vector3::Cross(normal, tangent) };
+    float inverseMassA = bodies.inverseMasses[bodyA];
+    float inverseMassB = bodies.inverseMasses[bodyB];
+    for (std::uint32_t row = 0; row < kRowCount; ++row) {
+        const Vector3& direction = directions[row];
+        Vector3 angularA = -Vector3::Cross(rA, direction);
+        Vector3 angularB = Vector3::Cross(rB, direction);
+        Vector3 responseA = angularA * bodies.inverseInertias[bodyA];
+        Vector3 responseB = angularB * bodies.inverseInertias[bodyB];
+        float k = inverseMassA + inverseMassB + Vector3::Dot(angularA, responseA) + Vector3::Dot(angularB, responseB);
+        linears_.push_back(direction);
+        angularsA_.push_back(angularA);
+        angularsB_.push_back(angularB);
+        angularResponsesA_.push_back(responseA);
+        angularResponsesB_.push_back(responseB);
+        effectiveMasses_.push_back(k > kEpsilon ? 1.0f / k : 0.0f);
+        impulses_.push_back(impulses ? impulses[row] : 0.0f);
+    }
+
+    // めり込みを戻す速さと、跳ね返る速さの大きい方
+    Vector3 velocityA = bodies.velocities[bodyA] + Vector3::Cross(bodies.angularVelocities[bodyA], rA);
+    Vector3 velocityB = bodies.velocities[bodyB] + Vector3::Cross(bodies.angularVelocities[bodyB], rB);
+    float normalSpeed = Vector3::Dot(velocityB - velocityA, normal);
+    float bias = settings.biasFactor / deltaTime * std::max(depth - settings.slop, 0.0f);
+    if (normalSpeed < -settings.restitutionThreshold) {
+        bias = std::max(bias, -restitution * normalSpeed);
+    }
+    biases_.push_back(bias);
+}
+
+void ContactSolver::WarmStart(SolverBodies& bodies) const {
+    for (std::uint32_t contact = 0; contact < GetCount(); ++contact) {
+        for (std::uint32_t row = 0; row < kRowCount; ++row) {
+            ApplyImpulse(bodies, contact, row, impulses_[contact * kRowCount + row]);
+        }
+    }
+}
+
+void ContactSolver::Solve(SolverBodies& bodies) {
+    for (std::uint32_t contact = 0; contact < GetCount(); ++contact) {
+        std::uint32_t bodyA = bodiesA_[contact];
+        std::uint32_t bodyB = bodiesB_[contact];
+        size_t base = contact * kRowCount;
+        // 法線を先に解き、その力積で摩擦を抑える
+        for (std::uint32_t row = 0; row < kRowCount; ++row) {
+            size_t i = base + row;
+            float speed =
+                Vector3::Dot(linears_[i], bodies.velocities[bodyB] - bodies.velocities[bodyA]) +
+                Vector3::Dot(angularsA_[i], bodies.angularVelocities[bodyA]) +
+                Vector3::Dot(angularsB_[i], bodies.angularVelocities[bodyB]);
+            float lambda;
+            if (row == 0) {
+                lambda = (biases_[contact] - speed) * effectiveMasses_[i];
+                float impulse = std::max(impulses_[i] + lambda, 0.0f);
+                lambda = impulse - impulses_[i];
+                impulses_[i] = impulse;
+            }
+            else {
+                float maxImpulse = frictions_[contact] * impulses_[base];
+                lambda = -speed * effectiveMasses_[i];
+                float impulse = std::clamp(impulses_[i] + lambda, -maxImpulse, maxImpulse);
+                lambda = impulse - impulses_[i];
+                impulses_[i] = impulse;
+            }
+            ApplyImpulse(bodies, contact, row, lambda);
+        }
+    }
+}
+
+void ContactSolver::ApplyImpulse(SolverBodies& bodies, std::uint32_t contact, std::uint32_t row, float impulse) const {
+    std::uint32_t bodyA = bodiesA_[contact];
+    std::uint32_t bodyB = bodiesB_[contact];
+    size_t i = contact * kRowCount + row;
+    bodies.velocities[bodyA] -= linears_[i] * (impulse * bodies.inverseMasses[bodyA]);
+    bodies.angularVelocities[bodyA] += angularResponsesA_[i] * impulse;
+    bodies.velocities[bodyB] += linears_[i] * (impulse * bodies.inverseMasses[bodyB]);
+    bodies.angularVelocities[bodyB] += angularResponsesB_[i] * impulse;
+}
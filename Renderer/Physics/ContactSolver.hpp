@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "../Math/MathUtils.hpp"
+#include "SolverBodies.hpp"
+
+// 接触を逐次インパルス法で解く。法線1行と摩擦2行
+// 接触ごとの値は成分ごとの配列に詰め、Solveは先頭から順に読む
+class ContactSolver {
+public:
+    static constexpr std::uint32_t kRowCount = 3;
+
+    struct Settings {
+        // 位置の誤差を1ステップで戻す割合
+        float biasFactor = 0.2f;
+        // 戻さずに残すめり込み
+        float slop = 0.005f;
+        // これより遅くぶつかったときは跳ね返さない
+        float restitutionThreshold = 1.0f;
+    };
+
+    void Clear();
+    // normalはAからBへ向かう。rA、rBは重心から接触点へ
+    // impulsesは前のステップの法線と摩擦2軸の力積で、温め始めに使う。nullptrなら0から
+    void Add(std::uint32_t bodyA, std::uint32_t bodyB, const Vector3& normal, const Vector3& rA, const Vector3& rB, float depth, float friction, float restitution, const float* impulses, const SolverBodies& bodies, float deltaTime, const Settings& settings);
+    void WarmStart(SolverBodies& bodies) const;
+    void Solve(SolverBodies& bodies);
+
+    std::uint32_t GetCount() const { return static_cast<std::uint32_t>(bodiesA_.size()); }
+    // index番目の接触の力積。kRowCount個
+    const float* GetImpulses(std::uint32_t index) const { return impulses_.data() + index * kRowCount; }
+
+private:
+    void ApplyImpulse(SolverBodies& bodies, std::uint32_t contact, std::uint32_t row, float impulse) const;
+
+    std::vector<std::uint32_t> bodiesA_;
+    std::vector<std::uint32_t> bodiesB_;
+    std::vector<float> frictions_;
+    // 法線の行で目指す離れる速さ
+    std::vector<float> biases_;
+    // ここから下は接触ごとにkRowCount行分ずつ。先頭が法線
+    std::vector<Vector3> linears_;
+    std::vector<Vector3> angularsA_;
+    std::vector<Vector3> angularsB_;
+    std::vector<Vector3> angularResponsesA_;
+    std::vector<Vector3> angularResponsesB_;
+    std::vector<float> effectiveMasses_;
+    std::vector<float> impulses_;
+};
@@ -0,0 +1,176 @@
+#include "JointSolver.hpp"
+
+#include <cassert>
+#include <cmath>
+#include <utility>
+
+namespace {
+    constexpr std::uint32_t kMaxRowCount = JointSolver::kMaxRowCount;
+    constexpr float kSingularTolerance = 1.0e-8f;
+
+    // n×nの行列を掃き出し法で逆行列にする。正則でなければfalse
+    bool Invert(float (&matrix)[kMaxRowCount][kMaxRowCount], std::uint32_t n, float (&inverse)[kMaxRowCount][kMaxRowCount]) {
+        for (std::uint32_t row = 0; row < n; ++row) {
+            for (std::uint32_t column = 0; column < n; ++column) {
+                inverse[row][column] = row == column ? 1.0f : 0.0f;
+            }
+        }
+        float scale = 0.0f;
+        for (std::uint32_t i = 0; i < n; ++i) {
+            scale = std::max(scale, std::abs(matrix[i][i]));
+        }
+        for (std::uint32_t pivot = 0; pivot < n; ++pivot) {
+            std::uint32_t best = pivot;
+            for (std::uint32_t row = pivot + 1; row < n; ++row) {
+                if (std::abs(matrix[row][pivot]) > std::abs(matrix[best][pivot])) {
+                    best = row;
+                }
+            }
+            if (std::abs(matrix[best][pivot]) <= kSingularTolerance * scale || scale == 0.0f) {
+                return false;
+            }
+            if (best != pivot) {
+                std::swap(matrix[best], matrix[pivot]);
+                std::swap(inverse[best], inverse[pivot]);
+            }
+            float inversePivot = 1.0f / matrix[pivot][pivot];
+            for (std::uint32_t column = 0; column < n; ++column) {
+                matrix[pivot][column] *= inversePivot;
+                inverse[pivot][column] *= inversePivot;
+            }
+            for (std::uint32_t row = 0; row < n; ++row) {
+                float factor = matrix[row][pivot];
+                if (row == pivot || factor == 0.0f) {
+                    continue;
+                }
+                for (std::uint32_t column = 0; column < n; ++column) {
+                    matrix[row][column] -= factor * matrix[pivot][column];
+                    inverse[row][column] -= factor * inverse[pivot][column];
+                }
+            }
+        }
+        return true;
+    }
+}
+
+void JointSolver::Clear() {
+    bodiesA_.clear();
+    bodiesB_.clear();
+    rowCounts_.clear();
+    linears_.clear();
+    angularsA_.clear();
+    angularsB_.clear();
+    angularResponsesA_.clear();
+    angularResponsesB_.clear();
+    biases_.clear();
+    impulses_.clear();
+    effectiveMasses_.clear();
+}
+
+void JointSolver::Add(std::uint32_t bodyA, std::uint32_t bodyB, const ConstraintRow* rows, std::uint32_t rowCount, const float* impulses, const SolverBodies& bodies, float biasFactor) {
+    assert(rowCount <= kMaxRowCount);
+    bodiesA_.push_back(bodyA);
+    bodiesB_.push_back(bodyB);
+    rowCounts_.push_back(rowCount);
+
+    // 使わない行も0で埋め、関節ごとの幅をそろえる
+    float inverseMassA = bodies.inverseMasses[bodyA];
+    float inverseMassB = bodies.inverseMasses[bodyB];
+    const Matrix4x4& inverseInertiaA = bodies.inverseInertias[bodyA];
+    const Matrix4x4& inverseInertiaB = bodies.inverseInertias[bodyB];
+    size_t base = linears_.size();
+    for (std::uint32_t i = 0; i < kMaxRowCount; ++i) {
+        ConstraintRow row = i < rowCount ? rows[i] : ConstraintRow{ Vector3::zero, Vector3::zero, Vector3::zero, 0.0f };
+        linears_.push_back(row.linear);
+        angularsA_.push_back(row.angularA);
+        angularsB_.push_back(row.angularB);
+        angularResponsesA_.push_back(row.angularA * inverseInertiaA);
+        angularResponsesB_.push_back(row.angularB * inverseInertiaB);
+        biases_.push_back(row.error * biasFactor);
+        impulses_.push_back(impulses && i < rowCount ? impulses[i] : 0.0f);
+    }
+
+    // K = J M^-1 J^T
+    float matrix[kMaxRowCount][kMaxRowCount]{};
+    for (std::uint32_t row = 0; row < rowCount; ++row) {
+        for (std::uint32_t column = 0; column < rowCount; ++column) {
+            matrix[row][column] =
+                (inverseMassA + inverseMassB) * Vector3::Dot(linears_[base + row], linears_[base + column]) +
+                Vector3::Dot(angularsA_[base + row], angularResponsesA_[base + column]) +
+                Vector3::Dot(angularsB_[base + row], angularResponsesB_[base + column]);
+        }
+    }
+    float inverse[kMaxRowCount][kMaxRowCount]{};
+    if (!Invert(matrix, rowCount, inverse)) {
+        for (std::uint32_t row = 0; row < kMaxRowCount; ++row) {
+            for (std::uint32_t column = 0; column < kMaxRowCount; ++column) {
+                inverse[row][column] = 0.0f;
+            }
+        }
+        for (std::uint32_t i = 0; i < kMaxRowCount; ++i) {
+            impulses_[base + i] = 0.0f;
+        }
+    }
+    for (std::uint32_t row = 0; row < kMaxRowCount; ++row) {
+        for (std::uint32_t column = 0; column < kMaxRowCount; ++column) {
+            effectiveMasses_.push_back(inverse[row][column]);
+        }
+    }
+}
+
+void JointSolver::WarmStart(SolverBodies& bodies) const {
+    for (std::uint32_t joint = 0; joint < GetCount(); ++joint) {
+        ApplyImpulses(bodies, joint, impulses_.data() + joint * kMaxRowCount);
+    }
+}
+
+void JointSolver::Solve(SolverBodies& bodies) {
+    for (std::uint32_t joint = 0; joint < GetCount(); ++joint) {
+        std::uint32_t bodyA = bodiesA_[joint];
+        std::uint32_t bodyB = bodiesB_[joint];
+        std::uint32_t rowCount = rowCounts_[joint];
+        size_t base = joint * kMaxRowCount;
+        Vector3 relativeVelocity = bodies.velocities[bodyB] - bodies.velocities[bodyA];
+        const Vector3& angularVelocityA = bodies.angularVelocities[bodyA];
+        const Vector3& angularVelocityB = bodies.angularVelocities[bodyB];
+
+        // 全ての行の速度の誤差を同時に0にする力積 λ = -K^-1 (J v + bias)
+        float velocityErrors[kMaxRowCount];
+        for (std::uint32_t row = 0; row < rowCount; ++row) {
+            velocityErrors[row] =
+                Vector3::Dot(linears_[base + row], relativeVelocity) +
+                Vector3::Dot(angularsA_[base + row], angularVelocityA) +
+                Vector3::Dot(angularsB_[base + row], angularVelocityB) +
+                biases_[base + row];
+        }
+        const float* effectiveMass = effectiveMasses_.data() + base * kMaxRowCount;
+        float lambdas[kMaxRowCount];
+        for (std::uint32_t row = 0; row < rowCount; ++row) {
+            float lambda = 0.0f;
+            for (std::uint32_t column = 0; column < rowCount; ++column) {
+                lambda -= effectiveMass[row * kMaxRowCount + column] * velocityErrors[column];
+            }
+            lambdas[row] = lambda;
+            impulses_[base + row] += lambda;
+        }
+        ApplyImpulses(bodies, joint, lambdas);
+    }
+}
+
+void JointSolver::ApplyImpulses(SolverBodies& bodies, std::uint32_t joint, const float* impulses) const {
+    std::uint32_t bodyA = bodiesA_[joint];
+    std::uint32_t bodyB = bodiesB_[joint];
+    size_t base = joint * kMaxRowCount;
+    Vector3 linearImpulse = Vector3::zero;
+    Vector3 angularA = Vector3::zero;
+    Vector3 angularB = Vector3::zero;
+    for (std::uint32_t row = 0; row < rowCounts_[joint]; ++row) {
+        linearImpulse += linears_[base + row] * impulses[row];
+        angularA += angularResponsesA_[base + row] * impulses[row];
+        angularB += angularResponsesB_[base + row] * impulses[row];
+    }
+    bodies.velocities[bodyA] -= linearImpulse * bodies.inverseMasses[bodyA];
+    bodies.angularVelocities[bodyA] += angularA;
+    bodies.velocities[bodyB] += linearImpulse * bodies.inverseMasses[bodyB];
+    bodies.angularVelocities[bodyB] += angularB;
+}
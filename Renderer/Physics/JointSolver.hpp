@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "../Math/MathUtils.hpp"
+#include "SolverBodies.hpp"
+
+// 関節の拘束を逐次インパルス法で解く
+// 1つの関節の行はまとめて1つのブロックとして解く。有効質量の逆行列はAddで求めておく
+// 関節ごとの値は成分ごとの配列に詰め、Solveは先頭から順に読む
+class JointSolver {
+public:
+    static constexpr std::uint32_t kMaxRowCount = 6;
+
+    void Clear();
+    // rowsを積む。impulsesは前のステップの力積で、温め始めに使う。nullptrなら0から
+    // 行が独立でなければ（両方動かないなど）有効質量を0にして何もしない
+    void Add(std::uint32_t bodyA, std::uint32_t bodyB, const ConstraintRow* rows, std::uint32_t rowCount, const float* impulses, const SolverBodies& bodies, float biasFactor);
+    void WarmStart(SolverBodies& bodies) const;
+    void Solve(SolverBodies& bodies);
+
+    std::uint32_t GetCount() const { return static_cast<std::uint32_t>(bodiesA_.size()); }
+    // index番目の関節の力積。kMaxRowCount個
+    const float* GetImpulses(std::uint32_t index) const { return impulses_.data() + index * kMaxRowCount; }
+
+private:
+    // 力積をrowCount行分加える
+    void ApplyImpulses(SolverBodies& bodies, std::uint32_t joint, const float* impulses) const;
+
+    std::vector<std::uint32_t> bodiesA_;
+    std::vector<std::uint32_t> bodiesB_;
+    std::vector<std::uint32_t> rowCounts_;
+    // ここから下は関節ごとにkMaxRowCount行分ずつ
+    std::vector<Vector3> linears_;
+    std::vector<Vector3> angularsA_;
+    std::vector<Vector3> angularsB_;
+    // 力積1あたりの角速度の変化（I^-1 J^T）
+    std::vector<Vector3> angularResponsesA_;
+    std::vector<Vector3> angularResponsesB_;
+    std::vector<float> biases_;
+    std::vector<float> impulses_;
+    // 有効質量（J M^-1 J^T の逆行列）。関節ごとにkMaxRowCount * kMaxRowCount
+    std::vector<float> effectiveMasses_;
+};
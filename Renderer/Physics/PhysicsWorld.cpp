@@ -0,0 +1,294 @@
+#include "PhysicsWorld.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#include "../Collider.hpp"
+#include "../GameObject.hpp"
+#include "../Joint.hpp"
+#include "../Rigidbody.hpp"
+#include "../Collision/Broadphase.hpp"
+#include "../Collision/CollisionWorld.hpp"
+
+namespace {
+    constexpr float kEpsilon = 1.0e-6f;
+
+    // normalに直交する2軸
+    void MakeTangents(const Vector3& normal, Vector3& tangent, Vector3& bitangent) {
+        tangent = Vector3::Cross(std::abs(normal.x) < 0.9f ? Vector3::unitX : Vector3::unitY, normal).Normalized();
+        bitangent = Vector3::Cross(normal, tangent);
+    }
+}
+
+void PhysicsWorld::Register(Rigidbody* rigidbody) {
+    assert(rigidbody && !rigidbody->world_);
+    rigidbody->world_ = this;
+    rigidbody->index_ = static_cast<std::uint32_t>(rigidbodies_.size());
+    rigidbodies_.push_back(rigidbody);
+}
+
+void PhysicsWorld::Unregister(Rigidbody* rigidbody) {
+    assert(rigidbody && rigidbody->world_ == this);
+    // 末尾と入れ替えて消す
+    std::uint32_t index = rigidbody->index_;
+    rigidbodies_[index] = rigidbodies_.back();
+    rigidbodies_[index]->index_ = index;
+    rigidbodies_.pop_back();
+    rigidbody->world_ = nullptr;
+    // つながっていた関節は外す
+    for (Joint* joint : joints_) {
+        if (joint->connectedBody_ == rigidbody) {
+            joint->connectedBody_ = nullptr;
+            joint->isConnected_ = false;
+        }
+    }
+}
+
+void PhysicsWorld::Register(Joint* joint) {
+    assert(joint && !joint->world_);
+    joint->world_ = this;
+    joint->index_ = static_cast<std::uint32_t>(joints_.size());
+    joints_.push_back(joint);
+    jointImpulses_.resize(joints_.size() * JointSolver::kMaxRowCount, 0.0f);
+}
+
+void PhysicsWorld::Unregister(Joint* joint) {
+    assert(joint && joint->world_ == this);
+    std::uint32_t index = joint->index_;
+    std::uint32_t last = static_cast<std::uint32_t>(joints_.size()) - 1;
+    joints_[index] = joints_[last];
+    joints_[index]->index_ = index;
+    joints_.pop_back();
+    std::copy_n(jointImpulses_.begin() + last * JointSolver::kMaxRowCount, JointSolver::kMaxRowCount, jointImpulses_.begin() + index * JointSolver::kMaxRowCount);
+    jointImpulses_.resize(joints_.size() * JointSolver::kMaxRowCount);
+    joint->world_ = nullptr;
+}
+
+void PhysicsWorld::Step(const CollisionWorld& collisionWorld, float deltaTime) {
+    if (deltaTime <= 0.0f) {
+        return;
+    }
+    GatherBodies(deltaTime);
+    contactSolver_.Clear();
+    AddContacts(collisionWorld, deltaTime);
+    jointSolver_.Clear();
+    AddJoints(deltaTime);
+
+    // 関節と接触を交互に解き、互いの結果を次の反復で取り込む
+    jointSolver_.WarmStart(bodies_);
+    contactSolver_.WarmStart(bodies_);
+    for (std::uint32_t iteration = 0; iteration < settings_.iterationCount; ++iteration) {
+        jointSolver_.Solve(bodies_);
+        contactSolver_.Solve(bodies_);
+    }
+    for (std::uint32_t i = 0; i < solvedPoints_.size(); ++i) {
+        std::copy_n(contactSolver_.GetImpulses(i), ContactSolver::kRowCount, solvedPoints_[i]->impulses);
+    }
+    for (std::uint32_t i = 0; i < solvedJoints_.size(); ++i) {
+        std::copy_n(jointSolver_.GetImpulses(i), JointSolver::kMaxRowCount, jointImpulses_.begin() + solvedJoints_[i] * JointSolver::kMaxRowCount);
+    }
+    Integrate(deltaTime);
+}
+
+void PhysicsWorld::GatherBodies(float deltaTime) {
+    std::uint32_t count = GetRigidbodyCount();
+    bodies_.Resize(count + 1);
+    positions_.resize(count);
+    orientations_.resize(count);
+    Matrix4x4 zero = Matrix4x4::MakeScaling(Vector3::zero);
+    for (std::uint32_t i = 0; i < count; ++i) {
+        Rigidbody& rigidbody = *rigidbodies_[i];
+        const Transform& transform = rigidbody.GetTransform();
+        positions_[i] = transform.translate;
+        orientations_[i] = transform.rotate.Normalized();
+        bodies_.velocities[i] = rigidbody.velocity_;
+        bodies_.angularVelocities[i] = rigidbody.angularVelocity_;
+        if (rigidbody.isKinematic_ || rigidbody.mass_ <= 0.0f) {
+            bodies_.inverseMasses[i] = 0.0f;
+            bodies_.inverseInertias[i] = zero;
+        }
+        else {
+            // I^-1 = R^T D^-1 R（行ベクトルに右から掛ける）
+            Vector3 inertia = rigidbody.ComputeLocalInertia();
+            Vector3 inverseInertia(
+                inertia.x > kEpsilon ? 1.0f / inertia.x : 0.0f,
+                inertia.y > kEpsilon ? 1.0f / inertia.y : 0.0f,
+                inertia.z > kEpsilon ? 1.0f / inertia.z : 0.0f);
+            Matrix4x4 rotation = Matrix4x4::MakeRotation(orientations_[i]);
+            bodies_.inverseMasses[i] = 1.0f / rigidbody.mass_;
+            bodies_.inverseInertias[i] = rotation.Transpose() * Matrix4x4::MakeScaling(inverseInertia) * rotation;
+
+            Vector3 acceleration = rigidbody.force_ * bodies_.inverseMasses[i];
+            if (rigidbody.useGravity_) {
+                acceleration += settings_.gravity;
+            }
+            bodies_.velocities[i] += acceleration * deltaTime;
+            bodies_.angularVelocities[i] += (rigidbody.torque_ * bodies_.inverseInertias[i]) * deltaTime;
+            bodies_.velocities[i] *= 1.0f / (1.0f + rigidbody.linearDamping_ * deltaTime);
+            bodies_.angularVelocities[i] *= 1.0f / (1.0f + rigidbody.angularDamping_ * deltaTime);
+        }
+        rigidbody.force_ = Vector3::zero;
+        rigidbody.torque_ = Vector3::zero;
+    }
+    // 動かない相手
+    bodies_.velocities[count] = Vector3::zero;
+    bodies_.angularVelocities[count] = Vector3::zero;
+    bodies_.inverseMasses[count] = 0.0f;
+    bodies_.inverseInertias[count] = zero;
+}
+
+void PhysicsWorld::AddContacts(const CollisionWorld& collisionWorld, float deltaTime) {
+    // 前のステップで触れていたペアの接触点だけを引き継ぐ
+    std::swap(manifolds_, previousManifolds_);
+    manifolds_.clear();
+    solvedPoints_.clear();
+    std::uint32_t count = GetRigidbodyCount();
+    float warmStart[ContactSolver::kRowCount];
+    for (const CollisionPair& pair : collisionWorld.GetCollisionPairs()) {
+        if (pair.isTrigger) {
+            continue;
+        }
+        Rigidbody* rigidbodyA = pair.colliderA->GetGameObject().GetComponent<Rigidbody>();
+        Rigidbody* rigidbodyB = pair.colliderB->GetGameObject().GetComponent<Rigidbody>();
+        std::uint32_t bodyA = GetBodyIndex(rigidbodyA);
+        std::uint32_t bodyB = GetBodyIndex(rigidbodyB);
+        if (bodies_.inverseMasses[bodyA] == 0.0f && bodies_.inverseMasses[bodyB] == 0.0f) {
+            continue;
+        }
+        std::uint64_t key = Broadphase::MakePairKey(pair.colliderA->GetID(), pair.colliderB->GetID());
+        ContactManifold& manifold = manifolds_[key];
+        auto previous = previousManifolds_.find(key);
+        if (previous != previousManifolds_.end()) {
+            manifold = previous->second;
+        }
+        ContactManifold::Pose poseA = GetPose(bodyA);
+        ContactManifold::Pose poseB = GetPose(bodyB);
+        manifold.Refresh(pair.contact.normal, poseA, poseB, settings_.contactBreakingDistance);
+        manifold.Add(pair.contact, poseA, poseB, settings_.contactBreakingDistance);
+
+        for (std::uint32_t i = 0; i < manifold.GetPointCount(); ++i) {
+            ContactManifold::Point& point = manifold.GetPoint(i);
+            Vector3 position = (point.pointA + point.pointB) * 0.5f;
+            Vector3 rA = bodyA < count ? position - positions_[bodyA] : Vector3::zero;
+            Vector3 rB = bodyB < count ? position - positions_[bodyB] : Vector3::zero;
+            for (std::uint32_t row = 0; row < ContactSolver::kRowCount; ++row) {
+                warmStart[row] = point.impulses[row] * settings_.warmStartFactor;
+            }
+            contactSolver_.Add(bodyA, bodyB, manifold.GetNormal(), rA, rB, point.depth, settings_.friction, settings_.restitution, warmStart, bodies_, deltaTime, settings_.contact);
+            solvedPoints_.push_back(&point);
+        }
+    }
+}
+
+ContactManifold::Pose PhysicsWorld::GetPose(std::uint32_t body) const {
+    if (body < GetRigidbodyCount()) {
+        return { positions_[body], orientations_[body] };
+    }
+    return { Vector3::zero, Quaternion::identity };
+}
+
+void PhysicsWorld::AddJoints(float deltaTime) {
+    solvedJoints_.clear();
+    float biasFactor = settings_.jointBiasFactor / deltaTime;
+    float warmStart[JointSolver::kMaxRowCount];
+    for (std::uint32_t index = 0; index < GetJointCount(); ++index) {
+        Joint& joint = *joints_[index];
+        Rigidbody* rigidbodyA = joint.isConnected_ ? joint.GetGameObject().GetComponent<Rigidbody>() : nullptr;
+        std::uint32_t count = GetRigidbodyCount();
+        std::uint32_t bodyA = GetBodyIndex(rigidbodyA);
+        std::uint32_t bodyB = GetBodyIndex(joint.connectedBody_);
+        if (bodyA == count) {
+            continue;
+        }
+        const Vector3& positionA = positions_[bodyA];
+        const Quaternion& rotationA = orientations_[bodyA];
+        Vector3 positionB = bodyB < count ? positions_[bodyB] : Vector3::zero;
+        Quaternion rotationB = bodyB < count ? orientations_[bodyB] : Quaternion::identity;
+
+        Vector3 rA = rotationA * joint.anchor_;
+        Vector3 rB = rotationB * joint.connectedAnchor_;
+        Vector3 separation = (positionB + rB) - (positionA + rA);
+        ConstraintRow rows[JointSolver::kMaxRowCount];
+        std::uint32_t rowCount = 0;
+        // アンカー同士のnの向きのずれ
+        auto addLinear = [&](const Vector3& n) {
+            rows[rowCount++] = { n, -Vector3::Cross(rA, n), Vector3::Cross(rB, n), Vector3::Dot(separation, n) };
+            };
+        auto addAngular = [&](const Vector3& axis, float error) {
+            rows[rowCount++] = { Vector3::zero, -axis, axis, error };
+            };
+        // 向きのずれ。AからrelativeRotationだけ回した向きとBの向きの差を回転ベクトルにする
+        auto addRotation = [&]() {
+            Quaternion error = rotationB * (rotationA * joint.relativeRotation_).Conjugate();
+            float sign = error.w < 0.0f ? -2.0f : 2.0f;
+            Vector3 angle(error.x * sign, error.y * sign, error.z * sign);
+            addAngular(Vector3::unitX, angle.x);
+            addAngular(Vector3::unitY, angle.y);
+            addAngular(Vector3::unitZ, angle.z);
+            };
+
+        Vector3 axisA = (rotationA * joint.axis_).Normalized();
+        Vector3 tangent, bitangent;
+        MakeTangents(axisA, tangent, bitangent);
+        switch (joint.type_) {
+        case Joint::Type::kBall:
+            addLinear(Vector3::unitX);
+            addLinear(Vector3::unitY);
+            addLinear(Vector3::unitZ);
+            break;
+        case Joint::Type::kHinge: {
+            addLinear(Vector3::unitX);
+            addLinear(Vector3::unitY);
+            addLinear(Vector3::unitZ);
+            // 軸に直交する2軸の周りの回転を止める
+            Vector3 axisB = (rotationB * joint.connectedAxis_).Normalized();
+            Vector3 error = Vector3::Cross(axisA, axisB);
+            addAngular(tangent, Vector3::Dot(error, tangent));
+            addAngular(bitangent, Vector3::Dot(error, bitangent));
+            break;
+        }
+        case Joint::Type::kSlider:
+            addLinear(tangent);
+            addLinear(bitangent);
+            addRotation();
+            break;
+        case Joint::Type::kFixed:
+            addLinear(Vector3::unitX);
+            addLinear(Vector3::unitY);
+            addLinear(Vector3::unitZ);
+            addRotation();
+            break;
+        }
+
+        const float* impulses = jointImpulses_.data() + index * JointSolver::kMaxRowCount;
+        for (std::uint32_t row = 0; row < JointSolver::kMaxRowCount; ++row) {
+            warmStart[row] = impulses[row] * settings_.warmStartFactor;
+        }
+        jointSolver_.Add(bodyA, bodyB, rows, rowCount, warmStart, bodies_, biasFactor);
+        solvedJoints_.push_back(index);
+    }
+}
+
+void PhysicsWorld::Integrate(float deltaTime) {
+    for (std::uint32_t i = 0; i < GetRigidbodyCount(); ++i) {
+        Rigidbody& rigidbody = *rigidbodies_[i];
+        const Vector3& velocity = bodies_.velocities[i];
+        const Vector3& angularVelocity = bodies_.angularVelocities[i];
+        rigidbody.velocity_ = velocity;
+        rigidbody.angularVelocity_ = angularVelocity;
+
+        // dq/dt = 0.5 * ω * q
+        Quaternion& orientation = orientations_[i];
+        Quaternion spin(angularVelocity.x, angularVelocity.y, angularVelocity.z, 0.0f);
+        orientation = (orientation + (spin * orientation) * (0.5f * deltaTime)).Normalized();
+        Transform& transform = rigidbody.GetTransform();
+        transform.translate = positions_[i] + velocity * deltaTime;
+        transform.rotate = orientation;
+        transform.UpdateWorldMatrix();
+    }
+}
+
+std::uint32_t PhysicsWorld::GetBodyIndex(const Rigidbody* rigidbody) const {
+    return rigidbody && rigidbody->world_ == this ? rigidbody->index_ : GetRigidbodyCount();
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "../Math/MathUtils.hpp"
+#include "ContactManifold.hpp"
+#include "ContactSolver.hpp"
+#include "JointSolver.hpp"
+#include "SolverBodies.hpp"
+
+class CollisionWorld;
+class Rigidbody;
+class Joint;
+
+// 剛体を進める。接触と関節を同じ逐次インパルス法のループで解く
+// 接触はCollisionWorld::Stepで求めたペアごとの1点を、ペアごとのContactManifoldに貯めて使う
+class PhysicsWorld {
+public:
+    struct Settings {
+        Vector3 gravity = Vector3(0.0f, -9.8f, 0.0f);
+        std::uint32_t iterationCount = 10;
+        // Rigidbodyを持たない相手との摩擦と反発
+        float friction = 0.5f;
+        float restitution = 0.0f;
+        // 関節のずれを1ステップで戻す割合
+        float jointBiasFactor = 0.2f;
+        // 前のステップの関節と接触の力積から始める割合
+        float warmStartFactor = 0.8f;
+        // 持ち越した接触点を捨てる、離れた距離と接平面でのずれ
+        float contactBreakingDistance = 0.02f;
+        ContactSolver::Settings contact;
+    };
+
+    void Register(Rigidbody* rigidbody);
+    void Unregister(Rigidbody* rigidbody);
+    void Register(Joint* joint);
+    void Unregister(Joint* joint);
+
+    // collisionWorld.Stepの後に呼ぶ。その接触で速度を解き、姿勢をTransformに書き戻す
+    void Step(const CollisionWorld& collisionWorld, float deltaTime);
+
+    void SetSettings(const Settings& settings) { settings_ = settings; }
+    const Settings& GetSettings() const { return settings_; }
+    std::uint32_t GetRigidbodyCount() const { return static_cast<std::uint32_t>(rigidbodies_.size()); }
+    std::uint32_t GetJointCount() const { return static_cast<std::uint32_t>(joints_.size()); }
+    std::uint32_t GetContactCount() const { return contactSolver_.GetCount(); }
+
+private:
+    // 剛体の状態を解く用の配列に写し、外力で速度を進める
+    void GatherBodies(float deltaTime);
+    void AddContacts(const CollisionWorld& collisionWorld, float deltaTime);
+    ContactManifold::Pose GetPose(std::uint32_t body) const;
+    void AddJoints(float deltaTime);
+    // 速度で姿勢を進め、Transformに書き戻す
+    void Integrate(float deltaTime);
+    // Rigidbodyでなければ動かない相手の番号
+    std::uint32_t GetBodyIndex(const Rigidbody* rigidbody) const;
+
+    Settings settings_;
+    std::vector<Rigidbody*> rigidbodies_;
+    std::vector<Joint*> joints_;
+    // joints_と同じ並びで、前のステップの力積をJointSolver::kMaxRowCount個ずつ
+    std::vector<float> jointImpulses_;
+    // コライダーのペアのキーごとの接触点。今のステップで触れていないペアは次のStepで消える
+    std::unordered_map<std::uint64_t, ContactManifold> manifolds_;
+    std::unordered_map<std::uint64_t, ContactManifold> previousManifolds_;
+
+    SolverBodies bodies_;
+    std::vector<Vector3> positions_;
+    std::vector<Quaternion> orientations_;
+    ContactSolver contactSolver_;
+    JointSolver jointSolver_;
+    // 解いた関節の番号（joints_の添字）
+    std::vector<std::uint32_t> solvedJoints_;
+    // contactSolver_に加えた順の接触点。解いた力積を書き戻す
+    std::vector<ContactManifold::Point*> solvedPoints_;
+};
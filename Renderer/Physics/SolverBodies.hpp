@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "../Math/MathUtils.hpp"
+
+// 拘束を解く間の剛体の速度と質量。成分ごとの配列で持つ
+// 動かない相手は末尾の1つにまとめ、質量の逆数を0にする
+struct SolverBodies {
+    std::vector<Vector3> velocities;
+    std::vector<Vector3> angularVelocities;
+    std::vector<float> inverseMasses;
+    // ワールド空間の慣性テンソルの逆行列。平行移動は0
+    std::vector<Matrix4x4> inverseInertias;
+
+    void Resize(std::uint32_t count) {
+        velocities.resize(count);
+        angularVelocities.resize(count);
+        inverseMasses.resize(count);
+        inverseInertias.resize(count);
+    }
+    std::uint32_t GetCount() const { return static_cast<std::uint32_t>(inverseMasses.size()); }
+};
+
+// 拘束の1行分のヤコビアン
+// Aには-linear、Bには+linearの向きの力積が掛かる。角速度の係数は符号を含む
+struct ConstraintRow {
+    Vector3 linear;
+    Vector3 angularA;
+    Vector3 angularB;
+    // 位置の誤差。Bが正の向きに進んでいれば正
+    float error;
+};
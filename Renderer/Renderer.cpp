@@ -39,6 +39,10 @@ namespace {
         D3D12_VERTEX_BUFFER_VIEW vertexBufferView{};
         D3D12_INDEX_BUFFER_VIEW indexBufferView{};
         std::uint32_t indexCount{};
+        // 動的なメッシュは頂点バッファをバックバッファの数に区切り、書き込んだ区画を指す
+        void* mappedVertices{ nullptr };
+        std::uint32_t vertexCount{};
+        std::uint32_t writtenRegion{};
     };
     struct Instance {
         Vector4 mat0;
@@ -46,6 +50,13 @@ namespace {
         Vector4 mat2;
         Vector4 color;
     };
+    static_assert(sizeof(Instance) == sizeof(Renderer::InstanceData));
+    // DrawInstancesで予約した範囲
+    struct BulkDraw {
+        std::size_t mesh;
+        std::uint32_t first;
+        std::uint32_t count;
+    };
     struct DynamicBuffer {
         std::size_t size{};
         ComPtr<ID3D12Resource> resource;
@@ -663,6 +674,42 @@ public:
         return handle;
     }
 
+    std::size_t RegisterDynamicMesh(const std::vector<Vertex>& vertices, const std::vector<std::uint16_t> indices) {
+        std::size_t handle = meshes_.size();
+        auto& mesh = meshes_.emplace_back();
+        std::size_t vertexBufferSize = vertices.size() * sizeof(Vertex);
+        std::size_t indexBufferSize = indices.size() * sizeof(std::uint16_t);
+        mesh.vertexBuffer = CreateBufferResource(vertexBufferSize * kSwapChainBufferCount);
+        mesh.indexBuffer = CreateBufferResource(indexBufferSize);
+
+        mesh.vertexBuffer->Map(0, nullptr, &mesh.mappedVertices);
+        for (uint32_t i = 0; i < kSwapChainBufferCount; ++i) {
+            memcpy(static_cast<std::uint8_t*>(mesh.mappedVertices) + vertexBufferSize * i, vertices.data(), vertexBufferSize);
+        }
+        void* mappedPtr = nullptr;
+        mesh.indexBuffer->Map(0, nullptr, &mappedPtr);
+        memcpy(mappedPtr, indices.data(), indexBufferSize);
+
+        mesh.vertexBufferView.BufferLocation = mesh.vertexBuffer->GetGPUVirtualAddress();
+        mesh.vertexBufferView.SizeInBytes = static_cast<std::uint32_t>(vertexBufferSize);
+        mesh.vertexBufferView.StrideInBytes = static_cast<std::uint32_t>(sizeof(Vertex));
+        mesh.indexBufferView.BufferLocation = mesh.indexBuffer->GetGPUVirtualAddress();
+        mesh.indexBufferView.SizeInBytes = static_cast<std::uint32_t>(indexBufferSize);
+        mesh.indexBufferView.Format = DXGI_FORMAT_R16_UINT;
+        mesh.indexCount = static_cast<std::uint32_t>(indices.size());
+        mesh.vertexCount = static_cast<std::uint32_t>(vertices.size());
+        return handle;
+    }
+    // このフレームの区画を返す。1フレーム前の区画はまだGPUが読んでいるかもしれない
+    Vertex* MapDynamicVertices(std::size_t mesh_handle, std::uint32_t vertex_count) {
+        auto& mesh = meshes_[mesh_handle];
+        assert(mesh.mappedVertices && vertex_count == mesh.vertexCount);
+        (void)vertex_count;
+        uint32_t backBufferIndex = swapChain_->GetCurrentBackBufferIndex();
+        SelectRegion(mesh, backBufferIndex);
+        return static_cast<Vertex*>(mesh.mappedVertices) + static_cast<std::size_t>(mesh.vertexCount) * backBufferIndex;
+    }
+
     void AddWireFrameInstance(std::size_t mesh_handle, const Matrix4x4& world_matrix, const Vector4& color) {
         assert(objectCounter_ < kMaxObjectCount);
         Matrix4x4 mat = world_matrix.Transpose();
@@ -703,6 +750,7 @@ public:
             std::size_t copySize = instances.size() * sizeof(instances[0]);
             memcpy(copyDest, instances.data(), copySize);
             copyDest += instances.size();
+            PrepareDynamicMesh(meshIndex, backBufferIndex);
             D3D12_VERTEX_BUFFER_VIEW views[] = {
                 meshes_[meshIndex].vertexBufferView,
                 instancingBufferViews_[backBufferIndex]
@@ -726,6 +774,7 @@ public:
             std::size_t copySize = instances.size() * sizeof(instances[0]);
             memcpy(copyDest, instances.data(), copySize);
             copyDest += instances.size();
+            PrepareDynamicMesh(meshIndex, backBufferIndex);
             D3D12_VERTEX_BUFFER_VIEW views[] = {
                 meshes_[meshIndex].vertexBufferView,
                 instancingBufferViews_[backBufferIndex]
@@ -742,12 +791,67 @@ public:
 
         assert(objectCounter_ == instanceLocation);
 
+        // 書き込み済みの大量インスタンスは専用のバッファから直接描く
+        for (auto& draw : bulkDraws_) {
+            PrepareDynamicMesh(draw.mesh, backBufferIndex);
+            D3D12_VERTEX_BUFFER_VIEW views[] = {
+                meshes_[draw.mesh].vertexBufferView,
+                bulkBufferViews_[backBufferIndex]
+            };
+            commandList_->IASetVertexBuffers(0, _countof(views), views);
+            commandList_->IASetIndexBuffer(&meshes_[draw.mesh].indexBufferView);
+            commandList_->DrawIndexedInstanced(
+                meshes_[draw.mesh].indexCount,
+                draw.count,
+                0, 0,
+                draw.first);
+        }
+
         wireFrameInstancesMap_.clear();
         objInstancesMap_.clear();
         objectCounter_ = 0;
+        bulkDraws_.clear();
+        bulkCount_ = 0;
+    }
+
+    Renderer::InstanceData* AddBulkInstances(std::size_t mesh_handle, std::uint32_t count) {
+        if (count == 0 || count > kMaxBulkInstanceCount - bulkCount_) {
+            return nullptr;
+        }
+        uint32_t backBufferIndex = swapChain_->GetCurrentBackBufferIndex();
+        // 使わないアプリで64MBを持たないよう、初めて使うときに作る
+        DynamicBuffer& buffer = bulkBuffers_[backBufferIndex];
+        if (!buffer.resource) {
+            std::size_t strideSize = sizeof(Renderer::InstanceData);
+            buffer.size = strideSize * kMaxBulkInstanceCount;
+            buffer.resource = CreateBufferResource(buffer.size);
+            buffer.resource->Map(0, nullptr, &buffer.mappedPtr);
+            bulkBufferViews_[backBufferIndex].BufferLocation = buffer.resource->GetGPUVirtualAddress();
+            bulkBufferViews_[backBufferIndex].StrideInBytes = static_cast<std::uint32_t>(strideSize);
+            bulkBufferViews_[backBufferIndex].SizeInBytes = static_cast<std::uint32_t>(buffer.size);
+        }
+        Renderer::InstanceData* instances = buffer.GetMappedPtr<Renderer::InstanceData>() + bulkCount_;
+        bulkDraws_.push_back({ mesh_handle, bulkCount_, count });
+        bulkCount_ += count;
+        return instances;
     }
 
 private:
+    void SelectRegion(Mesh& mesh, uint32_t region) {
+        mesh.writtenRegion = region;
+        mesh.vertexBufferView.BufferLocation = mesh.vertexBuffer->GetGPUVirtualAddress() + static_cast<std::uint64_t>(mesh.vertexBufferView.SizeInBytes) * region;
+    }
+    // このフレームで更新されなかった動的なメッシュは前の区画を写し、GPUが読む区画に書かないようにする
+    void PrepareDynamicMesh(std::size_t mesh_handle, uint32_t backBufferIndex) {
+        auto& mesh = meshes_[mesh_handle];
+        if (!mesh.mappedVertices || mesh.writtenRegion == backBufferIndex) {
+            return;
+        }
+        std::uint8_t* base = static_cast<std::uint8_t*>(mesh.mappedVertices);
+        std::size_t size = mesh.vertexBufferView.SizeInBytes;
+        memcpy(base + size * backBufferIndex, base + size * mesh.writtenRegion, size);
+        SelectRegion(mesh, backBufferIndex);
+    }
     ComPtr<ID3D12Resource> CreateBufferResource(size_t size_in_bytes) {
         // アップロードヒープ
         D3D12_HEAP_PROPERTIES uploadHeapProperties{};
@@ -819,6 +923,11 @@ private:
     std::unordered_map<std::size_t, std::vector<Instance>> objInstancesMap_;
     std::unordered_map<std::size_t, std::vector<Instance>> wireFrameInstancesMap_;
     std::size_t objectCounter_{ 0 };
+    // フレームの終わりまでGPUが読まないので、バックバッファごとに持つ
+    DynamicBuffer bulkBuffers_[kSwapChainBufferCount];
+    D3D12_VERTEX_BUFFER_VIEW bulkBufferViews_[kSwapChainBufferCount]{};
+    std::vector<BulkDraw> bulkDraws_;
+    std::uint32_t bulkCount_{ 0 };
 
     DynamicBuffer sceneBuffers_[kSwapChainBufferCount];
     Matrix4x4 projectionMatrix_;
@@ -919,3 +1028,22 @@ void Renderer::DrawObject(std::size_t mesh_handle, const Vector3& scale, const Q
     pimpl_->AddObjInstance(mesh_handle, Matrix4x4::MakeAffineTransform(scale, rotate, translate), color);
     // pimpl_->AddLineInstance(mesh_handle, Matrix4x4::MakeAffineTransform(scale, rotate, translate), color);
 }
+
+std::size_t Renderer::RegisterDynamicMesh(const std::vector<Vector3>& positions, const std::vector<std::uint16_t> indices) {
+    std::vector<Vertex> vertices;
+    CalcNormals(positions, indices, &vertices);
+    return pimpl_->RegisterDynamicMesh(vertices, indices);
+}
+
+void Renderer::UpdateMesh(std::size_t mesh_handle, const std::vector<Vector3>& positions, const std::vector<Vector3>& normals) {
+    assert(positions.size() == normals.size());
+    Vertex* vertices = pimpl_->MapDynamicVertices(mesh_handle, static_cast<std::uint32_t>(positions.size()));
+    for (size_t i = 0; i < positions.size(); ++i) {
+        vertices[i].position = positions[i];
+        vertices[i].normal = normals[i];
+    }
+}
+
+Renderer::InstanceData* Renderer::DrawInstances(std::size_t mesh_handle, std::uint32_t count) {
+    return pimpl_->AddBulkInstances(mesh_handle, count);
+}
@@ -14,6 +14,16 @@ enum class DrawMode {
 class Renderer {
 public:
     static const std::uint32_t kMaxObjectCount = 1024;
+    // DrawInstancesで1フレームに出せる数
+    static const std::uint32_t kMaxBulkInstanceCount = 1 << 20;
+
+    // インスタンスごとの頂点データ。転置したワールド行列の3行と色
+    struct InstanceData {
+        Vector4 mat0;
+        Vector4 mat1;
+        Vector4 mat2;
+        Vector4 color;
+    };
 
     Renderer();
     ~Renderer();
@@ -24,6 +34,10 @@ public:
     void Finalize();
 
     std::size_t RegisterMesh(const std::vector<Vector3>& positions, const std::vector<std::uint16_t> indices);
+    // 頂点をフレームごとに書き換えられるメッシュ。インデックスは変えられない
+    std::size_t RegisterDynamicMesh(const std::vector<Vector3>& positions, const std::vector<std::uint16_t> indices);
+    // RegisterDynamicMeshで作ったメッシュの頂点を書き換える。数は登録時と同じ
+    void UpdateMesh(std::size_t mesh_handle, const std::vector<Vector3>& positions, const std::vector<Vector3>& normals);
 
     void DrawPlane(const Matrix4x4& world_matrix, const Vector4& color, DrawMode draw_mode);
     void DrawBox(const Matrix4x4& world_matrix, const Vector4& color, DrawMode draw_mode);
@@ -31,6 +45,11 @@ public:
     void DrawCapsule(const Matrix4x4& world_matrix, const Vector4& color, DrawMode draw_mode);
     
     void DrawObject(std::size_t mesh_handle, const Vector3& scale, const Quaternion& rotate, const Vector3& translate, const Vector4& color);
+    // count個のインスタンスを1回の描画で出す。返した領域にEndRenderingまでに書き込む
+    // 1フレームの合計がkMaxBulkInstanceCountを超えるならnullptr
+    InstanceData* DrawInstances(std::size_t mesh_handle, std::uint32_t count);
+
+    std::size_t GetBoxMesh() const { return box_; }
 
 private:
     Renderer(const Renderer&) = delete;
@@ -0,0 +1,87 @@
+#include "Rigidbody.hpp"
+
+#include <algorithm>
+
+#include "Externals/ImGui/imgui.h"
+
+#include "GameObject.hpp"
+#include "Scene.hpp"
+#include "BoxCollider.hpp"
+#include "CapsuleCollider.hpp"
+#include "SphereCollider.hpp"
+
+Rigidbody::Rigidbody(GameObject* const gameObject) :
+    Component(gameObject),
+    world_(nullptr),
+    index_(0),
+    velocity_(Vector3::zero),
+    angularVelocity_(Vector3::zero),
+    force_(Vector3::zero),
+    torque_(Vector3::zero),
+    mass_(1.0f),
+    linearDamping_(0.05f),
+    angularDamping_(0.05f),
+    useGravity_(true),
+    isKinematic_(false) {
+    Scene* scene = gameObject->GetScene();
+    if (scene) {
+        scene->GetPhysicsWorld().Register(this);
+    }
+}
+
+Rigidbody::~Rigidbody() {
+    if (world_) {
+        world_->Unregister(this);
+    }
+}
+
+void Rigidbody::ShowUI() {
+    if (ImGui::TreeNodeEx("Rigidbody", ImGuiTreeNodeFlags_DefaultOpen | ImGuiTreeNodeFlags_SpanAvailWidth)) {
+        ImGui::Unindent();
+        ImGui::DragFloat("Mass", &mass_, 0.1f, 0.001f, Math::positiveInfinity);
+        ImGui::DragFloat("LinearDamping", &linearDamping_, 0.01f, 0.0f, Math::positiveInfinity);
+        ImGui::DragFloat("AngularDamping", &angularDamping_, 0.01f, 0.0f, Math::positiveInfinity);
+        ImGui::Checkbox("UseGravity", &useGravity_);
+        ImGui::SameLine();
+        ImGui::Checkbox("Kinematic", &isKinematic_);
+        ImGui::DragFloat3("Velocity", &velocity_.x, 0.1f);
+        ImGui::DragFloat3("AngularVelocity", &angularVelocity_.x, 0.1f);
+        ImGui::TreePop();
+    }
+}
+
+Vector3 Rigidbody::ComputeLocalInertia() const {
+    // 重心はTransformの原点とみなす。コライダーがなければ直径1の球
+    const Vector3& scale = GetTransform().scale;
+    float maxScale = std::max({ std::abs(scale.x), std::abs(scale.y), std::abs(scale.z) });
+    Collider* collider = gameObject.GetComponent<Collider>();
+    if (!collider) {
+        float inertia = 0.1f * mass_;
+        return { inertia, inertia, inertia };
+    }
+    Vector3 size;
+    switch (collider->GetType()) {
+    case Collider::Type::kSphere: {
+        float radius = static_cast<const SphereCollider*>(collider)->GetRadius() * maxScale;
+        float inertia = 0.4f * mass_ * radius * radius;
+        return { inertia, inertia, inertia };
+    }
+    case Collider::Type::kCapsule: {
+        // 円柱で近似する
+        const auto* capsule = static_cast<const CapsuleCollider*>(collider);
+        float radius = capsule->GetRadius() * maxScale;
+        float height = capsule->GetHeight() * std::abs(scale.y);
+        float side = mass_ * (3.0f * radius * radius + height * height) / 12.0f;
+        return { side, 0.5f * mass_ * radius * radius, side };
+    }
+    case Collider::Type::kBox:
+        size = Vector3::Scale(static_cast<const BoxCollider*>(collider)->GetSize(), scale);
+        break;
+    default:
+        // ワールドのAABBの箱で近似する
+        size = collider->GetAABB().max - collider->GetAABB().min;
+        break;
+    }
+    Vector3 square(size.x * size.x, size.y * size.y, size.z * size.z);
+    return Vector3(square.y + square.z, square.x + square.z, square.x + square.y) * (mass_ / 12.0f);
+}
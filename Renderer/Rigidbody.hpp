@@ -0,0 +1,57 @@
+#pragma once
+#include "Component.hpp"
+
+#include <cstdint>
+
+#include "Math/MathUtils.hpp"
+
+class PhysicsWorld;
+
+// 接触と関節で動く剛体。PhysicsWorld::Stepで進め、Transformのtranslateとrotateに書き戻す
+// ルートのGameObjectに付ける。慣性は同じGameObjectのコライダーの形から求める
+class Rigidbody :
+    public Component {
+public:
+    Rigidbody(GameObject* const gameObject);
+    ~Rigidbody();
+
+    // 次のStepの間だけ掛かる
+    void AddForce(const Vector3& force) { force_ += force; }
+    void AddTorque(const Vector3& torque) { torque_ += torque; }
+    void ShowUI() override;
+
+    void SetVelocity(const Vector3& velocity) { velocity_ = velocity; }
+    void SetAngularVelocity(const Vector3& angularVelocity) { angularVelocity_ = angularVelocity; }
+    void SetMass(float mass) { mass_ = mass; }
+    // 毎秒失う速度の割合
+    void SetLinearDamping(float linearDamping) { linearDamping_ = linearDamping; }
+    void SetAngularDamping(float angularDamping) { angularDamping_ = angularDamping; }
+    void SetUseGravity(bool useGravity) { useGravity_ = useGravity; }
+    // 質量を無限とみなし、速度のまま動かす
+    void SetIsKinematic(bool isKinematic) { isKinematic_ = isKinematic; }
+
+    const Vector3& GetVelocity() const { return velocity_; }
+    const Vector3& GetAngularVelocity() const { return angularVelocity_; }
+    float GetMass() const { return mass_; }
+    float GetLinearDamping() const { return linearDamping_; }
+    float GetAngularDamping() const { return angularDamping_; }
+    bool UseGravity() const { return useGravity_; }
+    bool IsKinematic() const { return isKinematic_; }
+    // ローカル空間の慣性テンソルの対角成分
+    Vector3 ComputeLocalInertia() const;
+
+private:
+    PhysicsWorld* world_;
+    std::uint32_t index_;
+    Vector3 velocity_;
+    Vector3 angularVelocity_;
+    Vector3 force_;
+    Vector3 torque_;
+    float mass_;
+    float linearDamping_;
+    float angularDamping_;
+    bool useGravity_;
+    bool isKinematic_;
+
+    friend class PhysicsWorld;
+};
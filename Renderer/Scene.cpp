@@ -1,7 +1,7 @@
 #include "Scene.hpp"
 
 GameObject& Scene::AddGameObject(const std::string& name) {
-    auto& go = gameObjects_.emplace_back(std::make_unique<GameObject>());
+    auto& go = gameObjects_.emplace_back(std::make_unique<GameObject>(this));
     go->SetName(name);
     return *go;
 }
@@ -4,10 +4,15 @@
 #include <string>
 
 #include "GameObject.hpp"
+#include "Collision/CollisionWorld.hpp"
+#include "Physics/PhysicsWorld.hpp"
 
 class Scene :
     public Object {
 public:
+    explicit Scene(BroadphaseType broadphaseType = BroadphaseType::kSweepAndPrune) :
+        collisionWorld_(broadphaseType) {
+    }
 
     GameObject& AddGameObject(const std::string& name);
 
@@ -15,8 +20,15 @@ public:
     const std::vector<std::unique_ptr<GameObject>>& GetGameObjects() const { return gameObjects_; }
     GameObject& GetGameObject(size_t index) { return *gameObjects_[index]; }
     const GameObject& GetGameObject(size_t index) const { return *gameObjects_[index]; }
+    CollisionWorld& GetCollisionWorld() { return collisionWorld_; }
+    const CollisionWorld& GetCollisionWorld() const { return collisionWorld_; }
+    PhysicsWorld& GetPhysicsWorld() { return physicsWorld_; }
+    const PhysicsWorld& GetPhysicsWorld() const { return physicsWorld_; }
 
 private:
+    // コライダーと剛体が登録を解除できるようにゲームオブジェクトより後に破棄する
+    CollisionWorld collisionWorld_;
+    PhysicsWorld physicsWorld_;
     std::vector<std::unique_ptr<GameObject>> gameObjects_;
 
 };
\ No newline at end of file
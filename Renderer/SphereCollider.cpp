@@ -0,0 +1,28 @@
+#include "SphereCollider.hpp"
+
+#include "Externals/ImGui/imgui.h"
+
+#include "Collision/Support.hpp"
+
+Vector3 SphereCollider::FindFurthestPoint(const Vector3& direction) const {
+    return ToWorldPoint(center_ + Support::Sphere(ToLocalDirection(direction), radius_));
+}
+
+std::uint32_t SphereCollider::GetLocalHull(Vector3(&points)[BoundingVolume::kMaxLocalPoints], float& radius) const {
+    points[0] = center_;
+    radius = radius_;
+    return 1;
+}
+
+void SphereCollider::ShowUI() {
+    if (ImGui::TreeNodeEx("SphereCollider", ImGuiTreeNodeFlags_DefaultOpen | ImGuiTreeNodeFlags_SpanAvailWidth)) {
+        ImGui::Unindent();
+        Collider::ShowUI();
+        bool isChanged = ImGui::DragFloat3("Center", &center_.x, 0.1f);
+        isChanged |= ImGui::DragFloat("Radius", &radius_, 0.1f, 0.0f, Math::positiveInfinity);
+        if (isChanged) {
+            MarkShapeChanged();
+        }
+        ImGui::TreePop();
+    }
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include "Collider.hpp"
+
+class SphereCollider :
+    public Collider {
+public:
+    SphereCollider(GameObject* const gameObject) :
+        Collider(gameObject, Type::kSphere),
+        center_(Vector3::zero),
+        radius_(0.5f) {
+    }
+
+    Vector3 FindFurthestPoint(const Vector3& direction) const override;
+    std::uint32_t GetLocalHull(Vector3(&points)[BoundingVolume::kMaxLocalPoints], float& radius) const override;
+    void ShowUI() override;
+
+    void SetCenter(const Vector3& center) { center_ = center; MarkShapeChanged(); }
+    void SetRadius(float radius) { radius_ = radius; MarkShapeChanged(); }
+
+    const Vector3& GetCenter() const { return center_; }
+    float GetRadius() const { return radius_; }
+
+private:
+    Vector3 center_;
+    float radius_;
+};
@@ -0,0 +1,102 @@
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(std::uint32_t workerCount) :
+    task_(nullptr),
+    taskCount_(0),
+    generation_(0),
+    busyWorkerCount_(0),
+    isExiting_(false),
+    nextTask_(0),
+    finishedTaskCount_(0) {
+    workers_.reserve(workerCount);
+    for (std::uint32_t i = 0; i < workerCount; ++i) {
+        workers_.emplace_back(&ThreadPool::WorkerMain, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        isExiting_ = true;
+    }
+    wakeCondition_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+void ThreadPool::ParallelFor(std::uint32_t taskCount, const Task& task) {
+    if (taskCount == 0) {
+        return;
+    }
+    // 起こす手間の方が大きい
+    if (taskCount == 1 || workers_.empty()) {
+        for (std::uint32_t i = 0; i < taskCount; ++i) {
+            task(i);
+        }
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        task_ = &task;
+        taskCount_ = taskCount;
+        nextTask_.store(0, std::memory_order_relaxed);
+        finishedTaskCount_.store(0, std::memory_order_relaxed);
+        ++generation_;
+    }
+    wakeCondition_.notify_all();
+    RunTasks(task, taskCount);
+
+    // 遅れて起きたワーカーが次の呼び出しのタスクを古いtaskで取らないよう、抜けるまで待つ
+    std::unique_lock<std::mutex> lock(mutex_);
+    doneCondition_.wait(lock, [&] { return finishedTaskCount_.load(std::memory_order_acquire) == taskCount && busyWorkerCount_ == 0; });
+    task_ = nullptr;
+    taskCount_ = 0;
+}
+
+ThreadPool& ThreadPool::GetShared() {
+    static ThreadPool threadPool;
+    return threadPool;
+}
+
+void ThreadPool::WorkerMain() {
+    std::uint64_t generation = 0;
+    while (true) {
+        const Task* task;
+        std::uint32_t taskCount;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wakeCondition_.wait(lock, [&] { return isExiting_ || (generation != generation_ && task_); });
+            if (isExiting_) {
+                return;
+            }
+            generation = generation_;
+            task = task_;
+            taskCount = taskCount_;
+            ++busyWorkerCount_;
+        }
+        RunTasks(*task, taskCount);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            --busyWorkerCount_;
+        }
+        doneCondition_.notify_all();
+    }
+}
+
+void ThreadPool::RunTasks(const Task& task, std::uint32_t taskCount) {
+    while (true) {
+        std::uint32_t index = nextTask_.fetch_add(1, std::memory_order_relaxed);
+        if (index >= taskCount) {
+            break;
+        }
+        task(index);
+        if (finishedTaskCount_.fetch_add(1, std::memory_order_acq_rel) + 1 == taskCount) {
+            // 待っている呼び出し側を起こす。条件はmutex_の中で確かめ直される
+            std::lock_guard<std::mutex> lock(mutex_);
+            doneCondition_.notify_all();
+        }
+    }
+}
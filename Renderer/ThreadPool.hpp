@@ -0,0 +1,50 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 常駐するワーカースレッドでタスクを並列に処理する
+// ParallelForは1つのスレッドからだけ呼ぶ（入れ子にしない）
+class ThreadPool {
+public:
+    using Task = std::function<void(std::uint32_t)>;
+
+    // 呼び出し側も処理に加わるので既定はコア数-1
+    explicit ThreadPool(std::uint32_t workerCount = std::max(std::thread::hardware_concurrency(), 1u) - 1);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // task(0)～task(taskCount - 1)を並列に呼び、全て終わるまで待つ
+    void ParallelFor(std::uint32_t taskCount, const Task& task);
+
+    // 呼び出し側を含めた同時に動くスレッド数
+    std::uint32_t GetThreadCount() const { return static_cast<std::uint32_t>(workers_.size()) + 1; }
+
+    // 物理や当たり判定で共有する既定のプール
+    static ThreadPool& GetShared();
+
+private:
+    void WorkerMain();
+    void RunTasks(const Task& task, std::uint32_t taskCount);
+
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable wakeCondition_;
+    std::condition_variable doneCondition_;
+    // 以下はmutex_で守る
+    const Task* task_;
+    std::uint32_t taskCount_;
+    std::uint64_t generation_;
+    std::uint32_t busyWorkerCount_;
+    bool isExiting_;
+
+    std::atomic<std::uint32_t> nextTask_;
+    std::atomic<std::uint32_t> finishedTaskCount_;
+};
@@ -10,6 +10,7 @@
 #include "Utils.hpp"
 
 #include "GameObject.hpp"
+#include "BoxCollider.hpp"
 
 #include "Scene.hpp"
 
@@ -31,7 +32,8 @@ int WINAPI WinMain(_In_ HINSTANCE, _In_opt_ HINSTANCE, _In_ LPSTR, _In_ int) {
     Scene scene;
     scene.SetName("Scene");
     for (size_t i = 0; i < 10; ++i) {
-        scene.AddGameObject(("obj" + std::to_string(i)).c_str());
+        auto& gameObject = scene.AddGameObject(("obj" + std::to_string(i)).c_str());
+        gameObject.AddComponent<BoxCollider>();
     }
 
     scene.GetGameObject(0).transform.scale = { 10.0f,1.0f,10.0f };
@@ -67,6 +69,9 @@ int WINAPI WinMain(_In_ HINSTANCE, _In_opt_ HINSTANCE, _In_ LPSTR, _In_ int) {
                         }
                     }
                 }
+                scene.GetCollisionWorld().Step();
+                scene.GetPhysicsWorld().Step(scene.GetCollisionWorld(), 1.0f / 60.0f);
+
                 for (auto& o : scene.GetGameObjects()) {
                     renderer.DrawBox(o->transform.GetWorldMatrix(), { 1.0f,1.0f,1.0f,1.0f }, DrawMode::kObject);
                 }
@@ -80,6 +85,12 @@ int WINAPI WinMain(_In_ HINSTANCE, _In_opt_ HINSTANCE, _In_ LPSTR, _In_ int) {
                 is = inspectorView.IsVisible();
                 ImGui::Checkbox("InspectorView", &is);
                 inspectorView.SetIsVisible(is);
+                const auto& profile = scene.GetCollisionWorld().GetProfile();
+                ImGui::Text("AABB %.3fms Broad %.3fms Narrow %.3fms Dispatch %.3fms Snapshot %.3fms",
+                    profile.updateAABB, profile.broadphase, profile.narrowphase, profile.dispatch, profile.snapshot);
+                ImGui::Text("%s %.1fKB Static %u Pairs %u Culled %u Batched %u Cached %u Contacts %u",
+                    GetBroadphaseName(scene.GetCollisionWorld().GetBroadphase().GetType()),
+                    static_cast<float>(profile.broadphaseMemory) / 1024.0f, profile.staticCount, profile.candidatePairCount, profile.culledPairCount, profile.batchedPairCount, profile.cachedPairCount, profile.contactCount);
                 ImGui::End();
 
                 hierarchyView.Show();